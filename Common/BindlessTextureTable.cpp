@@ -0,0 +1,49 @@
+#include "BindlessTextureTable.h"
+
+BindlessTextureTable::BindlessTextureTable(uint32 baseDescriptor, uint32 capacity)
+    : m_baseDescriptor(baseDescriptor), m_slots(FallbackIndex + 1, capacity > 0 ? capacity - 1 : 0) {
+}
+
+uint32 BindlessTextureTable::Register(const String& name, bool* added) {
+    auto it = m_indices.find(name);
+    if (it != m_indices.end()) {
+        if (added) *added = false;
+        return it->second;
+    }
+
+    uint32 slot = m_slots.Allocate();
+    if (slot == DescriptorFreeList::InvalidIndex) {
+        throw std::runtime_error("Bindless texture table is full");
+    }
+
+    m_indices[name] = slot;
+    if (added) *added = true;
+    return slot;
+}
+
+uint32 BindlessTextureTable::Find(const String& name) const {
+    auto it = m_indices.find(name);
+    return (it != m_indices.end()) ? it->second : FallbackIndex;
+}
+
+uint32 BindlessTextureTable::Reassign(const String& name, uint64 fenceValue) {
+    auto it = m_indices.find(name);
+    if (it == m_indices.end()) return FallbackIndex;
+
+    uint32 slot = m_slots.Allocate();
+    if (slot == DescriptorFreeList::InvalidIndex) {
+        throw std::runtime_error("Bindless texture table is full");
+    }
+
+    m_slots.Free(it->second, fenceValue);
+    it->second = slot;
+    return slot;
+}
+
+void BindlessTextureTable::Unregister(const String& name, uint64 fenceValue) {
+    auto it = m_indices.find(name);
+    if (it == m_indices.end()) return;
+
+    m_slots.Free(it->second, fenceValue);
+    m_indices.erase(it);
+}
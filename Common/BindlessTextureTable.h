@@ -0,0 +1,45 @@
+#pragma once
+
+#include "DescriptorAllocators.h"
+
+// Assigns every texture a slot in one contiguous SRV range that shaders index directly.
+// Materials store the slot instead of binding a descriptor table per texture.
+//
+// Only the index bookkeeping lives here; the owner writes the SRVs at
+// GetDescriptorIndex(slot) of its descriptor heap.
+class BindlessTextureTable {
+public:
+    // Slot 0 holds a null SRV, so materials without a texture sample zero. The owner moves
+    // materials here when their texture is removed; Find returns it for unregistered names.
+    static constexpr uint32 FallbackIndex = 0;
+
+    BindlessTextureTable(uint32 baseDescriptor, uint32 capacity);
+
+    // Returns the slot for name, assigning a new one the first time. added tells whether
+    // a new slot was taken. Throws when the table is full.
+    uint32 Register(const String& name, bool* added = nullptr);
+
+    // Returns FallbackIndex for unknown names.
+    uint32 Find(const String& name) const;
+    bool Contains(const String& name) const { return m_indices.find(name) != m_indices.end(); }
+
+    // The slot may still be read by work up to fenceValue, so it is reused only after that.
+    void Unregister(const String& name, uint64 fenceValue);
+
+    // Moves name to a new slot and frees the old one after fenceValue, for textures whose
+    // resource is replaced while earlier frames may still read the old descriptor. Returns
+    // the new slot, FallbackIndex for unknown names. Throws when the table is full.
+    uint32 Reassign(const String& name, uint64 fenceValue);
+
+    void Reclaim(uint64 completedFenceValue) { m_slots.Reclaim(completedFenceValue); }
+
+    uint32 GetDescriptorIndex(uint32 slot) const { return m_baseDescriptor + slot; }
+    uint32 GetBaseDescriptor() const { return m_baseDescriptor; }
+    uint32 GetCapacity() const { return m_slots.GetCapacity() + 1; }
+    uint32 GetTextureCount() const { return static_cast<uint32>(m_indices.size()); }
+
+private:
+    uint32 m_baseDescriptor = 0;
+    DescriptorFreeList m_slots;         // Slots after FallbackIndex
+    HashMap<String, uint32> m_indices;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <WindowsPlatform.h>
+#include "GpuFence.h"
+
+// IGpuFence over an ID3D12Fence signalled from one command queue. Both are owned by
+// the caller. Waits reuse a single event instead of creating one per wait.
+class D3D12GpuFence : public IGpuFence {
+public:
+    D3D12GpuFence(ID3D12CommandQueue* queue, ID3D12Fence* fence)
+        : m_queue(queue), m_fence(fence), m_event(CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS)) {
+        if (!m_event.isValid()) {
+            throw std::runtime_error("Failed to create fence event");
+        }
+    }
+
+    void Signal(uint64 value) override { ThrowIfFailed(m_queue->Signal(m_fence, value)); }
+
+    uint64 GetCompletedValue() const override { return m_fence->GetCompletedValue(); }
+
+    void WaitForValue(uint64 value) override {
+        if (m_fence->GetCompletedValue() >= value) return;
+
+        ThrowIfFailed(m_fence->SetEventOnCompletion(value, m_event.get()));
+        WaitForSingleObject(m_event.get(), INFINITE);
+    }
+
+private:
+    ID3D12CommandQueue* m_queue = nullptr;
+    ID3D12Fence* m_fence = nullptr;
+    ScopedHandle m_event;
+};
@@ -24,6 +24,7 @@
 #include <wrl.h>
 
 #include "DDSTextureLoader.h" 
+#include "GpuMemoryAllocator.h"
 
 using namespace Microsoft::WRL;
 
@@ -1241,12 +1242,18 @@ static HRESULT CreateD3DResources12(
 	_In_ bool isCubeMap,
 	_In_reads_opt_(mipCount*arraySize) D3D12_SUBRESOURCE_DATA* initData,
 	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	GpuMemoryAllocator* allocator,
+	GpuAllocation* textureAllocation,
+	GpuAllocation* uploadAllocation
 	)
 {
 	if (device == nullptr)
 		return E_POINTER;
 
+	if (allocator && (!textureAllocation || !uploadAllocation))
+		return E_INVALIDARG;
+
 	if (forceSRGB)
 		format = MakeSRGB(format);
 
@@ -1269,15 +1276,23 @@ static HRESULT CreateD3DResources12(
 		texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 		texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-		CD3DX12_HEAP_PROPERTIES defaultHeapProperties(D3D12_HEAP_TYPE_DEFAULT);
-		hr = device->CreateCommittedResource(
-			&defaultHeapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&texDesc,
-			D3D12_RESOURCE_STATE_COMMON,
-			nullptr,
-			IID_PPV_ARGS(&texture)
-			);
+		if (allocator)
+		{
+			hr = allocator->CreateResource(D3D12_HEAP_TYPE_DEFAULT, texDesc,
+				D3D12_RESOURCE_STATE_COMMON, nullptr, *textureAllocation, texture);
+		}
+		else
+		{
+			CD3DX12_HEAP_PROPERTIES defaultHeapProperties(D3D12_HEAP_TYPE_DEFAULT);
+			hr = device->CreateCommittedResource(
+				&defaultHeapProperties,
+				D3D12_HEAP_FLAG_NONE,
+				&texDesc,
+				D3D12_RESOURCE_STATE_COMMON,
+				nullptr,
+				IID_PPV_ARGS(&texture)
+				);
+		}
 
 		if (FAILED(hr))
 		{
@@ -1289,18 +1304,28 @@ static HRESULT CreateD3DResources12(
 			const UINT num2DSubresources = texDesc.DepthOrArraySize * texDesc.MipLevels;
 			const UINT64 uploadBufferSize = GetRequiredIntermediateSize(texture.Get(), 0, num2DSubresources);
 
-			CD3DX12_HEAP_PROPERTIES uploadHeapProperties(D3D12_HEAP_TYPE_UPLOAD);
 			CD3DX12_RESOURCE_DESC uploadBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
-			hr = device->CreateCommittedResource(
-				&uploadHeapProperties,
-				D3D12_HEAP_FLAG_NONE,
-				&uploadBufferDesc,
-				D3D12_RESOURCE_STATE_GENERIC_READ,
-				nullptr,
-				IID_PPV_ARGS(&textureUploadHeap));
+			if (allocator)
+			{
+				hr = allocator->CreateResource(D3D12_HEAP_TYPE_UPLOAD, uploadBufferDesc,
+					D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, *uploadAllocation, textureUploadHeap);
+			}
+			else
+			{
+				CD3DX12_HEAP_PROPERTIES uploadHeapProperties(D3D12_HEAP_TYPE_UPLOAD);
+				hr = device->CreateCommittedResource(
+					&uploadHeapProperties,
+					D3D12_HEAP_FLAG_NONE,
+					&uploadBufferDesc,
+					D3D12_RESOURCE_STATE_GENERIC_READ,
+					nullptr,
+					IID_PPV_ARGS(&textureUploadHeap));
+			}
 			if (FAILED(hr))
 			{
 				texture = nullptr;
+				if (textureAllocation)
+					textureAllocation->Reset();
 				return hr;
 			}
 			else
@@ -1683,7 +1708,10 @@ static HRESULT CreateTextureFromDDS12(
 	_In_ size_t maxsize,
 	_In_ bool forceSRGB,
 	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap)
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	GpuMemoryAllocator* allocator,
+	GpuAllocation* textureAllocation,
+	GpuAllocation* uploadAllocation)
 {
 	HRESULT hr = S_OK;
 
@@ -1872,7 +1900,10 @@ static HRESULT CreateTextureFromDDS12(
 			isCubeMap,
 			initData.get(),
 			texture, 
-			textureUploadHeap);
+			textureUploadHeap,
+			allocator,
+			textureAllocation,
+			uploadAllocation);
 	}
 
 	return hr;
@@ -1931,7 +1962,10 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 	ComPtr<ID3D12Resource>& texture,
 	ComPtr<ID3D12Resource>& textureUploadHeap,
 	_In_ size_t maxsize,
-	_Out_opt_ DDS_ALPHA_MODE* alphaMode
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode,
+	_In_opt_ GpuMemoryAllocator* allocator,
+	_Out_opt_ GpuAllocation* textureAllocation,
+	_Out_opt_ GpuAllocation* uploadAllocation
 	)
 {
 	if (alphaMode)
@@ -1984,7 +2018,10 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 		maxsize,
 		false,
 		texture,
-		textureUploadHeap
+		textureUploadHeap,
+		allocator,
+		textureAllocation,
+		uploadAllocation
 		);
 
 	if (SUCCEEDED(hr))
@@ -2145,7 +2182,10 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 	_Out_ ComPtr<ID3D12Resource>& texture,
 	_Out_ ComPtr<ID3D12Resource>& textureUploadHeap,
 	_In_ size_t maxsize,
-	_Out_opt_ DDS_ALPHA_MODE* alphaMode)
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode,
+	_In_opt_ GpuMemoryAllocator* allocator,
+	_Out_opt_ GpuAllocation* textureAllocation,
+	_Out_opt_ GpuAllocation* uploadAllocation)
 {
 	if (texture)
 	{
@@ -2177,7 +2217,8 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 	}
 
 	hr = CreateTextureFromDDS12(device, cmdList, header,
-		bitData, bitSize, maxsize, false, texture, textureUploadHeap);
+		bitData, bitSize, maxsize, false, texture, textureUploadHeap,
+		allocator, textureAllocation, uploadAllocation);
 
 	if (SUCCEEDED(hr))
 	{
@@ -44,6 +44,10 @@
 #define _Use_decl_annotations_
 #endif
 
+// Optional placement of the D3D12 resources, see GpuMemoryAllocator.h
+class GpuMemoryAllocator;
+class GpuAllocation;
+
 namespace DirectX
 {
     enum DDS_ALPHA_MODE
@@ -72,7 +76,10 @@ namespace DirectX
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                                 _In_ size_t maxsize = 0,
-		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                                 _In_opt_ GpuMemoryAllocator* allocator = nullptr,
+		                                 _Out_opt_ GpuAllocation* textureAllocation = nullptr,
+		                                 _Out_opt_ GpuAllocation* uploadAllocation = nullptr
 		                                 );
 
     HRESULT CreateDDSTextureFromFile( _In_ ID3D11Device* d3dDevice,
@@ -89,7 +96,10 @@ namespace DirectX
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                               _In_ size_t maxsize = 0,
-		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                               _In_opt_ GpuMemoryAllocator* allocator = nullptr,
+		                               _Out_opt_ GpuAllocation* textureAllocation = nullptr,
+		                               _Out_opt_ GpuAllocation* uploadAllocation = nullptr
 		                               );
 
     // Standard version with optional auto-gen mipmap support
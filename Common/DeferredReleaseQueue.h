@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Types.h>
+#include <deque>
+
+// Holds objects the GPU may still reference until a fence value has been reached.
+// Anything movable can be queued: ComPtrs, UniquePtrs, GpuAllocations, whole structs
+// of them. Destroying the queued object is what releases it.
+class DeferredReleaseQueue {
+public:
+    DeferredReleaseQueue() = default;
+    ~DeferredReleaseQueue() = default;
+
+    DECLARE_NON_COPYABLE(DeferredReleaseQueue)
+    DECLARE_NON_MOVABLE(DeferredReleaseQueue)
+
+    template<typename T>
+    void Push(T&& object, uint64 fenceValue) {
+        using Stored = std::decay_t<T>;
+
+        Entry entry;
+        entry.fenceValue = fenceValue;
+        entry.object = UniquePtr<Releasable>(new Holder<Stored>(std::forward<T>(object)));
+
+        // Values are normally handed out in order; keep the queue sorted if they are not.
+        auto it = m_entries.end();
+        while (it != m_entries.begin() && std::prev(it)->fenceValue > fenceValue) {
+            --it;
+        }
+        m_entries.insert(it, std::move(entry));
+    }
+
+    // Destroys every object whose fence value is <= completedValue. Returns how many.
+    uint32 Collect(uint64 completedValue) {
+        uint32 released = 0;
+        while (!m_entries.empty() && m_entries.front().fenceValue <= completedValue) {
+            m_entries.pop_front();
+            ++released;
+        }
+        return released;
+    }
+
+    // Destroys everything. Only valid once the GPU is idle.
+    void Clear() { m_entries.clear(); }
+
+    uint32 GetPendingCount() const { return static_cast<uint32>(m_entries.size()); }
+    bool IsEmpty() const { return m_entries.empty(); }
+
+private:
+    struct Releasable {
+        virtual ~Releasable() = default;
+    };
+
+    template<typename T>
+    struct Holder : Releasable {
+        explicit Holder(T&& value) : object(std::move(value)) {}
+        explicit Holder(const T& value) : object(value) {}
+        T object;
+    };
+
+    struct Entry {
+        uint64 fenceValue = 0;
+        UniquePtr<Releasable> object;
+    };
+
+    std::deque<Entry> m_entries;
+};
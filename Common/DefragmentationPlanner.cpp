@@ -0,0 +1,146 @@
+#include "DefragmentationPlanner.h"
+
+namespace {
+
+float Occupancy(const TlsfAllocator* block) {
+    return static_cast<float>(block->GetUsedBytes()) / static_cast<float>(block->GetCapacity());
+}
+
+} // namespace
+
+DefragmentationPlanner::Plan DefragmentationPlanner::CreatePlan(const Vector<TlsfAllocator*>& blocks,
+                                                                const Function<bool(uint32, uint32)>& canMove,
+                                                                const Settings& settings) {
+    Plan plan;
+
+    // Cheapest blocks to empty first.
+    Vector<uint32> candidates;
+    for (uint32 i = 0; i < blocks.size(); ++i) {
+        if (blocks[i] && !blocks[i]->IsEmpty() && Occupancy(blocks[i]) < settings.sparseOccupancy) {
+            candidates.push_back(i);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [&blocks](uint32 a, uint32 b) {
+        return blocks[a]->GetUsedBytes() < blocks[b]->GetUsedBytes();
+    });
+
+    // A block is either a source or a destination within one pass, never both.
+    Vector<bool> evacuated(blocks.size(), false);
+    Vector<bool> received(blocks.size(), false);
+
+    for (uint32 src : candidates) {
+        TlsfAllocator* srcBlock = blocks[src];
+        if (received[src] || Occupancy(srcBlock) >= settings.sparseOccupancy) continue;
+        if (plan.bytesMoved + srcBlock->GetUsedBytes() > settings.maxBytesPerPass) continue;
+        if (plan.moves.size() + srcBlock->GetAllocationCount() > settings.maxMovesPerPass) continue;
+
+        Vector<TlsfAllocator::Allocation> allocations;
+        bool pinned = false;
+        srcBlock->ForEachAllocation([&](const TlsfAllocator::Allocation& allocation) {
+            pinned |= !canMove(src, allocation.node);
+            allocations.push_back(allocation);
+        });
+        if (pinned) continue;
+
+        // Largest first, into the fullest block that fits, keeps the destinations dense.
+        std::sort(allocations.begin(), allocations.end(),
+            [](const TlsfAllocator::Allocation& a, const TlsfAllocator::Allocation& b) { return a.size > b.size; });
+
+        Vector<uint32> destinations;
+        for (uint32 i = 0; i < blocks.size(); ++i) {
+            if (blocks[i] && i != src && !evacuated[i] && blocks[i]->GetGranularity() == srcBlock->GetGranularity()) {
+                destinations.push_back(i);
+            }
+        }
+        std::sort(destinations.begin(), destinations.end(), [&blocks](uint32 a, uint32 b) {
+            return blocks[a]->GetUsedBytes() > blocks[b]->GetUsedBytes();
+        });
+
+        size_t firstMove = plan.moves.size();
+        bool complete = true;
+        for (const auto& allocation : allocations) {
+            TlsfAllocator::Allocation target;
+            uint32 dst = 0;
+            for (uint32 candidate : destinations) {
+                target = blocks[candidate]->Allocate(allocation.size);
+                if (target.IsValid()) {
+                    dst = candidate;
+                    break;
+                }
+            }
+
+            if (!target.IsValid()) {
+                complete = false;
+                break;
+            }
+
+            Move move;
+            move.srcBlock = src;
+            move.srcNode = allocation.node;
+            move.srcOffset = allocation.offset;
+            move.size = allocation.size;
+            move.dstBlock = dst;
+            move.dstNode = target.node;
+            move.dstOffset = target.offset;
+            plan.moves.push_back(move);
+        }
+
+        // Partially evacuating a block frees nothing, so roll its moves back.
+        if (!complete) {
+            for (size_t i = firstMove; i < plan.moves.size(); ++i) {
+                blocks[plan.moves[i].dstBlock]->Free(plan.moves[i].dstNode);
+            }
+            plan.moves.resize(firstMove);
+            continue;
+        }
+
+        for (size_t i = firstMove; i < plan.moves.size(); ++i) {
+            received[plan.moves[i].dstBlock] = true;
+            plan.bytesMoved += plan.moves[i].size;
+        }
+        evacuated[src] = true;
+        plan.evacuatedBlocks.push_back(src);
+    }
+
+    return plan;
+}
+
+void DefragmentationPlanner::Complete(const Vector<TlsfAllocator*>& blocks, const Plan& plan) {
+    for (const auto& move : plan.moves) {
+        blocks[move.srcBlock]->Free(move.srcNode);
+    }
+}
+
+void DefragmentationPlanner::Cancel(const Vector<TlsfAllocator*>& blocks, const Plan& plan) {
+    for (const auto& move : plan.moves) {
+        blocks[move.dstBlock]->Free(move.dstNode);
+    }
+}
+
+DefragmentationPlanner::Metrics DefragmentationPlanner::Measure(const Vector<TlsfAllocator*>& blocks) {
+    Metrics metrics;
+    uint64 freeBytes = 0;
+    float weightedFragmentation = 0.0f;
+
+    for (const TlsfAllocator* block : blocks) {
+        if (!block) continue;
+
+        TlsfAllocator::Stats stats = block->GetStats();
+        ++metrics.blockCount;
+        if (stats.allocationCount == 0) {
+            ++metrics.emptyBlockCount;
+        }
+        metrics.capacity += stats.capacity;
+        metrics.usedBytes += stats.usedBytes;
+        freeBytes += stats.freeBytes;
+        weightedFragmentation += stats.Fragmentation() * static_cast<float>(stats.freeBytes);
+    }
+
+    if (metrics.capacity > 0) {
+        metrics.occupancy = static_cast<float>(metrics.usedBytes) / static_cast<float>(metrics.capacity);
+    }
+    if (freeBytes > 0) {
+        metrics.fragmentation = weightedFragmentation / static_cast<float>(freeBytes);
+    }
+    return metrics;
+}
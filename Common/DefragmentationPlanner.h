@@ -0,0 +1,61 @@
+#pragma once
+
+#include "TlsfAllocator.h"
+
+// Decides which heap blocks to evacuate and where their allocations go.
+// Works purely on TlsfAllocator instances, so the same planning runs against
+// GpuMemoryAllocator pools and against simulated heaps without a device.
+class DefragmentationPlanner {
+public:
+    struct Settings {
+        float sparseOccupancy = 0.5f;               // Blocks used below this fraction get evacuated
+        uint64 maxBytesPerPass = 32ull * 1024 * 1024;
+        uint32 maxMovesPerPass = 256;
+    };
+
+    struct Move {
+        uint32 srcBlock = 0;
+        uint32 srcNode = TlsfAllocator::InvalidNode;
+        uint64 srcOffset = 0;
+        uint64 size = 0;
+        uint32 dstBlock = 0;
+        uint32 dstNode = TlsfAllocator::InvalidNode;
+        uint64 dstOffset = 0;
+    };
+
+    struct Plan {
+        Vector<Move> moves;
+        Vector<uint32> evacuatedBlocks;     // Blocks that are empty once every move completed
+        uint64 bytesMoved = 0;
+
+        bool IsEmpty() const { return moves.empty(); }
+    };
+
+    struct Metrics {
+        uint32 blockCount = 0;
+        uint32 emptyBlockCount = 0;
+        uint64 capacity = 0;
+        uint64 usedBytes = 0;
+        float occupancy = 0.0f;             // usedBytes / capacity over all live blocks
+        float fragmentation = 0.0f;         // Free-byte weighted TlsfAllocator::Stats::Fragmentation
+    };
+
+    // blocks holds one allocator per heap block, nullptr for released slots.
+    // canMove(block, node) reports whether a live allocation may be relocated;
+    // blocks containing anything pinned are never evacuated.
+    //
+    // Destination ranges are reserved in the allocators as part of planning, so the
+    // plan stays valid while the copies are in flight. Call Complete once the moves
+    // are done, or Cancel to drop the reservations.
+    static Plan CreatePlan(const Vector<TlsfAllocator*>& blocks,
+                           const Function<bool(uint32, uint32)>& canMove,
+                           const Settings& settings);
+
+    // Frees the source ranges of every move.
+    static void Complete(const Vector<TlsfAllocator*>& blocks, const Plan& plan);
+
+    // Frees the destination reservations of every move.
+    static void Cancel(const Vector<TlsfAllocator*>& blocks, const Plan& plan);
+
+    static Metrics Measure(const Vector<TlsfAllocator*>& blocks);
+};
@@ -0,0 +1,84 @@
+#include "DescriptorAllocators.h"
+#include <cassert>
+
+DescriptorFreeList::DescriptorFreeList(uint32 baseIndex, uint32 capacity)
+    : m_baseIndex(baseIndex), m_capacity(capacity) {
+}
+
+uint32 DescriptorFreeList::Allocate() {
+    // Reuse freed slots first so the used part of the range stays compact.
+    uint32 slot = InvalidIndex;
+    if (!m_free.empty()) {
+        slot = m_free.back();
+        m_free.pop_back();
+    }
+    else if (m_next < m_capacity) {
+        slot = m_next++;
+    }
+    else {
+        return InvalidIndex;
+    }
+
+    ++m_allocated;
+    return m_baseIndex + slot;
+}
+
+void DescriptorFreeList::Free(uint32 index, uint64 fenceValue) {
+    assert(index >= m_baseIndex && index < m_baseIndex + m_next && "Descriptor index not from this free list");
+    m_pending.push_back({ index - m_baseIndex, fenceValue });
+    --m_allocated;
+}
+
+void DescriptorFreeList::Reclaim(uint64 completedFenceValue) {
+    while (!m_pending.empty() && m_pending.front().fenceValue <= completedFenceValue) {
+        m_free.push_back(m_pending.front().index);
+        m_pending.pop_front();
+    }
+}
+
+DescriptorRing::DescriptorRing(uint32 baseIndex, uint32 capacity)
+    : m_baseIndex(baseIndex), m_capacity(capacity) {
+}
+
+uint32 DescriptorRing::Allocate(uint32 count) {
+    if (count == 0 || count > m_capacity) return InvalidIndex;
+
+    uint32 free = m_capacity - m_used;
+    if (count > free) return InvalidIndex;
+
+    // Allocations are contiguous, so a request that does not fit before the end of the
+    // ring skips the remaining descriptors and starts over at the front.
+    if (m_head >= m_tail && m_head + count > m_capacity) {
+        uint32 skipped = m_capacity - m_head;
+        if (count > free - skipped || count > m_tail) return InvalidIndex;
+
+        m_used += skipped;
+        m_frameCount += skipped;
+        m_head = 0;
+    }
+
+    uint32 start = m_head;
+    m_head = (m_head + count) % m_capacity;
+    m_used += count;
+    m_frameCount += count;
+    return m_baseIndex + start;
+}
+
+void DescriptorRing::EndFrame(uint64 fenceValue) {
+    m_frames.push_back({ fenceValue, m_head, m_frameCount });
+    m_frameCount = 0;
+}
+
+void DescriptorRing::Reclaim(uint64 completedFenceValue) {
+    while (!m_frames.empty() && m_frames.front().fenceValue <= completedFenceValue) {
+        m_used -= m_frames.front().count;
+        m_tail = m_frames.front().end;
+        m_frames.pop_front();
+    }
+
+    // Restarting an empty ring at the front avoids needless skips at the wrap.
+    if (m_used == 0 && m_frameCount == 0) {
+        m_head = 0;
+        m_tail = 0;
+    }
+}
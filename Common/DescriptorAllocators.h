@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Types.h>
+#include <deque>
+
+// Index allocators for ranges of a descriptor heap. They only hand out indices, so the
+// same logic serves shader-visible and CPU-only heaps and runs without a device.
+
+// Long-lived descriptors such as texture SRVs. Freed slots are only reused once the
+// GPU has passed the fence value they were freed at.
+class DescriptorFreeList {
+public:
+    static constexpr uint32 InvalidIndex = UINT32_MAX;
+
+    DescriptorFreeList(uint32 baseIndex, uint32 capacity);
+
+    // Returns InvalidIndex when every slot is in use.
+    uint32 Allocate();
+
+    // Work up to fenceValue may still read the descriptor.
+    void Free(uint32 index, uint64 fenceValue);
+
+    void Reclaim(uint64 completedFenceValue);
+
+    uint32 GetBaseIndex() const { return m_baseIndex; }
+    uint32 GetCapacity() const { return m_capacity; }
+    uint32 GetAllocatedCount() const { return m_allocated; }
+
+    // One past the highest slot ever handed out, relative to the base index.
+    uint32 GetHighWaterMark() const { return m_next; }
+
+private:
+    struct PendingFree {
+        uint32 index = 0;
+        uint64 fenceValue = 0;
+    };
+
+    uint32 m_baseIndex = 0;
+    uint32 m_capacity = 0;
+    uint32 m_next = 0;          // Slots below this were handed out at least once
+    uint32 m_allocated = 0;
+    Vector<uint32> m_free;
+    std::deque<PendingFree> m_pending;
+};
+
+// Transient descriptors written every frame. Allocation is a pointer bump; everything a
+// frame allocated is recycled at once when that frame's fence completes.
+class DescriptorRing {
+public:
+    static constexpr uint32 InvalidIndex = UINT32_MAX;
+
+    DescriptorRing(uint32 baseIndex, uint32 capacity);
+
+    // Returns the first of count contiguous descriptors, or InvalidIndex when the frames
+    // in flight hold too much of the ring.
+    uint32 Allocate(uint32 count);
+
+    // Closes the current frame; its descriptors are recycled once fenceValue completes.
+    void EndFrame(uint64 fenceValue);
+
+    void Reclaim(uint64 completedFenceValue);
+
+    uint32 GetBaseIndex() const { return m_baseIndex; }
+    uint32 GetCapacity() const { return m_capacity; }
+    uint32 GetUsedCount() const { return m_used; }
+
+private:
+    struct FrameMark {
+        uint64 fenceValue = 0;
+        uint32 end = 0;         // Head position when the frame ended
+        uint32 count = 0;       // Descriptors the frame used, including any skipped at the wrap
+    };
+
+    uint32 m_baseIndex = 0;
+    uint32 m_capacity = 0;
+    uint32 m_head = 0;
+    uint32 m_tail = 0;
+    uint32 m_used = 0;
+    uint32 m_frameCount = 0;    // Used by the frame being recorded
+    std::deque<FrameMark> m_frames;
+};
@@ -0,0 +1,115 @@
+#include "DescriptorHeapManager.h"
+
+uint32 DescriptorHeapManager::GetMaxTextureTableCapacity(ID3D12Device* device) {
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    ThrowIfFailed(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+
+    if (options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_2) {
+        return DefaultTextureTableCapacity;
+    }
+    return Tier1TextureTableCapacity;
+}
+
+DescriptorHeapManager::DescriptorHeapManager(ID3D12Device* device,
+                                             uint32 textureTableCapacity,
+                                             uint32 persistentCapacity,
+                                             uint32 transientCapacity)
+    : m_device(device),
+      m_capacity(textureTableCapacity + persistentCapacity + transientCapacity),
+      m_textureTable(0, textureTableCapacity),
+      m_persistent(textureTableCapacity, persistentCapacity),
+      m_transient(textureTableCapacity + persistentCapacity, transientCapacity) {
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.NumDescriptors = m_capacity;
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    heapDesc.NodeMask = 0;
+    ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(m_heap.GetAddressOf())));
+
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(m_stagingHeap.GetAddressOf())));
+
+    m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    // Every table slot starts out as a null SRV, so unassigned slots are safe to sample.
+    for (uint32 i = 0; i < textureTableCapacity; ++i) {
+        CreateNullShaderResourceView(m_textureTable.GetDescriptorIndex(i));
+    }
+    FlushCopies();
+}
+
+uint32 DescriptorHeapManager::AllocatePersistent() {
+    uint32 index = m_persistent.Allocate();
+    if (index == InvalidIndex) {
+        throw std::runtime_error("Out of persistent descriptors");
+    }
+    return index;
+}
+
+void DescriptorHeapManager::FreePersistent(uint32 index, uint64 fenceValue) {
+    m_persistent.Free(index, fenceValue);
+}
+
+uint32 DescriptorHeapManager::AllocateTransient(uint32 count) {
+    uint32 index = m_transient.Allocate(count);
+    if (index == InvalidIndex) {
+        throw std::runtime_error("Out of transient descriptors");
+    }
+    return index;
+}
+
+void DescriptorHeapManager::CreateShaderResourceView(ID3D12Resource* resource,
+                                                     const D3D12_SHADER_RESOURCE_VIEW_DESC* desc,
+                                                     uint32 index) {
+    m_device->CreateShaderResourceView(resource, desc, GetStagingHandle(index));
+    m_pendingCopies.MarkDirty(index);
+}
+
+void DescriptorHeapManager::CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc, uint32 index) {
+    m_device->CreateConstantBufferView(&desc, GetStagingHandle(index));
+    m_pendingCopies.MarkDirty(index);
+}
+
+void DescriptorHeapManager::CreateUnorderedAccessView(ID3D12Resource* resource,
+                                                      const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc,
+                                                      uint32 index) {
+    m_device->CreateUnorderedAccessView(resource, nullptr, desc, GetStagingHandle(index));
+    m_pendingCopies.MarkDirty(index);
+}
+
+void DescriptorHeapManager::CreateNullShaderResourceView(uint32 index) {
+    D3D12_SHADER_RESOURCE_VIEW_DESC nullDesc = {};
+    nullDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    nullDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    nullDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    nullDesc.Texture2D.MipLevels = 1;
+    CreateShaderResourceView(nullptr, &nullDesc, index);
+}
+
+uint32 DescriptorHeapManager::FlushCopies() {
+    uint32 copies = 0;
+    m_pendingCopies.Flush(m_capacity, [this, &copies](uint32 first, uint32 count) {
+        CD3DX12_CPU_DESCRIPTOR_HANDLE dst(m_heap->GetCPUDescriptorHandleForHeapStart(), first, m_descriptorSize);
+        m_device->CopyDescriptorsSimple(count, dst, GetStagingHandle(first), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        ++copies;
+    });
+    return copies;
+}
+
+void DescriptorHeapManager::BeginFrame(uint64 completedFenceValue) {
+    m_textureTable.Reclaim(completedFenceValue);
+    m_persistent.Reclaim(completedFenceValue);
+    m_transient.Reclaim(completedFenceValue);
+}
+
+void DescriptorHeapManager::EndFrame(uint64 fenceValue) {
+    m_transient.EndFrame(fenceValue);
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE DescriptorHeapManager::GetGpuHandle(uint32 index) const {
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heap->GetGPUDescriptorHandleForHeapStart(), index, m_descriptorSize);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorHeapManager::GetStagingHandle(uint32 index) const {
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_stagingHeap->GetCPUDescriptorHandleForHeapStart(), index, m_descriptorSize);
+}
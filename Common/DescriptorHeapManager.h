@@ -0,0 +1,87 @@
+#pragma once
+
+#include <WindowsPlatform.h>
+#include "DescriptorAllocators.h"
+#include "BindlessTextureTable.h"
+#include "DirtyRangeTracker.h"
+
+// Owns the shader-visible CBV/SRV/UAV heap. The heap is split into three ranges:
+// the bindless texture table, persistent descriptors managed by a DescriptorFreeList,
+// and a DescriptorRing for descriptors that only live for one frame.
+//
+// Views are never written straight into the shader-visible heap, which is slow to
+// access from the CPU on many GPUs. They go into a CPU-only staging heap with the same
+// layout, and FlushCopies moves every changed run across with one
+// CopyDescriptorsSimple call per run.
+class DescriptorHeapManager {
+public:
+    static constexpr uint32 InvalidIndex = DescriptorFreeList::InvalidIndex;
+    static constexpr uint32 DefaultTextureTableCapacity = 4096;
+    // Resource binding tier 1 allows 128 SRVs across the tables one shader stage sees, and
+    // the pixel shader's material table takes one of them.
+    static constexpr uint32 Tier1TextureTableCapacity = 127;
+    static constexpr uint32 DefaultPersistentCapacity = 4096;
+    static constexpr uint32 DefaultTransientCapacity = 4096;
+
+    DescriptorHeapManager(ID3D12Device* device,
+                          uint32 textureTableCapacity = DefaultTextureTableCapacity,
+                          uint32 persistentCapacity = DefaultPersistentCapacity,
+                          uint32 transientCapacity = DefaultTransientCapacity);
+
+    // Largest texture table the device's resource binding tier can bind, at most
+    // DefaultTextureTableCapacity.
+    static uint32 GetMaxTextureTableCapacity(ID3D12Device* device);
+
+    DECLARE_NON_COPYABLE(DescriptorHeapManager)
+    DECLARE_NON_MOVABLE(DescriptorHeapManager)
+
+    // Persistent descriptors. A freed index is reused once the GPU passed fenceValue.
+    uint32 AllocatePersistent();
+    void FreePersistent(uint32 index, uint64 fenceValue);
+
+    // count contiguous descriptors valid for the frame being recorded.
+    uint32 AllocateTransient(uint32 count = 1);
+
+    void CreateShaderResourceView(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc, uint32 index);
+    void CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc, uint32 index);
+    void CreateUnorderedAccessView(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, uint32 index);
+    // A 2D SRV without a resource; shaders sampling it read zero.
+    void CreateNullShaderResourceView(uint32 index);
+
+    // Copies staged views into the shader-visible heap. Call before submitting command
+    // lists that use them. Returns the number of CopyDescriptorsSimple calls made.
+    uint32 FlushCopies();
+
+    // Recycles descriptors of finished frames.
+    void BeginFrame(uint64 completedFenceValue);
+
+    // Closes the frame's transient allocations; they are recycled once fenceValue completes.
+    void EndFrame(uint64 fenceValue);
+
+    ID3D12DescriptorHeap* GetHeap() const { return m_heap.Get(); }
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32 index) const;
+    D3D12_CPU_DESCRIPTOR_HANDLE GetStagingHandle(uint32 index) const;
+
+    // The whole table is bound once per frame; shaders index it with the slots it hands out.
+    BindlessTextureTable& GetTextureTable() { return m_textureTable; }
+    const BindlessTextureTable& GetTextureTable() const { return m_textureTable; }
+    D3D12_GPU_DESCRIPTOR_HANDLE GetTextureTableGpuHandle() const { return GetGpuHandle(m_textureTable.GetBaseDescriptor()); }
+
+    const DescriptorFreeList& GetPersistent() const { return m_persistent; }
+    const DescriptorRing& GetTransient() const { return m_transient; }
+
+private:
+    ID3D12Device* m_device = nullptr;
+    ComPtr<ID3D12DescriptorHeap> m_heap;            // Shader visible
+    ComPtr<ID3D12DescriptorHeap> m_stagingHeap;     // CPU only, same layout
+    UINT m_descriptorSize = 0;
+    uint32 m_capacity = 0;
+
+    BindlessTextureTable m_textureTable;
+    DescriptorFreeList m_persistent;
+    DescriptorRing m_transient;
+
+    // Adjacent writes merge into one copy; a gap is never copied since it may hold
+    // descriptors the staging heap never wrote.
+    DirtyRangeTracker m_pendingCopies{ 0 };
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <Types.h>
+
+// Tracks which element ranges of a CPU-side array changed since the last flush,
+// so only those ranges have to be copied to the GPU.
+class DirtyRangeTracker {
+public:
+    struct Range {
+        uint32 begin = 0;   // First dirty element
+        uint32 end = 0;     // One past the last dirty element
+    };
+
+    // Ranges separated by at most this many clean elements are merged into one copy.
+    // Re-uploading a few clean elements is cheaper than starting a new copy.
+    static constexpr uint32 DefaultMergeGap = 4;
+
+    explicit DirtyRangeTracker(uint32 mergeGap = DefaultMergeGap) : m_mergeGap(mergeGap) {}
+
+    void MarkDirty(uint32 index) {
+        MarkDirty(index, index + 1);
+    }
+
+    void MarkDirty(uint32 begin, uint32 end) {
+        if (begin >= end) return;
+
+        // Sequential updates are the common case, so try to extend the last range first.
+        if (!m_ranges.empty()) {
+            Range& last = m_ranges.back();
+            if (begin <= last.end + m_mergeGap && end + m_mergeGap >= last.begin) {
+                if (begin < last.begin) m_sorted = m_ranges.size() == 1;
+                last.begin = std::min(last.begin, begin);
+                last.end = std::max(last.end, end);
+                return;
+            }
+            if (begin < last.end) m_sorted = false;
+        }
+
+        m_ranges.push_back({ begin, end });
+    }
+
+    void MarkAllDirty(uint32 count) {
+        m_ranges.clear();
+        m_sorted = true;
+        if (count > 0) {
+            m_ranges.push_back({ 0, count });
+        }
+    }
+
+    void Clear() {
+        m_ranges.clear();
+        m_sorted = true;
+    }
+
+    bool IsDirty() const { return !m_ranges.empty(); }
+
+    // Sorts and coalesces the pending ranges, clamps them to elementCount and hands
+    // each merged range to the callback. Clears the tracker afterwards.
+    // Returns the number of elements passed to the callback.
+    template<typename Fn>
+    uint32 Flush(uint32 elementCount, Fn&& copyRange) {
+        Coalesce();
+
+        uint32 flushed = 0;
+        for (const Range& range : m_ranges) {
+            uint32 end = std::min(range.end, elementCount);
+            if (range.begin >= end) continue;
+
+            copyRange(range.begin, end - range.begin);
+            flushed += end - range.begin;
+        }
+
+        Clear();
+        return flushed;
+    }
+
+    const Vector<Range>& GetRanges() {
+        Coalesce();
+        return m_ranges;
+    }
+
+private:
+    Vector<Range> m_ranges;
+    uint32 m_mergeGap = DefaultMergeGap;
+    bool m_sorted = true;
+
+    void Coalesce() {
+        if (m_sorted || m_ranges.size() < 2) {
+            m_sorted = true;
+            return;
+        }
+
+        std::sort(m_ranges.begin(), m_ranges.end(),
+            [](const Range& a, const Range& b) { return a.begin < b.begin; });
+
+        size_t out = 0;
+        for (size_t i = 1; i < m_ranges.size(); ++i) {
+            Range& merged = m_ranges[out];
+            const Range& next = m_ranges[i];
+            if (next.begin <= merged.end + m_mergeGap) {
+                merged.end = std::max(merged.end, next.end);
+            }
+            else {
+                m_ranges[++out] = next;
+            }
+        }
+        m_ranges.resize(out + 1);
+        m_sorted = true;
+    }
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <WindowsPlatform.h>
+#include "RootArgumentCache.h"
+
+// Per-draw binding front end for a graphics command list. Redundant pipeline state and
+// root argument calls are dropped, so a draw that only differs from the previous one in
+// its draw ID costs a single SetGraphicsRoot32BitConstants.
+class DrawBinder {
+public:
+    struct Stats {
+        uint32 issuedCalls = 0;
+        uint32 skippedCalls = 0;
+    };
+
+    // Starts binding on cmdList. Setting the root signature invalidates every root argument.
+    // initialPso is the state the list was reset with, if any.
+    void Begin(ID3D12GraphicsCommandList* cmdList, ID3D12RootSignature* rootSignature,
+               ID3D12PipelineState* initialPso = nullptr) {
+        m_commandList = cmdList;
+        m_pipelineState = initialPso;
+        m_geometry = nullptr;
+        m_cache.Reset();
+        m_commandList->SetGraphicsRootSignature(rootSignature);
+        ++m_stats.issuedCalls;
+    }
+
+    void SetPipelineState(ID3D12PipelineState* pso) {
+        if (!pso || pso == m_pipelineState) {
+            ++m_stats.skippedCalls;
+            return;
+        }
+        m_commandList->SetPipelineState(pso);
+        m_pipelineState = pso;
+        ++m_stats.issuedCalls;
+    }
+
+    // Binds the vertex and index buffers of geometry as a triangle list. Draws sorted by
+    // mesh then only bind each mesh once.
+    void SetGeometry(const MeshGeometry* geometry) {
+        if (!geometry || geometry == m_geometry) {
+            ++m_stats.skippedCalls;
+            return;
+        }
+        auto vbv = geometry->VertexBufferView();
+        auto ibv = geometry->IndexBufferView();
+        m_commandList->IASetVertexBuffers(0, 1, &vbv);
+        m_commandList->IASetIndexBuffer(&ibv);
+        m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        m_geometry = geometry;
+        ++m_stats.issuedCalls;
+    }
+
+    void SetConstants(UINT parameter, const void* values, UINT count, UINT offset = 0) {
+        if (!Track(m_cache.SetConstants(parameter, static_cast<const uint32*>(values), count, offset))) return;
+        m_commandList->SetGraphicsRoot32BitConstants(parameter, count, values, offset);
+    }
+
+    void SetConstant(UINT parameter, uint32 value, UINT offset = 0) {
+        if (!Track(m_cache.SetConstants(parameter, &value, 1, offset))) return;
+        m_commandList->SetGraphicsRoot32BitConstant(parameter, value, offset);
+    }
+
+    void SetConstantBuffer(UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address) {
+        if (!Track(m_cache.SetValue(parameter, address))) return;
+        m_commandList->SetGraphicsRootConstantBufferView(parameter, address);
+    }
+
+    void SetShaderResource(UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address) {
+        if (!Track(m_cache.SetValue(parameter, address))) return;
+        m_commandList->SetGraphicsRootShaderResourceView(parameter, address);
+    }
+
+    void SetDescriptorTable(UINT parameter, D3D12_GPU_DESCRIPTOR_HANDLE handle) {
+        if (!Track(m_cache.SetValue(parameter, handle.ptr))) return;
+        m_commandList->SetGraphicsRootDescriptorTable(parameter, handle);
+    }
+
+    ID3D12GraphicsCommandList* GetCommandList() const { return m_commandList; }
+
+    const Stats& GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = Stats(); }
+
+private:
+    bool Track(bool changed) {
+        ++(changed ? m_stats.issuedCalls : m_stats.skippedCalls);
+        return changed;
+    }
+
+    ID3D12GraphicsCommandList* m_commandList = nullptr;
+    ID3D12PipelineState* m_pipelineState = nullptr;
+    const MeshGeometry* m_geometry = nullptr;
+    RootArgumentCache m_cache;
+    Stats m_stats;
+};
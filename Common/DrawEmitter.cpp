@@ -0,0 +1,19 @@
+#include "DrawEmitter.h"
+
+DrawEmitter::Stats DrawEmitter::Emit(const InstanceBatcher& batcher, IDrawCommandSink& sink) {
+    Stats stats;
+    for (const InstancedDraw& draw : batcher.GetDraws()) {
+        IDrawCommandSink::IndexRange range;
+        if (!sink.BindDraw(draw.drawId, draw.firstInstance, range)) {
+            sink.RenderObject(draw.drawId);
+            ++stats.objectDraws;
+            continue;
+        }
+
+        // SV_InstanceID starts at 0; the draw constants carry the instance list offset.
+        sink.DrawIndexedInstanced(range.indexCount, draw.instanceCount, range.startIndex, range.baseVertex, 0);
+        ++stats.instancedDraws;
+        stats.instances += draw.instanceCount;
+    }
+    return stats;
+}
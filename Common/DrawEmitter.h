@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Types.h>
+#include "InstanceBatcher.h"
+
+// Receives the commands DrawEmitter records. Graphics implements it over its command
+// list and DrawBinder; tests capture the calls instead.
+class IDrawCommandSink {
+public:
+    // Index range of a submesh, as DrawIndexedInstanced takes it.
+    struct IndexRange {
+        uint32 indexCount = 0;
+        uint32 startIndex = 0;
+        int32 baseVertex = 0;
+    };
+
+    virtual ~IDrawCommandSink() = default;
+
+    // Binds pipeline, geometry and draw constants for a draw of drawId's submesh whose
+    // instances read their draw IDs from instanceOffset on in the instance list, and
+    // fills range. Returns false for objects that record their own draws.
+    virtual bool BindDraw(uint32 drawId, uint32 instanceOffset, IndexRange& range) = 0;
+
+    virtual void DrawIndexedInstanced(uint32 indexCountPerInstance, uint32 instanceCount, uint32 startIndexLocation,
+                                      int32 baseVertexLocation, uint32 startInstanceLocation) = 0;
+
+    // Lets an object that BindDraw refused record itself.
+    virtual void RenderObject(uint32 drawId) = 0;
+};
+
+// Records the draws of an InstanceBatcher in order: one DrawIndexedInstanced per run of
+// objects sharing a submesh, or the object's own commands where it has none.
+class DrawEmitter {
+public:
+    struct Stats {
+        uint32 instancedDraws = 0;
+        uint32 objectDraws = 0;     // Objects that recorded themselves
+        uint32 instances = 0;       // Objects covered by the instanced draws
+    };
+
+    static Stats Emit(const InstanceBatcher& batcher, IDrawCommandSink& sink);
+};
@@ -0,0 +1,177 @@
+#include "EntityWorld.h"
+#include <algorithm>
+#include <atomic>
+
+ComponentId ComponentRegistry::Register(uint32 size, uint32 alignment) {
+    // Id<T>() of different types may run for the first time on different threads.
+    static std::atomic<uint32> count{ 0 };
+    uint32 id = count.fetch_add(1, std::memory_order_relaxed);
+    if (id >= MaxComponentTypes) {
+        throw std::runtime_error("Too many component types");
+    }
+    Infos()[id] = { size, alignment };
+    return id;
+}
+
+std::array<ComponentRegistry::Info, ComponentRegistry::MaxComponentTypes>& ComponentRegistry::Infos() {
+    static std::array<Info, MaxComponentTypes> infos;
+    return infos;
+}
+
+namespace {
+    uint32 AlignUp(uint32 value, uint32 alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+Archetype::Archetype(ComponentMask mask) : m_mask(mask) {
+    // Row size including the entity handle column plus worst case alignment padding
+    // per column, the handle column's included, so the capacity always fits.
+    uint32 rowBytes = sizeof(Handle);
+    uint32 padding = ComponentRegistry::MaxAlignment;
+    for (ComponentId id = 0; id < ComponentRegistry::MaxComponentTypes; ++id) {
+        if (!Has(id)) continue;
+        rowBytes += ComponentRegistry::GetInfo(id).size;
+        padding += ComponentRegistry::GetInfo(id).alignment;
+    }
+    m_chunkCapacity = std::max<uint32>(1, (ChunkBytes - padding) / rowBytes);
+
+    // Columns follow each other: entity handles first, then components by ID.
+    uint32 offset = AlignUp(sizeof(Handle) * m_chunkCapacity, ComponentRegistry::MaxAlignment);
+    for (ComponentId id = 0; id < ComponentRegistry::MaxComponentTypes; ++id) {
+        if (!Has(id)) continue;
+        const auto& info = ComponentRegistry::GetInfo(id);
+        offset = AlignUp(offset, info.alignment);
+        m_offsets[id] = offset;
+        offset += info.size * m_chunkCapacity;
+    }
+    m_chunkBytes = offset;
+}
+
+void Archetype::AddRow(Handle entity, uint32& chunkIndex, uint32& row) {
+    if (m_chunks.empty() || m_chunks.back().count == m_chunkCapacity) {
+        Chunk chunk;
+        chunk.data.reset(new uint8[m_chunkBytes]);
+        chunk.dirtyRows.reset(new uint64[GetDirtyWordCount()]());
+        m_chunks.push_back(std::move(chunk));
+    }
+
+    chunkIndex = GetChunkCount() - 1;
+    Chunk& chunk = m_chunks.back();
+    row = chunk.count++;
+    GetEntities(chunk)[row] = entity;
+    SetRowDirty(chunk, row);
+    ++m_entityCount;
+}
+
+Handle Archetype::RemoveRow(uint32 chunkIndex, uint32 row) {
+    Chunk& last = m_chunks.back();
+    uint32 lastRow = last.count - 1;
+    bool isLast = (&m_chunks[chunkIndex] == &last) && row == lastRow;
+
+    Handle moved;
+    if (!isLast) {
+        Chunk& chunk = m_chunks[chunkIndex];
+        moved = GetEntities(last)[lastRow];
+        GetEntities(chunk)[row] = moved;
+        for (ComponentId id = 0; id < ComponentRegistry::MaxComponentTypes; ++id) {
+            if (!Has(id)) continue;
+            uint32 size = ComponentRegistry::GetInfo(id).size;
+            std::memcpy(GetColumn(chunk, id) + row * size, GetColumn(last, id) + lastRow * size, size);
+        }
+        // The moved entity may have changes nobody has seen yet.
+        SetRowDirty(chunk, row);
+    }
+
+    last.dirtyRows[lastRow / 64] &= ~(uint64(1) << (lastRow % 64));
+    --last.count;
+    --m_entityCount;
+    if (last.count == 0) {
+        m_chunks.pop_back();
+    }
+    return moved;
+}
+
+bool Archetype::IsAnyRowDirty(const Chunk& chunk) const {
+    for (uint32 i = 0; i < GetDirtyWordCount(); ++i) {
+        if (chunk.dirtyRows[i]) return true;
+    }
+    return false;
+}
+
+void Archetype::CopySharedComponents(uint32 chunkIndex, uint32 row, Archetype& src, uint32 srcChunk, uint32 srcRow) {
+    Chunk& dstChunk = m_chunks[chunkIndex];
+    Chunk& srcData = src.m_chunks[srcChunk];
+    ComponentMask shared = m_mask & src.m_mask;
+    for (ComponentId id = 0; id < ComponentRegistry::MaxComponentTypes; ++id) {
+        if (!((shared >> id) & 1u)) continue;
+        uint32 size = ComponentRegistry::GetInfo(id).size;
+        std::memcpy(GetColumn(dstChunk, id) + row * size, src.GetColumn(srcData, id) + srcRow * size, size);
+    }
+}
+
+EntityWorld::EntityWorld() {
+    m_records.emplace_back();   // EntityID 0 stays unused
+}
+
+Handle EntityWorld::AllocateHandle() {
+    Handle entity;
+    if (!m_freeIds.empty()) {
+        entity.index = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else {
+        entity.index = static_cast<EntityID>(m_records.size());
+        m_records.emplace_back();
+    }
+
+    entity.generation = ++m_records[entity.index].generation;
+    ++m_entityCount;
+    return entity;
+}
+
+void EntityWorld::DestroyEntity(Handle entity) {
+    if (!IsAlive(entity)) return;
+
+    EntityRecord& record = m_records[entity.index];
+    Handle moved = record.archetype->RemoveRow(record.chunk, record.row);
+    if (moved.IsValid()) {
+        m_records[moved.index].chunk = record.chunk;
+        m_records[moved.index].row = record.row;
+    }
+
+    record.archetype = nullptr;
+    m_freeIds.push_back(entity.index);
+    --m_entityCount;
+}
+
+Archetype* EntityWorld::GetOrCreateArchetype(ComponentMask mask) {
+    auto it = m_archetypeByMask.find(mask);
+    if (it != m_archetypeByMask.end()) return it->second;
+
+    m_archetypes.push_back(UniquePtr<Archetype>(new Archetype(mask)));
+    Archetype* archetype = m_archetypes.back().get();
+    m_archetypeByMask[mask] = archetype;
+    return archetype;
+}
+
+void EntityWorld::MoveToArchetype(Handle entity, ComponentMask mask) {
+    EntityRecord& record = m_records[entity.index];
+    Archetype* src = record.archetype;
+    Archetype* dst = GetOrCreateArchetype(mask);
+
+    uint32 chunk = 0;
+    uint32 row = 0;
+    dst->AddRow(entity, chunk, row);
+    dst->CopySharedComponents(chunk, row, *src, record.chunk, record.row);
+
+    Handle moved = src->RemoveRow(record.chunk, record.row);
+    if (moved.IsValid()) {
+        m_records[moved.index].chunk = record.chunk;
+        m_records[moved.index].row = record.row;
+    }
+
+    record.archetype = dst;
+    record.chunk = chunk;
+    record.row = row;
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <Types.h>
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+// Data-oriented entity store. Entities with the same set of components share an
+// archetype, whose rows live in fixed-size chunks holding one tightly packed column
+// per component (SoA). Queries walk the matching chunks column by column instead of
+// chasing one heap object per entity.
+//
+// Entities are addressed by Handle: index is the EntityID, generation detects handles
+// of destroyed entities. EntityID 0 is never used, so a default Handle is invalid.
+//
+// Components must be trivially copyable since rows are moved with memcpy when entities
+// are destroyed or change archetype.
+//
+// Every chunk also keeps one dirty bit per row, so systems that only care about changed
+// entities skip clean rows and chunks instead of testing each entity. Rows start dirty
+// when created or moved; after that MarkDirty sets the bit and the systems clear it.
+
+using ComponentId = uint32;
+using ComponentMask = uint32;
+
+class ComponentRegistry {
+public:
+    static constexpr uint32 MaxComponentTypes = 32;
+    static constexpr uint32 MaxAlignment = 16;
+
+    struct Info {
+        uint32 size = 0;
+        uint32 alignment = 0;
+    };
+
+    template<typename T>
+    static ComponentId Id() {
+        static_assert(std::is_trivially_copyable<T>::value, "Components are moved with memcpy");
+        static_assert(alignof(T) <= MaxAlignment, "Chunk columns are aligned to at most 16 bytes");
+        static const ComponentId id = Register(sizeof(T), alignof(T));
+        return id;
+    }
+
+    template<typename T>
+    static ComponentMask Bit() { return 1u << Id<T>(); }
+
+    template<typename... Ts>
+    static ComponentMask MaskOf() { return (ComponentMask(0) | ... | Bit<Ts>()); }
+
+    static const Info& GetInfo(ComponentId id) { return Infos()[id]; }
+
+private:
+    static ComponentId Register(uint32 size, uint32 alignment);
+    static std::array<Info, MaxComponentTypes>& Infos();
+};
+
+class Archetype {
+public:
+    static constexpr uint32 ChunkBytes = 16 * 1024;
+
+    struct Chunk {
+        UniquePtr<uint8[]> data;
+        UniquePtr<uint64[]> dirtyRows;  // One bit per row, GetDirtyWordCount words
+        uint32 count = 0;
+    };
+
+    explicit Archetype(ComponentMask mask);
+
+    DECLARE_NON_COPYABLE(Archetype)
+    DECLARE_NON_MOVABLE(Archetype)
+
+    ComponentMask GetMask() const { return m_mask; }
+    bool Has(ComponentId id) const { return (m_mask >> id) & 1u; }
+    bool Matches(ComponentMask required) const { return (m_mask & required) == required; }
+
+    uint32 GetChunkCapacity() const { return m_chunkCapacity; }
+    uint32 GetChunkBytes() const { return m_chunkBytes; }
+    uint32 GetChunkCount() const { return static_cast<uint32>(m_chunks.size()); }
+    uint32 GetEntityCount() const { return m_entityCount; }
+    uint32 GetDirtyWordCount() const { return (m_chunkCapacity + 63) / 64; }
+    Chunk& GetChunk(uint32 index) { return m_chunks[index]; }
+
+    bool IsAnyRowDirty(const Chunk& chunk) const;
+    void SetRowDirty(Chunk& chunk, uint32 row) { chunk.dirtyRows[row / 64] |= uint64(1) << (row % 64); }
+
+    // Column start of component id, or of the entity handles, in chunk.
+    uint8* GetColumn(Chunk& chunk, ComponentId id) const { return chunk.data.get() + m_offsets[id]; }
+    Handle* GetEntities(Chunk& chunk) const { return reinterpret_cast<Handle*>(chunk.data.get()); }
+
+    template<typename T>
+    T* GetColumn(Chunk& chunk) const { return reinterpret_cast<T*>(GetColumn(chunk, ComponentRegistry::Id<T>())); }
+
+    // Appends an uninitialized row. Returns its chunk and row.
+    void AddRow(Handle entity, uint32& chunkIndex, uint32& row);
+
+    // Fills the row with the last row of the archetype. Returns the handle of the entity
+    // that moved into it, or an invalid handle when the removed row was the last one.
+    Handle RemoveRow(uint32 chunkIndex, uint32 row);
+
+    // Copies every component both archetypes have from src's row into this row.
+    void CopySharedComponents(uint32 chunkIndex, uint32 row, Archetype& src, uint32 srcChunk, uint32 srcRow);
+
+private:
+    ComponentMask m_mask = 0;
+    uint32 m_chunkCapacity = 0;
+    uint32 m_chunkBytes = 0;            // At most ChunkBytes unless a single row is larger
+    uint32 m_entityCount = 0;
+    std::array<uint32, ComponentRegistry::MaxComponentTypes> m_offsets = {};
+    Vector<Chunk> m_chunks;
+};
+
+class EntityWorld {
+public:
+    EntityWorld();
+
+    DECLARE_NON_COPYABLE(EntityWorld)
+    DECLARE_NON_MOVABLE(EntityWorld)
+
+    template<typename... Ts>
+    Handle CreateEntity(const Ts&... components) {
+        Handle entity = AllocateHandle();
+        Archetype* archetype = GetOrCreateArchetype(ComponentRegistry::MaskOf<Ts...>());
+
+        EntityRecord& record = m_records[entity.index];
+        record.archetype = archetype;
+        archetype->AddRow(entity, record.chunk, record.row);
+
+        (WriteComponent(record, components), ...);
+        return entity;
+    }
+
+    void DestroyEntity(Handle entity);
+
+    // Flags the entity's row for ForEachDirtyChunk.
+    void MarkDirty(Handle entity) {
+        if (!IsAlive(entity)) return;
+        EntityRecord& record = m_records[entity.index];
+        record.archetype->SetRowDirty(record.archetype->GetChunk(record.chunk), record.row);
+    }
+
+    // Get for writing: also flags the entity's row for ForEachDirtyChunk.
+    template<typename T>
+    T* GetDirty(Handle entity) {
+        if (!Has<T>(entity)) return nullptr;
+        EntityRecord& record = m_records[entity.index];
+        Archetype::Chunk& chunk = record.archetype->GetChunk(record.chunk);
+        record.archetype->SetRowDirty(chunk, record.row);
+        return record.archetype->GetColumn<T>(chunk) + record.row;
+    }
+
+    bool IsAlive(Handle entity) const {
+        return entity.index != 0 && entity.index < m_records.size() &&
+               m_records[entity.index].generation == entity.generation &&
+               m_records[entity.index].archetype != nullptr;
+    }
+
+    template<typename T>
+    bool Has(Handle entity) const {
+        return IsAlive(entity) && m_records[entity.index].archetype->Has(ComponentRegistry::Id<T>());
+    }
+
+    // Returns nullptr when the entity is dead or lacks the component. The pointer is
+    // invalidated by any structural change (create, destroy, add, remove).
+    template<typename T>
+    T* Get(Handle entity) {
+        if (!Has<T>(entity)) return nullptr;
+        EntityRecord& record = m_records[entity.index];
+        return record.archetype->GetColumn<T>(record.archetype->GetChunk(record.chunk)) + record.row;
+    }
+
+    // Adds or overwrites the component, moving the entity to the matching archetype.
+    template<typename T>
+    void Add(Handle entity, const T& component) {
+        if (!IsAlive(entity)) return;
+        EntityRecord& record = m_records[entity.index];
+        if (!record.archetype->Has(ComponentRegistry::Id<T>())) {
+            MoveToArchetype(entity, record.archetype->GetMask() | ComponentRegistry::Bit<T>());
+        }
+        WriteComponent(record, component);
+    }
+
+    template<typename T>
+    void Remove(Handle entity) {
+        if (!Has<T>(entity)) return;
+        MoveToArchetype(entity, m_records[entity.index].archetype->GetMask() & ~ComponentRegistry::Bit<T>());
+    }
+
+    // Calls fn(count, entities, columns...) once per chunk of every archetype that has
+    // all of Ts. Components may be modified, the world's structure may not.
+    template<typename... Ts, typename Fn>
+    void ForEachChunk(Fn&& fn) {
+        ComponentMask required = ComponentRegistry::MaskOf<Ts...>();
+        for (auto& archetype : m_archetypes) {
+            if (!archetype->Matches(required)) continue;
+
+            for (uint32 c = 0; c < archetype->GetChunkCount(); ++c) {
+                Archetype::Chunk& chunk = archetype->GetChunk(c);
+                if (chunk.count == 0) continue;
+                fn(chunk.count, archetype->GetEntities(chunk), archetype->GetColumn<Ts>(chunk)...);
+            }
+        }
+    }
+
+    // Like ForEachChunk, but only for chunks with dirty rows, calling
+    // fn(count, entities, dirtyRows, columns...). dirtyRows holds one bit per row, 64 rows
+    // per word; fn clears the bits of the rows it is done with.
+    template<typename... Ts, typename Fn>
+    void ForEachDirtyChunk(Fn&& fn) {
+        ComponentMask required = ComponentRegistry::MaskOf<Ts...>();
+        for (auto& archetype : m_archetypes) {
+            if (!archetype->Matches(required)) continue;
+
+            for (uint32 c = 0; c < archetype->GetChunkCount(); ++c) {
+                Archetype::Chunk& chunk = archetype->GetChunk(c);
+                if (!archetype->IsAnyRowDirty(chunk)) continue;
+                fn(chunk.count, archetype->GetEntities(chunk), chunk.dirtyRows.get(), archetype->GetColumn<Ts>(chunk)...);
+            }
+        }
+    }
+
+    // Calls fn(entity, components&...) for every entity that has all of Ts.
+    template<typename... Ts, typename Fn>
+    void ForEach(Fn&& fn) {
+        ForEachChunk<Ts...>([&fn](uint32 count, const Handle* entities, Ts*... columns) {
+            for (uint32 i = 0; i < count; ++i) {
+                fn(entities[i], columns[i]...);
+            }
+        });
+    }
+
+    template<typename... Ts>
+    uint32 Count() {
+        uint32 count = 0;
+        ComponentMask required = ComponentRegistry::MaskOf<Ts...>();
+        for (auto& archetype : m_archetypes) {
+            if (archetype->Matches(required)) count += archetype->GetEntityCount();
+        }
+        return count;
+    }
+
+    uint32 GetEntityCount() const { return m_entityCount; }
+    uint32 GetArchetypeCount() const { return static_cast<uint32>(m_archetypes.size()); }
+
+private:
+    struct EntityRecord {
+        uint32 generation = 0;
+        Archetype* archetype = nullptr;     // nullptr while the ID is free
+        uint32 chunk = 0;
+        uint32 row = 0;
+    };
+
+    Vector<EntityRecord> m_records;         // Indexed by EntityID, 0 is reserved
+    Vector<EntityID> m_freeIds;
+    Vector<UniquePtr<Archetype>> m_archetypes;
+    HashMap<ComponentMask, Archetype*> m_archetypeByMask;
+    uint32 m_entityCount = 0;
+
+    template<typename T>
+    void WriteComponent(EntityRecord& record, const T& component) {
+        Archetype::Chunk& chunk = record.archetype->GetChunk(record.chunk);
+        std::memcpy(record.archetype->GetColumn<T>(chunk) + record.row, &component, sizeof(T));
+    }
+
+    Handle AllocateHandle();
+    Archetype* GetOrCreateArchetype(ComponentMask mask);
+    void MoveToArchetype(Handle entity, ComponentMask mask);
+};
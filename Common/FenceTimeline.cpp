@@ -0,0 +1,45 @@
+#include "FenceTimeline.h"
+#include <cassert>
+
+FenceTimeline::FenceTimeline(IGpuFence* fence)
+    : m_fence(fence) {
+    m_lastSignaled = m_fence->GetCompletedValue();
+    m_lastCompleted = m_lastSignaled;
+}
+
+FenceTimeline::~FenceTimeline() {
+    // Deferred objects, and whatever the owner destroys after this, may still be in use.
+    WaitFor(m_lastSignaled);
+    m_releaseQueue.Clear();
+}
+
+uint64 FenceTimeline::Signal() {
+    m_fence->Signal(++m_lastSignaled);
+    return m_lastSignaled;
+}
+
+uint64 FenceTimeline::GetCompletedValue() {
+    m_lastCompleted = std::max(m_lastCompleted, m_fence->GetCompletedValue());
+    return m_lastCompleted;
+}
+
+bool FenceTimeline::IsComplete(uint64 value) {
+    return value <= m_lastCompleted || value <= GetCompletedValue();
+}
+
+void FenceTimeline::WaitFor(uint64 value) {
+    assert(value <= m_lastSignaled && "Waiting for a fence value that was never signalled");
+    if (IsComplete(value)) return;
+
+    m_fence->WaitForValue(value);
+    m_lastCompleted = std::max(m_lastCompleted, value);
+}
+
+void FenceTimeline::WaitForIdle() {
+    WaitFor(Signal());
+    CollectGarbage();
+}
+
+uint32 FenceTimeline::CollectGarbage() {
+    return m_releaseQueue.Collect(GetCompletedValue());
+}
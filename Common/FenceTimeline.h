@@ -0,0 +1,59 @@
+#pragma once
+
+#include "GpuFence.h"
+#include "DeferredReleaseQueue.h"
+
+// Owns the fence values of one command queue. Signal hands out completion points,
+// waits go through the fence's reused event, and the deferred-release queue destroys
+// objects once the GPU has passed the point they were released at. Nothing here
+// needs the GPU to go idle; WaitForIdle exists for the few places that must.
+class FenceTimeline {
+public:
+    explicit FenceTimeline(IGpuFence* fence);
+
+    // Waits for everything signalled so far before destroying the deferred objects.
+    ~FenceTimeline();
+
+    DECLARE_NON_COPYABLE(FenceTimeline)
+    DECLARE_NON_MOVABLE(FenceTimeline)
+
+    // Signals the next value after all work submitted so far and returns it.
+    uint64 Signal();
+
+    uint64 GetLastSignaledValue() const { return m_lastSignaled; }
+
+    // Queries the fence and caches the result.
+    uint64 GetCompletedValue();
+
+    // Answers from the cached value when it can, so polling many values stays cheap.
+    bool IsComplete(uint64 value);
+
+    void WaitFor(uint64 value);
+
+    // Signals and waits for it. Stalls the CPU until the queue is empty.
+    void WaitForIdle();
+
+    // Keeps object alive until the GPU has finished everything submitted so far and
+    // the commands being recorded now, which complete with the next Signal.
+    template<typename T>
+    void DeferRelease(T&& object) {
+        m_releaseQueue.Push(std::forward<T>(object), m_lastSignaled + 1);
+    }
+
+    // Same, for an object only referenced by work up to fenceValue.
+    template<typename T>
+    void DeferRelease(T&& object, uint64 fenceValue) {
+        m_releaseQueue.Push(std::forward<T>(object), fenceValue);
+    }
+
+    // Destroys every deferred object the GPU is done with. Returns how many.
+    uint32 CollectGarbage();
+
+    uint32 GetPendingReleaseCount() const { return m_releaseQueue.GetPendingCount(); }
+
+private:
+    IGpuFence* m_fence = nullptr;
+    uint64 m_lastSignaled = 0;
+    uint64 m_lastCompleted = 0;
+    DeferredReleaseQueue m_releaseQueue;
+};
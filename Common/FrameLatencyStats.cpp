@@ -0,0 +1,93 @@
+#include "FrameLatencyStats.h"
+#include <cassert>
+
+FrameLatencyStats::FrameLatencyStats(uint32 capacity)
+    : m_frames(std::max(capacity, 1u)) {
+}
+
+void FrameLatencyStats::BeginFrame(uint64 frameNumber, uint32 framesInFlight, float64 nowMs) {
+    if (FrameTiming* previous = Current()) {
+        previous->cpuFrameMs = nowMs - previous->beginMs;
+    }
+
+    FrameTiming& frame = m_frames[m_next];
+    frame = FrameTiming();
+    frame.frameNumber = frameNumber;
+    frame.framesInFlight = framesInFlight;
+    frame.beginMs = nowMs;
+
+    m_next = (m_next + 1) % GetCapacity();
+    m_count = std::min(m_count + 1, GetCapacity());
+}
+
+void FrameLatencyStats::RecordFenceWait(float64 waitMs) {
+    if (FrameTiming* frame = Current()) {
+        frame->fenceWaitMs += waitMs;
+    }
+}
+
+void FrameLatencyStats::RecordSubmit(uint64 fenceValue, float64 nowMs) {
+    if (FrameTiming* frame = Current()) {
+        frame->fenceValue = fenceValue;
+        frame->submitMs = nowMs;
+    }
+}
+
+void FrameLatencyStats::RecordFenceCompleted(uint64 completedValue, float64 nowMs) {
+    // Fence values grow with the frames, so everything older than the newest resolved
+    // frame is resolved too and the walk stops there.
+    for (uint32 age = 0; age < m_count; ++age) {
+        FrameTiming& frame = m_frames[(m_next + GetCapacity() - 1 - age) % GetCapacity()];
+        if (frame.fenceValue == 0) continue;
+        if (frame.gpuLatencyMs >= 0.0) break;
+        if (frame.fenceValue <= completedValue) {
+            frame.gpuLatencyMs = nowMs - frame.submitMs;
+        }
+    }
+}
+
+void FrameLatencyStats::Clear() {
+    m_next = 0;
+    m_count = 0;
+}
+
+const FrameTiming& FrameLatencyStats::GetFrame(uint32 age) const {
+    assert(age < m_count && "Frame age out of range");
+    return m_frames[(m_next + GetCapacity() - 1 - age) % GetCapacity()];
+}
+
+FrameLatencyStats::Summary FrameLatencyStats::Summarize(uint32 frameCount) const {
+    Summary summary;
+    uint32 cpuSamples = 0;
+    uint32 gpuSamples = 0;
+
+    frameCount = std::min(frameCount, m_count);
+    for (uint32 age = 0; age < frameCount; ++age) {
+        const FrameTiming& frame = GetFrame(age);
+
+        summary.avgFenceWaitMs += frame.fenceWaitMs;
+        summary.maxFenceWaitMs = std::max(summary.maxFenceWaitMs, frame.fenceWaitMs);
+
+        if (frame.cpuFrameMs >= 0.0) {
+            summary.avgCpuFrameMs += frame.cpuFrameMs;
+            summary.maxCpuFrameMs = std::max(summary.maxCpuFrameMs, frame.cpuFrameMs);
+            ++cpuSamples;
+        }
+        if (frame.gpuLatencyMs >= 0.0) {
+            summary.avgGpuLatencyMs += frame.gpuLatencyMs;
+            summary.maxGpuLatencyMs = std::max(summary.maxGpuLatencyMs, frame.gpuLatencyMs);
+            ++gpuSamples;
+        }
+    }
+
+    summary.sampleCount = frameCount;
+    if (frameCount > 0) summary.avgFenceWaitMs /= frameCount;
+    if (cpuSamples > 0) summary.avgCpuFrameMs /= cpuSamples;
+    if (gpuSamples > 0) summary.avgGpuLatencyMs /= gpuSamples;
+    return summary;
+}
+
+FrameTiming* FrameLatencyStats::Current() {
+    if (m_count == 0) return nullptr;
+    return &m_frames[(m_next + GetCapacity() - 1) % GetCapacity()];
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Types.h>
+
+// Timings of one frame, all in milliseconds.
+struct FrameTiming {
+    uint64 frameNumber = 0;
+    uint64 fenceValue = 0;          // Signalled after the frame's command lists, 0 until submitted
+    uint32 framesInFlight = 0;
+    float64 beginMs = 0.0;
+    float64 submitMs = 0.0;
+    float64 cpuFrameMs = -1.0;      // Begin of this frame to begin of the next, negative until known
+    float64 fenceWaitMs = 0.0;      // Time blocked waiting for the frame slot to be released
+    float64 gpuLatencyMs = -1.0;    // Submit to observed fence completion, negative until known
+};
+
+// Ring of the most recent FrameTimings.
+//
+// GPU latency is measured from submission until the CPU first notices the fence has
+// passed the frame's value, so it is an upper bound whose precision depends on how
+// often RecordFenceCompleted is called.
+class FrameLatencyStats {
+public:
+    struct Summary {
+        uint32 sampleCount = 0;
+        float64 avgCpuFrameMs = 0.0;
+        float64 maxCpuFrameMs = 0.0;
+        float64 avgFenceWaitMs = 0.0;
+        float64 maxFenceWaitMs = 0.0;
+        float64 avgGpuLatencyMs = 0.0;
+        float64 maxGpuLatencyMs = 0.0;
+    };
+
+    static constexpr uint32 DefaultCapacity = 256;
+
+    explicit FrameLatencyStats(uint32 capacity = DefaultCapacity);
+
+    void BeginFrame(uint64 frameNumber, uint32 framesInFlight, float64 nowMs);
+    void RecordFenceWait(float64 waitMs);
+    void RecordSubmit(uint64 fenceValue, float64 nowMs);
+    void RecordFenceCompleted(uint64 completedValue, float64 nowMs);
+
+    void Clear();
+
+    uint32 GetCapacity() const { return static_cast<uint32>(m_frames.size()); }
+    uint32 GetCount() const { return m_count; }
+
+    // age 0 is the current frame, 1 the one before, and so on up to GetCount() - 1.
+    const FrameTiming& GetFrame(uint32 age) const;
+
+    // Averages and maxima over the last frameCount frames; values that are not known
+    // yet are left out.
+    Summary Summarize(uint32 frameCount) const;
+
+private:
+    Vector<FrameTiming> m_frames;
+    uint32 m_next = 0;      // Slot the next BeginFrame writes
+    uint32 m_count = 0;
+
+    FrameTiming* Current();
+};
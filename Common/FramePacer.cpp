@@ -0,0 +1,52 @@
+#include "FramePacer.h"
+
+#include <chrono>
+
+FramePacer::FramePacer(IGpuFence* fence, uint32 framesInFlight, Clock clock)
+    : m_fence(fence), m_clock(std::move(clock)) {
+    if (!m_clock) {
+        m_clock = []() {
+            using namespace std::chrono;
+            return duration<float64, std::milli>(steady_clock::now().time_since_epoch()).count();
+        };
+    }
+    SetFramesInFlight(framesInFlight);
+}
+
+uint32 FramePacer::BeginFrame() {
+    // The first frame after a reset starts at slot 0.
+    if (m_restart) {
+        m_restart = false;
+    }
+    else {
+        m_frameIndex = (m_frameIndex + 1) % GetFramesInFlight();
+    }
+    ++m_frameNumber;
+
+    m_stats.BeginFrame(m_frameNumber, GetFramesInFlight(), m_clock());
+
+    uint64 slotFence = m_slotFences[m_frameIndex];
+    if (slotFence != 0 && m_fence->GetCompletedValue() < slotFence) {
+        float64 waitStart = m_clock();
+        m_fence->WaitForValue(slotFence);
+        m_stats.RecordFenceWait(m_clock() - waitStart);
+    }
+
+    PollCompletion();
+    return m_frameIndex;
+}
+
+void FramePacer::EndFrame(uint64 fenceValue) {
+    m_slotFences[m_frameIndex] = fenceValue;
+    m_stats.RecordSubmit(fenceValue, m_clock());
+}
+
+void FramePacer::PollCompletion() {
+    m_stats.RecordFenceCompleted(m_fence->GetCompletedValue(), m_clock());
+}
+
+void FramePacer::SetFramesInFlight(uint32 count) {
+    m_slotFences.assign(ClampFramesInFlight(count), 0);
+    m_frameIndex = 0;
+    m_restart = true;
+}
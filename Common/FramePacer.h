@@ -0,0 +1,63 @@
+#pragma once
+
+#include "GpuFence.h"
+#include "FrameLatencyStats.h"
+
+// Decides which frame resource slot the CPU records into and blocks until the GPU
+// has released it. The number of frames in flight trades input latency (fewer) for
+// throughput (more) and can be changed while running.
+//
+// Every frame's fence wait, GPU latency and CPU frame time go into a
+// FrameLatencyStats ring.
+class FramePacer {
+public:
+    static constexpr uint32 MinFramesInFlight = 1;
+    static constexpr uint32 MaxFramesInFlight = 4;
+    static constexpr uint32 DefaultFramesInFlight = 3;
+
+    // Returns the current time in milliseconds. Defaults to std::chrono::steady_clock.
+    using Clock = Function<float64()>;
+
+    FramePacer(IGpuFence* fence, uint32 framesInFlight = DefaultFramesInFlight, Clock clock = nullptr);
+
+    DECLARE_NON_COPYABLE(FramePacer)
+    DECLARE_NON_MOVABLE(FramePacer)
+
+    // Moves to the next slot and waits until the GPU finished the frame that used it last.
+    // Returns the slot index.
+    uint32 BeginFrame();
+
+    // Records that the frame's work was submitted and fenceValue signalled after it.
+    void EndFrame(uint64 fenceValue);
+
+    // Resolves GPU latencies of finished frames without waiting. BeginFrame does this too,
+    // calling it more often only makes the measurement more precise.
+    void PollCompletion();
+
+    // Clamped to [MinFramesInFlight, MaxFramesInFlight]. Frames already submitted are not
+    // waited for: the new slots start out free, so the caller must give them per-frame
+    // resources the GPU is not using, e.g. new ones with the old ones deferred to the fence
+    // timeline. The next BeginFrame starts again at slot 0; the stats keep resolving the
+    // GPU latency of the earlier frames.
+    void SetFramesInFlight(uint32 count);
+
+    uint32 GetFramesInFlight() const { return static_cast<uint32>(m_slotFences.size()); }
+    uint32 GetFrameIndex() const { return m_frameIndex; }
+    uint64 GetFrameNumber() const { return m_frameNumber; }
+
+    const FrameLatencyStats& GetStats() const { return m_stats; }
+    FrameLatencyStats& GetStats() { return m_stats; }
+
+    static uint32 ClampFramesInFlight(uint32 count) {
+        return std::min(std::max(count, MinFramesInFlight), MaxFramesInFlight);
+    }
+
+private:
+    IGpuFence* m_fence = nullptr;
+    Clock m_clock;
+    Vector<uint64> m_slotFences;    // Fence value of the last frame recorded into each slot
+    uint32 m_frameIndex = 0;
+    uint64 m_frameNumber = 0;      // Keeps counting across SetFramesInFlight
+    bool m_restart = true;
+    FrameLatencyStats m_stats;
+};
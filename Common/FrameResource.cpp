@@ -1,6 +1,7 @@
 #include "FrameResource.h"
 
-FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT materialCount) {
+FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT materialCount,
+                             GpuMemoryAllocator* allocator) {
     // Create command allocator for this frame
     ThrowIfFailed(device->CreateCommandAllocator(
         D3D12_COMMAND_LIST_TYPE_DIRECT,
@@ -9,17 +10,19 @@ FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCo
     // Create upload buffers for constant data
     if (passCount > 0) {
         PassCB = UniquePtr<UploadBuffer<PassConstants>>(
-            new UploadBuffer<PassConstants>(device, passCount, true));
+            new UploadBuffer<PassConstants>(device, passCount, true, allocator));
     }
 
     if (objectCount > 0) {
-        ObjectCB = UniquePtr<UploadBuffer<ObjectConstants>>(
-            new UploadBuffer<ObjectConstants>(device, objectCount, true));
+        ObjectUpload = UniquePtr<UploadBuffer<ObjectData>>(
+            new UploadBuffer<ObjectData>(device, objectCount, false, allocator));
+        InstanceList = UniquePtr<UploadBuffer<uint32>>(
+            new UploadBuffer<uint32>(device, objectCount, false, allocator));
     }
 
     if (materialCount > 0) {
-        MaterialCB = UniquePtr<UploadBuffer<MaterialConstants>>(
-            new UploadBuffer<MaterialConstants>(device, materialCount, true));
+        MaterialBuffer = UniquePtr<UploadBuffer<MaterialConstants>>(
+            new UploadBuffer<MaterialConstants>(device, materialCount, false, allocator));
     }
 }
 
@@ -4,6 +4,7 @@
 #include "UploadBuffer.h"
 #include "RenderComponents.h"
 #include "RenderObject.h"
+#include "ObjectData.h"
 
 // Forward declarations
 struct MaterialConstants; // Already defined in RenderComponents.h
@@ -31,7 +32,8 @@ struct PassConstants {
 // synchronization issues between CPU and GPU.
 class FrameResource {
 public:
-    FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT materialCount = 0);
+    FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT materialCount = 0,
+                  GpuMemoryAllocator* allocator = nullptr);
     ~FrameResource();
 
     // We cannot copy or assign frame resources
@@ -45,8 +47,13 @@ public:
     // We cannot update a cbuffer until the GPU is done processing the commands
     // that reference it. So each frame needs its own cbuffers.
     UniquePtr<UploadBuffer<PassConstants>> PassCB;
-    UniquePtr<UploadBuffer<ObjectConstants>> ObjectCB;
-    UniquePtr<UploadBuffer<MaterialConstants>> MaterialCB;
+    // Staging for the objects whose data changed this frame; they are copied into the
+    // persistent object buffer.
+    UniquePtr<UploadBuffer<ObjectData>> ObjectUpload;
+    // Structured buffer read through the material table, indexed by material index.
+    UniquePtr<UploadBuffer<MaterialConstants>> MaterialBuffer;
+    // Draw IDs of the frame's instanced draws, one per object at most.
+    UniquePtr<UploadBuffer<uint32>> InstanceList;
 
     // Fence value to mark commands up to this fence point. This lets us
     // check if these frame resources are still in use by the GPU.
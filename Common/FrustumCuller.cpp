@@ -0,0 +1,214 @@
+#include "FrustumCuller.h"
+#include "WorkerPool.h"
+#include "SimdSupport.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Extents of an empty box. Large enough that every plane rejects it, small enough
+    // that the sums stay finite.
+    constexpr float EmptyExtent = -1e30f;
+    constexpr float InfiniteExtent = 1e30f;
+
+    // A box is outside a plane when even its corner furthest along the normal is behind
+    // it: dot(n, center) + d + dot(|n|, extents) < 0.
+    uint32 CullScalar(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32 begin, uint32 end,
+                      uint32* visible) {
+        uint32 count = 0;
+        for (uint32 i = begin; i < end; ++i) {
+            bool inside = true;
+            for (uint32 p = 0; p < 6 && inside; ++p) {
+                float distance = frustum.normalX[p] * bounds.GetCenterX()[i] + frustum.normalY[p] * bounds.GetCenterY()[i] +
+                                 frustum.normalZ[p] * bounds.GetCenterZ()[i] + frustum.d[p];
+                float radius = std::fabs(frustum.normalX[p]) * bounds.GetExtentX()[i] +
+                               std::fabs(frustum.normalY[p]) * bounds.GetExtentY()[i] +
+                               std::fabs(frustum.normalZ[p]) * bounds.GetExtentZ()[i];
+                inside = distance + radius >= 0.0f;
+            }
+            if (inside) visible[count++] = i;
+        }
+        return count;
+    }
+
+    // Appends first + k for every set bit k of mask without branching: each index is
+    // written, and the cursor only advances past the visible ones.
+    inline uint32 AppendMask(uint32* visible, uint32 count, uint32 first, uint32 mask, uint32 lanes) {
+        for (uint32 k = 0; k < lanes; ++k) {
+            visible[count] = first + k;
+            count += (mask >> k) & 1u;
+        }
+        return count;
+    }
+
+#ifdef SIMD_X86
+    uint32 CullSSE(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32 begin, uint32 end,
+                   uint32* visible) {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 nx[6], ny[6], nz[6], d[6], ax[6], ay[6], az[6];
+        for (uint32 p = 0; p < 6; ++p) {
+            nx[p] = _mm_set1_ps(frustum.normalX[p]);
+            ny[p] = _mm_set1_ps(frustum.normalY[p]);
+            nz[p] = _mm_set1_ps(frustum.normalZ[p]);
+            d[p] = _mm_set1_ps(frustum.d[p]);
+            ax[p] = _mm_andnot_ps(signMask, nx[p]);
+            ay[p] = _mm_andnot_ps(signMask, ny[p]);
+            az[p] = _mm_andnot_ps(signMask, nz[p]);
+        }
+
+        uint32 count = 0;
+        uint32 i = begin;
+        for (; i + 4 <= end; i += 4) {
+            __m128 cx = _mm_loadu_ps(bounds.GetCenterX() + i), cy = _mm_loadu_ps(bounds.GetCenterY() + i);
+            __m128 cz = _mm_loadu_ps(bounds.GetCenterZ() + i), ex = _mm_loadu_ps(bounds.GetExtentX() + i);
+            __m128 ey = _mm_loadu_ps(bounds.GetExtentY() + i), ez = _mm_loadu_ps(bounds.GetExtentZ() + i);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (uint32 p = 0; p < 6; ++p) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+                                             _mm_add_ps(_mm_mul_ps(nz[p], cz), d[p]));
+                __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+            }
+            count = AppendMask(visible, count, i, static_cast<uint32>(_mm_movemask_ps(inside)), 4);
+        }
+
+        return count + CullScalar(frustum, bounds, i, end, visible + count);
+    }
+
+    SIMD_TARGET_AVX2 uint32 CullAVX2(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32 begin,
+                                     uint32 end, uint32* visible) {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        __m256 nx[6], ny[6], nz[6], d[6], ax[6], ay[6], az[6];
+        for (uint32 p = 0; p < 6; ++p) {
+            nx[p] = _mm256_set1_ps(frustum.normalX[p]);
+            ny[p] = _mm256_set1_ps(frustum.normalY[p]);
+            nz[p] = _mm256_set1_ps(frustum.normalZ[p]);
+            d[p] = _mm256_set1_ps(frustum.d[p]);
+            ax[p] = _mm256_andnot_ps(signMask, nx[p]);
+            ay[p] = _mm256_andnot_ps(signMask, ny[p]);
+            az[p] = _mm256_andnot_ps(signMask, nz[p]);
+        }
+
+        uint32 count = 0;
+        uint32 i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256 cx = _mm256_loadu_ps(bounds.GetCenterX() + i), cy = _mm256_loadu_ps(bounds.GetCenterY() + i);
+            __m256 cz = _mm256_loadu_ps(bounds.GetCenterZ() + i), ex = _mm256_loadu_ps(bounds.GetExtentX() + i);
+            __m256 ey = _mm256_loadu_ps(bounds.GetExtentY() + i), ez = _mm256_loadu_ps(bounds.GetExtentZ() + i);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (uint32 p = 0; p < 6; ++p) {
+                __m256 distance = _mm256_fmadd_ps(nz[p], cz, _mm256_fmadd_ps(ny[p], cy, _mm256_fmadd_ps(nx[p], cx, d[p])));
+                distance = _mm256_fmadd_ps(az[p], ez, _mm256_fmadd_ps(ay[p], ey, _mm256_fmadd_ps(ax[p], ex, distance)));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            count = AppendMask(visible, count, i, static_cast<uint32>(_mm256_movemask_ps(inside)), 8);
+        }
+
+        return count + CullSSE(frustum, bounds, i, end, visible + count);
+    }
+#endif
+
+    uint32 CullRange(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32 begin, uint32 end,
+                     uint32* visible, FrustumCuller::Path path) {
+#ifdef SIMD_X86
+        switch (path) {
+        case FrustumCuller::Path::AVX2: return CullAVX2(frustum, bounds, begin, end, visible);
+        case FrustumCuller::Path::SSE: return CullSSE(frustum, bounds, begin, end, visible);
+        default: break;
+        }
+#endif
+        return CullScalar(frustum, bounds, begin, end, visible);
+    }
+}
+
+void CullingBounds::Resize(uint32 count) {
+    for (auto* stream : { &m_centerX, &m_centerY, &m_centerZ }) stream->resize(count, 0.0f);
+    for (auto* stream : { &m_extentX, &m_extentY, &m_extentZ }) stream->resize(count, EmptyExtent);
+}
+
+void CullingBounds::Set(uint32 index, const float center[3], const float extents[3]) {
+    m_centerX[index] = center[0];
+    m_centerY[index] = center[1];
+    m_centerZ[index] = center[2];
+    m_extentX[index] = extents[0];
+    m_extentY[index] = extents[1];
+    m_extentZ[index] = extents[2];
+}
+
+void CullingBounds::SetEmpty(uint32 index) {
+    const float center[3] = { 0.0f, 0.0f, 0.0f };
+    const float extents[3] = { EmptyExtent, EmptyExtent, EmptyExtent };
+    Set(index, center, extents);
+}
+
+void CullingBounds::SetInfinite(uint32 index) {
+    const float center[3] = { 0.0f, 0.0f, 0.0f };
+    const float extents[3] = { InfiniteExtent, InfiniteExtent, InfiniteExtent };
+    Set(index, center, extents);
+}
+
+FrustumPlanes FrustumCuller::ExtractPlanes(const float* m) {
+    // For clip = p * M the planes are combinations of M's columns: -w <= x <= w,
+    // -w <= y <= w and 0 <= z <= w.
+    auto column = [m](uint32 c, uint32 r) { return m[r * 4 + c]; };
+    float planes[6][4];
+    for (uint32 r = 0; r < 4; ++r) {
+        planes[0][r] = column(3, r) + column(0, r);     // Left
+        planes[1][r] = column(3, r) - column(0, r);     // Right
+        planes[2][r] = column(3, r) + column(1, r);     // Bottom
+        planes[3][r] = column(3, r) - column(1, r);     // Top
+        planes[4][r] = column(2, r);                    // Near
+        planes[5][r] = column(3, r) - column(2, r);     // Far
+    }
+
+    FrustumPlanes frustum;
+    for (uint32 p = 0; p < 6; ++p) {
+        float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+        float scale = length > 0.0f ? 1.0f / length : 0.0f;
+        frustum.normalX[p] = planes[p][0] * scale;
+        frustum.normalY[p] = planes[p][1] * scale;
+        frustum.normalZ[p] = planes[p][2] * scale;
+        frustum.d[p] = planes[p][3] * scale;
+    }
+    return frustum;
+}
+
+FrustumCuller::Path FrustumCuller::GetBestPath() {
+#ifdef SIMD_X86
+    return Simd::SupportsAVX2() ? Path::AVX2 : Path::SSE;
+#else
+    return Path::Scalar;
+#endif
+}
+
+uint32 FrustumCuller::Cull(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32* visible, Path path) {
+    return CullRange(frustum, bounds, 0, bounds.GetCount(), visible, path);
+}
+
+uint32 FrustumCuller::Cull(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32* visible,
+                           WorkerPool* pool) {
+    uint32 count = bounds.GetCount();
+    Path path = GetBestPath();
+    if (!pool || count < ParallelThreshold) {
+        return CullRange(frustum, bounds, 0, count, visible, path);
+    }
+
+    // Each batch compacts into its own part of visible, starting at the batch's first
+    // index; the parts are then moved together in order.
+    const uint32 unit = 256;
+    Vector<uint32> batchCounts((count + unit - 1) / unit, 0);
+    pool->ParallelFor(count, unit, [&](uint32 begin, uint32 end) {
+        batchCounts[begin / unit] = CullRange(frustum, bounds, begin, end, visible + begin, path);
+    });
+
+    uint32 total = 0;
+    for (uint32 u = 0; u < batchCounts.size(); ++u) {
+        if (batchCounts[u] == 0) continue;
+        if (total != u * unit) {
+            std::memmove(visible + total, visible + u * unit, batchCounts[u] * sizeof(uint32));
+        }
+        total += batchCounts[u];
+    }
+    return total;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Types.h>
+
+class WorkerPool;
+
+// Six planes with normals pointing inwards: a point p is inside a plane when
+// dot(normal, p) + d >= 0.
+struct FrustumPlanes {
+    float normalX[6];
+    float normalY[6];
+    float normalZ[6];
+    float d[6];
+};
+
+// World-space axis-aligned boxes as center and half extents, one array per component
+// so the culler can test 8 boxes per instruction.
+class CullingBounds {
+public:
+    // New entries are empty.
+    void Resize(uint32 count);
+
+    void Set(uint32 index, const float center[3], const float extents[3]);
+
+    // An empty box is never visible, e.g. a free slot.
+    void SetEmpty(uint32 index);
+
+    // An infinite box is always visible, for objects without bounds.
+    void SetInfinite(uint32 index);
+
+    uint32 GetCount() const { return static_cast<uint32>(m_centerX.size()); }
+
+    const float* GetCenterX() const { return m_centerX.data(); }
+    const float* GetCenterY() const { return m_centerY.data(); }
+    const float* GetCenterZ() const { return m_centerZ.data(); }
+    const float* GetExtentX() const { return m_extentX.data(); }
+    const float* GetExtentY() const { return m_extentY.data(); }
+    const float* GetExtentZ() const { return m_extentZ.data(); }
+
+private:
+    Vector<float> m_centerX, m_centerY, m_centerZ;
+    Vector<float> m_extentX, m_extentY, m_extentZ;
+};
+
+class FrustumCuller {
+public:
+    enum class Path : uint8 { Scalar, SSE, AVX2 };
+
+    // Bounds per call below which threading costs more than it saves.
+    static constexpr uint32 ParallelThreshold = 8192;
+
+    // Planes of a row-major view-projection matrix for row vectors, D3D depth range 0..1.
+    static FrustumPlanes ExtractPlanes(const float* viewProj);
+
+    // Writes the indices of the boxes that intersect the frustum to visible in ascending
+    // order and returns how many there are. visible must have room for every box.
+    static uint32 Cull(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32* visible,
+                       WorkerPool* pool = nullptr);
+
+    // Single threaded on the given path.
+    static uint32 Cull(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32* visible, Path path);
+
+    static Path GetBestPath();
+};
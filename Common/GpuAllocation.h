@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Types.h>
+#include <d3d12.h>
+
+class GpuMemoryAllocator;
+
+// A range of an ID3D12Heap block owned by GpuMemoryAllocator. The range is returned
+// to the allocator when this object is destroyed or reset, so it should be declared
+// next to (and before) the resource placed in it.
+class GpuAllocation {
+public:
+    // Receives the resource that replaced the original one after a defragmentation move.
+    // The owner should store it wherever it kept the old resource and rebuild any views.
+    using RelocationCallback = Function<void(ID3D12Resource* newResource)>;
+
+    GpuAllocation() = default;
+    ~GpuAllocation() { Reset(); }
+
+    GpuAllocation(GpuAllocation&& other) noexcept { *this = std::move(other); }
+
+    GpuAllocation& operator=(GpuAllocation&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            m_allocator = other.m_allocator;
+            m_poolIndex = other.m_poolIndex;
+            m_blockIndex = other.m_blockIndex;
+            m_node = other.m_node;
+            m_offset = other.m_offset;
+            m_size = other.m_size;
+            m_resource = other.m_resource;
+            m_steadyState = other.m_steadyState;
+            m_onRelocate = std::move(other.m_onRelocate);
+            other.m_allocator = nullptr;
+            other.m_onRelocate = nullptr;
+            RebindOwner();
+        }
+        return *this;
+    }
+
+    DECLARE_NON_COPYABLE(GpuAllocation)
+
+    // Returns the range to the allocator. Defined in GpuMemoryAllocator.cpp.
+    void Reset();
+
+    // Lets the defragmenter move the resource. steadyState is the state the resource
+    // rests in between uses; a relocated resource rests in D3D12_RESOURCE_STATE_COMMON.
+    void EnableRelocation(D3D12_RESOURCE_STATES steadyState, RelocationCallback callback) {
+        m_steadyState = steadyState;
+        m_onRelocate = std::move(callback);
+    }
+
+    bool IsValid() const { return m_allocator != nullptr; }
+    bool IsRelocatable() const { return IsValid() && m_onRelocate != nullptr; }
+    uint64 GetOffset() const { return m_offset; }
+    uint64 GetSize() const { return m_size; }
+    ID3D12Resource* GetResource() const { return m_resource; }
+
+private:
+    friend class GpuMemoryAllocator;
+    friend class GpuDefragmenter;
+
+    GpuMemoryAllocator* m_allocator = nullptr;
+    uint32 m_poolIndex = 0;
+    uint32 m_blockIndex = 0;
+    uint32 m_node = 0;
+    uint64 m_offset = 0;
+    uint64 m_size = 0;
+
+    ID3D12Resource* m_resource = nullptr;   // Not owned, the user holds the reference
+    D3D12_RESOURCE_STATES m_steadyState = D3D12_RESOURCE_STATE_COMMON;
+    RelocationCallback m_onRelocate;
+
+    // Tells the allocator this object now owns the range. Defined in GpuMemoryAllocator.cpp.
+    void RebindOwner();
+};
@@ -0,0 +1,285 @@
+#include "GpuDefragmenter.h"
+
+GpuDefragmenter::GpuDefragmenter(ID3D12Device* device, GpuMemoryAllocator* allocator)
+    : m_device(device), m_allocator(allocator) {
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(m_copyQueue.GetAddressOf())));
+
+    ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY,
+        IID_PPV_ARGS(m_copyAllocator.GetAddressOf())));
+
+    ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_copyAllocator.Get(), nullptr,
+        IID_PPV_ARGS(m_copyList.GetAddressOf())));
+    ThrowIfFailed(m_copyList->Close());
+
+    ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_copyFence.GetAddressOf())));
+}
+
+GpuDefragmenter::~GpuDefragmenter() {
+    // The caller has flushed the direct queue, so only the copy queue can still be busy.
+    if (m_copyFence->GetCompletedValue() < m_copyFenceValue) {
+        ScopedHandle eventHandle(CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS));
+        ThrowIfFailed(m_copyFence->SetEventOnCompletion(m_copyFenceValue, eventHandle.get()));
+        WaitForSingleObject(eventHandle.get(), INFINITE);
+    }
+
+    // Unfinished moves leave the owners where they were.
+    for (auto& pending : m_moves) {
+        auto& block = m_allocator->m_pools[pending.poolIndex].blocks[pending.move.dstBlock];
+        block.allocator->Free(pending.move.dstNode);
+    }
+    m_moves.clear();
+    m_state = State::Idle;
+
+    ReleaseRetired(UINT64_MAX);
+}
+
+void GpuDefragmenter::BeginFrame(ID3D12GraphicsCommandList* directList,
+                                 UINT64 completedFrameFence,
+                                 UINT64 lastSubmittedFrameFence) {
+    ReleaseRetired(completedFrameFence);
+
+    if (m_state == State::Copying && m_copyFence->GetCompletedValue() >= m_copyFenceValue) {
+        FinishPass(lastSubmittedFrameFence);
+    }
+
+    if (m_state != State::Idle || !m_retired.empty() || !m_evacuated.empty() || !m_enabled) {
+        return;
+    }
+
+    if (++m_framesSincePass >= m_passInterval) {
+        m_framesSincePass = 0;
+        StartPass(directList, lastSubmittedFrameFence);
+    }
+}
+
+void GpuDefragmenter::EndFrame(ID3D12Fence* frameFence, UINT64 frameFenceValue) {
+    if (m_state != State::PendingSubmit) return;
+
+    ThrowIfFailed(m_copyAllocator->Reset());
+    ThrowIfFailed(m_copyList->Reset(m_copyAllocator.Get(), nullptr));
+
+    // Both resources are in COMMON, which the copy queue promotes to COPY_SOURCE / COPY_DEST.
+    for (const auto& pending : m_moves) {
+        m_copyList->CopyResource(pending.destination.Get(), pending.source.Get());
+    }
+    ThrowIfFailed(m_copyList->Close());
+
+    // Sources that needed a barrier to COMMON are only ready once this frame has executed.
+    ThrowIfFailed(m_copyQueue->Wait(frameFence, frameFenceValue));
+
+    ID3D12CommandList* cmdsLists[] = { m_copyList.Get() };
+    m_copyQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+    ThrowIfFailed(m_copyQueue->Signal(m_copyFence.Get(), ++m_copyFenceValue));
+
+    m_state = State::Copying;
+}
+
+Vector<TlsfAllocator*> GpuDefragmenter::GetBlockAllocators(uint32 poolIndex) const {
+    const auto& blocks = m_allocator->m_pools[poolIndex].blocks;
+
+    Vector<TlsfAllocator*> result(blocks.size(), nullptr);
+    for (uint32 i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].heap) {
+            result[i] = blocks[i].allocator.get();
+        }
+    }
+    return result;
+}
+
+DefragmentationPlanner::Metrics GpuDefragmenter::MeasureAll() const {
+    Vector<TlsfAllocator*> blocks;
+    for (uint32 poolIndex = 0; poolIndex < m_allocator->GetPoolCount(); ++poolIndex) {
+        Vector<TlsfAllocator*> poolBlocks = GetBlockAllocators(poolIndex);
+        blocks.insert(blocks.end(), poolBlocks.begin(), poolBlocks.end());
+    }
+    return DefragmentationPlanner::Measure(blocks);
+}
+
+void GpuDefragmenter::StartPass(ID3D12GraphicsCommandList* directList, UINT64 lastSubmittedFrameFence) {
+    PassStats stats;
+    stats.before = MeasureAll();
+
+    Vector<CD3DX12_RESOURCE_BARRIER> barriers;
+    DefragmentationPlanner::Settings budget = m_settings;
+
+    for (uint32 poolIndex = 0; poolIndex < m_allocator->GetPoolCount(); ++poolIndex) {
+        if (budget.maxMovesPerPass == 0 || budget.maxBytesPerPass == 0) break;
+
+        Vector<TlsfAllocator*> blocks = GetBlockAllocators(poolIndex);
+        auto canMove = [this, poolIndex](uint32 blockIndex, uint32 node) {
+            GpuAllocation* owner = m_allocator->GetOwner(poolIndex, blockIndex, node);
+            return owner && owner->IsRelocatable();
+        };
+
+        DefragmentationPlanner::Plan plan = DefragmentationPlanner::CreatePlan(blocks, canMove, budget);
+        if (plan.IsEmpty()) continue;
+
+        auto& pool = m_allocator->m_pools[poolIndex];
+        bool uploadHeap = pool.heapType == D3D12_HEAP_TYPE_UPLOAD;
+
+        // Place every destination first so a failure can still drop the whole plan.
+        Vector<PendingMove> moves;
+        bool failed = false;
+        for (const auto& move : plan.moves) {
+            GpuAllocation* owner = m_allocator->GetOwner(poolIndex, move.srcBlock, move.srcNode);
+
+            PendingMove pending;
+            pending.poolIndex = poolIndex;
+            pending.move = move;
+            pending.source = owner->m_resource;
+
+            D3D12_RESOURCE_DESC desc = pending.source->GetDesc();
+            HRESULT hr = m_device->CreatePlacedResource(
+                pool.blocks[move.dstBlock].heap.Get(),
+                move.dstOffset,
+                &desc,
+                uploadHeap ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                IID_PPV_ARGS(pending.destination.GetAddressOf()));
+
+            if (FAILED(hr)) {
+                failed = true;
+                break;
+            }
+            moves.push_back(std::move(pending));
+        }
+
+        if (failed) {
+            DefragmentationPlanner::Cancel(blocks, plan);
+            continue;
+        }
+
+        for (uint32 blockIndex : plan.evacuatedBlocks) {
+            pool.blocks[blockIndex].evacuating = true;
+            m_evacuated.push_back({ poolIndex, blockIndex, 0 });
+        }
+
+        stats.moveCount += static_cast<uint32>(plan.moves.size());
+        stats.bytesMoved += plan.bytesMoved;
+        stats.evacuatedBlockCount += static_cast<uint32>(plan.evacuatedBlocks.size());
+        budget.maxMovesPerPass -= static_cast<uint32>(std::min<size_t>(plan.moves.size(), budget.maxMovesPerPass));
+        budget.maxBytesPerPass -= std::min(plan.bytesMoved, budget.maxBytesPerPass);
+
+        if (uploadHeap) {
+            // Upload heaps are CPU visible, so the move is a memcpy and completes right away.
+            for (auto& pending : moves) {
+                void* src = nullptr;
+                void* dst = nullptr;
+                ThrowIfFailed(pending.source->Map(0, nullptr, &src));
+                ThrowIfFailed(pending.destination->Map(0, nullptr, &dst));
+                std::memcpy(dst, src, static_cast<size_t>(pending.source->GetDesc().Width));
+                pending.destination->Unmap(0, nullptr);
+                pending.source->Unmap(0, nullptr);
+
+                Relocate(pending, lastSubmittedFrameFence);
+            }
+            continue;
+        }
+
+        for (auto& pending : moves) {
+            GpuAllocation* owner = m_allocator->GetOwner(poolIndex, pending.move.srcBlock, pending.move.srcNode);
+            if (pending.source->GetDesc().Dimension != D3D12_RESOURCE_DIMENSION_BUFFER &&
+                owner->m_steadyState != D3D12_RESOURCE_STATE_COMMON) {
+                // Textures do not decay to COMMON on their own; buffers do at the end of every submission.
+                barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(pending.source.Get(),
+                    owner->m_steadyState, D3D12_RESOURCE_STATE_COMMON));
+                owner->m_steadyState = D3D12_RESOURCE_STATE_COMMON;
+            }
+            m_moves.push_back(std::move(pending));
+        }
+    }
+
+    if (!barriers.empty()) {
+        directList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+    }
+
+    if (stats.moveCount == 0) return;
+
+    m_lastPass = stats;
+    if (m_moves.empty()) {
+        FinishPass(lastSubmittedFrameFence);
+    }
+    else {
+        m_state = State::PendingSubmit;
+    }
+}
+
+void GpuDefragmenter::Relocate(PendingMove& pending, UINT64 lastSubmittedFrameFence) {
+    const auto& move = pending.move;
+    auto& pool = m_allocator->m_pools[pending.poolIndex];
+    GpuAllocation* owner = m_allocator->GetOwner(pending.poolIndex, move.srcBlock, move.srcNode);
+
+    // The owner let go of the resource while it was being copied, which already freed the source.
+    if (!owner) {
+        pool.blocks[move.dstBlock].allocator->Free(move.dstNode);
+        return;
+    }
+
+    owner->m_blockIndex = move.dstBlock;
+    owner->m_node = move.dstNode;
+    owner->m_offset = move.dstOffset;
+    owner->m_resource = pending.destination.Get();
+    owner->m_steadyState = D3D12_RESOURCE_STATE_COMMON;
+    m_allocator->SetOwner(pending.poolIndex, move.dstBlock, move.dstNode, owner);
+    m_allocator->SetOwner(pending.poolIndex, move.srcBlock, move.srcNode, nullptr);
+
+    // The owner drops its reference to the old resource in the callback, frames still in
+    // flight may use it, so the retired entry keeps it alive.
+    owner->m_onRelocate(pending.destination.Get());
+
+    RetiredRange retired;
+    retired.poolIndex = pending.poolIndex;
+    retired.blockIndex = move.srcBlock;
+    retired.node = move.srcNode;
+    retired.resource = std::move(pending.source);
+    retired.frameFence = lastSubmittedFrameFence;
+    m_retired.push_back(std::move(retired));
+}
+
+void GpuDefragmenter::FinishPass(UINT64 lastSubmittedFrameFence) {
+    for (auto& pending : m_moves) {
+        Relocate(pending, lastSubmittedFrameFence);
+    }
+    m_moves.clear();
+
+    for (auto& evacuated : m_evacuated) {
+        evacuated.frameFence = lastSubmittedFrameFence;
+    }
+    m_state = State::Idle;
+}
+
+void GpuDefragmenter::ReleaseRetired(UINT64 completedFrameFence) {
+    for (size_t i = 0; i < m_retired.size();) {
+        RetiredRange& retired = m_retired[i];
+        if (retired.frameFence > completedFrameFence) {
+            ++i;
+            continue;
+        }
+
+        retired.resource = nullptr;
+        auto& block = m_allocator->m_pools[retired.poolIndex].blocks[retired.blockIndex];
+        block.allocator->Free(retired.node);
+
+        m_retired[i] = std::move(m_retired.back());
+        m_retired.pop_back();
+    }
+
+    // Blocks are only released once the pass finished and every range in them was retired.
+    if (m_state != State::Idle || !m_retired.empty() || m_evacuated.empty()) return;
+
+    for (const auto& evacuated : m_evacuated) {
+        if (evacuated.frameFence > completedFrameFence) return;
+    }
+
+    for (const auto& evacuated : m_evacuated) {
+        m_allocator->m_pools[evacuated.poolIndex].blocks[evacuated.blockIndex].evacuating = false;
+        m_allocator->ReleaseBlockIfEmpty(evacuated.poolIndex, evacuated.blockIndex);
+    }
+    m_evacuated.clear();
+
+    m_lastPass.after = MeasureAll();
+    m_lastPass.completed = true;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "GpuMemoryAllocator.h"
+#include "DefragmentationPlanner.h"
+
+// Compacts the heaps of a GpuMemoryAllocator in the background.
+//
+// Every few frames the defragmenter plans a pass that evacuates sparse heap blocks,
+// places a copy of each live resource in a denser block and copies the contents on a
+// dedicated copy queue. Once the copies are done the owners of the GpuAllocations are
+// handed the new resources through their relocation callbacks. The old resources and
+// ranges are kept until the direct queue has finished every frame that could still
+// reference them, after which emptied blocks are released.
+//
+// Only allocations that opted in through GpuAllocation::EnableRelocation are moved;
+// a block holding anything else is left alone.
+class GpuDefragmenter {
+public:
+    struct PassStats {
+        uint32 moveCount = 0;
+        uint64 bytesMoved = 0;
+        uint32 evacuatedBlockCount = 0;
+        DefragmentationPlanner::Metrics before;
+        DefragmentationPlanner::Metrics after;     // Valid once completed is set
+        bool completed = false;
+    };
+
+    static constexpr uint32 DefaultPassInterval = 120;
+
+    GpuDefragmenter(ID3D12Device* device, GpuMemoryAllocator* allocator);
+    ~GpuDefragmenter();
+
+    DECLARE_NON_COPYABLE(GpuDefragmenter)
+    DECLARE_NON_MOVABLE(GpuDefragmenter)
+
+    // Call after the frame's command list was reset. Retires finished work, hands out
+    // relocated resources and may start a new pass, recording any barriers it needs on
+    // directList. completedFrameFence is the last frame fence value the GPU reached and
+    // lastSubmittedFrameFence the last one signalled.
+    void BeginFrame(ID3D12GraphicsCommandList* directList, UINT64 completedFrameFence, UINT64 lastSubmittedFrameFence);
+
+    // Call after the frame was submitted and frameFence signalled with frameFenceValue.
+    // The copies of a new pass start once the direct queue reaches that value.
+    void EndFrame(ID3D12Fence* frameFence, UINT64 frameFenceValue);
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled; }
+
+    void SetSettings(const DefragmentationPlanner::Settings& settings) { m_settings = settings; }
+    void SetPassInterval(uint32 frames) { m_passInterval = frames; }
+
+    bool IsIdle() const { return m_state == State::Idle && m_retired.empty(); }
+    const PassStats& GetLastPassStats() const { return m_lastPass; }
+
+private:
+    enum class State {
+        Idle,
+        PendingSubmit,      // Planned, copies are submitted in EndFrame
+        Copying             // Waiting for m_copyFence
+    };
+
+    struct PendingMove {
+        uint32 poolIndex = 0;
+        DefragmentationPlanner::Move move;
+        ComPtr<ID3D12Resource> source;          // Kept alive while the copy queue reads it
+        ComPtr<ID3D12Resource> destination;
+    };
+
+    struct RetiredRange {
+        uint32 poolIndex = 0;
+        uint32 blockIndex = 0;
+        uint32 node = 0;
+        ComPtr<ID3D12Resource> resource;
+        UINT64 frameFence = 0;
+    };
+
+    struct EvacuatedBlock {
+        uint32 poolIndex = 0;
+        uint32 blockIndex = 0;
+        UINT64 frameFence = 0;
+    };
+
+    ID3D12Device* m_device = nullptr;
+    GpuMemoryAllocator* m_allocator = nullptr;
+
+    ComPtr<ID3D12CommandQueue> m_copyQueue;
+    ComPtr<ID3D12CommandAllocator> m_copyAllocator;
+    ComPtr<ID3D12GraphicsCommandList> m_copyList;
+    ComPtr<ID3D12Fence> m_copyFence;
+    UINT64 m_copyFenceValue = 0;
+
+    DefragmentationPlanner::Settings m_settings;
+    uint32 m_passInterval = DefaultPassInterval;
+    uint32 m_framesSincePass = 0;
+    bool m_enabled = true;
+
+    State m_state = State::Idle;
+    Vector<PendingMove> m_moves;
+    Vector<EvacuatedBlock> m_evacuated;
+    Vector<RetiredRange> m_retired;
+    PassStats m_lastPass;
+
+    Vector<TlsfAllocator*> GetBlockAllocators(uint32 poolIndex) const;
+    DefragmentationPlanner::Metrics MeasureAll() const;
+
+    void StartPass(ID3D12GraphicsCommandList* directList, UINT64 lastSubmittedFrameFence);
+    void Relocate(PendingMove& pending, UINT64 lastSubmittedFrameFence);
+    void FinishPass(UINT64 lastSubmittedFrameFence);
+    void ReleaseRetired(UINT64 completedFrameFence);
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Types.h>
+
+// The part of a GPU fence that frame pacing and the fence timeline need. Keeping it
+// this small lets that code run against a simulated fence without a device.
+class IGpuFence {
+public:
+    virtual ~IGpuFence() = default;
+
+    // Makes the GPU set the fence to value once all work submitted before this call is done.
+    virtual void Signal(uint64 value) = 0;
+
+    // Highest value the GPU has signalled so far.
+    virtual uint64 GetCompletedValue() const = 0;
+
+    // Blocks the calling thread until GetCompletedValue() >= value.
+    virtual void WaitForValue(uint64 value) = 0;
+};
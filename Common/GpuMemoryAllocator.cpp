@@ -0,0 +1,236 @@
+#include "GpuMemoryAllocator.h"
+
+void GpuAllocation::Reset() {
+    if (m_allocator) {
+        m_allocator->Free(*this);
+        m_allocator = nullptr;
+    }
+    m_resource = nullptr;
+    m_onRelocate = nullptr;
+}
+
+void GpuAllocation::RebindOwner() {
+    if (m_allocator) {
+        m_allocator->SetOwner(m_poolIndex, m_blockIndex, m_node, this);
+    }
+}
+
+GpuMemoryAllocator::GpuMemoryAllocator(ID3D12Device* device, uint64 defaultBlockSize, uint64 uploadBlockSize)
+    : m_device(device), m_defaultBlockSize(defaultBlockSize), m_uploadBlockSize(uploadBlockSize) {
+}
+
+HRESULT GpuMemoryAllocator::CreateResource(D3D12_HEAP_TYPE heapType,
+                                           const D3D12_RESOURCE_DESC& desc,
+                                           D3D12_RESOURCE_STATES initialState,
+                                           const D3D12_CLEAR_VALUE* clearValue,
+                                           GpuAllocation& allocation,
+                                           ComPtr<ID3D12Resource>& resource) {
+    allocation.Reset();
+    resource = nullptr;
+
+    ResourceClass resourceClass = GetResourceClass(desc);
+    D3D12_RESOURCE_DESC placedDesc = desc;
+
+    // Small textures can use 4KB placement, which packs them far tighter than the default 64KB.
+    // The runtime reports whether this particular texture qualifies.
+    D3D12_RESOURCE_ALLOCATION_INFO info = {};
+    if (resourceClass == ResourceClass::Texture && placedDesc.SampleDesc.Count <= 1) {
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+            placedDesc.Alignment = 0;
+            info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        }
+    }
+    else {
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+
+    if (info.SizeInBytes == UINT64_MAX) {
+        return E_INVALIDARG;
+    }
+
+    uint32 poolIndex = GetPoolIndex(heapType, resourceClass, info.Alignment);
+    Pool& pool = m_pools[poolIndex];
+
+    // First fit over the existing blocks; TLSF makes each attempt O(1).
+    uint32 blockIndex = 0;
+    TlsfAllocator::Allocation range;
+    for (; blockIndex < pool.blocks.size(); ++blockIndex) {
+        HeapBlock& block = pool.blocks[blockIndex];
+        if (!block.heap || block.evacuating) continue;
+
+        range = block.allocator->Allocate(info.SizeInBytes);
+        if (range.IsValid()) break;
+    }
+
+    if (!range.IsValid()) {
+        HRESULT hr = CreateBlock(pool, info.SizeInBytes, blockIndex);
+        if (FAILED(hr)) return hr;
+
+        range = pool.blocks[blockIndex].allocator->Allocate(info.SizeInBytes);
+        if (!range.IsValid()) return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = m_device->CreatePlacedResource(
+        pool.blocks[blockIndex].heap.Get(),
+        range.offset,
+        &placedDesc,
+        initialState,
+        clearValue,
+        IID_PPV_ARGS(resource.GetAddressOf()));
+
+    if (FAILED(hr)) {
+        pool.blocks[blockIndex].allocator->Free(range.node);
+        resource = nullptr;
+        return hr;
+    }
+
+    allocation.m_allocator = this;
+    allocation.m_poolIndex = poolIndex;
+    allocation.m_blockIndex = blockIndex;
+    allocation.m_node = range.node;
+    allocation.m_offset = range.offset;
+    allocation.m_size = range.size;
+    allocation.m_resource = resource.Get();
+    SetOwner(poolIndex, blockIndex, range.node, &allocation);
+    return S_OK;
+}
+
+void GpuMemoryAllocator::ReleaseEmptyBlocks() {
+    for (auto& pool : m_pools) {
+        for (auto& block : pool.blocks) {
+            if (block.heap && !block.evacuating && block.allocator->IsEmpty()) {
+                block = HeapBlock();
+            }
+        }
+    }
+}
+
+Vector<GpuMemoryAllocator::PoolStats> GpuMemoryAllocator::GetStats() const {
+    Vector<PoolStats> result;
+    result.reserve(m_pools.size());
+
+    for (const auto& pool : m_pools) {
+        PoolStats stats;
+        stats.heapType = pool.heapType;
+        stats.resourceClass = pool.resourceClass;
+        stats.alignment = pool.alignment;
+
+        for (const auto& block : pool.blocks) {
+            if (!block.heap) continue;
+
+            TlsfAllocator::Stats blockStats = block.allocator->GetStats();
+            ++stats.blockCount;
+            stats.memory.capacity += blockStats.capacity;
+            stats.memory.usedBytes += blockStats.usedBytes;
+            stats.memory.freeBytes += blockStats.freeBytes;
+            stats.memory.largestFreeBlock = std::max(stats.memory.largestFreeBlock, blockStats.largestFreeBlock);
+            stats.memory.allocationCount += blockStats.allocationCount;
+            stats.memory.freeBlockCount += blockStats.freeBlockCount;
+        }
+
+        result.push_back(stats);
+    }
+
+    return result;
+}
+
+GpuMemoryAllocator::ResourceClass GpuMemoryAllocator::GetResourceClass(const D3D12_RESOURCE_DESC& desc) {
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+        return ResourceClass::Buffer;
+    }
+    if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) {
+        return ResourceClass::RenderTarget;
+    }
+    return ResourceClass::Texture;
+}
+
+D3D12_HEAP_FLAGS GpuMemoryAllocator::GetHeapFlags(ResourceClass resourceClass) {
+    switch (resourceClass) {
+    case ResourceClass::Buffer:
+        return D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+    case ResourceClass::Texture:
+        return D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+    case ResourceClass::RenderTarget:
+        return D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+    }
+    return D3D12_HEAP_FLAG_NONE;
+}
+
+uint32 GpuMemoryAllocator::GetPoolIndex(D3D12_HEAP_TYPE heapType, ResourceClass resourceClass, uint64 alignment) {
+    for (uint32 i = 0; i < m_pools.size(); ++i) {
+        const Pool& pool = m_pools[i];
+        if (pool.heapType == heapType && pool.resourceClass == resourceClass && pool.alignment == alignment) {
+            return i;
+        }
+    }
+
+    Pool pool;
+    pool.heapType = heapType;
+    pool.resourceClass = resourceClass;
+    pool.alignment = alignment;
+    pool.blockSize = (heapType == D3D12_HEAP_TYPE_UPLOAD) ? m_uploadBlockSize : m_defaultBlockSize;
+    m_pools.push_back(std::move(pool));
+    return static_cast<uint32>(m_pools.size() - 1);
+}
+
+HRESULT GpuMemoryAllocator::CreateBlock(Pool& pool, uint64 minSize, uint32& blockIndex) {
+    // Resources larger than a block get a dedicated block of their own size.
+    uint64 size = std::max(pool.blockSize, minSize);
+    size = (size + pool.alignment - 1) / pool.alignment * pool.alignment;
+
+    D3D12_HEAP_DESC heapDesc = {};
+    heapDesc.SizeInBytes = size;
+    heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(pool.heapType);
+    heapDesc.Alignment = (pool.alignment > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+        ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+        : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    heapDesc.Flags = GetHeapFlags(pool.resourceClass);
+
+    HeapBlock block;
+    HRESULT hr = m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(block.heap.GetAddressOf()));
+    if (FAILED(hr)) return hr;
+
+    block.allocator = UniquePtr<TlsfAllocator>(new TlsfAllocator(size, pool.alignment));
+
+    // Reuse a released slot so existing allocations keep their block indices.
+    for (blockIndex = 0; blockIndex < pool.blocks.size(); ++blockIndex) {
+        if (!pool.blocks[blockIndex].heap) {
+            pool.blocks[blockIndex] = std::move(block);
+            return S_OK;
+        }
+    }
+
+    pool.blocks.push_back(std::move(block));
+    blockIndex = static_cast<uint32>(pool.blocks.size() - 1);
+    return S_OK;
+}
+
+void GpuMemoryAllocator::Free(GpuAllocation& allocation) {
+    HeapBlock& block = m_pools[allocation.m_poolIndex].blocks[allocation.m_blockIndex];
+    if (block.allocator) {
+        block.allocator->Free(allocation.m_node);
+        SetOwner(allocation.m_poolIndex, allocation.m_blockIndex, allocation.m_node, nullptr);
+    }
+}
+
+void GpuMemoryAllocator::SetOwner(uint32 poolIndex, uint32 blockIndex, uint32 node, GpuAllocation* owner) {
+    auto& owners = m_pools[poolIndex].blocks[blockIndex].owners;
+    if (node >= owners.size()) {
+        owners.resize(node + 1, nullptr);
+    }
+    owners[node] = owner;
+}
+
+GpuAllocation* GpuMemoryAllocator::GetOwner(uint32 poolIndex, uint32 blockIndex, uint32 node) const {
+    const auto& owners = m_pools[poolIndex].blocks[blockIndex].owners;
+    return node < owners.size() ? owners[node] : nullptr;
+}
+
+void GpuMemoryAllocator::ReleaseBlockIfEmpty(uint32 poolIndex, uint32 blockIndex) {
+    HeapBlock& block = m_pools[poolIndex].blocks[blockIndex];
+    if (block.heap && block.allocator->IsEmpty()) {
+        block = HeapBlock();
+    }
+}
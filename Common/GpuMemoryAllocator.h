@@ -0,0 +1,94 @@
+#pragma once
+
+#include <WindowsPlatform.h>
+#include "TlsfAllocator.h"
+
+// Places buffers and textures inside large ID3D12Heap blocks instead of giving
+// every resource its own implicit heap through CreateCommittedResource.
+//
+// Resources are bucketed into pools by heap type, resource class and placement
+// alignment. Each pool owns a list of heap blocks that are sub-allocated with a
+// TlsfAllocator whose granularity is the pool's alignment, so small resources pack
+// tightly and never pay for alignment padding.
+class GpuMemoryAllocator {
+public:
+    // Resource heap tier 1 hardware cannot mix these classes within one heap.
+    enum class ResourceClass : uint32 {
+        Buffer,
+        Texture,
+        RenderTarget
+    };
+
+    struct PoolStats {
+        D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+        ResourceClass resourceClass = ResourceClass::Buffer;
+        uint64 alignment = 0;
+        uint32 blockCount = 0;
+        TlsfAllocator::Stats memory;    // Summed over all blocks of the pool
+    };
+
+    static constexpr uint64 DefaultBlockSize = 64ull * 1024 * 1024;
+    static constexpr uint64 UploadBlockSize = 16ull * 1024 * 1024;
+
+    GpuMemoryAllocator(ID3D12Device* device,
+                       uint64 defaultBlockSize = DefaultBlockSize,
+                       uint64 uploadBlockSize = UploadBlockSize);
+    ~GpuMemoryAllocator() = default;
+
+    DECLARE_NON_COPYABLE(GpuMemoryAllocator)
+    DECLARE_NON_MOVABLE(GpuMemoryAllocator)
+
+    // Drop-in replacement for CreateCommittedResource. On success the resource is
+    // placed in one of the pool heaps and allocation owns its range.
+    HRESULT CreateResource(D3D12_HEAP_TYPE heapType,
+                           const D3D12_RESOURCE_DESC& desc,
+                           D3D12_RESOURCE_STATES initialState,
+                           const D3D12_CLEAR_VALUE* clearValue,
+                           GpuAllocation& allocation,
+                           ComPtr<ID3D12Resource>& resource);
+
+    // Releases heap blocks that no longer hold any allocation. Only call this once the
+    // GPU can no longer reference resources that were placed in them.
+    void ReleaseEmptyBlocks();
+
+    uint32 GetPoolCount() const { return static_cast<uint32>(m_pools.size()); }
+
+    Vector<PoolStats> GetStats() const;
+
+    ID3D12Device* GetDevice() const { return m_device; }
+
+private:
+    friend class GpuAllocation;
+    friend class GpuDefragmenter;
+
+    struct HeapBlock {
+        ComPtr<ID3D12Heap> heap;
+        UniquePtr<TlsfAllocator> allocator;
+        Vector<GpuAllocation*> owners;  // Indexed by TLSF node, nullptr for free or reserved ranges
+        bool evacuating = false;        // Excluded from new allocations while the defragmenter empties it
+    };
+
+    struct Pool {
+        D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+        ResourceClass resourceClass = ResourceClass::Buffer;
+        uint64 alignment = 0;
+        uint64 blockSize = 0;
+        Vector<HeapBlock> blocks;   // Released blocks stay as empty slots so indices remain stable
+    };
+
+    ID3D12Device* m_device = nullptr;
+    uint64 m_defaultBlockSize = DefaultBlockSize;
+    uint64 m_uploadBlockSize = UploadBlockSize;
+    Vector<Pool> m_pools;
+
+    static ResourceClass GetResourceClass(const D3D12_RESOURCE_DESC& desc);
+    static D3D12_HEAP_FLAGS GetHeapFlags(ResourceClass resourceClass);
+
+    uint32 GetPoolIndex(D3D12_HEAP_TYPE heapType, ResourceClass resourceClass, uint64 alignment);
+    HRESULT CreateBlock(Pool& pool, uint64 minSize, uint32& blockIndex);
+    void Free(GpuAllocation& allocation);
+
+    void SetOwner(uint32 poolIndex, uint32 blockIndex, uint32 node, GpuAllocation* owner);
+    GpuAllocation* GetOwner(uint32 poolIndex, uint32 blockIndex, uint32 node) const;
+    void ReleaseBlockIfEmpty(uint32 poolIndex, uint32 blockIndex);
+};
@@ -0,0 +1,24 @@
+#include "InstanceBatcher.h"
+
+void InstanceBatcher::Build(const RenderQueue& queue) {
+    m_draws.clear();
+    m_instanceList.clear();
+    m_instanceList.reserve(queue.GetCount());
+
+    uint64 runState = 0;
+    for (uint32 i = 0; i < queue.GetCount(); ++i) {
+        uint64 key = queue.GetKey(i);
+        uint32 drawId = queue.GetPayload(i);
+        uint64 state = RenderQueue::GetStateBits(key);
+
+        bool extendsRun = !m_draws.empty() && state == runState && RenderQueue::GetMesh(key) != NotInstanced;
+        if (extendsRun) {
+            ++m_draws.back().instanceCount;
+        }
+        else {
+            m_draws.push_back({ drawId, GetInstanceCount(), 1 });
+            runState = state;
+        }
+        m_instanceList.push_back(drawId);
+    }
+}
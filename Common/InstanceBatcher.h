@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Types.h>
+#include "RenderQueue.h"
+
+// One instanced draw covering a run of queued draws with the same state.
+struct InstancedDraw {
+    uint32 drawId;              // First object of the run; its mesh and submesh are drawn
+    uint32 firstInstance;       // Offset of the run's draw IDs in the instance list
+    uint32 instanceCount;
+};
+
+// Turns a sorted RenderQueue into instanced draws. Neighbouring draws whose keys only
+// differ in depth share pipeline, material and mesh, so they become one draw whose
+// instances read their object data through the instance list of draw IDs. Sorting
+// already put identical opaque draws next to each other; transparent ones only merge
+// when they are neighbours by depth too, which keeps them in back-to-front order.
+class InstanceBatcher {
+public:
+    // Mesh ID of draws that can't be instanced, e.g. objects without a submesh. They get
+    // a draw of their own.
+    static constexpr uint32 NotInstanced = 0;
+
+    void Build(const RenderQueue& queue);
+
+    const Vector<InstancedDraw>& GetDraws() const { return m_draws; }
+
+    // Draw IDs in queue order, indexed by InstancedDraw::firstInstance + instance.
+    const Vector<uint32>& GetInstanceList() const { return m_instanceList; }
+
+    uint32 GetDrawCount() const { return static_cast<uint32>(m_draws.size()); }
+    uint32 GetInstanceCount() const { return static_cast<uint32>(m_instanceList.size()); }
+
+private:
+    Vector<InstancedDraw> m_draws;
+    Vector<uint32> m_instanceList;
+};
@@ -0,0 +1,213 @@
+#include "LooseQuadtree.h"
+#include <cfloat>
+#include <cmath>
+
+LooseQuadtree::LooseQuadtree(float originX, float originZ, float size, uint32 maxDepth)
+    : m_originX(originX), m_originZ(originZ), m_size(size), m_maxDepth(maxDepth),
+      m_minY(FLT_MAX), m_maxY(-FLT_MAX) {
+    uint32 cellCount = 0;
+    for (uint32 level = 0; level <= m_maxDepth; ++level) {
+        m_levelOffsets.push_back(cellCount);
+        cellCount += 1u << (2 * level);
+    }
+    m_cellHeads.resize(cellCount, InvalidIndex);
+    m_subtreeCounts.resize(cellCount, 0);
+}
+
+uint32 LooseQuadtree::FindCell(const float center[3], const float extents[3]) const {
+    float localX = center[0] - m_originX;
+    float localZ = center[2] - m_originZ;
+    if (!(localX >= 0.0f && localX < m_size && localZ >= 0.0f && localZ < m_size)) {
+        return 0;
+    }
+
+    // A loose cell holds anything centered in it that is at most half a cell wide, so
+    // go down while the object would still fit one level further.
+    float extent = std::max(extents[0], extents[2]);
+    uint32 level = 0;
+    float cellSize = m_size;
+    while (level < m_maxDepth && extent <= cellSize * 0.25f) {
+        cellSize *= 0.5f;
+        ++level;
+    }
+
+    uint32 last = (1u << level) - 1;
+    uint32 x = std::min(static_cast<uint32>(localX / cellSize), last);
+    uint32 z = std::min(static_cast<uint32>(localZ / cellSize), last);
+    return GetCellIndex(level, x, z);
+}
+
+void LooseQuadtree::Link(uint32 id, uint32 cell) {
+    Object& object = m_objects[id];
+    object.cell = cell;
+    object.prev = InvalidIndex;
+    object.next = m_cellHeads[cell];
+    if (object.next != InvalidIndex) m_objects[object.next].prev = id;
+    m_cellHeads[cell] = id;
+    AddToSubtreeCounts(cell, 1);
+}
+
+void LooseQuadtree::Unlink(uint32 id) {
+    Object& object = m_objects[id];
+    if (object.prev != InvalidIndex) {
+        m_objects[object.prev].next = object.next;
+    }
+    else {
+        m_cellHeads[object.cell] = object.next;
+    }
+    if (object.next != InvalidIndex) m_objects[object.next].prev = object.prev;
+
+    AddToSubtreeCounts(object.cell, -1);
+    object.cell = InvalidIndex;
+}
+
+void LooseQuadtree::AddToSubtreeCounts(uint32 cell, int32 delta) {
+    uint32 level = 0;
+    while (level < m_maxDepth && cell >= m_levelOffsets[level + 1]) ++level;
+
+    uint32 local = cell - m_levelOffsets[level];
+    uint32 x = local & ((1u << level) - 1);
+    uint32 z = local >> level;
+    for (;;) {
+        m_subtreeCounts[GetCellIndex(level, x, z)] += delta;
+        if (level == 0) break;
+        --level;
+        x >>= 1;
+        z >>= 1;
+    }
+}
+
+void LooseQuadtree::Insert(uint32 id, const float center[3], const float extents[3]) {
+    if (id >= m_objects.size()) m_objects.resize(id + 1);
+
+    Object& object = m_objects[id];
+    for (uint32 i = 0; i < 3; ++i) {
+        object.center[i] = center[i];
+        object.extents[i] = extents[i];
+    }
+    m_minY = std::min(m_minY, center[1] - extents[1]);
+    m_maxY = std::max(m_maxY, center[1] + extents[1]);
+
+    // Most moves stay within the same cell and only need the new bounds.
+    uint32 cell = FindCell(center, extents);
+    if (object.cell == cell) return;
+
+    if (object.cell != InvalidIndex) {
+        Unlink(id);
+    }
+    else {
+        ++m_objectCount;
+    }
+    Link(id, cell);
+}
+
+void LooseQuadtree::Remove(uint32 id) {
+    if (!Contains(id)) return;
+
+    Unlink(id);
+    --m_objectCount;
+}
+
+void LooseQuadtree::GetLooseBounds(const CellRef& cell, float& minX, float& minZ, float& maxX, float& maxZ) const {
+    float cellSize = m_size / static_cast<float>(1u << cell.level);
+    minX = m_originX + (static_cast<float>(cell.x) - 0.5f) * cellSize;
+    minZ = m_originZ + (static_cast<float>(cell.z) - 0.5f) * cellSize;
+    maxX = minX + 2.0f * cellSize;
+    maxZ = minZ + 2.0f * cellSize;
+}
+
+template<typename OverlapFn, typename TestFn>
+void LooseQuadtree::Query(OverlapFn&& overlaps, TestFn&& test) const {
+    m_lastQueryStats = QueryStats();
+
+    Vector<CellRef> stack;
+    stack.push_back({ 0, 0, 0 });
+    while (!stack.empty()) {
+        CellRef cell = stack.back();
+        stack.pop_back();
+
+        uint32 index = GetCellIndex(cell.level, cell.x, cell.z);
+        if (m_subtreeCounts[index] == 0) continue;
+
+        // The root also holds whatever lies outside the covered area, so it is always
+        // searched.
+        if (cell.level > 0) {
+            float minX, minZ, maxX, maxZ;
+            GetLooseBounds(cell, minX, minZ, maxX, maxZ);
+            if (!overlaps(minX, minZ, maxX, maxZ)) continue;
+        }
+
+        ++m_lastQueryStats.cellsVisited;
+        for (uint32 id = m_cellHeads[index]; id != InvalidIndex; id = m_objects[id].next) {
+            ++m_lastQueryStats.objectsTested;
+            test(id, m_objects[id]);
+        }
+
+        if (cell.level < m_maxDepth) {
+            uint32 level = cell.level + 1;
+            uint32 x = cell.x * 2;
+            uint32 z = cell.z * 2;
+            stack.push_back({ level, x, z });
+            stack.push_back({ level, x + 1, z });
+            stack.push_back({ level, x, z + 1 });
+            stack.push_back({ level, x + 1, z + 1 });
+        }
+    }
+}
+
+void LooseQuadtree::QueryRect(float minX, float minZ, float maxX, float maxZ, Vector<uint32>& results) const {
+    auto overlaps = [&](float cellMinX, float cellMinZ, float cellMaxX, float cellMaxZ) {
+        return cellMinX <= maxX && cellMaxX >= minX && cellMinZ <= maxZ && cellMaxZ >= minZ;
+    };
+    Query(overlaps, [&](uint32 id, const Object& object) {
+        if (object.center[0] - object.extents[0] <= maxX && object.center[0] + object.extents[0] >= minX &&
+            object.center[2] - object.extents[2] <= maxZ && object.center[2] + object.extents[2] >= minZ) {
+            results.push_back(id);
+        }
+    });
+}
+
+void LooseQuadtree::QueryRadius(float x, float z, float radius, Vector<uint32>& results) const {
+    // Distance from the center to the nearest point of the box, per axis.
+    auto distanceSq = [x, z](float centerX, float centerZ, float extentX, float extentZ) {
+        float dx = std::max(std::fabs(x - centerX) - extentX, 0.0f);
+        float dz = std::max(std::fabs(z - centerZ) - extentZ, 0.0f);
+        return dx * dx + dz * dz;
+    };
+
+    float radiusSq = radius * radius;
+    auto overlaps = [&](float minX, float minZ, float maxX, float maxZ) {
+        float extentX = 0.5f * (maxX - minX);
+        float extentZ = 0.5f * (maxZ - minZ);
+        return distanceSq(minX + extentX, minZ + extentZ, extentX, extentZ) <= radiusSq;
+    };
+    Query(overlaps, [&](uint32 id, const Object& object) {
+        if (distanceSq(object.center[0], object.center[2], object.extents[0], object.extents[2]) <= radiusSq) {
+            results.push_back(id);
+        }
+    });
+}
+
+void LooseQuadtree::QueryFrustum(const FrustumPlanes& frustum, Vector<uint32>& results) const {
+    // Same test as FrustumCuller: outside when the corner furthest along a normal is
+    // behind the plane.
+    auto inside = [&frustum](const float center[3], const float extents[3]) {
+        for (uint32 p = 0; p < 6; ++p) {
+            float distance = frustum.normalX[p] * center[0] + frustum.normalY[p] * center[1] +
+                             frustum.normalZ[p] * center[2] + frustum.d[p];
+            float radius = std::fabs(frustum.normalX[p]) * extents[0] + std::fabs(frustum.normalY[p]) * extents[1] +
+                           std::fabs(frustum.normalZ[p]) * extents[2];
+            if (distance + radius < 0.0f) return false;
+        }
+        return true;
+    };
+
+    auto overlaps = [&](float minX, float minZ, float maxX, float maxZ) {
+        const float center[3] = { 0.5f * (minX + maxX), 0.5f * (m_minY + m_maxY), 0.5f * (minZ + maxZ) };
+        const float extents[3] = { 0.5f * (maxX - minX), 0.5f * (m_maxY - m_minY), 0.5f * (maxZ - minZ) };
+        return inside(center, extents);
+    };
+    Query(overlaps, [&](uint32 id, const Object& object) {
+        if (inside(object.center, object.extents)) results.push_back(id);
+    });
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Types.h>
+#include "FrustumCuller.h"
+
+// Spatial index over the XZ plane for wide, flat scenes. Cells are implicit: level d
+// splits the square world into 2^d x 2^d cells stored in one flat array. Each cell's
+// bounds are loosened by half a cell on every side, so an object belongs to the cell
+// holding its center on the deepest level it fits, found without searching. Cells
+// keep their objects in intrusive lists, which makes moving an object O(1) apart from
+// the per-level counts used to skip empty subtrees.
+//
+// Objects are identified by caller-chosen IDs, e.g. draw IDs; the index grows to the
+// largest ID used. Bounds are 3D AABBs as center and half extents; Y only matters to
+// frustum queries.
+class LooseQuadtree {
+public:
+    static constexpr uint32 DefaultMaxDepth = 8;
+
+    struct QueryStats {
+        uint32 cellsVisited = 0;
+        uint32 objectsTested = 0;
+    };
+
+    // Covers the square from (originX, originZ) to (originX + size, originZ + size).
+    // Objects outside it still work but land in the root cell.
+    LooseQuadtree(float originX, float originZ, float size, uint32 maxDepth = DefaultMaxDepth);
+
+    // Inserts the object, or moves it when it is already there.
+    void Insert(uint32 id, const float center[3], const float extents[3]);
+    void Remove(uint32 id);
+    bool Contains(uint32 id) const { return id < m_objects.size() && m_objects[id].cell != InvalidIndex; }
+
+    // Each query appends the IDs of objects whose bounds overlap the region to results.
+    void QueryRect(float minX, float minZ, float maxX, float maxZ, Vector<uint32>& results) const;
+    void QueryRadius(float x, float z, float radius, Vector<uint32>& results) const;
+    void QueryFrustum(const FrustumPlanes& frustum, Vector<uint32>& results) const;
+
+    uint32 GetObjectCount() const { return m_objectCount; }
+    const QueryStats& GetLastQueryStats() const { return m_lastQueryStats; }
+
+private:
+    static constexpr uint32 InvalidIndex = UINT32_MAX;
+
+    struct Object {
+        float center[3] = {};
+        float extents[3] = {};
+        uint32 cell = InvalidIndex;
+        uint32 prev = InvalidIndex;
+        uint32 next = InvalidIndex;
+    };
+
+    struct CellRef {
+        uint32 level;
+        uint32 x;
+        uint32 z;
+    };
+
+    float m_originX;
+    float m_originZ;
+    float m_size;
+    uint32 m_maxDepth;
+
+    Vector<uint32> m_levelOffsets;      // Index of each level's first cell
+    Vector<uint32> m_cellHeads;         // First object of each cell
+    Vector<uint32> m_subtreeCounts;     // Objects in each cell and its descendants
+    Vector<Object> m_objects;           // Indexed by ID
+    uint32 m_objectCount = 0;
+
+    // Y range of everything ever inserted, to turn cells into boxes for frustum tests.
+    float m_minY = 0.0f;
+    float m_maxY = 0.0f;
+
+    mutable QueryStats m_lastQueryStats;
+
+    uint32 GetCellIndex(uint32 level, uint32 x, uint32 z) const {
+        return m_levelOffsets[level] + z * (1u << level) + x;
+    }
+
+    uint32 FindCell(const float center[3], const float extents[3]) const;
+    void Link(uint32 id, uint32 cell);
+    void Unlink(uint32 id);
+    void AddToSubtreeCounts(uint32 cell, int32 delta);
+    void GetLooseBounds(const CellRef& cell, float& minX, float& minZ, float& maxX, float& maxZ) const;
+
+    // Visits every non-empty cell whose loose bounds pass overlaps, depth first, and
+    // calls test on each object in it.
+    template<typename OverlapFn, typename TestFn>
+    void Query(OverlapFn&& overlaps, TestFn&& test) const;
+};
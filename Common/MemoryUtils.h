@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Types.h>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define STREAMING_COPY_SSE2 1
+#else
+    #define STREAMING_COPY_SSE2 0
+#endif
+
+// Copies into write-combined memory (mapped UPLOAD heaps) with non-temporal stores.
+// Mapped upload memory is never read back by the CPU, so bypassing the cache avoids
+// polluting it with data only the GPU will consume, and whole 64 byte lines are
+// handed to the write-combine buffers at once.
+inline void StreamingCopy(void* dst, const void* src, size_t byteSize) {
+#if STREAMING_COPY_SSE2
+    uint8* d = static_cast<uint8*>(dst);
+    const uint8* s = static_cast<const uint8*>(src);
+
+    // Non-temporal stores need 16 byte aligned destinations. Copy the unaligned head normally.
+    size_t head = (16 - (reinterpret_cast<uintptr_t>(d) & 15)) & 15;
+    if (head > byteSize) head = byteSize;
+    if (head) {
+        memcpy(d, s, head);
+        d += head;
+        s += head;
+        byteSize -= head;
+    }
+
+    // One cache line per iteration.
+    while (byteSize >= 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+        __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+        d += 64;
+        s += 64;
+        byteSize -= 64;
+    }
+
+    while (byteSize >= 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+        d += 16;
+        s += 16;
+        byteSize -= 16;
+    }
+
+    if (byteSize) {
+        memcpy(d, s, byteSize);
+    }
+
+    // Make the streamed data globally visible before the command list referencing it is submitted.
+    _mm_sfence();
+#else
+    memcpy(dst, src, byteSize);
+#endif
+}
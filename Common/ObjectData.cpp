@@ -0,0 +1,19 @@
+#include "ObjectData.h"
+
+void ObjectDataPacker::Pack(const float* world, uint32 materialIndex, uint32 flags, ObjectData& dst) {
+    for (uint32 row = 0; row < 4; ++row) {
+        for (uint32 column = 0; column < 4; ++column) {
+            dst.World[column * 4 + row] = world[row * 4 + column];
+        }
+    }
+    dst.MaterialIndex = materialIndex;
+    dst.Flags = flags;
+    dst.Pad0 = 0;
+    dst.Pad1 = 0;
+}
+
+uint32 ObjectDataPacker::Add(const float* world, uint32 materialIndex, uint32 flags) {
+    m_objects.emplace_back();
+    Pack(world, materialIndex, flags, m_objects.back());
+    return GetCount() - 1;
+}
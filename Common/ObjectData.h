@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Types.h>
+
+enum ObjectFlags : uint32 {
+    ObjectFlagNone = 0,
+    ObjectFlagTransparent = 1u << 0,
+};
+
+// Per-object data read by shaders from a StructuredBuffer, at draw ID plus instance ID.
+// Tightly packed at 80 bytes instead of padded to the 256 byte constant buffer alignment,
+// and free of camera data: the view-projection comes from the pass constants.
+struct ObjectData {
+    float World[16];            // Transposed, HLSL reads matrices column-major
+    uint32 MaterialIndex = 0;
+    uint32 Flags = 0;
+    uint32 Pad0 = 0;
+    uint32 Pad1 = 0;
+};
+
+static_assert(sizeof(ObjectData) == 80, "ObjectData must match the HLSL layout");
+
+// Builds the frame's ObjectData array on the CPU, so it can be streamed into the mapped
+// upload buffer in one sequential copy.
+class ObjectDataPacker {
+public:
+    // world is a row-major matrix as stored in XMFLOAT4X4.
+    static void Pack(const float* world, uint32 materialIndex, uint32 flags, ObjectData& dst);
+
+    void Clear() { m_objects.clear(); }
+    void Reserve(uint32 count) { m_objects.reserve(count); }
+
+    // Returns the draw ID of the object: its index in the buffer.
+    uint32 Add(const float* world, uint32 materialIndex, uint32 flags = ObjectFlagNone);
+
+    const ObjectData* GetData() const { return m_objects.data(); }
+    uint32 GetCount() const { return static_cast<uint32>(m_objects.size()); }
+    uint64 GetByteSize() const { return uint64(m_objects.size()) * sizeof(ObjectData); }
+
+private:
+    Vector<ObjectData> m_objects;
+};
@@ -0,0 +1,29 @@
+#include "ObjectDataStore.h"
+#include <cassert>
+#include <cstring>
+
+ObjectDataStore::ObjectDataStore(uint32 capacity)
+    : m_objects(capacity), m_slots(0, capacity) {
+}
+
+uint32 ObjectDataStore::Allocate() {
+    return m_slots.Allocate();
+}
+
+void ObjectDataStore::Free(uint32 slot, uint64 fenceValue) {
+    m_slots.Free(slot, fenceValue);
+}
+
+bool ObjectDataStore::Update(uint32 slot, const float* world, uint32 materialIndex, uint32 flags) {
+    assert(slot < GetHighWaterMark() && "Object slot was never allocated");
+    ++m_stats.updates;
+
+    ObjectData packed;
+    ObjectDataPacker::Pack(world, materialIndex, flags, packed);
+    if (std::memcmp(&packed, &m_objects[slot], sizeof(ObjectData)) == 0) return false;
+
+    m_objects[slot] = packed;
+    m_changes.MarkDirty(slot);
+    ++m_stats.changedObjects;
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ObjectData.h"
+#include "DescriptorAllocators.h"
+#include "DirtyRangeTracker.h"
+
+// CPU side of the persistent object buffer. Every object keeps its ObjectData in a fixed
+// slot, which is also its draw ID. Only slots whose data actually changed are handed out
+// for upload, so static objects are written once and idle scenes upload nothing.
+class ObjectDataStore {
+public:
+    static constexpr uint32 InvalidSlot = DescriptorFreeList::InvalidIndex;
+
+    struct Stats {
+        uint32 updates = 0;             // Update calls before the flush
+        uint32 changedObjects = 0;      // Of those, the ones that changed the data
+        uint32 uploadedObjects = 0;     // Objects handed out by the flush, clean gaps included
+        uint32 uploadedRanges = 0;
+    };
+
+    explicit ObjectDataStore(uint32 capacity);
+
+    // Returns InvalidSlot when the store is full.
+    uint32 Allocate();
+
+    // The slot may still be read by work up to fenceValue, so it is reused only after that.
+    void Free(uint32 slot, uint64 fenceValue);
+    void Reclaim(uint64 completedFenceValue) { m_slots.Reclaim(completedFenceValue); }
+
+    // world is a row-major matrix as stored in XMFLOAT4X4. Returns false when the
+    // packed data equals what the slot already holds; nothing is uploaded then.
+    bool Update(uint32 slot, const float* world, uint32 materialIndex, uint32 flags = ObjectFlagNone);
+
+    const ObjectData& Get(uint32 slot) const { return m_objects[slot]; }
+
+    bool HasChanges() const { return m_changes.IsDirty(); }
+
+    // Calls copyRange(firstSlot, objects, count) for every merged range of changed slots
+    // and clears them. Returns the number of objects handed out.
+    template<typename Fn>
+    uint32 FlushChanges(Fn&& copyRange) {
+        m_stats.uploadedObjects = m_changes.Flush(GetCapacity(), [&](uint32 first, uint32 count) {
+            copyRange(first, m_objects.data() + first, count);
+            ++m_stats.uploadedRanges;
+        });
+
+        m_lastStats = m_stats;
+        m_stats = Stats();
+        return m_lastStats.uploadedObjects;
+    }
+
+    // Counters of the period that ended with the last flush.
+    const Stats& GetStats() const { return m_lastStats; }
+
+    uint32 GetCapacity() const { return m_slots.GetCapacity(); }
+    uint32 GetLiveCount() const { return m_slots.GetAllocatedCount(); }
+
+    // Slots at or above this were never handed out; draws never index past it.
+    uint32 GetHighWaterMark() const { return m_slots.GetHighWaterMark(); }
+
+private:
+    Vector<ObjectData> m_objects;
+    DescriptorFreeList m_slots;         // Plain fenced index free list over the slots
+    DirtyRangeTracker m_changes;
+    Stats m_stats;
+    Stats m_lastStats;
+};
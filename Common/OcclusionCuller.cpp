@@ -0,0 +1,311 @@
+#include "OcclusionCuller.h"
+#include "FrustumCuller.h"
+#include "WorkerPool.h"
+#include "SimdSupport.h"
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    // Boxes per call below which threading the tests costs more than it saves.
+    constexpr uint32 ParallelFilterThreshold = 1024;
+
+    // Below this w a box corner is treated as crossing the near plane.
+    constexpr float MinW = 1e-6f;
+
+    // Sutherland-Hodgman against the near plane z >= 0. A triangle gives at most four
+    // vertices.
+    template<typename Vertex>
+    uint32 ClipNear(const Vertex* in, Vertex* out) {
+        uint32 count = 0;
+        for (uint32 i = 0; i < 3; ++i) {
+            const Vertex& a = in[i];
+            const Vertex& b = in[(i + 1) % 3];
+            if (a.z >= 0.0f) out[count++] = a;
+            if ((a.z >= 0.0f) != (b.z >= 0.0f)) {
+                float t = a.z / (a.z - b.z);
+                out[count++] = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, 0.0f, a.w + (b.w - a.w) * t };
+            }
+        }
+        return count;
+    }
+}
+
+OcclusionCuller::OcclusionCuller(uint32 width, uint32 height) {
+    m_tilesX = std::max((width + TileWidth - 1) / TileWidth, 1u);
+    m_tilesY = std::max((height + TileHeight - 1) / TileHeight, 1u);
+    m_width = m_tilesX * TileWidth;
+    m_height = m_tilesY * TileHeight;
+    m_depth.resize(m_width * m_height, 1.0f);
+    m_tileMaxDepth.resize(m_tilesX * m_tilesY, 1.0f);
+}
+
+void OcclusionCuller::Begin(const float* viewProj) {
+    for (uint32 i = 0; i < 16; ++i) m_viewProj[i] = viewProj[i];
+    std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+    std::fill(m_tileMaxDepth.begin(), m_tileMaxDepth.end(), 1.0f);
+    m_vertices.clear();
+    m_triangles.clear();
+    m_screenTriangles.clear();
+    m_stats = Stats();
+}
+
+void OcclusionCuller::AddOccluder(const float* world, const void* vertices, uint32 vertexStride, uint32 vertexCount,
+                                  const uint16* indices, uint32 indexCount, int32 baseVertex) {
+    float m[16];
+    for (uint32 r = 0; r < 4; ++r) {
+        for (uint32 c = 0; c < 4; ++c) {
+            m[r * 4 + c] = world[r * 4] * m_viewProj[c] + world[r * 4 + 1] * m_viewProj[4 + c] +
+                           world[r * 4 + 2] * m_viewProj[8 + c] + world[r * 4 + 3] * m_viewProj[12 + c];
+        }
+    }
+
+    // Only the vertices the indices use are transformed, each once.
+    Vector<uint32> clipIndex(vertexCount, UINT32_MAX);
+    const uint8* bytes = static_cast<const uint8*>(vertices);
+    auto getVertex = [&](uint32 index) {
+        int64 vertex = static_cast<int64>(index) + baseVertex;
+        if (vertex < 0 || vertex >= vertexCount) return UINT32_MAX;
+
+        uint32& clip = clipIndex[static_cast<uint32>(vertex)];
+        if (clip == UINT32_MAX) {
+            const float* p = reinterpret_cast<const float*>(bytes + vertex * vertexStride);
+            clip = static_cast<uint32>(m_vertices.size());
+            m_vertices.push_back({ p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12],
+                                   p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13],
+                                   p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14],
+                                   p[0] * m[3] + p[1] * m[7] + p[2] * m[11] + m[15] });
+        }
+        return clip;
+    };
+
+    for (uint32 i = 0; i + 3 <= indexCount; i += 3) {
+        uint32 a = getVertex(indices[i]), b = getVertex(indices[i + 1]), c = getVertex(indices[i + 2]);
+        if (a == UINT32_MAX || b == UINT32_MAX || c == UINT32_MAX) continue;
+
+        m_triangles.push_back(a);
+        m_triangles.push_back(b);
+        m_triangles.push_back(c);
+        ++m_stats.occluderTriangles;
+    }
+}
+
+void OcclusionCuller::SetupTriangle(const ClipVertex& c0, const ClipVertex& c1, const ClipVertex& c2) {
+    float x[3], y[3], z[3];
+    const ClipVertex* clip[3] = { &c0, &c1, &c2 };
+    for (uint32 i = 0; i < 3; ++i) {
+        float invW = 1.0f / clip[i]->w;
+        x[i] = (clip[i]->x * invW * 0.5f + 0.5f) * static_cast<float>(m_width);
+        y[i] = (0.5f - clip[i]->y * invW * 0.5f) * static_cast<float>(m_height);
+        z[i] = clip[i]->z * invW;
+    }
+
+    // Occluders are drawn from both sides, so the winding is normalized instead of
+    // culling back faces.
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (std::fabs(area) < 1e-8f) return;
+    if (area < 0.0f) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+    }
+
+    ScreenTriangle tri;
+    tri.minX = std::max(static_cast<int32>(std::floor(std::min({ x[0], x[1], x[2] }))), 0);
+    tri.maxX = std::min(static_cast<int32>(std::ceil(std::max({ x[0], x[1], x[2] }))), static_cast<int32>(m_width) - 1);
+    tri.minY = std::max(static_cast<int32>(std::floor(std::min({ y[0], y[1], y[2] }))), 0);
+    tri.maxY = std::min(static_cast<int32>(std::ceil(std::max({ y[0], y[1], y[2] }))), static_cast<int32>(m_height) - 1);
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+
+    // Edge a->b is (b.x - a.x)(p.y - a.y) - (b.y - a.y)(p.x - a.x), positive on the inside.
+    for (uint32 e = 0; e < 3; ++e) {
+        uint32 a = e, b = (e + 1) % 3;
+        tri.edgeA[e] = y[a] - y[b];
+        tri.edgeB[e] = x[b] - x[a];
+        tri.edgeC[e] = (y[b] - y[a]) * x[a] - (x[b] - x[a]) * y[a];
+    }
+
+    float dz1 = z[1] - z[0], dz2 = z[2] - z[0];
+    tri.depthA = (dz1 * (y[2] - y[0]) - dz2 * (y[1] - y[0])) / area;
+    tri.depthB = (dz2 * (x[1] - x[0]) - dz1 * (x[2] - x[0])) / area;
+    tri.depthC = z[0] - tri.depthA * x[0] - tri.depthB * y[0];
+    tri.minDepth = std::max(std::min({ z[0], z[1], z[2] }), 0.0f);
+    tri.maxDepth = std::max({ z[0], z[1], z[2] });
+    m_screenTriangles.push_back(tri);
+}
+
+void OcclusionCuller::RasterizeBand(uint32 firstTileRow, uint32 lastTileRow) {
+    int32 bandMinY = static_cast<int32>(firstTileRow * TileHeight);
+    int32 bandMaxY = static_cast<int32>(lastTileRow * TileHeight) - 1;
+
+    for (const ScreenTriangle& tri : m_screenTriangles) {
+        int32 minY = std::max(tri.minY, bandMinY);
+        int32 maxY = std::min(tri.maxY, bandMaxY);
+
+        for (int32 y = minY; y <= maxY; ++y) {
+            float py = static_cast<float>(y) + 0.5f;
+            float row[3];
+            for (uint32 e = 0; e < 3; ++e) row[e] = tri.edgeB[e] * py + tri.edgeC[e];
+            float rowDepth = tri.depthB * py + tri.depthC;
+
+            // Groups of four pixels share a row of a tile, so each group is one vector.
+            int32 x = tri.minX & ~3;
+#ifdef SIMD_X86
+            const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 minDepth = _mm_set1_ps(tri.minDepth), maxDepth = _mm_set1_ps(tri.maxDepth);
+            for (; x <= tri.maxX; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeA[0]), px), _mm_set1_ps(row[0])), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeA[1]), px), _mm_set1_ps(row[1])), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeA[2]), px), _mm_set1_ps(row[2])), zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.depthA), px), _mm_set1_ps(rowDepth));
+                depth = _mm_min_ps(_mm_max_ps(depth, minDepth), maxDepth);
+
+                float* pixels = &m_depth[GetPixelIndex(static_cast<uint32>(x), static_cast<uint32>(y))];
+                __m128 old = _mm_loadu_ps(pixels);
+                __m128 nearer = _mm_min_ps(old, depth);
+                _mm_storeu_ps(pixels, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+            }
+#else
+            for (; x <= tri.maxX; ++x) {
+                float px = static_cast<float>(x) + 0.5f;
+                if (tri.edgeA[0] * px + row[0] < 0.0f || tri.edgeA[1] * px + row[1] < 0.0f ||
+                    tri.edgeA[2] * px + row[2] < 0.0f) {
+                    continue;
+                }
+
+                float depth = std::min(std::max(tri.depthA * px + rowDepth, tri.minDepth), tri.maxDepth);
+                float& pixel = m_depth[GetPixelIndex(static_cast<uint32>(x), static_cast<uint32>(y))];
+                pixel = std::min(pixel, depth);
+            }
+#endif
+        }
+    }
+
+    // The band's tiles are final now, so their farthest depth can be taken right away.
+    const uint32 tileSize = TileWidth * TileHeight;
+    for (uint32 tile = firstTileRow * m_tilesX; tile < lastTileRow * m_tilesX; ++tile) {
+        const float* pixels = &m_depth[tile * tileSize];
+        float maxDepth = pixels[0];
+        for (uint32 i = 1; i < tileSize; ++i) maxDepth = std::max(maxDepth, pixels[i]);
+        m_tileMaxDepth[tile] = maxDepth;
+    }
+}
+
+void OcclusionCuller::Rasterize(WorkerPool* pool) {
+    m_screenTriangles.clear();
+    for (size_t i = 0; i + 3 <= m_triangles.size(); i += 3) {
+        ClipVertex v[3] = { m_vertices[m_triangles[i]], m_vertices[m_triangles[i + 1]], m_vertices[m_triangles[i + 2]] };
+
+        // Entirely outside one of the frustum planes.
+        auto allOutside = [&v](auto outside) { return outside(v[0]) && outside(v[1]) && outside(v[2]); };
+        if (allOutside([](const ClipVertex& c) { return c.x < -c.w; }) ||
+            allOutside([](const ClipVertex& c) { return c.x > c.w; }) ||
+            allOutside([](const ClipVertex& c) { return c.y < -c.w; }) ||
+            allOutside([](const ClipVertex& c) { return c.y > c.w; }) ||
+            allOutside([](const ClipVertex& c) { return c.z < 0.0f; }) ||
+            allOutside([](const ClipVertex& c) { return c.z > c.w; })) {
+            continue;
+        }
+
+        if (v[0].z >= 0.0f && v[1].z >= 0.0f && v[2].z >= 0.0f) {
+            SetupTriangle(v[0], v[1], v[2]);
+            continue;
+        }
+
+        ClipVertex clipped[4];
+        uint32 count = ClipNear(v, clipped);
+        for (uint32 k = 2; k < count; ++k) {
+            SetupTriangle(clipped[0], clipped[k - 1], clipped[k]);
+        }
+    }
+    m_stats.rasterizedTriangles = static_cast<uint32>(m_screenTriangles.size());
+
+    if (pool && !m_screenTriangles.empty()) {
+        pool->ParallelFor(m_tilesY, 1, [this](uint32 begin, uint32 end) { RasterizeBand(begin, end); });
+    }
+    else {
+        RasterizeBand(0, m_tilesY);
+    }
+}
+
+bool OcclusionCuller::IsVisible(const float center[3], const float extents[3]) const {
+    const float* m = m_viewProj;
+    float base[4], axisX[4], axisY[4], axisZ[4];
+    for (uint32 c = 0; c < 4; ++c) {
+        base[c] = center[0] * m[c] + center[1] * m[4 + c] + center[2] * m[8 + c] + m[12 + c];
+        axisX[c] = extents[0] * m[c];
+        axisY[c] = extents[1] * m[4 + c];
+        axisZ[c] = extents[2] * m[8 + c];
+    }
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minDepth = FLT_MAX;
+    for (uint32 corner = 0; corner < 8; ++corner) {
+        float sx = (corner & 1) ? 1.0f : -1.0f;
+        float sy = (corner & 2) ? 1.0f : -1.0f;
+        float sz = (corner & 4) ? 1.0f : -1.0f;
+        float p[4];
+        for (uint32 c = 0; c < 4; ++c) p[c] = base[c] + sx * axisX[c] + sy * axisY[c] + sz * axisZ[c];
+        if (p[3] < MinW || p[2] < 0.0f) return true;
+
+        float invW = 1.0f / p[3];
+        float x = (p[0] * invW * 0.5f + 0.5f) * static_cast<float>(m_width);
+        float y = (0.5f - p[1] * invW * 0.5f) * static_cast<float>(m_height);
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        minDepth = std::min(minDepth, p[2] * invW);
+    }
+
+    if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(m_width) || minY >= static_cast<float>(m_height)) {
+        return true;
+    }
+
+    uint32 tileMinX = static_cast<uint32>(std::max(minX, 0.0f)) / TileWidth;
+    uint32 tileMinY = static_cast<uint32>(std::max(minY, 0.0f)) / TileHeight;
+    uint32 tileMaxX = std::min(static_cast<uint32>(maxX) / TileWidth, m_tilesX - 1);
+    uint32 tileMaxY = std::min(static_cast<uint32>(maxY) / TileHeight, m_tilesY - 1);
+    for (uint32 ty = tileMinY; ty <= tileMaxY; ++ty) {
+        for (uint32 tx = tileMinX; tx <= tileMaxX; ++tx) {
+            if (minDepth <= m_tileMaxDepth[ty * m_tilesX + tx]) return true;
+        }
+    }
+    return false;
+}
+
+uint32 OcclusionCuller::Filter(const CullingBounds& bounds, uint32* drawIds, uint32 count, WorkerPool* pool) {
+    auto testRange = [&](uint32 begin, uint32 end) {
+        for (uint32 i = begin; i < end; ++i) {
+            uint32 id = drawIds[i];
+            const float center[3] = { bounds.GetCenterX()[id], bounds.GetCenterY()[id], bounds.GetCenterZ()[id] };
+            const float extents[3] = { bounds.GetExtentX()[id], bounds.GetExtentY()[id], bounds.GetExtentZ()[id] };
+            m_visibleFlags[i] = IsVisible(center, extents);
+        }
+    };
+
+    m_visibleFlags.resize(count);
+    if (pool && count >= ParallelFilterThreshold) {
+        pool->ParallelFor(count, 64, testRange);
+    }
+    else {
+        testRange(0, count);
+    }
+
+    uint32 visible = 0;
+    for (uint32 i = 0; i < count; ++i) {
+        drawIds[visible] = drawIds[i];
+        visible += m_visibleFlags[i];
+    }
+
+    m_stats.testedObjects += count;
+    m_stats.occludedObjects += count - visible;
+    return visible;
+}
+
+float OcclusionCuller::GetDepth(uint32 x, uint32 y) const {
+    return (x < m_width && y < m_height) ? m_depth[GetPixelIndex(x, y)] : 1.0f;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Types.h>
+
+class WorkerPool;
+class CullingBounds;
+
+// Software occlusion culling against a few large occluders. Occluder triangles are
+// rasterized on the CPU into a small depth buffer stored in 8x4 pixel tiles, and each
+// tile keeps the farthest depth it holds. An object whose nearest point is behind that
+// depth on every tile its screen rectangle touches is hidden.
+//
+// Depth follows D3D: 0 is the near plane and the buffer clears to 1.
+class OcclusionCuller {
+public:
+    static constexpr uint32 TileWidth = 8;
+    static constexpr uint32 TileHeight = 4;
+    static constexpr uint32 DefaultWidth = 320;
+    static constexpr uint32 DefaultHeight = 192;
+
+    struct Stats {
+        uint32 occluderTriangles = 0;       // Triangles queued by AddOccluder
+        uint32 rasterizedTriangles = 0;     // Left after clipping and rejection
+        uint32 testedObjects = 0;
+        uint32 occludedObjects = 0;
+    };
+
+    // The size is rounded up to whole tiles.
+    OcclusionCuller(uint32 width = DefaultWidth, uint32 height = DefaultHeight);
+
+    // Clears the depth buffer and the queued occluders. viewProj is row-major for row
+    // vectors, like FrustumCuller::ExtractPlanes takes it.
+    void Begin(const float* viewProj);
+
+    // Queues the triangles of an indexed mesh. Positions are the first three floats of
+    // each vertex and world is the row-major object-to-world matrix.
+    void AddOccluder(const float* world, const void* vertices, uint32 vertexStride, uint32 vertexCount,
+                     const uint16* indices, uint32 indexCount, int32 baseVertex = 0);
+
+    bool HasOccluders() const { return !m_triangles.empty(); }
+
+    // Rasterizes the queued occluders and builds the tile depths, one band of tile rows
+    // per batch across pool when given.
+    void Rasterize(WorkerPool* pool = nullptr);
+
+    // Boxes as center and half extents in world space. Boxes crossing the near plane or
+    // leaving the screen are treated as visible.
+    bool IsVisible(const float center[3], const float extents[3]) const;
+
+    // Removes the IDs of hidden boxes from drawIds, keeping the order, and returns how
+    // many are left.
+    uint32 Filter(const CullingBounds& bounds, uint32* drawIds, uint32 count, WorkerPool* pool = nullptr);
+
+    const Stats& GetStats() const { return m_stats; }
+    uint32 GetWidth() const { return m_width; }
+    uint32 GetHeight() const { return m_height; }
+
+    // Rasterized depth at a pixel, for debug views.
+    float GetDepth(uint32 x, uint32 y) const;
+
+private:
+    struct ClipVertex {
+        float x, y, z, w;
+    };
+
+    // Screen-space triangle with edge functions that are >= 0 inside and depth as a
+    // plane over the screen.
+    struct ScreenTriangle {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float depthA, depthB, depthC;
+        float minDepth, maxDepth;
+        int32 minX, maxX, minY, maxY;
+    };
+
+    uint32 m_width;
+    uint32 m_height;
+    uint32 m_tilesX;
+    uint32 m_tilesY;
+    float m_viewProj[16] = {};
+
+    Vector<float> m_depth;              // Tile by tile, row by row within a tile
+    Vector<float> m_tileMaxDepth;
+    Vector<ClipVertex> m_vertices;
+    Vector<uint32> m_triangles;         // Three indices into m_vertices each
+    Vector<ScreenTriangle> m_screenTriangles;
+    Vector<uint8> m_visibleFlags;
+    Stats m_stats;
+
+    uint32 GetPixelIndex(uint32 x, uint32 y) const {
+        uint32 tile = (y / TileHeight) * m_tilesX + x / TileWidth;
+        return tile * TileWidth * TileHeight + (y % TileHeight) * TileWidth + x % TileWidth;
+    }
+
+    void SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+    void RasterizeBand(uint32 firstTileRow, uint32 lastTileRow);
+};
@@ -0,0 +1,47 @@
+#include "PersistentObjectBuffer.h"
+
+PersistentObjectBuffer::PersistentObjectBuffer(ID3D12Device* device, uint32 capacity, GpuMemoryAllocator* allocator)
+    : m_store(capacity) {
+    CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(uint64(capacity) * sizeof(ObjectData));
+    if (allocator) {
+        ThrowIfFailed(allocator->CreateResource(
+            D3D12_HEAP_TYPE_DEFAULT,
+            bufferDesc,
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            m_allocation,
+            m_buffer));
+    }
+    else {
+        CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+        ThrowIfFailed(device->CreateCommittedResource(
+            &heapProps,
+            D3D12_HEAP_FLAG_NONE,
+            &bufferDesc,
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS(&m_buffer)));
+    }
+}
+
+uint32 PersistentObjectBuffer::RecordUploads(ID3D12GraphicsCommandList* cmdList, UploadBuffer<ObjectData>& staging) {
+    if (!m_store.HasChanges()) return 0;
+
+    // Buffers decay to COMMON after every ExecuteCommandLists, so the copies promote the
+    // buffer to COPY_DEST implicitly. Reading it after a write in the same list needs an
+    // explicit transition though.
+    uint32 stagingOffset = 0;
+    uint32 copied = m_store.FlushChanges([&](uint32 first, const ObjectData* objects, uint32 count) {
+        staging.CopyRange(stagingOffset, objects, count);
+        cmdList->CopyBufferRegion(m_buffer.Get(), uint64(first) * sizeof(ObjectData),
+                                  staging.Resource(), uint64(stagingOffset) * sizeof(ObjectData),
+                                  uint64(count) * sizeof(ObjectData));
+        stagingOffset += count;
+    });
+
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_buffer.Get(),
+        D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    cmdList->ResourceBarrier(1, &barrier);
+
+    return copied;
+}
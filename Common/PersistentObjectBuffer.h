@@ -0,0 +1,36 @@
+#pragma once
+
+#include "UploadBuffer.h"
+#include "ObjectDataStore.h"
+
+// Default-heap buffer holding the ObjectData of every object, indexed by draw ID. It
+// lives across frames: objects are written when they are created and afterwards only
+// when their data changes, through the frame's upload buffer.
+//
+// All frames share the one buffer. That is safe because the copies are recorded on the
+// same queue as the draws, so they execute after every earlier frame read the old data.
+class PersistentObjectBuffer {
+public:
+    PersistentObjectBuffer(ID3D12Device* device, uint32 capacity, GpuMemoryAllocator* allocator = nullptr);
+
+    DECLARE_NON_COPYABLE(PersistentObjectBuffer)
+    DECLARE_NON_MOVABLE(PersistentObjectBuffer)
+
+    ObjectDataStore& GetStore() { return m_store; }
+    const ObjectDataStore& GetStore() const { return m_store; }
+
+    // Records copies of every changed object. staging must be the current frame's upload
+    // buffer with room for GetCapacity elements. Returns the number of objects copied.
+    uint32 RecordUploads(ID3D12GraphicsCommandList* cmdList, UploadBuffer<ObjectData>& staging);
+
+    ID3D12Resource* GetResource() const { return m_buffer.Get(); }
+    D3D12_GPU_VIRTUAL_ADDRESS GetGpuAddress() const { return m_buffer->GetGPUVirtualAddress(); }
+    uint32 GetCapacity() const { return m_store.GetCapacity(); }
+
+private:
+    // Not relocatable: the defragmenter copies on its own queue and could miss uploads
+    // recorded while the copy is in flight.
+    GpuAllocation m_allocation;     // Declared first so the range outlives the resource
+    ComPtr<ID3D12Resource> m_buffer;
+    ObjectDataStore m_store;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "UploadBuffer.h"
+#include "RootSignatureDesc.h"
 
 struct MaterialConstants {
     DirectX::XMFLOAT4 DiffuseAlbedo = { 1.0f, 1.0f, 1.0f, 1.0f };
@@ -8,6 +9,11 @@ struct MaterialConstants {
     float Roughness = 0.25f;
 
     DirectX::XMFLOAT4X4 MatTransform;
+
+    uint32 DiffuseMapIndex = 0;     // Slot in the bindless texture table, 0 is the fallback
+    uint32 Pad0 = 0;
+    uint32 Pad1 = 0;
+    uint32 Pad2 = 0;
 };
 
 class IMeshComponent {
@@ -18,6 +24,33 @@ public:
     virtual const SubmeshGeometry& GetSubmesh(const String& name) const = 0;
     virtual bool HasSubmesh(const String& name) const = 0;
     virtual const MeshGeometry* GetMeshData() const = 0;
+
+    // One lookup instead of HasSubmesh and GetSubmesh; null when the mesh has no such submesh.
+    virtual const SubmeshGeometry* FindSubmesh(const String& name) const = 0;
+};
+
+// A submesh looked up by name once, when the object's mesh or submesh name is set, so
+// drawing never hashes strings.
+struct SubmeshDrawRecord {
+    const SubmeshGeometry* Submesh = nullptr;   // Entry in the mesh's DrawArgs, null when unresolved
+    UINT IndexCount = 0;
+    UINT StartIndexLocation = 0;
+    INT BaseVertexLocation = 0;
+    DirectX::BoundingBox Bounds;
+
+    bool IsResolved() const { return Submesh != nullptr; }
+
+    static SubmeshDrawRecord Resolve(const IMeshComponent* mesh, const String& submeshName) {
+        SubmeshDrawRecord record;
+        record.Submesh = mesh ? mesh->FindSubmesh(submeshName) : nullptr;
+        if (record.Submesh) {
+            record.IndexCount = record.Submesh->IndexCount;
+            record.StartIndexLocation = record.Submesh->StartIndexLocation;
+            record.BaseVertexLocation = record.Submesh->BaseVertexLocation;
+            record.Bounds = record.Submesh->Bounds;
+        }
+        return record;
+    }
 };
 
 class IMaterialComponent {
@@ -33,6 +66,10 @@ public:
 
     virtual const MaterialConstants& GetMaterialConstants() const = 0;
     virtual void SetMaterialConstants(const MaterialConstants& constants) = 0;
+
+    // Index of the material's entry in the per-frame material table.
+    virtual uint32 GetMaterialIndex() const = 0;
+    virtual void SetMaterialIndex(uint32 index) = 0;
 };
 
 class ITextureComponent {
@@ -71,6 +108,13 @@ public:
         return m_mesh && m_mesh->DrawArgs.find(name) != m_mesh->DrawArgs.end();
     }
 
+    const SubmeshGeometry* FindSubmesh(const String& name) const override {
+        if (!m_mesh) return nullptr;
+
+        auto it = m_mesh->DrawArgs.find(name);
+        return (it != m_mesh->DrawArgs.end()) ? &it->second : nullptr;
+    }
+
     const MeshGeometry* GetMeshData() const override {
         return m_mesh.get();
     }
@@ -121,6 +165,14 @@ public:
         UpdateMaterialBuffer();
     }
 
+    uint32 GetMaterialIndex() const override {
+        return m_materialIndex;
+    }
+
+    void SetMaterialIndex(uint32 index) override {
+        m_materialIndex = index;
+    }
+
     void InitializeMaterialBuffer(ID3D12Device* device) {
         m_materialCB = UniquePtr<UploadBuffer<MaterialConstants>>(new UploadBuffer<MaterialConstants>(device, 1, true));
         UpdateMaterialBuffer();
@@ -130,6 +182,7 @@ private:
     ComPtr<ID3D12PipelineState> m_pso;
     MaterialConstants m_materialConstants;
     UniquePtr<UploadBuffer<MaterialConstants>> m_materialCB;
+    uint32 m_materialIndex = 0;
     bool m_isTransparent = false;
 
     void UpdateMaterialBuffer() {
@@ -0,0 +1,55 @@
+#include "RenderObject.h"
+#include <cstring>
+
+DirtyObjectList::~DirtyObjectList() {
+    for (IRenderObject* object : m_objects) {
+        object->m_queued = false;
+        object->m_dirtyList = nullptr;
+    }
+}
+
+void DirtyObjectList::Add(IRenderObject* object) {
+    m_objects.push_back(object);
+}
+
+void DirtyObjectList::Remove(IRenderObject* object) {
+    auto it = std::find(m_objects.begin(), m_objects.end(), object);
+    if (it != m_objects.end()) {
+        *it = m_objects.back();
+        m_objects.pop_back();
+    }
+    m_transformObjects.erase(std::remove(m_transformObjects.begin(), m_transformObjects.end(), object),
+                             m_transformObjects.end());
+}
+
+void DirtyObjectList::Flush(WorkerPool* pool) {
+    using namespace DirectX;
+
+    m_batch.Clear();
+    m_transformObjects.clear();
+    for (IRenderObject* object : m_objects) {
+        if (!object->m_transformDirty) continue;
+
+        // Same rotation as XMMatrixRotationRollPitchYaw, as a quaternion for the kernel.
+        XMFLOAT4 rotation;
+        XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYaw(object->m_rotation.x, object->m_rotation.y,
+                                                                  object->m_rotation.z));
+        m_batch.Add(&object->m_position.x, &rotation.x, &object->m_scale.x);
+        m_transformObjects.push_back(object);
+    }
+
+    m_batch.Compute(MatrixLayout::RowMajor, pool);
+    for (uint32 i = 0; i < m_batch.GetCount(); ++i) {
+        IRenderObject* object = m_transformObjects[i];
+        std::memcpy(&object->m_world, m_batch.GetWorld(i), sizeof(XMFLOAT4X4));
+        object->m_transformDirty = false;
+    }
+}
+
+void DirtyObjectList::Clear() {
+    for (IRenderObject* object : m_objects) {
+        object->m_queued = false;
+    }
+    m_objects.clear();
+    m_transformObjects.clear();
+}
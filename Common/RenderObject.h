@@ -1,56 +1,179 @@
 #pragma once
 
 #include "UploadBuffer.h"
+#include "DrawBinder.h"
+#include "TransformBatch.h"
 
 struct ObjectConstants {
     DirectX::XMFLOAT4X4 WorldViewProj;
     DirectX::XMFLOAT4X4 World;
 };
 
+class IRenderObject;
+struct SubmeshDrawRecord;
+
+// Objects whose GPU data changed since the last frame. Transform setters only queue the
+// object, and Flush rebuilds every pending world matrix in one batch. An object moved,
+// rotated and scaled in one tick is composed once, and clean objects cost nothing.
+class DirtyObjectList {
+public:
+    DirtyObjectList() = default;
+    ~DirtyObjectList();
+
+    DECLARE_NON_COPYABLE(DirtyObjectList)
+    DECLARE_NON_MOVABLE(DirtyObjectList)
+
+    // Rebuilds the world matrices of queued objects whose transform changed, split
+    // across pool when given.
+    void Flush(WorkerPool* pool = nullptr);
+
+    // Queued objects, valid until Clear.
+    const Vector<IRenderObject*>& GetObjects() const { return m_objects; }
+
+    // Queued objects whose world matrix the last Flush rebuilt.
+    const Vector<IRenderObject*>& GetTransformedObjects() const { return m_transformObjects; }
+
+    // Empties the list. Objects are queued again by their next change.
+    void Clear();
+
+private:
+    friend class IRenderObject;
+
+    void Add(IRenderObject* object);
+    void Remove(IRenderObject* object);
+
+    Vector<IRenderObject*> m_objects;
+    Vector<IRenderObject*> m_transformObjects;     // Batch index to object
+    TransformBatch m_batch;
+};
+
 class IRenderObject {
 public:
-    virtual ~IRenderObject() = default;
+    virtual ~IRenderObject() {
+        SetDirtyList(nullptr);
+    }
 
     virtual void Update(float deltaTime, const DirectX::XMMATRIX& view, const DirectX::XMMATRIX& proj) = 0;
-    virtual void Render(ID3D12GraphicsCommandList* cmdList) = 0;
+    virtual void Render(DrawBinder& binder) = 0;
 
     virtual bool IsVisible() const { return m_isVisible; }
     virtual void SetVisible(bool visible) { m_isVisible = visible; }
 
     virtual bool IsTransparent() const { return m_isTransparent; }
 
-    const DirectX::XMFLOAT4X4& GetWorldMatrix() const { return m_world; }
-    void SetWorldMatrix(const DirectX::XMFLOAT4X4& world) { m_world = world; }
+    // Occluders are rasterized into the software depth buffer that hides the objects
+    // behind them. Meant for a few large, simple meshes such as buildings and cliffs.
+    bool IsOccluder() const { return m_isOccluder; }
+    void SetOccluder(bool occluder) { m_isOccluder = occluder; }
+
+    // Static objects never move after the map is loaded. Graphics merges them into
+    // static batches at load and stops drawing them one by one.
+    bool IsStatic() const { return m_isStatic; }
+    void SetStatic(bool isStatic) { m_isStatic = isStatic; }
+
+    // Rebuilt on demand when the transform changed since the last DirtyObjectList::Flush.
+    const DirectX::XMFLOAT4X4& GetWorldMatrix() const {
+        if (m_transformDirty) UpdateWorldMatrix();
+        return m_world;
+    }
+
+    void SetWorldMatrix(const DirectX::XMFLOAT4X4& world) {
+        m_world = world;
+        m_transformDirty = false;
+        MarkDirty();
+    }
+
+    // Set whenever the object's GPU data changes; cleared once it has been handed to
+    // the persistent object buffer. Static objects stay clean after their first upload.
+    bool IsDirty() const { return m_isDirty; }
+    void ClearDirty() { m_isDirty = false; }
+
+    // Changes are queued on list, which must outlive the object or be reset to nullptr.
+    // A dirty object joins the list right away.
+    void SetDirtyList(DirtyObjectList* list) {
+        if (m_dirtyList && m_queued) m_dirtyList->Remove(this);
+        m_queued = false;
+        m_dirtyList = list;
+        if (m_isDirty) MarkDirty();
+    }
 
     const DirectX::XMFLOAT3& GetPosition() const { return m_position; }
     void SetPosition(const DirectX::XMFLOAT3& pos) {
         m_position = pos;
-        UpdateWorldMatrix();
+        MarkTransformDirty();
     }
 
     const DirectX::XMFLOAT3& GetRotation() const { return m_rotation; }
     void SetRotation(const DirectX::XMFLOAT3& rot) {
         m_rotation = rot;
-        UpdateWorldMatrix();
+        MarkTransformDirty();
     }
 
     const DirectX::XMFLOAT3& GetScale() const { return m_scale; }
     void SetScale(const DirectX::XMFLOAT3& scale) {
         m_scale = scale;
-        UpdateWorldMatrix();
+        MarkTransformDirty();
     }
 
+    void SetConstantBufferIndex(uint32 index) {
+        m_cbElementIndex = index;
+    }
+
+    // Also the draw ID the shader sees.
+    uint32 GetConstantBufferIndex() const { return m_cbElementIndex; }
+
+    virtual uint32 GetMaterialIndex() const { return 0; }
+
+    // State the render queue groups draws by; null when the object has none.
+    virtual const MeshGeometry* GetGeometry() const { return nullptr; }
+    virtual const SubmeshDrawRecord* GetDrawRecord() const { return nullptr; }
+    virtual ID3D12PipelineState* GetPipelineState() const { return nullptr; }
+
+    // Object-space bounds for culling. Objects without bounds are never culled.
+    virtual bool GetLocalBounds(DirectX::BoundingBox& bounds) const { return false; }
+
+    // Node of the object in a TransformHierarchy. While attached, the position, rotation
+    // and scale are relative to the node's parent and the world matrix is written back
+    // by the hierarchy's update.
+    Handle GetTransformNode() const { return m_transformNode; }
+    void SetTransformNode(Handle node) { m_transformNode = node; }
+
 protected:
-    DirectX::XMFLOAT4X4 m_world;
+    mutable DirectX::XMFLOAT4X4 m_world;
     DirectX::XMFLOAT3 m_position = { 0.0f, 0.0f, 0.0f };
     DirectX::XMFLOAT3 m_rotation = { 0.0f, 0.0f, 0.0f };
     DirectX::XMFLOAT3 m_scale = { 1.0f, 1.0f, 1.0f };
 
+    uint32 m_cbElementIndex = 0;
+    Handle m_transformNode;
+
     bool m_isVisible = true;
     bool m_isTransparent = false;
+    bool m_isOccluder = false;
+    bool m_isStatic = false;
     bool m_isDirty = true;
 
-    void UpdateWorldMatrix() {
+    void MarkDirty() {
+        m_isDirty = true;
+        if (m_dirtyList && !m_queued) {
+            m_queued = true;
+            m_dirtyList->Add(this);
+        }
+    }
+
+    void MarkTransformDirty() {
+        m_transformDirty = true;
+        MarkDirty();
+    }
+
+private:
+    friend class DirtyObjectList;
+
+    DirtyObjectList* m_dirtyList = nullptr;
+    bool m_queued = false;
+    mutable bool m_transformDirty = false;
+
+    void UpdateWorldMatrix() const {
         using namespace DirectX;
 
         XMMATRIX scale = XMMatrixScaling(m_scale.x, m_scale.y, m_scale.z);
@@ -59,7 +182,7 @@ protected:
 
         XMMATRIX world = scale * rotation * translation;
         XMStoreFloat4x4(&m_world, world);
-        m_isDirty = true;
+        m_transformDirty = false;
     }
 };
 
@@ -76,21 +199,22 @@ public:
     void Update(float deltaTime, const DirectX::XMMATRIX& view, const DirectX::XMMATRIX& proj) override {
         static_cast<Derived*>(this)->UpdateInternal(deltaTime);
 
-        // Only update constants if we have our own CB (not using FrameResource)
+        // Only update constants if we have our own CB (not using FrameResource).
+        // Otherwise the dirty flag is left for the persistent object buffer.
         if (m_objectCB) {
             UpdateConstants(view, proj);
+            m_isDirty = false;
         }
-        m_isDirty = false;
         m_constantsDirty = false;
     }
 
-    void Render(ID3D12GraphicsCommandList* cmdList) override {
+    void Render(DrawBinder& binder) override {
         if (!IsVisible()) return;
 
         auto* derived = static_cast<Derived*>(this);
-        derived->PrepareRender(cmdList);
-        derived->BindResources(cmdList);
-        derived->Draw(cmdList);
+        derived->PrepareRender(binder);
+        derived->BindResources(binder);
+        derived->Draw(binder.GetCommandList());
     }
 
     void InitializeConstantBuffer(ID3D12Device* device, uint32 elementCount = 1) {
@@ -98,13 +222,8 @@ public:
         m_cbElementIndex = 0;
     }
 
-    void SetConstantBufferIndex(uint32 index) {
-        m_cbElementIndex = index;
-    }
-
 protected:
     UniquePtr<UploadBuffer<ObjectConstants>> m_objectCB;
-    uint32 m_cbElementIndex = 0;
     bool m_constantsDirty = true;
 
     void UpdateConstants(const DirectX::XMMATRIX& view, const DirectX::XMMATRIX& proj) {
@@ -112,7 +231,7 @@ protected:
 
         using namespace DirectX;
 
-        XMMATRIX world = XMLoadFloat4x4(&m_world);
+        XMMATRIX world = XMLoadFloat4x4(&GetWorldMatrix());
         XMMATRIX worldViewProj = world * view * proj;
 
         ObjectConstants objConstants;
@@ -0,0 +1,97 @@
+#include "RenderQueue.h"
+
+namespace {
+    constexpr uint64 FieldMask(uint32 bits) { return (uint64(1) << bits) - 1; }
+
+    // 11-bit digits sort 64-bit keys in six passes with histograms that stay in L1.
+    constexpr uint32 DigitBits = 11;
+    constexpr uint32 DigitCount = (64 + DigitBits - 1) / DigitBits;
+    constexpr uint64 DigitMask = (uint64(1) << DigitBits) - 1;
+}
+
+uint64 RenderQueue::MakeKey(uint32 pass, Bucket bucket, uint32 pipeline, uint32 material, uint32 mesh, float depth) {
+    depth = std::min(std::max(depth, 0.0f), 1.0f);
+    uint64 quantized = static_cast<uint64>(depth * static_cast<float>(FieldMask(DepthBits)));
+
+    uint64 key = pass & FieldMask(PassBits);
+    key = (key << BucketBits) | (static_cast<uint64>(bucket) & FieldMask(BucketBits));
+
+    // Transparent draws blend in order, so depth decides before any state does.
+    if (bucket == Bucket::Transparent) {
+        key = (key << DepthBits) | (~quantized & FieldMask(DepthBits));
+    }
+    key = (key << PipelineBits) | (pipeline & FieldMask(PipelineBits));
+    key = (key << MaterialBits) | (material & FieldMask(MaterialBits));
+    key = (key << MeshBits) | (mesh & FieldMask(MeshBits));
+    if (bucket != Bucket::Transparent) {
+        key = (key << DepthBits) | quantized;
+    }
+    return key;
+}
+
+uint64 RenderQueue::GetStateBits(uint64 key) {
+    uint32 depthShift = (GetBucket(key) == Bucket::Transparent) ? PipelineBits + MaterialBits + MeshBits : 0;
+    return key & ~(FieldMask(DepthBits) << depthShift);
+}
+
+void RenderQueue::RadixSort(uint64* keys, uint32* payloads, uint32 count, uint64* keyScratch, uint32* payloadScratch) {
+    if (count < 2) return;
+
+    // Bits that differ between any two keys. Digits without one would only copy the
+    // arrays, and in a typical frame the pass, bucket and the high bits of every ID are
+    // shared by all keys.
+    uint64 varying = 0;
+    for (uint32 i = 1; i < count; ++i) varying |= keys[i] ^ keys[0];
+
+    uint32 activeShifts[DigitCount];
+    uint32 activeCount = 0;
+    for (uint32 digit = 0; digit < DigitCount; ++digit) {
+        if ((varying >> (digit * DigitBits)) & DigitMask) activeShifts[activeCount++] = digit * DigitBits;
+    }
+    if (activeCount == 0) return;
+
+    // Every active digit's histogram in one read of the keys.
+    static thread_local uint32 histograms[DigitCount][DigitMask + 1];
+    for (uint32 d = 0; d < activeCount; ++d) std::fill(histograms[d], histograms[d] + DigitMask + 1, 0u);
+    for (uint32 i = 0; i < count; ++i) {
+        uint64 key = keys[i];
+        for (uint32 d = 0; d < activeCount; ++d) {
+            ++histograms[d][(key >> activeShifts[d]) & DigitMask];
+        }
+    }
+
+    uint64* srcKeys = keys;
+    uint32* srcPayloads = payloads;
+    uint64* dstKeys = keyScratch;
+    uint32* dstPayloads = payloadScratch;
+    for (uint32 d = 0; d < activeCount; ++d) {
+        uint32 shift = activeShifts[d];
+        uint32* offsets = histograms[d];
+
+        uint32 offset = 0;
+        for (uint32 digit = 0; digit <= DigitMask; ++digit) {
+            uint32 digitCount = offsets[digit];
+            offsets[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (uint32 i = 0; i < count; ++i) {
+            uint32 slot = offsets[(srcKeys[i] >> shift) & DigitMask]++;
+            dstKeys[slot] = srcKeys[i];
+            dstPayloads[slot] = srcPayloads[i];
+        }
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcPayloads, dstPayloads);
+    }
+
+    if (srcKeys != keys) {
+        std::copy(srcKeys, srcKeys + count, keys);
+        std::copy(srcPayloads, srcPayloads + count, payloads);
+    }
+}
+
+void RenderQueue::Sort() {
+    m_keyScratch.resize(m_keys.size());
+    m_payloadScratch.resize(m_payloads.size());
+    RadixSort(m_keys.data(), m_payloads.data(), GetCount(), m_keyScratch.data(), m_payloadScratch.data());
+}
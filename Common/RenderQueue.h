@@ -0,0 +1,106 @@
+#pragma once
+
+#include <Types.h>
+
+// Draws as 64-bit sort keys with a payload each, usually the draw ID. Sorting the keys
+// orders the whole frame: by pass, then opaque before transparent, then opaque draws
+// grouped by pipeline, material and mesh and front to back within a group, and
+// transparent draws back to front. Keys are sorted with an LSD radix sort that skips
+// the digits every key shares.
+//
+//   Opaque:      pass:4 | bucket:2 | pipeline:10 | material:12 | mesh:12 | depth:24
+//   Transparent: pass:4 | bucket:2 | ~depth:24 | pipeline:10 | material:12 | mesh:12
+class RenderQueue {
+public:
+    enum class Bucket : uint8 { Opaque = 0, Transparent = 1 };
+
+    static constexpr uint32 PassBits = 4;
+    static constexpr uint32 BucketBits = 2;
+    static constexpr uint32 PipelineBits = 10;
+    static constexpr uint32 MaterialBits = 12;
+    static constexpr uint32 MeshBits = 12;
+    static constexpr uint32 DepthBits = 24;
+
+    // IDs wider than their field are wrapped, which only costs grouping. depth is the
+    // view depth scaled to 0..1 and is clamped to it.
+    static uint64 MakeKey(uint32 pass, Bucket bucket, uint32 pipeline, uint32 material, uint32 mesh, float depth);
+
+    static Bucket GetBucket(uint64 key) {
+        return static_cast<Bucket>((key >> (64 - PassBits - BucketBits)) & ((1u << BucketBits) - 1));
+    }
+
+    // The key without its depth: equal for draws of the same pass, bucket, pipeline,
+    // material and mesh.
+    static uint64 GetStateBits(uint64 key);
+
+    static uint32 GetMesh(uint64 key) {
+        uint32 shift = (GetBucket(key) == Bucket::Transparent) ? 0 : DepthBits;
+        return static_cast<uint32>((key >> shift) & ((1u << MeshBits) - 1));
+    }
+
+    // Sorts keys ascending and moves payloads along. The sort is stable, and the scratch
+    // arrays need room for count entries.
+    static void RadixSort(uint64* keys, uint32* payloads, uint32 count, uint64* keyScratch, uint32* payloadScratch);
+
+    void Clear() {
+        m_keys.clear();
+        m_payloads.clear();
+    }
+
+    void Reserve(uint32 count) {
+        m_keys.reserve(count);
+        m_payloads.reserve(count);
+    }
+
+    void Push(uint64 key, uint32 payload) {
+        m_keys.push_back(key);
+        m_payloads.push_back(payload);
+    }
+
+    void Sort();
+
+    uint32 GetCount() const { return static_cast<uint32>(m_keys.size()); }
+    uint64 GetKey(uint32 i) const { return m_keys[i]; }
+    uint32 GetPayload(uint32 i) const { return m_payloads[i]; }
+    const Vector<uint32>& GetPayloads() const { return m_payloads; }
+
+private:
+    Vector<uint64> m_keys;
+    Vector<uint32> m_payloads;
+    Vector<uint64> m_keyScratch;
+    Vector<uint32> m_payloadScratch;
+};
+
+// Small dense IDs for the pipelines and meshes that go into sort keys, handed out in
+// first-seen order. IDs stay stable from frame to frame, so the same state groups across
+// frames, until the table fills up.
+class SortKeyIdTable {
+public:
+    // IDs from capacity on don't fit their key field.
+    explicit SortKeyIdTable(uint32 capacity) : m_capacity(capacity) {}
+
+    // Call before the frame's first GetId. Once every ID that fits has been handed out the
+    // table starts over, so resources that were destroyed stop holding IDs. Never doing
+    // it within a frame keeps two live objects from sharing an ID.
+    void BeginFrame() {
+        if (m_ids.size() >= m_capacity) m_ids.clear();
+    }
+
+    uint32 GetId(const void* object) {
+        auto it = m_ids.find(object);
+        if (it != m_ids.end()) return it->second;
+
+        uint32 id = static_cast<uint32>(m_ids.size());
+        m_ids.emplace(object, id);
+        return id;
+    }
+
+    void Clear() { m_ids.clear(); }
+
+    uint32 GetCount() const { return static_cast<uint32>(m_ids.size()); }
+    uint32 GetCapacity() const { return m_capacity; }
+
+private:
+    uint32 m_capacity;
+    HashMap<const void*, uint32> m_ids;
+};
@@ -0,0 +1,37 @@
+#include "ResourceId.h"
+#include <cstdio>
+#include <mutex>
+
+namespace {
+#if DEBUG_BUILD
+    std::mutex s_mutex;
+    HashMap<ResourceId, String> s_names;
+#endif
+
+    String FormatHash(ResourceId id) {
+        char text[19];
+        std::snprintf(text, sizeof(text), "#%016llx", static_cast<unsigned long long>(id.GetHash()));
+        return text;
+    }
+}
+
+ResourceId ResourceNameTable::Register(std::string_view name) {
+    ResourceId id(name);
+#if DEBUG_BUILD
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto [it, inserted] = s_names.emplace(id, String(name));
+    if (!inserted && it->second != name) {
+        throw std::runtime_error("Resource name \"" + String(name) + "\" has the same ID as \"" + it->second + "\"");
+    }
+#endif
+    return id;
+}
+
+String ResourceNameTable::GetName(ResourceId id) {
+#if DEBUG_BUILD
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto it = s_names.find(id);
+    if (it != s_names.end()) return it->second;
+#endif
+    return FormatHash(id);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Types.h>
+#include <string_view>
+
+// A resource name as its 64-bit FNV-1a hash. ID("box") hashes at compile time, so
+// looking a resource up compares integers and never touches string memory. Names
+// only matter when resources are registered.
+class ResourceId {
+public:
+    constexpr ResourceId() = default;
+    constexpr explicit ResourceId(std::string_view name) : m_hash(Hash(name)) {}
+
+    static constexpr uint64 Hash(std::string_view name) {
+        uint64 hash = 0xcbf29ce484222325ull;
+        for (char c : name) {
+            hash ^= static_cast<uint8>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    constexpr uint64 GetHash() const { return m_hash; }
+
+    // Default constructed IDs name nothing; every name, even "", hashes to non-zero.
+    constexpr bool IsValid() const { return m_hash != 0; }
+
+    constexpr bool operator==(ResourceId other) const { return m_hash == other.m_hash; }
+    constexpr bool operator!=(ResourceId other) const { return m_hash != other.m_hash; }
+
+private:
+    uint64 m_hash = 0;
+};
+
+// Compile-time ID of a name, for lookups in per-frame code.
+consteval ResourceId ID(std::string_view name) {
+    return ResourceId(name);
+}
+
+namespace std {
+    template<>
+    struct hash<ResourceId> {
+        // Already a well mixed hash.
+        size_t operator()(ResourceId id) const noexcept { return static_cast<size_t>(id.GetHash()); }
+    };
+}
+
+// Names behind the IDs, kept in debug builds only. Registering a name that hashes like
+// a different registered one throws, so a collision shows up where the resource is
+// added instead of as the wrong mesh on screen.
+class ResourceNameTable {
+public:
+    // The name's ID, recorded for GetName in debug builds.
+    static ResourceId Register(std::string_view name);
+
+    // The registered name; in release builds, and for unknown IDs, the hash in hex.
+    static String GetName(ResourceId id);
+};
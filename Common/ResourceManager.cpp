@@ -8,33 +8,59 @@ struct Vertex {
     XMFLOAT2 TexCoord;
 };
 
+HRESULT ResourceManager::CreateResource(D3D12_HEAP_TYPE heapType,
+                                        const D3D12_RESOURCE_DESC& desc,
+                                        D3D12_RESOURCE_STATES initialState,
+                                        GpuAllocation& allocation,
+                                        ComPtr<ID3D12Resource>& resource) {
+    if (m_allocator) {
+        return m_allocator->CreateResource(heapType, desc, initialState, nullptr, allocation, resource);
+    }
+
+    CD3DX12_HEAP_PROPERTIES heapProps(heapType);
+    return m_device->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        initialState,
+        nullptr,
+        IID_PPV_ARGS(resource.GetAddressOf()));
+}
+
+void ResourceManager::EnableRelocation(MeshGeometry* mesh) {
+    // Buffer views are built from the resources on every draw, so swapping them is enough.
+    mesh->VertexBufferAllocation.EnableRelocation(D3D12_RESOURCE_STATE_GENERIC_READ, [mesh](ID3D12Resource* resource) {
+        mesh->VertexBufferGPU = resource;
+    });
+    mesh->IndexBufferAllocation.EnableRelocation(D3D12_RESOURCE_STATE_GENERIC_READ, [mesh](ID3D12Resource* resource) {
+        mesh->IndexBufferGPU = resource;
+    });
+}
+
 ComPtr<ID3D12Resource> ResourceManager::CreateDefaultBuffer(const void* initData,
                                                            UINT64 byteSize,
-                                                           ComPtr<ID3D12Resource>& uploadBuffer) {
+                                                           ComPtr<ID3D12Resource>& uploadBuffer,
+                                                           GpuAllocation& bufferAllocation,
+                                                           GpuAllocation& uploadAllocation) {
     ComPtr<ID3D12Resource> defaultBuffer;
 
     // Create the actual default buffer resource
-    CD3DX12_HEAP_PROPERTIES defaultHeapProps(D3D12_HEAP_TYPE_DEFAULT);
     CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
 
-    m_device->CreateCommittedResource(
-        &defaultHeapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &bufferDesc,
+    ThrowIfFailed(CreateResource(
+        D3D12_HEAP_TYPE_DEFAULT,
+        bufferDesc,
         D3D12_RESOURCE_STATE_COMMON,
-        nullptr,
-        IID_PPV_ARGS(defaultBuffer.GetAddressOf()));
+        bufferAllocation,
+        defaultBuffer));
 
     // Create upload buffer
-    CD3DX12_HEAP_PROPERTIES uploadHeapProps(D3D12_HEAP_TYPE_UPLOAD);
-
-    m_device->CreateCommittedResource(
-        &uploadHeapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &bufferDesc,
+    ThrowIfFailed(CreateResource(
+        D3D12_HEAP_TYPE_UPLOAD,
+        bufferDesc,
         D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(uploadBuffer.GetAddressOf()));
+        uploadAllocation,
+        uploadBuffer));
 
     // Copy data to upload buffer
     D3D12_SUBRESOURCE_DATA subResourceData = {};
@@ -147,8 +173,11 @@ SharedPtr<MeshGeometry> ResourceManager::CreateBoxMesh(const String& name,
     CopyMemory(mesh->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
     // Create GPU buffers
-    mesh->VertexBufferGPU = CreateDefaultBuffer(vertices.data(), vbByteSize, mesh->VertexBufferUploader);
-    mesh->IndexBufferGPU = CreateDefaultBuffer(indices.data(), ibByteSize, mesh->IndexBufferUploader);
+    mesh->VertexBufferGPU = CreateDefaultBuffer(vertices.data(), vbByteSize, mesh->VertexBufferUploader,
+                                                 mesh->VertexBufferAllocation, mesh->VertexUploaderAllocation);
+    mesh->IndexBufferGPU = CreateDefaultBuffer(indices.data(), ibByteSize, mesh->IndexBufferUploader,
+                                                mesh->IndexBufferAllocation, mesh->IndexUploaderAllocation);
+    EnableRelocation(mesh.get());
 
     mesh->VertexByteStride = sizeof(Vertex);
     mesh->VertexBufferByteSize = vbByteSize;
@@ -160,10 +189,11 @@ SharedPtr<MeshGeometry> ResourceManager::CreateBoxMesh(const String& name,
     submesh.IndexCount = (UINT)indices.size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
+    BoundingBox::CreateFromPoints(submesh.Bounds, vertices.size(), &vertices[0].Pos, sizeof(Vertex));
 
     mesh->DrawArgs["box"] = submesh;
 
-    m_meshes[name] = mesh;
+    AddMesh(name, mesh);
     return mesh;
 }
 
@@ -225,8 +255,11 @@ SharedPtr<MeshGeometry> ResourceManager::CreatePlaneMesh(const String& name,
     D3DCreateBlob(ibByteSize, &mesh->IndexBufferCPU);
     CopyMemory(mesh->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
-    mesh->VertexBufferGPU = CreateDefaultBuffer(vertices.data(), vbByteSize, mesh->VertexBufferUploader);
-    mesh->IndexBufferGPU = CreateDefaultBuffer(indices.data(), ibByteSize, mesh->IndexBufferUploader);
+    mesh->VertexBufferGPU = CreateDefaultBuffer(vertices.data(), vbByteSize, mesh->VertexBufferUploader,
+                                                 mesh->VertexBufferAllocation, mesh->VertexUploaderAllocation);
+    mesh->IndexBufferGPU = CreateDefaultBuffer(indices.data(), ibByteSize, mesh->IndexBufferUploader,
+                                                mesh->IndexBufferAllocation, mesh->IndexUploaderAllocation);
+    EnableRelocation(mesh.get());
 
     mesh->VertexByteStride = sizeof(Vertex);
     mesh->VertexBufferByteSize = vbByteSize;
@@ -237,10 +270,11 @@ SharedPtr<MeshGeometry> ResourceManager::CreatePlaneMesh(const String& name,
     submesh.IndexCount = (UINT)indices.size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
+    BoundingBox::CreateFromPoints(submesh.Bounds, vertices.size(), &vertices[0].Pos, sizeof(Vertex));
 
     mesh->DrawArgs["plane"] = submesh;
 
-    m_meshes[name] = mesh;
+    AddMesh(name, mesh);
     return mesh;
 }
 
@@ -265,42 +299,159 @@ ComPtr<ID3DBlob> ResourceManager::CompileShader(const String& name,
     }
 
     if (SUCCEEDED(hr)) {
-        m_shaders[name] = byteCode;
+        m_shaders[ResourceNameTable::Register(name)] = byteCode;
     }
 
     return byteCode;
 }
 
+SharedPtr<MeshGeometry> ResourceManager::CreateMesh(const String& name,
+                                                   const void* vertices,
+                                                   uint32 vertexStride,
+                                                   uint32 vertexCount,
+                                                   const void* indices,
+                                                   DXGI_FORMAT indexFormat,
+                                                   uint32 indexCount) {
+    const UINT indexSize = (indexFormat == DXGI_FORMAT_R32_UINT) ? 4 : 2;
+    const UINT vbByteSize = vertexCount * vertexStride;
+    const UINT ibByteSize = indexCount * indexSize;
+
+    auto mesh = SharedPtr<MeshGeometry>(new MeshGeometry());
+    mesh->Name = name;
+
+    D3DCreateBlob(vbByteSize, &mesh->VertexBufferCPU);
+    CopyMemory(mesh->VertexBufferCPU->GetBufferPointer(), vertices, vbByteSize);
+
+    D3DCreateBlob(ibByteSize, &mesh->IndexBufferCPU);
+    CopyMemory(mesh->IndexBufferCPU->GetBufferPointer(), indices, ibByteSize);
+
+    mesh->VertexBufferGPU = CreateDefaultBuffer(vertices, vbByteSize, mesh->VertexBufferUploader,
+                                                 mesh->VertexBufferAllocation, mesh->VertexUploaderAllocation);
+    mesh->IndexBufferGPU = CreateDefaultBuffer(indices, ibByteSize, mesh->IndexBufferUploader,
+                                                mesh->IndexBufferAllocation, mesh->IndexUploaderAllocation);
+    EnableRelocation(mesh.get());
+
+    mesh->VertexByteStride = vertexStride;
+    mesh->VertexBufferByteSize = vbByteSize;
+    mesh->IndexFormat = indexFormat;
+    mesh->IndexBufferByteSize = ibByteSize;
+
+    AddMesh(name, mesh);
+    return mesh;
+}
+
 ComPtr<ID3D12PipelineState> ResourceManager::CreatePSO(const String& name,
                                                       const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) {
     ComPtr<ID3D12PipelineState> pso;
     HRESULT hr = m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pso));
 
     if (SUCCEEDED(hr)) {
-        m_psos[name] = pso;
+        m_psos[ResourceNameTable::Register(name)] = pso;
     }
 
     return pso;
 }
 
-SharedPtr<IMaterialComponent> ResourceManager::CreateMaterial(const String& psoName,
-                                                                   const MaterialConstants& constants) {
+SharedPtr<IMaterialComponent> ResourceManager::CreateMaterial(ResourceId psoId,
+                                                                   const MaterialConstants& constants,
+                                                                   const String& diffuseTexture,
+                                                                   Handle* handle) {
     auto material = SharedPtr<BasicMaterialComponent>(new BasicMaterialComponent());
 
-    auto pso = GetPSO(psoName);
+    auto pso = GetPSO(psoId);
     if (pso) {
         material->SetPSO(pso);
     }
 
-    material->SetMaterialConstants(constants);
+    MaterialConstants materialConstants = constants;
+    if (!diffuseTexture.empty()) {
+        materialConstants.DiffuseMapIndex = GetTextureIndex(diffuseTexture);
+    }
+
+    material->SetMaterialConstants(materialConstants);
     material->InitializeMaterialBuffer(m_device);
 
+    Handle materialHandle = m_materials.Insert(material);
+    material->SetMaterialIndex(materialHandle.index);
+    if (handle) *handle = materialHandle;
+
     return material;
 }
 
-SharedPtr<IMeshComponent> ResourceManager::CreateMeshComponent(const String& meshName) {
-    auto mesh = GetMesh(meshName);
+SharedPtr<IMeshComponent> ResourceManager::CreateMeshComponent(ResourceId meshId) {
+    auto mesh = GetMesh(meshId);
     if (!mesh) return nullptr;
 
     return SharedPtr<BasicMeshComponent>(new BasicMeshComponent(mesh));
-}
\ No newline at end of file
+}
+Handle ResourceManager::AddTexture(const String& name, SharedPtr<Texture> texture) {
+    Handle handle = AddNamed(m_textures, m_textureHandles, name, texture);
+    if (!m_descriptors || !texture || !texture->resource) return handle;
+
+    texture->bindlessIndex = m_descriptors->GetTextureTable().Register(name);
+    WriteTextureDescriptor(*texture, texture->resource.Get());
+
+    // Placed textures can be moved by the defragmenter. Frames in flight may still read
+    // the old slot, so the moved texture gets a new one, its materials follow, and the old
+    // slot is reused once those frames are done.
+    if (texture->allocation.IsValid()) {
+        Texture* target = texture.get();
+        texture->allocation.EnableRelocation(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            [this, target, name](ID3D12Resource* resource) {
+                uint32 oldIndex = target->bindlessIndex;
+                target->resource = resource;
+                target->bindlessIndex = m_descriptors->GetTextureTable().Reassign(name, GetNextFenceValue());
+                WriteTextureDescriptor(*target, resource);
+                RepointMaterials(oldIndex, target->bindlessIndex);
+            });
+    }
+    return handle;
+}
+
+void ResourceManager::RemoveTexture(const String& name) {
+    auto it = m_textureHandles.find(ResourceId(name));
+    if (it == m_textureHandles.end()) return;
+
+    if (m_descriptors) {
+        auto& table = m_descriptors->GetTextureTable();
+        uint32 slot = table.Find(name);
+        if (slot != BindlessTextureTable::FallbackIndex) {
+            // Nothing recorded from now on may reach the released texture through the slot,
+            // whether through a material or the slot's next owner.
+            RepointMaterials(slot, BindlessTextureTable::FallbackIndex);
+            m_descriptors->CreateNullShaderResourceView(table.GetDescriptorIndex(slot));
+        }
+        table.Unregister(name, GetNextFenceValue());
+    }
+
+    if (m_fenceTimeline) {
+        m_fenceTimeline->DeferRelease(std::move(*m_textures.Get(it->second)));
+    }
+    m_textures.Erase(it->second);
+    m_textureHandles.erase(it);
+}
+
+void ResourceManager::RepointMaterials(uint32 oldIndex, uint32 newIndex) {
+    for (auto& material : m_materials) {
+        if (!material || material->GetMaterialConstants().DiffuseMapIndex != oldIndex) continue;
+
+        MaterialConstants constants = material->GetMaterialConstants();
+        constants.DiffuseMapIndex = newIndex;
+        material->SetMaterialConstants(constants);
+    }
+}
+
+void ResourceManager::WriteTextureDescriptor(const Texture& texture, ID3D12Resource* resource) {
+    auto resourceDesc = resource->GetDesc();
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Format = resourceDesc.Format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.MipLevels = resourceDesc.MipLevels;
+    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+
+    const auto& table = m_descriptors->GetTextureTable();
+    m_descriptors->CreateShaderResourceView(resource, &srvDesc, table.GetDescriptorIndex(texture.bindlessIndex));
+}
@@ -1,22 +1,45 @@
 #pragma once
 
 #include "RenderComponents.h"
+#include "GpuMemoryAllocator.h"
+#include "FenceTimeline.h"
+#include "DescriptorHeapManager.h"
+#include "SlotMap.h"
+#include "ResourceId.h"
 
 class ResourceManager {
 public:
-    ResourceManager(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList)
-        : m_device(device), m_commandList(cmdList) {}
+    ResourceManager(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+                    GpuMemoryAllocator* allocator = nullptr, FenceTimeline* fenceTimeline = nullptr,
+                    DescriptorHeapManager* descriptors = nullptr)
+        : m_device(device), m_commandList(cmdList), m_allocator(allocator), m_fenceTimeline(fenceTimeline),
+          m_descriptors(descriptors) {}
     
     ~ResourceManager() = default;
     
     // Mesh management
-    SharedPtr<MeshGeometry> GetMesh(const String& name) {
-        auto it = m_meshes.find(name);
-        return (it != m_meshes.end()) ? it->second : nullptr;
+    // Meshes, textures and materials live in slot maps. Resources are registered by name
+    // and looked up by ResourceId, e.g. GetMesh(ID("box")), which compares hashes only.
+    // IDs resolve to handles once; Get(Handle) then costs an array lookup and no reference
+    // count traffic.
+    SharedPtr<MeshGeometry> GetMesh(ResourceId id) {
+        auto* mesh = m_meshes.Get(GetMeshHandle(id));
+        return mesh ? *mesh : nullptr;
     }
-    
-    void AddMesh(const String& name, SharedPtr<MeshGeometry> mesh) {
-        m_meshes[name] = mesh;
+
+    MeshGeometry* GetMesh(Handle handle) const {
+        auto* mesh = m_meshes.Get(handle);
+        return mesh ? mesh->get() : nullptr;
+    }
+
+    Handle GetMeshHandle(ResourceId id) const {
+        auto it = m_meshHandles.find(id);
+        return (it != m_meshHandles.end()) ? it->second : Handle();
+    }
+
+    // Replaces the mesh in place when the name is taken, so its handle stays valid.
+    Handle AddMesh(const String& name, SharedPtr<MeshGeometry> mesh) {
+        return AddNamed(m_meshes, m_meshHandles, name, std::move(mesh));
     }
     
     SharedPtr<MeshGeometry> CreateBoxMesh(const String& name,
@@ -41,41 +64,71 @@ public:
                                                   float depth = 10.0f,
                                                   uint32 m = 2,
                                                   uint32 n = 2);
+
+    // Uploads geometry built elsewhere, e.g. merged static batches. The mesh has no
+    // submeshes; callers add their ranges to DrawArgs.
+    SharedPtr<MeshGeometry> CreateMesh(const String& name,
+                                       const void* vertices,
+                                       uint32 vertexStride,
+                                       uint32 vertexCount,
+                                       const void* indices,
+                                       DXGI_FORMAT indexFormat,
+                                       uint32 indexCount);
     
     // Texture management
-    SharedPtr<Texture> GetTexture(const String& name) {
-        auto it = m_textures.find(name);
-        return (it != m_textures.end()) ? it->second : nullptr;
+    SharedPtr<Texture> GetTexture(ResourceId id) {
+        auto* texture = m_textures.Get(GetTextureHandle(id));
+        return texture ? *texture : nullptr;
+    }
+
+    Texture* GetTexture(Handle handle) const {
+        auto* texture = m_textures.Get(handle);
+        return texture ? texture->get() : nullptr;
+    }
+
+    Handle GetTextureHandle(ResourceId id) const {
+        auto it = m_textureHandles.find(id);
+        return (it != m_textureHandles.end()) ? it->second : Handle();
     }
     
-    void AddTexture(const String& name, SharedPtr<Texture> texture) {
-        m_textures[name] = texture;
+    // With a descriptor heap the texture also gets a slot in the bindless texture table,
+    // stored in texture->bindlessIndex.
+    Handle AddTexture(const String& name, SharedPtr<Texture> texture);
+
+    // The texture and its table slot are released once the GPU is done with them.
+    // Materials using the slot are moved to BindlessTextureTable::FallbackIndex and the
+    // slot gets a null SRV, so later frames sample zero instead of the removed texture.
+    void RemoveTexture(const String& name);
+
+    // Bindless slot of the texture, or BindlessTextureTable::FallbackIndex when unknown.
+    uint32 GetTextureIndex(const String& name) const {
+        return m_descriptors ? m_descriptors->GetTextureTable().Find(name) : BindlessTextureTable::FallbackIndex;
     }
     
     SharedPtr<Texture> LoadTextureFromFile(const String& name,
                                                  const WString& filename);
     
     // Pipeline State Object management
-    ComPtr<ID3D12PipelineState> GetPSO(const String& name) {
-        auto it = m_psos.find(name);
+    ComPtr<ID3D12PipelineState> GetPSO(ResourceId id) {
+        auto it = m_psos.find(id);
         return (it != m_psos.end()) ? it->second : nullptr;
     }
     
     void AddPSO(const String& name, ComPtr<ID3D12PipelineState> pso) {
-        m_psos[name] = pso;
+        m_psos[ResourceNameTable::Register(name)] = pso;
     }
     
     ComPtr<ID3D12PipelineState> CreatePSO(const String& name,
                                           const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
     
     // Shader management
-    ComPtr<ID3DBlob> GetShader(const String& name) {
-        auto it = m_shaders.find(name);
+    ComPtr<ID3DBlob> GetShader(ResourceId id) {
+        auto it = m_shaders.find(id);
         return (it != m_shaders.end()) ? it->second : nullptr;
     }
     
     void AddShader(const String& name, ComPtr<ID3DBlob> shader) {
-        m_shaders[name] = shader;
+        m_shaders[ResourceNameTable::Register(name)] = shader;
     }
     
     ComPtr<ID3DBlob> CompileShader(const String& name,
@@ -84,66 +137,137 @@ public:
                                    const String& target);
     
     // Material component factory
-    SharedPtr<IMaterialComponent> CreateMaterial(const String& psoName,
-                                                       const MaterialConstants& constants = MaterialConstants());
-    
+    // diffuseTexture, when given, overrides constants.DiffuseMapIndex with that texture's slot.
+    // The material's slot in m_materials is its index in the material table; handle, when
+    // given, receives it.
+    SharedPtr<IMaterialComponent> CreateMaterial(ResourceId psoId,
+                                                       const MaterialConstants& constants = MaterialConstants(),
+                                                       const String& diffuseTexture = "",
+                                                       Handle* handle = nullptr);
+
+    IMaterialComponent* GetMaterial(Handle handle) const {
+        auto* material = m_materials.Get(handle);
+        return material ? material->get() : nullptr;
+    }
+
+    // Frees the material's table index. Objects still using it must be given another material.
+    void RemoveMaterial(Handle handle) { m_materials.Erase(handle); }
+
+    const SlotMap<SharedPtr<IMaterialComponent>>& GetMaterials() const { return m_materials; }
+
     // Mesh component factory
-    SharedPtr<IMeshComponent> CreateMeshComponent(const String& meshName);
+    SharedPtr<IMeshComponent> CreateMeshComponent(ResourceId meshId);
     
-    // Cleanup upload buffers after GPU upload is complete
+    // Releases the upload buffers. With a fence timeline they are destroyed once the GPU has
+    // executed the copies recorded so far; without one the upload must already be complete.
     void CleanupUploadBuffers() {
-        for (auto& [name, mesh] : m_meshes) {
-            if (mesh) {
-                mesh->DisposeUploaders();
+        for (auto& mesh : m_meshes) {
+            if (!mesh) continue;
+
+            if (m_fenceTimeline) {
+                m_fenceTimeline->DeferRelease(std::move(mesh->VertexBufferUploader));
+                m_fenceTimeline->DeferRelease(std::move(mesh->IndexBufferUploader));
+                m_fenceTimeline->DeferRelease(std::move(mesh->VertexUploaderAllocation));
+                m_fenceTimeline->DeferRelease(std::move(mesh->IndexUploaderAllocation));
             }
+            mesh->DisposeUploaders();
         }
         
-        for (auto& [name, texture] : m_textures) {
+        for (auto& texture : m_textures) {
             if (texture && texture->uploadHeap) {
+                if (m_fenceTimeline) {
+                    m_fenceTimeline->DeferRelease(std::move(texture->uploadHeap));
+                    m_fenceTimeline->DeferRelease(std::move(texture->uploadAllocation));
+                }
                 texture->uploadHeap = nullptr;
+                texture->uploadAllocation.Reset();
             }
         }
     }
     
-    // Get all resource names for debugging
+    // Get all resource names for debugging. Release builds don't keep the names and
+    // list the IDs' hashes instead.
     Vector<String> GetMeshNames() const {
         Vector<String> names;
-        for (const auto& [name, mesh] : m_meshes) {
-            names.push_back(name);
+        for (const auto& [id, handle] : m_meshHandles) {
+            names.push_back(ResourceNameTable::GetName(id));
         }
         return names;
     }
     
     Vector<String> GetTextureNames() const {
         Vector<String> names;
-        for (const auto& [name, texture] : m_textures) {
-            names.push_back(name);
+        for (const auto& [id, handle] : m_textureHandles) {
+            names.push_back(ResourceNameTable::GetName(id));
         }
         return names;
     }
     
     Vector<String> GetPSONames() const {
         Vector<String> names;
-        for (const auto& [name, pso] : m_psos) {
-            names.push_back(name);
+        for (const auto& [id, pso] : m_psos) {
+            names.push_back(ResourceNameTable::GetName(id));
         }
         return names;
     }
     
     ID3D12Device* GetDevice() const { return m_device; }
     ID3D12GraphicsCommandList* GetCommandList() const { return m_commandList; }
+    GpuMemoryAllocator* GetAllocator() const { return m_allocator; }
     
 private:
     ID3D12Device* m_device;
     ID3D12GraphicsCommandList* m_commandList;
+    GpuMemoryAllocator* m_allocator;   // Optional, resources are committed when null
+    FenceTimeline* m_fenceTimeline;    // Optional, released resources are destroyed immediately when null
+    DescriptorHeapManager* m_descriptors;   // Optional, textures get no bindless slot when null
     
-    HashMap<String, SharedPtr<MeshGeometry>> m_meshes;
-    HashMap<String, SharedPtr<Texture>> m_textures;
-    HashMap<String, ComPtr<ID3D12PipelineState>> m_psos;
-    HashMap<String, ComPtr<ID3DBlob>> m_shaders;
+    SlotMap<SharedPtr<MeshGeometry>> m_meshes;
+    SlotMap<SharedPtr<Texture>> m_textures;
+    SlotMap<SharedPtr<IMaterialComponent>> m_materials;    // Slot is the material index
+    HashMap<ResourceId, Handle> m_meshHandles;
+    HashMap<ResourceId, Handle> m_textureHandles;
+    HashMap<ResourceId, ComPtr<ID3D12PipelineState>> m_psos;
+    HashMap<ResourceId, ComPtr<ID3DBlob>> m_shaders;
+
+    template<typename T>
+    static Handle AddNamed(SlotMap<SharedPtr<T>>& values, HashMap<ResourceId, Handle>& handles,
+                           const String& name, SharedPtr<T> value) {
+        ResourceId id = ResourceNameTable::Register(name);
+        auto it = handles.find(id);
+        if (it != handles.end()) {
+            *values.Get(it->second) = std::move(value);
+            return it->second;
+        }
+        Handle handle = values.Insert(std::move(value));
+        handles[id] = handle;
+        return handle;
+    }
     
     // Helper function to create default buffer on GPU
     ComPtr<ID3D12Resource> CreateDefaultBuffer(const void* initData,
                                                UINT64 byteSize,
-                                               ComPtr<ID3D12Resource>& uploadBuffer);
+                                               ComPtr<ID3D12Resource>& uploadBuffer,
+                                               GpuAllocation& bufferAllocation,
+                                               GpuAllocation& uploadAllocation);
+
+    // Places the resource through m_allocator when there is one, otherwise commits it.
+    HRESULT CreateResource(D3D12_HEAP_TYPE heapType,
+                           const D3D12_RESOURCE_DESC& desc,
+                           D3D12_RESOURCE_STATES initialState,
+                           GpuAllocation& allocation,
+                           ComPtr<ID3D12Resource>& resource);
+
+    // Lets the defragmenter move the mesh's vertex and index buffers.
+    void EnableRelocation(MeshGeometry* mesh);
+
+    void WriteTextureDescriptor(const Texture& texture, ID3D12Resource* resource);
+
+    // Points materials sampling oldIndex at newIndex.
+    void RepointMaterials(uint32 oldIndex, uint32 newIndex);
+
+    // Fence value the GPU passes once the commands recorded so far have executed.
+    uint64 GetNextFenceValue() const {
+        return m_fenceTimeline ? m_fenceTimeline->GetLastSignaledValue() + 1 : 0;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Types.h>
+#include <cassert>
+
+// Remembers the root arguments last set on a command list, so a draw only issues the
+// root calls whose value actually changes. Values are opaque 64-bit words: GPU virtual
+// addresses for root descriptors, descriptor handle pointers for tables.
+//
+// Everything is unknown after Reset, which must follow a new command list or a
+// SetGraphicsRootSignature call since both invalidate the bound arguments.
+class RootArgumentCache {
+public:
+    static constexpr uint32 MaxParameters = 16;
+    static constexpr uint32 MaxCachedConstants = 16;   // Per parameter, later offsets are never cached
+
+    void Reset() {
+        m_valueValid = 0;
+        m_constantValid.fill(0);
+    }
+
+    // Returns true when value differs from what parameter holds and the call must be made.
+    bool SetValue(uint32 parameter, uint64 value) {
+        assert(parameter < MaxParameters && "Root parameter out of range");
+        uint32 bit = 1u << parameter;
+        if ((m_valueValid & bit) && m_values[parameter] == value) return false;
+
+        m_values[parameter] = value;
+        m_valueValid |= bit;
+        return true;
+    }
+
+    // Returns true when any of count constants starting at offset differs.
+    bool SetConstants(uint32 parameter, const uint32* values, uint32 count, uint32 offset = 0) {
+        assert(parameter < MaxParameters && "Root parameter out of range");
+        if (offset + count > MaxCachedConstants) {
+            InvalidateConstants(parameter);
+            return true;
+        }
+
+        uint32 mask = ((1u << count) - 1) << offset;
+        uint32& valid = m_constantValid[parameter];
+        uint32* cached = m_constants[parameter].data() + offset;
+
+        bool changed = (valid & mask) != mask;
+        for (uint32 i = 0; i < count && !changed; ++i) {
+            changed = cached[i] != values[i];
+        }
+        if (!changed) return false;
+
+        std::copy(values, values + count, cached);
+        valid |= mask;
+        return true;
+    }
+
+    void Invalidate(uint32 parameter) {
+        m_valueValid &= ~(1u << parameter);
+        InvalidateConstants(parameter);
+    }
+
+private:
+    void InvalidateConstants(uint32 parameter) { m_constantValid[parameter] = 0; }
+
+    std::array<uint64, MaxParameters> m_values = {};
+    uint32 m_valueValid = 0;
+
+    std::array<std::array<uint32, MaxCachedConstants>, MaxParameters> m_constants = {};
+    std::array<uint32, MaxParameters> m_constantValid = {};
+};
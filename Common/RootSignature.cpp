@@ -0,0 +1,177 @@
+#include "RootSignature.h"
+
+namespace {
+    D3D12_SHADER_VISIBILITY ToD3D12(RootVisibility visibility) {
+        switch (visibility) {
+        case RootVisibility::Vertex: return D3D12_SHADER_VISIBILITY_VERTEX;
+        case RootVisibility::Pixel: return D3D12_SHADER_VISIBILITY_PIXEL;
+        default: return D3D12_SHADER_VISIBILITY_ALL;
+        }
+    }
+
+    D3D12_DESCRIPTOR_RANGE_TYPE ToD3D12(DescriptorRangeKind kind) {
+        switch (kind) {
+        case DescriptorRangeKind::ShaderResource: return D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+        case DescriptorRangeKind::UnorderedAccess: return D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+        case DescriptorRangeKind::ConstantBuffer: return D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+        default: return D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
+        }
+    }
+
+    D3D12_ROOT_PARAMETER_TYPE ToD3D12(RootParameterKind kind) {
+        switch (kind) {
+        case RootParameterKind::Constants: return D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+        case RootParameterKind::ConstantBuffer: return D3D12_ROOT_PARAMETER_TYPE_CBV;
+        case RootParameterKind::ShaderResource: return D3D12_ROOT_PARAMETER_TYPE_SRV;
+        case RootParameterKind::UnorderedAccess: return D3D12_ROOT_PARAMETER_TYPE_UAV;
+        default: return D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        }
+    }
+
+    D3D12_ROOT_DESCRIPTOR_FLAGS ToRootDescriptorFlags(RootDataVolatility data) {
+        switch (data) {
+        case RootDataVolatility::Static: return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC;
+        case RootDataVolatility::StaticWhileSetAtExecute: return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+        default: return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE;
+        }
+    }
+
+    D3D12_DESCRIPTOR_RANGE_FLAGS ToRangeFlags(const DescriptorRangeDesc& range) {
+        // Samplers carry no data flags.
+        D3D12_DESCRIPTOR_RANGE_FLAGS flags = range.volatileDescriptors
+            ? D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE
+            : D3D12_DESCRIPTOR_RANGE_FLAG_NONE;
+        if (range.kind == DescriptorRangeKind::Sampler) return flags;
+
+        switch (range.data) {
+        case RootDataVolatility::Static: return flags | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC;
+        case RootDataVolatility::StaticWhileSetAtExecute: return flags | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+        default: return flags | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE;
+        }
+    }
+
+    UINT ToRangeCount(uint32 count) {
+        return count == DescriptorRangeDesc::Unbounded ? UINT_MAX : count;
+    }
+
+    ComPtr<ID3DBlob> Serialize1_1(const RootSignatureDesc& desc, const D3D12_STATIC_SAMPLER_DESC* staticSamplers,
+                                  UINT staticSamplerCount, D3D12_ROOT_SIGNATURE_FLAGS flags) {
+        // Ranges of every table are stored up front so the pointers into them stay valid.
+        Vector<Vector<D3D12_DESCRIPTOR_RANGE1>> ranges(desc.GetParameterCount());
+        Vector<D3D12_ROOT_PARAMETER1> parameters(desc.GetParameterCount());
+
+        for (uint32 i = 0; i < desc.GetParameterCount(); ++i) {
+            const auto& src = desc.GetParameter(i);
+            auto& dst = parameters[i];
+            dst.ParameterType = ToD3D12(src.kind);
+            dst.ShaderVisibility = ToD3D12(src.visibility);
+
+            switch (src.kind) {
+            case RootParameterKind::Constants:
+                dst.Constants = { src.shaderRegister, src.space, src.num32BitValues };
+                break;
+            case RootParameterKind::DescriptorTable:
+                for (const auto& range : src.ranges) {
+                    ranges[i].push_back({ ToD3D12(range.kind), ToRangeCount(range.count), range.baseRegister,
+                                          range.space, ToRangeFlags(range), D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND });
+                }
+                dst.DescriptorTable = { static_cast<UINT>(ranges[i].size()), ranges[i].data() };
+                break;
+            default:
+                dst.Descriptor = { src.shaderRegister, src.space, ToRootDescriptorFlags(src.data) };
+                break;
+            }
+        }
+
+        D3D12_VERSIONED_ROOT_SIGNATURE_DESC versionedDesc = {};
+        versionedDesc.Version = D3D_ROOT_SIGNATURE_VERSION_1_1;
+        versionedDesc.Desc_1_1 = { static_cast<UINT>(parameters.size()), parameters.data(),
+                                   staticSamplerCount, staticSamplers, flags };
+
+        ComPtr<ID3DBlob> serialized;
+        ComPtr<ID3DBlob> errorBlob;
+        HRESULT hr = D3D12SerializeVersionedRootSignature(&versionedDesc, serialized.GetAddressOf(), errorBlob.GetAddressOf());
+        if (errorBlob != nullptr) {
+            ::OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+        }
+        ThrowIfFailed(hr);
+        return serialized;
+    }
+
+    // Version 1.0 has no volatility flags; everything is treated as volatile.
+    ComPtr<ID3DBlob> Serialize1_0(const RootSignatureDesc& desc, const D3D12_STATIC_SAMPLER_DESC* staticSamplers,
+                                  UINT staticSamplerCount, D3D12_ROOT_SIGNATURE_FLAGS flags) {
+        Vector<Vector<D3D12_DESCRIPTOR_RANGE>> ranges(desc.GetParameterCount());
+        Vector<D3D12_ROOT_PARAMETER> parameters(desc.GetParameterCount());
+
+        for (uint32 i = 0; i < desc.GetParameterCount(); ++i) {
+            const auto& src = desc.GetParameter(i);
+            auto& dst = parameters[i];
+            dst.ParameterType = ToD3D12(src.kind);
+            dst.ShaderVisibility = ToD3D12(src.visibility);
+
+            switch (src.kind) {
+            case RootParameterKind::Constants:
+                dst.Constants = { src.shaderRegister, src.space, src.num32BitValues };
+                break;
+            case RootParameterKind::DescriptorTable:
+                for (const auto& range : src.ranges) {
+                    ranges[i].push_back({ ToD3D12(range.kind), ToRangeCount(range.count), range.baseRegister,
+                                          range.space, D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND });
+                }
+                dst.DescriptorTable = { static_cast<UINT>(ranges[i].size()), ranges[i].data() };
+                break;
+            default:
+                dst.Descriptor = { src.shaderRegister, src.space };
+                break;
+            }
+        }
+
+        D3D12_ROOT_SIGNATURE_DESC rootSigDesc = { static_cast<UINT>(parameters.size()), parameters.data(),
+                                                  staticSamplerCount, staticSamplers, flags };
+
+        ComPtr<ID3DBlob> serialized;
+        ComPtr<ID3DBlob> errorBlob;
+        HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+                                                 serialized.GetAddressOf(), errorBlob.GetAddressOf());
+        if (errorBlob != nullptr) {
+            ::OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+        }
+        ThrowIfFailed(hr);
+        return serialized;
+    }
+}
+
+ComPtr<ID3D12RootSignature> CreateRootSignature(ID3D12Device* device,
+                                                const RootSignatureDesc& desc,
+                                                const D3D12_STATIC_SAMPLER_DESC* staticSamplers,
+                                                UINT staticSamplerCount,
+                                                D3D12_ROOT_SIGNATURE_FLAGS flags,
+                                                D3D_ROOT_SIGNATURE_VERSION* version) {
+    String error = desc.Validate();
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+
+    D3D12_FEATURE_DATA_ROOT_SIGNATURE feature = {};
+    feature.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+    if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &feature, sizeof(feature)))) {
+        feature.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+    }
+
+    ComPtr<ID3DBlob> serialized = (feature.HighestVersion >= D3D_ROOT_SIGNATURE_VERSION_1_1)
+        ? Serialize1_1(desc, staticSamplers, staticSamplerCount, flags)
+        : Serialize1_0(desc, staticSamplers, staticSamplerCount, flags);
+
+    ComPtr<ID3D12RootSignature> rootSignature;
+    ThrowIfFailed(device->CreateRootSignature(
+        0,
+        serialized->GetBufferPointer(),
+        serialized->GetBufferSize(),
+        IID_PPV_ARGS(rootSignature.GetAddressOf())));
+
+    if (version) {
+        *version = feature.HighestVersion;
+    }
+    return rootSignature;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <WindowsPlatform.h>
+#include "RootSignatureDesc.h"
+
+// Creates the root signature described by desc. It is serialized as version 1.1 so the
+// data and descriptor volatility hints reach the driver, falling back to 1.0 on runtimes
+// without 1.1 support. version, when given, receives the version used.
+// Throws when desc does not validate.
+ComPtr<ID3D12RootSignature> CreateRootSignature(ID3D12Device* device,
+                                                const RootSignatureDesc& desc,
+                                                const D3D12_STATIC_SAMPLER_DESC* staticSamplers,
+                                                UINT staticSamplerCount,
+                                                D3D12_ROOT_SIGNATURE_FLAGS flags,
+                                                D3D_ROOT_SIGNATURE_VERSION* version = nullptr);
@@ -0,0 +1,187 @@
+#include "RootSignatureDesc.h"
+
+namespace {
+    // Register classes share no namespace with each other: b0 and t0 never collide.
+    enum class RegisterClass : uint8 { CBV, SRV, UAV, Sampler };
+
+    struct RegisterRange {
+        RegisterClass registerClass;
+        uint32 space;
+        uint64 first;
+        uint64 end;             // Exclusive
+        RootVisibility visibility;
+        uint32 parameter;
+    };
+
+    RegisterClass ToRegisterClass(DescriptorRangeKind kind) {
+        switch (kind) {
+        case DescriptorRangeKind::ShaderResource: return RegisterClass::SRV;
+        case DescriptorRangeKind::UnorderedAccess: return RegisterClass::UAV;
+        case DescriptorRangeKind::ConstantBuffer: return RegisterClass::CBV;
+        default: return RegisterClass::Sampler;
+        }
+    }
+
+    RegisterClass ToRegisterClass(RootParameterKind kind) {
+        switch (kind) {
+        case RootParameterKind::ShaderResource: return RegisterClass::SRV;
+        case RootParameterKind::UnorderedAccess: return RegisterClass::UAV;
+        default: return RegisterClass::CBV;
+        }
+    }
+
+    bool VisibilityOverlaps(RootVisibility a, RootVisibility b) {
+        return a == RootVisibility::All || b == RootVisibility::All || a == b;
+    }
+}
+
+uint32 RootParameterDesc::GetCost() const {
+    switch (kind) {
+    case RootParameterKind::Constants: return num32BitValues;
+    case RootParameterKind::DescriptorTable: return 1;
+    default: return 2;     // 64-bit GPU virtual address
+    }
+}
+
+uint32 RootSignatureDesc::AddConstants(uint32 num32BitValues, uint32 shaderRegister, uint32 space,
+                                       RootVisibility visibility) {
+    RootParameterDesc parameter;
+    parameter.kind = RootParameterKind::Constants;
+    parameter.visibility = visibility;
+    parameter.shaderRegister = shaderRegister;
+    parameter.space = space;
+    parameter.num32BitValues = num32BitValues;
+    m_parameters.push_back(std::move(parameter));
+    return GetParameterCount() - 1;
+}
+
+uint32 RootSignatureDesc::AddConstantBuffer(uint32 shaderRegister, uint32 space, RootVisibility visibility,
+                                            RootDataVolatility data) {
+    RootParameterDesc parameter;
+    parameter.kind = RootParameterKind::ConstantBuffer;
+    parameter.visibility = visibility;
+    parameter.shaderRegister = shaderRegister;
+    parameter.space = space;
+    parameter.data = data;
+    m_parameters.push_back(std::move(parameter));
+    return GetParameterCount() - 1;
+}
+
+uint32 RootSignatureDesc::AddShaderResource(uint32 shaderRegister, uint32 space, RootVisibility visibility,
+                                            RootDataVolatility data) {
+    RootParameterDesc parameter;
+    parameter.kind = RootParameterKind::ShaderResource;
+    parameter.visibility = visibility;
+    parameter.shaderRegister = shaderRegister;
+    parameter.space = space;
+    parameter.data = data;
+    m_parameters.push_back(std::move(parameter));
+    return GetParameterCount() - 1;
+}
+
+uint32 RootSignatureDesc::AddDescriptorTable(const Vector<DescriptorRangeDesc>& ranges, RootVisibility visibility) {
+    RootParameterDesc parameter;
+    parameter.kind = RootParameterKind::DescriptorTable;
+    parameter.visibility = visibility;
+    parameter.ranges = ranges;
+    m_parameters.push_back(std::move(parameter));
+    return GetParameterCount() - 1;
+}
+
+uint32 RootSignatureDesc::GetCost() const {
+    uint32 cost = 0;
+    for (const auto& parameter : m_parameters) {
+        cost += parameter.GetCost();
+    }
+    return cost;
+}
+
+String RootSignatureDesc::Validate() const {
+    uint32 cost = GetCost();
+    if (cost > MaxCost) {
+        return "Root signature costs " + std::to_string(cost) + " DWORDs, the limit is " + std::to_string(MaxCost);
+    }
+
+    Vector<RegisterRange> claimed;
+    for (uint32 i = 0; i < GetParameterCount(); ++i) {
+        const auto& parameter = m_parameters[i];
+
+        if (parameter.kind == RootParameterKind::Constants && parameter.num32BitValues == 0) {
+            return "Root parameter " + std::to_string(i) + " has no constants";
+        }
+
+        if (parameter.kind != RootParameterKind::DescriptorTable) {
+            claimed.push_back({ ToRegisterClass(parameter.kind), parameter.space, parameter.shaderRegister,
+                                uint64(parameter.shaderRegister) + 1, parameter.visibility, i });
+            continue;
+        }
+
+        if (parameter.ranges.empty()) {
+            return "Descriptor table " + std::to_string(i) + " has no ranges";
+        }
+
+        bool hasSampler = false;
+        bool hasView = false;
+        for (const auto& range : parameter.ranges) {
+            if (range.count == 0) {
+                return "Descriptor table " + std::to_string(i) + " has an empty range";
+            }
+
+            (range.kind == DescriptorRangeKind::Sampler ? hasSampler : hasView) = true;
+
+            uint64 end = (range.count == DescriptorRangeDesc::Unbounded)
+                ? uint64(UINT32_MAX) + 1
+                : uint64(range.baseRegister) + range.count;
+            claimed.push_back({ ToRegisterClass(range.kind), range.space, range.baseRegister, end,
+                                parameter.visibility, i });
+        }
+
+        if (hasSampler && hasView) {
+            return "Descriptor table " + std::to_string(i) + " mixes samplers with other descriptors";
+        }
+    }
+
+    for (size_t a = 0; a < claimed.size(); ++a) {
+        for (size_t b = a + 1; b < claimed.size(); ++b) {
+            const auto& x = claimed[a];
+            const auto& y = claimed[b];
+            if (x.registerClass != y.registerClass || x.space != y.space) continue;
+            if (!VisibilityOverlaps(x.visibility, y.visibility)) continue;
+            if (x.first < y.end && y.first < x.end) {
+                return "Root parameters " + std::to_string(x.parameter) + " and " + std::to_string(y.parameter) +
+                       " bind overlapping registers in space " + std::to_string(x.space);
+            }
+        }
+    }
+
+    return String();
+}
+
+RootSignatureDesc BuildSceneRootSignatureDesc(uint32 textureTableCapacity) {
+    RootSignatureDesc desc;
+
+    desc.AddConstants(DrawConstantCount, 0);
+    desc.AddShaderResource(1);
+    desc.AddShaderResource(2, 0, RootVisibility::Vertex);
+    desc.AddConstantBuffer(1);
+
+    // Materials are rewritten into the frame's buffer before the frame is submitted.
+    DescriptorRangeDesc materials;
+    materials.kind = DescriptorRangeKind::ShaderResource;
+    materials.count = 1;
+    materials.baseRegister = 0;
+    desc.AddDescriptorTable({ materials }, RootVisibility::Pixel);
+
+    // New textures are written into free slots while earlier frames still read the
+    // table, so its descriptors are volatile. Above 127 slots the table needs resource
+    // binding tier 2, see DescriptorHeapManager::GetMaxTextureTableCapacity.
+    DescriptorRangeDesc textures;
+    textures.kind = DescriptorRangeKind::ShaderResource;
+    textures.count = textureTableCapacity;
+    textures.baseRegister = 0;
+    textures.space = 1;
+    textures.volatileDescriptors = true;
+    desc.AddDescriptorTable({ textures }, RootVisibility::Pixel);
+
+    return desc;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Types.h>
+
+// Device-independent description of a root signature. It mirrors the D3D12 1.1 layout
+// closely enough to be turned into one by CreateRootSignature, but can be built,
+// costed and validated without a device.
+
+enum class RootParameterKind : uint8 {
+    Constants,
+    ConstantBuffer,         // Root CBV
+    ShaderResource,         // Root SRV
+    UnorderedAccess,        // Root UAV
+    DescriptorTable
+};
+
+enum class DescriptorRangeKind : uint8 {
+    ShaderResource,
+    UnorderedAccess,
+    ConstantBuffer,
+    Sampler
+};
+
+enum class RootVisibility : uint8 {
+    All,
+    Vertex,
+    Pixel
+};
+
+// How long the data behind a descriptor stays unchanged. Becomes the 1.1 DATA_* flag;
+// version 1.0 treats everything as Volatile.
+enum class RootDataVolatility : uint8 {
+    Static,                 // Never changes after the descriptor is written
+    StaticWhileSetAtExecute,// Unchanged while a command list using it executes
+    Volatile
+};
+
+struct DescriptorRangeDesc {
+    static constexpr uint32 Unbounded = UINT32_MAX;
+
+    DescriptorRangeKind kind = DescriptorRangeKind::ShaderResource;
+    uint32 count = 1;
+    uint32 baseRegister = 0;
+    uint32 space = 0;
+
+    // Descriptors may be written while a command list using the table executes.
+    bool volatileDescriptors = false;
+    RootDataVolatility data = RootDataVolatility::StaticWhileSetAtExecute;
+};
+
+struct RootParameterDesc {
+    RootParameterKind kind = RootParameterKind::Constants;
+    RootVisibility visibility = RootVisibility::All;
+
+    // Constants and root descriptors
+    uint32 shaderRegister = 0;
+    uint32 space = 0;
+    uint32 num32BitValues = 0;
+    RootDataVolatility data = RootDataVolatility::StaticWhileSetAtExecute;
+
+    // Descriptor tables
+    Vector<DescriptorRangeDesc> ranges;
+
+    // DWORDs the parameter takes from the 64 DWORD root signature budget.
+    uint32 GetCost() const;
+};
+
+class RootSignatureDesc {
+public:
+    static constexpr uint32 MaxCost = 64;
+
+    // Each Add returns the index of the new root parameter.
+    uint32 AddConstants(uint32 num32BitValues, uint32 shaderRegister, uint32 space = 0,
+                        RootVisibility visibility = RootVisibility::All);
+    uint32 AddConstantBuffer(uint32 shaderRegister, uint32 space = 0,
+                             RootVisibility visibility = RootVisibility::All,
+                             RootDataVolatility data = RootDataVolatility::StaticWhileSetAtExecute);
+    uint32 AddShaderResource(uint32 shaderRegister, uint32 space = 0,
+                             RootVisibility visibility = RootVisibility::All,
+                             RootDataVolatility data = RootDataVolatility::StaticWhileSetAtExecute);
+    uint32 AddDescriptorTable(const Vector<DescriptorRangeDesc>& ranges,
+                              RootVisibility visibility = RootVisibility::All);
+
+    uint32 GetParameterCount() const { return static_cast<uint32>(m_parameters.size()); }
+    const RootParameterDesc& GetParameter(uint32 index) const { return m_parameters[index]; }
+    const Vector<RootParameterDesc>& GetParameters() const { return m_parameters; }
+
+    uint32 GetCost() const;
+
+    // Checks the cost budget, that tables are not empty and that no two bindings visible
+    // to the same stage claim the same register. Returns an empty string when valid.
+    String Validate() const;
+
+private:
+    Vector<RootParameterDesc> m_parameters;
+};
+
+// Root parameter slots of the scene root signature. Parameters that change per draw
+// come first.
+enum RootParameter : uint32 {
+    RootParamDrawConstants = 0, // Root constants b0: DrawConstants
+    RootParamObjectBuffer,      // Root SRV t1: StructuredBuffer of ObjectData
+    RootParamInstanceList,      // Root SRV t2: StructuredBuffer of draw IDs for instanced draws
+    RootParamPassCB,            // Root CBV b1: PassConstants
+    RootParamMaterialTable,     // SRV table t0: StructuredBuffer of MaterialConstants
+    RootParamTextureTable,      // Bindless Texture2D table, t0 space1
+    RootParamCount
+};
+
+// InstanceOffset value of draws that don't use the instance list.
+static constexpr uint32 NoInstanceList = UINT32_MAX;
+
+// The shader reads object DrawId + SV_InstanceID, so one draw can cover consecutive objects.
+// With an InstanceOffset it reads the draw IDs at InstanceOffset + SV_InstanceID of the
+// instance list instead, so one draw can cover any set of objects.
+struct DrawConstants {
+    uint32 DrawId = 0;
+    uint32 InstanceOffset = NoInstanceList;
+};
+
+static constexpr uint32 DrawConstantCount = sizeof(DrawConstants) / sizeof(uint32);
+
+// Layout matching RootParameter, for a bindless table of textureTableCapacity entries.
+RootSignatureDesc BuildSceneRootSignatureDesc(uint32 textureTableCapacity);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Types.h>
+
+class IRenderObject;
+
+// Components of renderable entities in EntityWorld. Plain data without DirectXMath types
+// so systems over them also run without the Windows headers.
+
+struct Position {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+// Unit quaternion.
+struct Rotation {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float w = 1.0f;
+};
+
+struct Scale {
+    float x = 1.0f;
+    float y = 1.0f;
+    float z = 1.0f;
+};
+
+// Row-major, laid out like XMFLOAT4X4: translation in the last row.
+struct WorldMatrix {
+    float m[16] = { 1.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f, 1.0f, 0.0f, 0.0f,
+                    0.0f, 0.0f, 1.0f, 0.0f,
+                    0.0f, 0.0f, 0.0f, 1.0f };
+};
+
+struct MeshRef {
+    Handle mesh;
+    uint32 submesh = 0;
+};
+
+struct MaterialRef {
+    Handle material;
+};
+
+// Render object whose world matrix the entity drives. The object must outlive the entity.
+struct RenderObjectRef {
+    IRenderObject* object = nullptr;
+};
+
+enum EntityFlagBits : uint32 {
+    EntityFlagNone = 0,
+    EntityFlagTransformDirty = 1u << 0,     // Position, rotation or scale changed
+    EntityFlagWorldChanged = 1u << 1,       // World matrix was rebuilt, GPU copy is stale
+    EntityFlagStatic = 1u << 2,             // Never moves after creation
+    EntityFlagTransparent = 1u << 3,
+    EntityFlagHidden = 1u << 4,
+};
+
+struct EntityFlags {
+    uint32 bits = EntityFlagTransformDirty;
+};
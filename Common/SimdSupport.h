@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Types.h>
+
+// x86 SIMD helpers for kernels with SSE and AVX2 paths. SSE2 is always there on x64;
+// AVX2 functions carry SIMD_TARGET_AVX2 so GCC and Clang compile them without
+// -mavx2, and are only called once SupportsAVX2 returned true.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace Simd {
+    // AVX2 and FMA supported by the CPU and enabled by the OS. Detected once.
+    bool SupportsAVX2();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Types.h>
+
+// Container addressed by generation-checked handles. Values are packed densely so
+// iteration walks one contiguous array, and insert and erase are O(1): erasing moves
+// the last value into the hole, so iteration order is insertion order until then.
+//
+// Handle.index is the slot, which stays the same for the value's lifetime and can
+// be used as a stable table index. Slot 0 is never used, so a default Handle is
+// invalid. Erasing a value bumps its slot's generation, so stale handles resolve
+// to nullptr instead of whatever takes the slot over.
+template<typename T>
+class SlotMap {
+public:
+    SlotMap() {
+        m_slots.emplace_back();     // Slot 0 stays unused
+    }
+
+    template<typename... Args>
+    Handle Emplace(Args&&... args) {
+        Handle handle;
+        if (!m_freeSlots.empty()) {
+            handle.index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else {
+            handle.index = static_cast<uint32>(m_slots.size());
+            m_slots.emplace_back();
+        }
+
+        Slot& slot = m_slots[handle.index];
+        slot.dense = static_cast<uint32>(m_values.size());
+        handle.generation = slot.generation;
+
+        m_values.emplace_back(std::forward<Args>(args)...);
+        m_denseToSlot.push_back(handle.index);
+        return handle;
+    }
+
+    Handle Insert(T value) { return Emplace(std::move(value)); }
+
+    // Returns false when the handle is stale or invalid.
+    bool Erase(Handle handle) {
+        if (!Contains(handle)) return false;
+
+        Slot& slot = m_slots[handle.index];
+        uint32 last = static_cast<uint32>(m_values.size()) - 1;
+        if (slot.dense != last) {
+            m_values[slot.dense] = std::move(m_values[last]);
+            m_denseToSlot[slot.dense] = m_denseToSlot[last];
+            m_slots[m_denseToSlot[last]].dense = slot.dense;
+        }
+        m_values.pop_back();
+        m_denseToSlot.pop_back();
+
+        slot.dense = InvalidDense;
+        ++slot.generation;
+        m_freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    bool Contains(Handle handle) const {
+        return handle.index != 0 && handle.index < m_slots.size() &&
+               m_slots[handle.index].generation == handle.generation &&
+               m_slots[handle.index].dense != InvalidDense;
+    }
+
+    // nullptr when the handle is stale. The pointer is invalidated by Emplace and Erase.
+    T* Get(Handle handle) { return Contains(handle) ? &m_values[m_slots[handle.index].dense] : nullptr; }
+    const T* Get(Handle handle) const { return Contains(handle) ? &m_values[m_slots[handle.index].dense] : nullptr; }
+
+    // Handle of the value at dense position i, for iterating values and handles together.
+    Handle GetHandle(uint32 i) const {
+        uint32 index = m_denseToSlot[i];
+        return { index, m_slots[index].generation };
+    }
+
+    void Clear() {
+        for (uint32 index : m_denseToSlot) {
+            m_slots[index].dense = InvalidDense;
+            ++m_slots[index].generation;
+            m_freeSlots.push_back(index);
+        }
+        m_values.clear();
+        m_denseToSlot.clear();
+    }
+
+    void Reserve(uint32 count) {
+        m_values.reserve(count);
+        m_denseToSlot.reserve(count);
+        m_slots.reserve(count + 1);
+    }
+
+    uint32 Size() const { return static_cast<uint32>(m_values.size()); }
+    bool Empty() const { return m_values.empty(); }
+
+    // One past the highest slot ever used; bounds Handle.index.
+    uint32 GetSlotCount() const { return static_cast<uint32>(m_slots.size()); }
+
+    T* Data() { return m_values.data(); }
+    const T* Data() const { return m_values.data(); }
+
+    typename Vector<T>::iterator begin() { return m_values.begin(); }
+    typename Vector<T>::iterator end() { return m_values.end(); }
+    typename Vector<T>::const_iterator begin() const { return m_values.begin(); }
+    typename Vector<T>::const_iterator end() const { return m_values.end(); }
+
+private:
+    static constexpr uint32 InvalidDense = UINT32_MAX;
+
+    struct Slot {
+        uint32 dense = InvalidDense;
+        uint32 generation = 1;
+    };
+
+    Vector<T> m_values;
+    Vector<uint32> m_denseToSlot;
+    Vector<Slot> m_slots;
+    Vector<uint32> m_freeSlots;
+};
@@ -0,0 +1,343 @@
+#include "StaticBatcher.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    constexpr uint32 CacheMagic = 0x54414253;      // "SBAT"
+    constexpr uint32 CacheVersion = 1;
+
+    // Sources per batch of parallel work; most static props are a few hundred vertices.
+    constexpr uint32 SourcesPerTask = 16;
+
+    struct CacheHeader {
+        uint32 magic;
+        uint32 version;
+        uint64 sourceHash;
+        float cellSize;
+        uint32 batchCount;
+        uint32 vertexCount;
+        uint32 indexCount;
+    };
+
+    // Where a source's geometry lands, filled in by the grouping pass.
+    struct SourcePlacement {
+        uint32 firstVertex = 0;         // Lowest referenced vertex, baseVertex included
+        uint32 vertexCount = 0;         // Referenced vertex range, 0 for skipped sources
+        int32 cellX = 0;
+        int32 cellZ = 0;
+        uint32 batch = 0;
+        uint32 vertexOffset = 0;        // Within the batch
+        uint32 indexOffset = 0;
+        bool outOfRange = false;
+    };
+
+    uint32 ReadIndex(const StaticBatchSource& source, uint32 i) {
+        if (source.indexSize == 4) return static_cast<const uint32*>(source.indices)[source.startIndex + i];
+        return static_cast<const uint16*>(source.indices)[source.startIndex + i];
+    }
+
+    uint64 HashBytes(uint64 hash, const void* data, size_t size) {
+        const uint8* bytes = static_cast<const uint8*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    template<typename T>
+    uint64 HashValue(uint64 hash, const T& value) {
+        return HashBytes(hash, &value, sizeof(T));
+    }
+
+    void RunRange(WorkerPool* pool, uint32 count, uint32 minBatch, const Function<void(uint32, uint32)>& fn) {
+        if (pool && count > minBatch) {
+            pool->ParallelFor(count, minBatch, fn);
+        }
+        else {
+            fn(0, count);
+        }
+    }
+
+    // Finds the referenced vertex range and the grid cell of the bounds center.
+    void PlaceSource(const StaticBatchSource& source, float cellSize, SourcePlacement& placement) {
+        if (!source.vertices || !source.indices || source.indexCount == 0) return;
+
+        uint32 minIndex = UINT32_MAX, maxIndex = 0;
+        for (uint32 i = 0; i < source.indexCount; ++i) {
+            uint32 index = ReadIndex(source, i);
+            minIndex = std::min(minIndex, index);
+            maxIndex = std::max(maxIndex, index);
+        }
+
+        int64 first = static_cast<int64>(minIndex) + source.baseVertex;
+        int64 last = static_cast<int64>(maxIndex) + source.baseVertex;
+        if (first < 0 || last >= source.vertexCount) {
+            placement.outOfRange = true;
+            return;
+        }
+        placement.firstVertex = static_cast<uint32>(first);
+        placement.vertexCount = static_cast<uint32>(last - first + 1);
+
+        float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (uint32 v = 0; v < placement.vertexCount; ++v) {
+            const float* p = source.vertices[placement.firstVertex + v].position;
+            for (uint32 k = 0; k < 3; ++k) {
+                lo[k] = std::min(lo[k], p[k]);
+                hi[k] = std::max(hi[k], p[k]);
+            }
+        }
+
+        const float* m = source.world;
+        float c[3] = { 0.5f * (lo[0] + hi[0]), 0.5f * (lo[1] + hi[1]), 0.5f * (lo[2] + hi[2]) };
+        float worldX = c[0] * m[0] + c[1] * m[4] + c[2] * m[8] + m[12];
+        float worldZ = c[0] * m[2] + c[1] * m[6] + c[2] * m[10] + m[14];
+        placement.cellX = static_cast<int32>(std::floor(worldX / cellSize));
+        placement.cellZ = static_cast<int32>(std::floor(worldZ / cellSize));
+    }
+
+    // Writes the source's vertices in world space and its indices relative to the batch.
+    void MergeSource(const StaticBatchSource& source, const SourcePlacement& placement, const StaticBatch& batch,
+                     StaticBatchVertex* vertices, uint32* indices) {
+        const float* m = source.world;
+
+        // Normals go through the inverse transpose, which is the cofactor matrix up to the
+        // determinant's scale. A negative determinant also mirrors the triangles.
+        float cofactor[9] = {
+            m[5] * m[10] - m[6] * m[9], m[6] * m[8] - m[4] * m[10], m[4] * m[9] - m[5] * m[8],
+            m[2] * m[9] - m[1] * m[10], m[0] * m[10] - m[2] * m[8], m[1] * m[8] - m[0] * m[9],
+            m[1] * m[6] - m[2] * m[5], m[2] * m[4] - m[0] * m[6], m[0] * m[5] - m[1] * m[4],
+        };
+        float det = m[0] * cofactor[0] + m[1] * cofactor[1] + m[2] * cofactor[2];
+        float sign = (det < 0.0f) ? -1.0f : 1.0f;
+
+        StaticBatchVertex* dst = vertices + batch.baseVertex + placement.vertexOffset;
+        for (uint32 v = 0; v < placement.vertexCount; ++v) {
+            const StaticBatchVertex& in = source.vertices[placement.firstVertex + v];
+            StaticBatchVertex& out = dst[v];
+
+            const float* p = in.position;
+            for (uint32 k = 0; k < 3; ++k) {
+                out.position[k] = p[0] * m[k] + p[1] * m[4 + k] + p[2] * m[8 + k] + m[12 + k];
+            }
+
+            const float* n = in.normal;
+            float normal[3];
+            for (uint32 k = 0; k < 3; ++k) {
+                normal[k] = sign * (n[0] * cofactor[k] + n[1] * cofactor[3 + k] + n[2] * cofactor[6 + k]);
+            }
+            float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            float scale = (length > 0.0f) ? 1.0f / length : 0.0f;
+            for (uint32 k = 0; k < 3; ++k) out.normal[k] = normal[k] * scale;
+
+            out.texCoord[0] = in.texCoord[0];
+            out.texCoord[1] = in.texCoord[1];
+        }
+
+        uint32* out = indices + batch.startIndex + placement.indexOffset;
+        uint32 rebase = placement.vertexOffset - placement.firstVertex + static_cast<uint32>(source.baseVertex);
+        for (uint32 i = 0; i < source.indexCount; ++i) {
+            out[i] = ReadIndex(source, i) + rebase;
+        }
+        if (det < 0.0f) {
+            for (uint32 i = 0; i + 2 < source.indexCount; i += 3) std::swap(out[i + 1], out[i + 2]);
+        }
+    }
+}
+
+void StaticBatcher::Clear() {
+    m_batches.clear();
+    m_vertices.clear();
+    m_indices.clear();
+    m_stats = Stats();
+}
+
+void StaticBatcher::Build(const Vector<StaticBatchSource>& sources, WorkerPool* pool) {
+    Clear();
+    uint32 sourceCount = static_cast<uint32>(sources.size());
+
+    Vector<SourcePlacement> placements(sourceCount);
+    RunRange(pool, sourceCount, SourcesPerTask, [&](uint32 begin, uint32 end) {
+        for (uint32 i = begin; i < end; ++i) PlaceSource(sources[i], m_cellSize, placements[i]);
+    });
+
+    Vector<uint32> order;
+    order.reserve(sourceCount);
+    for (uint32 i = 0; i < sourceCount; ++i) {
+        if (placements[i].outOfRange) throw std::runtime_error("StaticBatcher: submesh indexes past its vertices");
+        if (placements[i].vertexCount > 0) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](uint32 a, uint32 b) {
+        const SourcePlacement& pa = placements[a];
+        const SourcePlacement& pb = placements[b];
+        if (sources[a].material != sources[b].material) return sources[a].material < sources[b].material;
+        if (pa.cellX != pb.cellX) return pa.cellX < pb.cellX;
+        if (pa.cellZ != pb.cellZ) return pa.cellZ < pb.cellZ;
+        return a < b;
+    });
+
+    // Lay out every batch and every source's slice of it before anything is written, so
+    // the sources can then be merged independently.
+    uint32 vertexTotal = 0, indexTotal = 0;
+    for (uint32 sourceIndex : order) {
+        const StaticBatchSource& source = sources[sourceIndex];
+        SourcePlacement& placement = placements[sourceIndex];
+
+        StaticBatch* batch = m_batches.empty() ? nullptr : &m_batches.back();
+        if (!batch || batch->material != source.material || batch->cellX != placement.cellX ||
+            batch->cellZ != placement.cellZ) {
+            m_batches.push_back({ source.material, placement.cellX, placement.cellZ, vertexTotal, 0, indexTotal, 0, 0,
+                                  { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } });
+            batch = &m_batches.back();
+        }
+
+        placement.batch = static_cast<uint32>(m_batches.size() - 1);
+        placement.vertexOffset = batch->vertexCount;
+        placement.indexOffset = batch->indexCount;
+        batch->vertexCount += placement.vertexCount;
+        batch->indexCount += source.indexCount;
+        ++batch->sourceCount;
+        vertexTotal += placement.vertexCount;
+        indexTotal += source.indexCount;
+    }
+
+    m_vertices.resize(vertexTotal);
+    m_indices.resize(indexTotal);
+    RunRange(pool, static_cast<uint32>(order.size()), SourcesPerTask, [&](uint32 begin, uint32 end) {
+        for (uint32 i = begin; i < end; ++i) {
+            const SourcePlacement& placement = placements[order[i]];
+            MergeSource(sources[order[i]], placement, m_batches[placement.batch], m_vertices.data(), m_indices.data());
+        }
+    });
+
+    RunRange(pool, static_cast<uint32>(m_batches.size()), 1, [&](uint32 begin, uint32 end) {
+        for (uint32 b = begin; b < end; ++b) {
+            StaticBatch& batch = m_batches[b];
+            float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+            float hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            for (uint32 v = 0; v < batch.vertexCount; ++v) {
+                const float* p = m_vertices[batch.baseVertex + v].position;
+                for (uint32 k = 0; k < 3; ++k) {
+                    lo[k] = std::min(lo[k], p[k]);
+                    hi[k] = std::max(hi[k], p[k]);
+                }
+            }
+            for (uint32 k = 0; k < 3; ++k) {
+                batch.center[k] = 0.5f * (lo[k] + hi[k]);
+                batch.extents[k] = 0.5f * (hi[k] - lo[k]);
+            }
+        }
+    });
+
+    // Unbatched, sources sharing a submesh share its buffers too.
+    Vector<std::pair<const void*, const void*>> submeshes;
+    submeshes.reserve(order.size());
+    for (uint32 sourceIndex : order) {
+        const StaticBatchSource& source = sources[sourceIndex];
+        const SourcePlacement& placement = placements[sourceIndex];
+        const uint8* firstIndex = static_cast<const uint8*>(source.indices) + source.startIndex * source.indexSize;
+        submeshes.push_back({ source.vertices + placement.firstVertex, firstIndex });
+    }
+    Vector<uint32> distinct(order.size());
+    for (uint32 i = 0; i < distinct.size(); ++i) distinct[i] = i;
+    std::sort(distinct.begin(), distinct.end(), [&](uint32 a, uint32 b) { return submeshes[a] < submeshes[b]; });
+
+    m_stats.sourceCount = static_cast<uint32>(order.size());
+    m_stats.batchCount = static_cast<uint32>(m_batches.size());
+    for (uint32 i = 0; i < distinct.size(); ++i) {
+        if (i > 0 && submeshes[distinct[i]] == submeshes[distinct[i - 1]]) continue;
+
+        const StaticBatchSource& source = sources[order[distinct[i]]];
+        m_stats.sourceBytes += static_cast<uint64>(placements[order[distinct[i]]].vertexCount) * sizeof(StaticBatchVertex) +
+                               static_cast<uint64>(source.indexCount) * source.indexSize;
+    }
+    m_stats.batchBytes = static_cast<uint64>(vertexTotal) * sizeof(StaticBatchVertex) +
+                         static_cast<uint64>(indexTotal) * sizeof(uint32);
+}
+
+uint64 StaticBatcher::HashSources(const Vector<StaticBatchSource>& sources) const {
+    uint64 hash = 0xcbf29ce484222325ull;
+    hash = HashValue(hash, CacheVersion);
+    hash = HashValue(hash, m_cellSize);
+    hash = HashValue(hash, static_cast<uint64>(sources.size()));
+
+    // Meshes are usually shared by many sources, so each one's contents are hashed once
+    // and later sources hash its number instead.
+    HashMap<const void*, uint32> meshes;
+    HashMap<const void*, uint32> indexRanges;
+    for (const StaticBatchSource& source : sources) {
+        auto mesh = meshes.emplace(source.vertices, static_cast<uint32>(meshes.size()));
+        if (mesh.second && source.vertices) {
+            hash = HashBytes(hash, source.vertices, static_cast<size_t>(source.vertexCount) * sizeof(StaticBatchVertex));
+        }
+        hash = HashValue(hash, mesh.first->second);
+        hash = HashValue(hash, source.vertexCount);
+
+        const uint8* firstIndex = static_cast<const uint8*>(source.indices) + source.startIndex * source.indexSize;
+        auto range = indexRanges.emplace(firstIndex, source.indexCount);
+        if ((range.second || range.first->second != source.indexCount) && source.indices) {
+            hash = HashBytes(hash, firstIndex, static_cast<size_t>(source.indexCount) * source.indexSize);
+            range.first->second = source.indexCount;
+        }
+        hash = HashValue(hash, source.indexSize);
+        hash = HashValue(hash, source.indexCount);
+        hash = HashValue(hash, source.baseVertex);
+        hash = HashBytes(hash, source.world, sizeof(source.world));
+        hash = HashValue(hash, source.material);
+    }
+    return hash;
+}
+
+bool StaticBatcher::SaveCache(const String& path, uint64 sourceHash) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    CacheHeader header = { CacheMagic, CacheVersion, sourceHash, m_cellSize, static_cast<uint32>(m_batches.size()),
+                           static_cast<uint32>(m_vertices.size()), static_cast<uint32>(m_indices.size()) };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&m_stats), sizeof(m_stats));
+    file.write(reinterpret_cast<const char*>(m_batches.data()), m_batches.size() * sizeof(StaticBatch));
+    file.write(reinterpret_cast<const char*>(m_vertices.data()), m_vertices.size() * sizeof(StaticBatchVertex));
+    file.write(reinterpret_cast<const char*>(m_indices.data()), m_indices.size() * sizeof(uint32));
+    return static_cast<bool>(file);
+}
+
+bool StaticBatcher::LoadCache(const String& path, uint64 sourceHash) {
+    Clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CacheMagic ||
+        header.version != CacheVersion || header.sourceHash != sourceHash || header.cellSize != m_cellSize) {
+        return false;
+    }
+
+    m_batches.resize(header.batchCount);
+    m_vertices.resize(header.vertexCount);
+    m_indices.resize(header.indexCount);
+    file.read(reinterpret_cast<char*>(&m_stats), sizeof(m_stats));
+    file.read(reinterpret_cast<char*>(m_batches.data()), m_batches.size() * sizeof(StaticBatch));
+    file.read(reinterpret_cast<char*>(m_vertices.data()), m_vertices.size() * sizeof(StaticBatchVertex));
+    file.read(reinterpret_cast<char*>(m_indices.data()), m_indices.size() * sizeof(uint32));
+
+    bool valid = static_cast<bool>(file);
+    for (const StaticBatch& batch : m_batches) {
+        valid = valid && static_cast<uint64>(batch.baseVertex) + batch.vertexCount <= m_vertices.size() &&
+                static_cast<uint64>(batch.startIndex) + batch.indexCount <= m_indices.size();
+
+        // Indices are relative to the batch's vertices; one past them would read another
+        // batch's geometry, or past the buffer.
+        for (uint32 i = 0; valid && i < batch.indexCount; ++i) {
+            valid = m_indices[batch.startIndex + i] < batch.vertexCount;
+        }
+    }
+    if (!valid) Clear();
+    return valid;
+}
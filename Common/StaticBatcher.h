@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Types.h>
+
+class WorkerPool;
+
+// Vertex layout of the scene's input layout: position, normal, texture coordinate.
+struct StaticBatchVertex {
+    float position[3];
+    float normal[3];
+    float texCoord[2];
+};
+
+// One static mesh to merge: a submesh range of indices into its mesh's vertices, placed
+// by a row-major world matrix. The geometry is only read during Build and HashSources.
+struct StaticBatchSource {
+    const StaticBatchVertex* vertices = nullptr;
+    uint32 vertexCount = 0;
+    const void* indices = nullptr;
+    uint32 indexSize = 2;           // Bytes per index, 2 or 4
+    uint32 startIndex = 0;
+    uint32 indexCount = 0;
+    int32 baseVertex = 0;
+    float world[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    uint32 material = 0;
+};
+
+// Geometry of one cell and material in the merged buffers. Indices are relative to
+// baseVertex, so the batch is drawn with DrawIndexedInstanced(indexCount, 1, startIndex,
+// baseVertex, 0).
+struct StaticBatch {
+    uint32 material;
+    int32 cellX;
+    int32 cellZ;
+    uint32 baseVertex;
+    uint32 vertexCount;
+    uint32 startIndex;
+    uint32 indexCount;
+    uint32 sourceCount;
+    float center[3];            // World bounds of the batch's vertices
+    float extents[3];
+};
+
+// Merges meshes that never move into one vertex and index buffer at load time. Sources
+// are pre-transformed into world space and grouped by material and by the XZ grid cell
+// holding their bounds center, so each cell and material becomes a single draw that can
+// still be culled by its cell bounds. Larger cells mean fewer draws but coarser culling.
+class StaticBatcher {
+public:
+    struct Stats {
+        uint32 sourceCount = 0;         // Draws without batching
+        uint32 batchCount = 0;          // Draws with batching
+        uint64 sourceBytes = 0;         // Geometry of the sources, each distinct submesh once
+        uint64 batchBytes = 0;          // Merged vertex and index buffers
+    };
+
+    explicit StaticBatcher(float cellSize = 64.0f) : m_cellSize(cellSize) {}
+
+    // Replaces the previous result. Sources are transformed on pool when given.
+    void Build(const Vector<StaticBatchSource>& sources, WorkerPool* pool = nullptr);
+
+    // Fingerprint of everything Build reads, so a cache made from other input is rejected.
+    uint64 HashSources(const Vector<StaticBatchSource>& sources) const;
+
+    // The cache is a binary dump of the result tagged with the sources' hash. Loading
+    // fails, leaving the batcher empty, when the file is missing, damaged or was made
+    // from other sources. Saving fails when the file can't be written.
+    bool SaveCache(const String& path, uint64 sourceHash) const;
+    bool LoadCache(const String& path, uint64 sourceHash);
+
+    void Clear();
+
+    float GetCellSize() const { return m_cellSize; }
+    const Vector<StaticBatch>& GetBatches() const { return m_batches; }
+    const Vector<StaticBatchVertex>& GetVertices() const { return m_vertices; }
+    const Vector<uint32>& GetIndices() const { return m_indices; }
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    float m_cellSize;
+    Vector<StaticBatch> m_batches;
+    Vector<StaticBatchVertex> m_vertices;
+    Vector<uint32> m_indices;
+    Stats m_stats;
+};
@@ -2,6 +2,8 @@
 
 #include "RenderObject.h"
 #include "RenderComponents.h"
+#include "DirtyRangeTracker.h"
+#include "FenceTimeline.h"
 
 class StaticMesh : public RenderObject<StaticMesh> {
 public:
@@ -10,10 +12,13 @@ public:
     StaticMesh(SharedPtr<IMeshComponent> mesh, 
                SharedPtr<IMaterialComponent> material,
                const String& submeshName = "default")
-        : m_mesh(mesh), m_material(material), m_submeshName(submeshName) {}
+        : m_mesh(mesh), m_material(material), m_submeshName(submeshName) {
+        ResolveSubmesh();
+    }
     
     void SetMesh(SharedPtr<IMeshComponent> mesh) {
         m_mesh = mesh;
+        ResolveSubmesh();
     }
     
     void SetMaterial(SharedPtr<IMaterialComponent> material) {
@@ -21,10 +26,19 @@ public:
         if (material) {
             m_isTransparent = material->IsTransparent();
         }
+        MarkDirty();    // The material index is part of the object data
     }
     
     void SetSubmeshName(const String& name) {
         m_submeshName = name;
+        ResolveSubmesh();
+    }
+
+    // Looks the submesh up by name again. SetMesh and SetSubmeshName already do; call it
+    // after editing the DrawArgs of the mesh in place.
+    void ResolveSubmesh() {
+        m_drawRecord = SubmeshDrawRecord::Resolve(m_mesh.get(), m_submeshName);
+        MarkDirty();    // The bounds feed the culling data
     }
     
     void SetTextures(SharedPtr<ITextureComponent> textures) {
@@ -38,16 +52,16 @@ public:
         // using FrameResource
     }
     
-    void PrepareRender(ID3D12GraphicsCommandList* cmdList) {
+    void PrepareRender(DrawBinder& binder) {
         // Set any common state before rendering
         // This can be overridden for specific preparation
     }
     
-    void BindResources(ID3D12GraphicsCommandList* cmdList) {
+    void BindResources(DrawBinder& binder) {
         if (!m_mesh || !m_material) return;
         
-        // Bind mesh geometry
-        m_mesh->BindGeometry(cmdList);
+        // Bind mesh geometry, skipped when the previous draw used the same mesh
+        binder.SetGeometry(m_mesh->GetMeshData());
         
         // For now, use descriptor table for compatibility with existing root signature
         // The constant buffer is already bound via descriptor heap in Graphics::DrawFrame
@@ -60,32 +74,39 @@ public:
         //     cmdList->SetPipelineState(m_material->GetPSO());
         // }
         
-        // Note: Material constants and textures binding commented out 
-        // until we extend the root signature
-        // m_material->BindMaterial(cmdList, 1);
-        // if (m_textures) {
-        //     m_textures->BindTextures(cmdList, 2);
-        // }
+        // Object data, materials and textures are bound once per frame; the draw only
+        // passes its draw ID.
+        DrawConstants constants;
+        constants.DrawId = m_cbElementIndex;
+        binder.SetConstants(RootParamDrawConstants, &constants, DrawConstantCount);
     }
     
     void Draw(ID3D12GraphicsCommandList* cmdList) {
-        if (!m_mesh || !m_material) return;
-        
-        if (!m_mesh->HasSubmesh(m_submeshName)) return;
-        
-        const auto& submesh = m_mesh->GetSubmesh(m_submeshName);
+        if (!m_material || !m_drawRecord.IsResolved()) return;
         
         cmdList->DrawIndexedInstanced(
-            submesh.IndexCount,
+            m_drawRecord.IndexCount,
             1,
-            submesh.StartIndexLocation,
-            submesh.BaseVertexLocation,
+            m_drawRecord.StartIndexLocation,
+            m_drawRecord.BaseVertexLocation,
             0
         );
     }
     
     SharedPtr<IMeshComponent> GetMesh() const { return m_mesh; }
     SharedPtr<IMaterialComponent> GetMaterial() const { return m_material; }
+    uint32 GetMaterialIndex() const override { return m_material ? m_material->GetMaterialIndex() : 0; }
+    const MeshGeometry* GetGeometry() const override { return m_mesh ? m_mesh->GetMeshData() : nullptr; }
+    const SubmeshDrawRecord* GetDrawRecord() const override {
+        return (m_material && m_drawRecord.IsResolved()) ? &m_drawRecord : nullptr;
+    }
+    ID3D12PipelineState* GetPipelineState() const override { return m_material ? m_material->GetPSO() : nullptr; }
+
+    bool GetLocalBounds(DirectX::BoundingBox& bounds) const override {
+        if (!m_drawRecord.IsResolved()) return false;
+        bounds = m_drawRecord.Bounds;
+        return true;
+    }
     SharedPtr<ITextureComponent> GetTextures() const { return m_textures; }
     const String& GetSubmeshName() const { return m_submeshName; }
     
@@ -99,86 +120,181 @@ private:
     SharedPtr<IMaterialComponent> m_material;
     SharedPtr<ITextureComponent> m_textures;
     String m_submeshName = "default";
+    SubmeshDrawRecord m_drawRecord;
 };
 
 class InstancedStaticMesh : public RenderObject<InstancedStaticMesh> {
 public:
+    // Read by the instanced input layout as WORLD0-3 and COLOR. Unlike the object data,
+    // World is not transposed: its rows become the vertex attributes.
     struct InstanceData {
         DirectX::XMFLOAT4X4 World;
         DirectX::XMFLOAT4 Color;
     };
     
+    // Reported once per frame through the statistics hook.
+    struct InstanceBufferStats {
+        uint32 FrameIndex = 0;          // Frame resource slot that was updated
+        uint32 InstanceCount = 0;
+        uint32 Capacity = 0;            // Capacity of the slot's buffer in instances
+        uint32 UploadedInstances = 0;
+        uint64 UploadedBytes = 0;
+        uint32 PendingReleases = 0;     // Retired buffers still waiting for the GPU
+        bool Resized = false;           // The slot's buffer was reallocated this frame
+    };
+    using StatsCallback = Function<void(const InstanceBufferStats&)>;
+    
+    static constexpr size_t MinInstanceCapacity = 64;
+    // Frames the instance count has to stay below a quarter of the capacity before shrinking.
+    static constexpr uint32 ShrinkDelayFrames = 120;
+    
     InstancedStaticMesh() = default;
     
     InstancedStaticMesh(SharedPtr<IMeshComponent> mesh,
                         SharedPtr<IMaterialComponent> material,
                         const String& submeshName = "default")
-        : m_mesh(mesh), m_material(material), m_submeshName(submeshName) {}
+        : m_mesh(mesh), m_material(material), m_submeshName(submeshName),
+          m_drawRecord(SubmeshDrawRecord::Resolve(mesh.get(), submeshName)) {}
     
     void AddInstance(const InstanceData& instance) {
         m_instances.push_back(instance);
-        m_instancesDirty = true;
+        MarkDirty(static_cast<uint32>(m_instances.size() - 1));
+        MarkBoundsDirty();
     }
     
     void ClearInstances() {
         m_instances.clear();
-        m_instancesDirty = true;
+        for (auto& frame : m_frameBuffers) {
+            frame.DirtyRanges.Clear();
+        }
+        MarkBoundsDirty();
     }
     
     void UpdateInstanceData(size_t index, const InstanceData& data) {
         if (index < m_instances.size()) {
             m_instances[index] = data;
-            m_instancesDirty = true;
+            MarkDirty(static_cast<uint32>(index));
+            MarkBoundsDirty();
+        }
+    }
+    
+    // Union of the submesh bounds placed by every instance's World. The instanced vertex
+    // shader ignores the object's own transform, so it must stay at identity for these
+    // bounds to match what is drawn. Recomputed on demand after the instances change.
+    bool GetLocalBounds(DirectX::BoundingBox& bounds) const override {
+        if (!m_drawRecord.IsResolved() || m_instances.empty()) return false;
+    
+        if (m_boundsDirty) {
+            m_drawRecord.Bounds.Transform(m_instanceBounds, DirectX::XMLoadFloat4x4(&m_instances[0].World));
+            for (size_t i = 1; i < m_instances.size(); ++i) {
+                DirectX::BoundingBox instanceBounds;
+                m_drawRecord.Bounds.Transform(instanceBounds, DirectX::XMLoadFloat4x4(&m_instances[i].World));
+                DirectX::BoundingBox::CreateMerged(m_instanceBounds, m_instanceBounds, instanceBounds);
+            }
+            m_boundsDirty = false;
+        }
+        bounds = m_instanceBounds;
+        return true;
+    }
+    
+    // Each in-flight frame gets its own instance buffer so we never write memory the GPU
+    // may still be reading. Buffers start at initialCapacity and grow as instances are added.
+    // With a fence timeline, replaced buffers are released through it; without one they
+    // wait until every frame resource has cycled once.
+    void InitializeInstanceBuffer(ID3D12Device* device, uint32 frameCount, FenceTimeline* fenceTimeline = nullptr,
+                                  size_t initialCapacity = MinInstanceCapacity) {
+        m_device = device;
+        m_fenceTimeline = fenceTimeline;
+        m_initialCapacity = std::max(initialCapacity, MinInstanceCapacity);
+        m_frameBuffers.clear();
+        m_frameBuffers.resize(frameCount);
+        m_currFrameIndex = 0;
+    }
+    
+    // Follows a change of the frames-in-flight count. The old buffers are retired, and the
+    // new slots are filled with every instance on their first update.
+    void SetFrameCount(uint32 frameCount) {
+        if (frameCount == m_frameBuffers.size()) return;
+    
+        for (auto& frame : m_frameBuffers) {
+            if (frame.Buffer) RetireBuffer(std::move(frame.Buffer));
         }
+        m_frameBuffers.clear();
+        m_frameBuffers.resize(frameCount);
+        m_currFrameIndex = 0;
     }
     
-    void InitializeInstanceBuffer(ID3D12Device* device, size_t maxInstances) {
-        m_instanceBuffer = UniquePtr<UploadBuffer<InstanceData>>(
-            new UploadBuffer<InstanceData>(device, static_cast<UINT>(maxInstances), false));
-        m_maxInstances = maxInstances;
+    // Selects the buffer slot matching the current frame resource. frameNumber is a
+    // monotonically increasing frame counter used to release retired buffers.
+    void SetFrameIndex(uint32 frameIndex, uint64 frameNumber) {
+        if (!m_frameBuffers.empty()) {
+            m_currFrameIndex = frameIndex % static_cast<uint32>(m_frameBuffers.size());
+        }
+        m_frameNumber = frameNumber;
+        ReleaseRetiredBuffers();
+    }
+    
+    void SetStatsCallback(StatsCallback callback) {
+        m_statsCallback = std::move(callback);
     }
     
     void UpdateInternal(float deltaTime) {
-        if (m_instancesDirty && m_instanceBuffer) {
-            UpdateInstanceBuffer();
-            m_instancesDirty = false;
+        if (m_frameBuffers.empty() || !m_device) return;
+    
+        InstanceBufferStats stats;
+        stats.FrameIndex = m_currFrameIndex;
+        stats.Resized = EnsureCapacity(m_frameBuffers[m_currFrameIndex]);
+        stats.UploadedInstances = UpdateInstanceBuffer(m_frameBuffers[m_currFrameIndex]);
+        stats.UploadedBytes = static_cast<uint64>(stats.UploadedInstances) * sizeof(InstanceData);
+        stats.InstanceCount = static_cast<uint32>(m_instances.size());
+        stats.Capacity = static_cast<uint32>(m_frameBuffers[m_currFrameIndex].Capacity);
+        stats.PendingReleases = static_cast<uint32>(m_retiredBuffers.size());
+    
+        if (m_statsCallback) {
+            m_statsCallback(stats);
         }
     }
     
-    void PrepareRender(ID3D12GraphicsCommandList* cmdList) {
+    void PrepareRender(DrawBinder& binder) {
         // Prepare for instanced rendering
     }
     
-    void BindResources(ID3D12GraphicsCommandList* cmdList) {
+    // Pipeline whose input layout reads InstanceData from vertex buffer slot 1. Graphics
+    // binds it before Render.
+    void SetPipelineState(ComPtr<ID3D12PipelineState> pso) { m_pipelineState = pso; }
+    ID3D12PipelineState* GetPipelineState() const override { return m_pipelineState.Get(); }
+    uint32 GetMaterialIndex() const override { return m_material ? m_material->GetMaterialIndex() : 0; }
+    
+    void BindResources(DrawBinder& binder) {
         if (!m_mesh || !m_material) return;
         
-        m_mesh->BindGeometry(cmdList);
+        ID3D12GraphicsCommandList* cmdList = binder.GetCommandList();
+        binder.SetGeometry(m_mesh->GetMeshData());
         
         // For instanced rendering, we'll need to set up instance buffer
-        if (m_instanceBuffer && !m_instances.empty()) {
+        const FrameInstanceBuffer* frame = CurrentFrameBuffer();
+        if (frame && frame->Buffer && !m_instances.empty()) {
             D3D12_VERTEX_BUFFER_VIEW instanceBufferView;
-            instanceBufferView.BufferLocation = m_instanceBuffer->Resource()->GetGPUVirtualAddress();
+            instanceBufferView.BufferLocation = frame->Buffer->Resource()->GetGPUVirtualAddress();
             instanceBufferView.StrideInBytes = sizeof(InstanceData);
-            instanceBufferView.SizeInBytes = static_cast<UINT>(m_instances.size() * sizeof(InstanceData));
+            instanceBufferView.SizeInBytes = static_cast<UINT>(GetDrawInstanceCount() * sizeof(InstanceData));
             
             cmdList->IASetVertexBuffers(1, 1, &instanceBufferView);
         }
         
-        m_material->BindMaterial(cmdList, 1);
+        DrawConstants constants;
+        constants.DrawId = m_cbElementIndex;
+        binder.SetConstants(RootParamDrawConstants, &constants, DrawConstantCount);
     }
     
     void Draw(ID3D12GraphicsCommandList* cmdList) {
-        if (!m_mesh || !m_material || m_instances.empty()) return;
-        
-        if (!m_mesh->HasSubmesh(m_submeshName)) return;
-        
-        const auto& submesh = m_mesh->GetSubmesh(m_submeshName);
+        if (!m_material || !m_drawRecord.IsResolved() || GetDrawInstanceCount() == 0) return;
         
         cmdList->DrawIndexedInstanced(
-            submesh.IndexCount,
-            static_cast<UINT>(m_instances.size()),
-            submesh.StartIndexLocation,
-            submesh.BaseVertexLocation,
+            m_drawRecord.IndexCount,
+            static_cast<UINT>(GetDrawInstanceCount()),
+            m_drawRecord.StartIndexLocation,
+            m_drawRecord.BaseVertexLocation,
             0
         );
     }
@@ -187,19 +303,123 @@ public:
     const Vector<InstanceData>& GetInstances() const { return m_instances; }
     
 private:
+    struct FrameInstanceBuffer {
+        UniquePtr<UploadBuffer<InstanceData>> Buffer;
+        size_t Capacity = 0;
+        uint32 LowUsageUpdates = 0;
+        DirtyRangeTracker DirtyRanges;
+    };
+    
+    struct RetiredBuffer {
+        UniquePtr<UploadBuffer<InstanceData>> Buffer;
+        uint64 ReleaseFrame = 0;    // First frame number at which the GPU can no longer use it
+    };
+    
     SharedPtr<IMeshComponent> m_mesh;
     SharedPtr<IMaterialComponent> m_material;
     String m_submeshName = "default";
+    SubmeshDrawRecord m_drawRecord;     // Resolved once, the mesh and name never change
+    ComPtr<ID3D12PipelineState> m_pipelineState;
     
     Vector<InstanceData> m_instances;
-    UniquePtr<UploadBuffer<InstanceData>> m_instanceBuffer;
-    size_t m_maxInstances = 0;
-    bool m_instancesDirty = true;
+    mutable DirectX::BoundingBox m_instanceBounds;
+    mutable bool m_boundsDirty = true;
+    
+    ID3D12Device* m_device = nullptr;
+    FenceTimeline* m_fenceTimeline = nullptr;
+    Vector<FrameInstanceBuffer> m_frameBuffers;
+    Vector<RetiredBuffer> m_retiredBuffers;
+    uint32 m_currFrameIndex = 0;
+    uint64 m_frameNumber = 0;
+    size_t m_initialCapacity = MinInstanceCapacity;
+    StatsCallback m_statsCallback;
+    
+    const FrameInstanceBuffer* CurrentFrameBuffer() const {
+        return m_frameBuffers.empty() ? nullptr : &m_frameBuffers[m_currFrameIndex];
+    }
+    
+    // Instances past the current slot's capacity are only possible before its first update.
+    size_t GetDrawInstanceCount() const {
+        const FrameInstanceBuffer* frame = CurrentFrameBuffer();
+        return frame ? std::min(m_instances.size(), frame->Capacity) : 0;
+    }
+    
+    void MarkDirty(uint32 index) {
+        for (auto& frame : m_frameBuffers) {
+            frame.DirtyRanges.MarkDirty(index);
+        }
+    }
+    
+    // Queues the object so Graphics picks up the new culling bounds.
+    void MarkBoundsDirty() {
+        m_boundsDirty = true;
+        IRenderObject::MarkDirty();
+    }
+    
+    // Grows the slot's buffer geometrically when the instances no longer fit, and
+    // halves it once the instance count stayed low for a while. Returns true when reallocated.
+    bool EnsureCapacity(FrameInstanceBuffer& frame) {
+        size_t count = m_instances.size();
+        size_t capacity = frame.Capacity;
+    
+        // Each slot is only updated every frameCount frames.
+        uint32 shrinkDelay = std::max(ShrinkDelayFrames / static_cast<uint32>(m_frameBuffers.size()), 1u);
+        if (count * 4 <= capacity && capacity > m_initialCapacity) {
+            ++frame.LowUsageUpdates;
+        }
+        else {
+            frame.LowUsageUpdates = 0;
+        }
+    
+        size_t newCapacity = capacity;
+        if (!frame.Buffer) {
+            newCapacity = m_initialCapacity;
+        }
+        else if (frame.LowUsageUpdates >= shrinkDelay) {
+            newCapacity = std::max(capacity / 2, m_initialCapacity);
+        }
+        while (newCapacity < count) {
+            newCapacity *= 2;
+        }
+    
+        if (newCapacity == capacity && frame.Buffer) return false;
+    
+        // The buffer may already be referenced by recorded commands.
+        if (frame.Buffer) {
+            RetireBuffer(std::move(frame.Buffer));
+        }
+    
+        frame.Buffer = UniquePtr<UploadBuffer<InstanceData>>(
+            new UploadBuffer<InstanceData>(m_device, static_cast<UINT>(newCapacity), false));
+        frame.Capacity = newCapacity;
+        frame.DirtyRanges.MarkAllDirty(static_cast<uint32>(count));
+        frame.LowUsageUpdates = 0;
+        return true;
+    }
     
-    void UpdateInstanceBuffer() {
-        size_t count = std::min(m_instances.size(), m_maxInstances);
-        for (size_t i = 0; i < count; ++i) {
-            m_instanceBuffer->CopyData(static_cast<int>(i), m_instances[i]);
+    // Keeps the buffer alive until the GPU is done with it: through the fence timeline when
+    // there is one, otherwise until every frame resource has cycled once.
+    void RetireBuffer(UniquePtr<UploadBuffer<InstanceData>> buffer) {
+        if (m_fenceTimeline) {
+            m_fenceTimeline->DeferRelease(std::move(buffer));
+            return;
         }
+        m_retiredBuffers.push_back({ std::move(buffer), m_frameNumber + m_frameBuffers.size() });
+    }
+    
+    void ReleaseRetiredBuffers() {
+        m_retiredBuffers.erase(std::remove_if(m_retiredBuffers.begin(), m_retiredBuffers.end(),
+            [this](const RetiredBuffer& retired) { return retired.ReleaseFrame <= m_frameNumber; }),
+            m_retiredBuffers.end());
+    }
+    
+    // Uploads only the merged dirty ranges, one bulk copy per range.
+    uint32 UpdateInstanceBuffer(FrameInstanceBuffer& frame) {
+        if (!frame.Buffer || !frame.DirtyRanges.IsDirty()) return 0;
+    
+        uint32 count = static_cast<uint32>(std::min(m_instances.size(), frame.Capacity));
+        return frame.DirtyRanges.Flush(count, [&frame, this](uint32 first, uint32 rangeCount) {
+            frame.Buffer->CopyRange(static_cast<int>(first), &m_instances[first], rangeCount);
+        });
     }
 };
\ No newline at end of file
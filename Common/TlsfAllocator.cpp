@@ -0,0 +1,266 @@
+#include "TlsfAllocator.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+uint32 FindLastSet(uint64 value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<uint32>(index);
+#else
+    return 63u - static_cast<uint32>(__builtin_clzll(value));
+#endif
+}
+
+uint32 FindFirstSet(uint64 value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<uint32>(index);
+#else
+    return static_cast<uint32>(__builtin_ctzll(value));
+#endif
+}
+
+} // namespace
+
+TlsfAllocator::TlsfAllocator(uint64 capacity, uint64 granularity)
+    : m_granularity(granularity > 0 ? granularity : 1) {
+    m_capacity = capacity - capacity % m_granularity;
+
+    for (auto& level : m_freeHeads) {
+        for (auto& head : level) {
+            head = InvalidNode;
+        }
+    }
+
+    if (m_capacity == 0) return;
+
+    uint32 node = NewNode();
+    m_blocks[node].offset = 0;
+    m_blocks[node].size = m_capacity;
+    m_firstPhysical = node;
+    InsertFreeBlock(node);
+}
+
+TlsfAllocator::Allocation TlsfAllocator::Allocate(uint64 size) {
+    if (size == 0) size = 1;
+    uint64 units = (size + m_granularity - 1) / m_granularity;
+
+    uint32 fl, sl;
+    MappingSearch(units, fl, sl);
+    if (fl >= FirstLevelCount) return {};
+
+    uint32 node = FindSuitableBlock(fl, sl);
+    if (node == InvalidNode) return {};
+
+    RemoveFreeBlock(node);
+    node = MarkUsed(node, units * m_granularity);
+    return { node, m_blocks[node].offset, m_blocks[node].size };
+}
+
+TlsfAllocator::Allocation TlsfAllocator::AllocateAt(uint64 offset, uint64 size) {
+    if (size == 0 || offset % m_granularity != 0) return {};
+    size = (size + m_granularity - 1) / m_granularity * m_granularity;
+
+    // Physical blocks are address ordered, so walk until the one containing offset.
+    uint32 node = m_firstPhysical;
+    while (node != InvalidNode && m_blocks[node].offset + m_blocks[node].size <= offset) {
+        node = m_blocks[node].nextPhys;
+    }
+    if (node == InvalidNode) return {};
+
+    if (!m_blocks[node].isFree || m_blocks[node].offset + m_blocks[node].size < offset + size) return {};
+
+    RemoveFreeBlock(node);
+
+    // Split off the free space in front of the requested range.
+    if (m_blocks[node].offset < offset) {
+        uint32 front = node;
+        SplitBlock(front, offset - m_blocks[front].offset);
+        node = m_blocks[front].nextPhys;
+        InsertFreeBlock(front);
+        RemoveFreeBlock(node);
+    }
+
+    node = MarkUsed(node, size);
+    return { node, m_blocks[node].offset, m_blocks[node].size };
+}
+
+void TlsfAllocator::Free(uint32 node) {
+    if (node >= m_blocks.size() || m_blocks[node].isFree) return;
+
+    m_usedBytes -= m_blocks[node].size;
+    --m_allocationCount;
+
+    // Coalesce with free neighbours so the free lists always hold maximal blocks.
+    uint32 prev = m_blocks[node].prevPhys;
+    if (prev != InvalidNode && m_blocks[prev].isFree) {
+        RemoveFreeBlock(prev);
+        m_blocks[prev].size += m_blocks[node].size;
+        m_blocks[prev].nextPhys = m_blocks[node].nextPhys;
+        if (m_blocks[node].nextPhys != InvalidNode) {
+            m_blocks[m_blocks[node].nextPhys].prevPhys = prev;
+        }
+        ReleaseNode(node);
+        node = prev;
+    }
+
+    uint32 next = m_blocks[node].nextPhys;
+    if (next != InvalidNode && m_blocks[next].isFree) {
+        RemoveFreeBlock(next);
+        m_blocks[node].size += m_blocks[next].size;
+        m_blocks[node].nextPhys = m_blocks[next].nextPhys;
+        if (m_blocks[next].nextPhys != InvalidNode) {
+            m_blocks[m_blocks[next].nextPhys].prevPhys = node;
+        }
+        ReleaseNode(next);
+    }
+
+    InsertFreeBlock(node);
+}
+
+TlsfAllocator::Stats TlsfAllocator::GetStats() const {
+    Stats stats;
+    stats.capacity = m_capacity;
+    stats.usedBytes = m_usedBytes;
+    stats.freeBytes = m_capacity - m_usedBytes;
+    stats.allocationCount = m_allocationCount;
+
+    for (uint32 node = m_firstPhysical; node != InvalidNode; node = m_blocks[node].nextPhys) {
+        const Block& block = m_blocks[node];
+        if (block.isFree) {
+            ++stats.freeBlockCount;
+            stats.largestFreeBlock = std::max(stats.largestFreeBlock, block.size);
+        }
+    }
+    return stats;
+}
+
+uint32 TlsfAllocator::NewNode() {
+    if (!m_unusedNodes.empty()) {
+        uint32 node = m_unusedNodes.back();
+        m_unusedNodes.pop_back();
+        m_blocks[node] = Block();
+        return node;
+    }
+
+    m_blocks.emplace_back();
+    return static_cast<uint32>(m_blocks.size() - 1);
+}
+
+void TlsfAllocator::ReleaseNode(uint32 node) {
+    m_blocks[node] = Block();
+    m_unusedNodes.push_back(node);
+}
+
+void TlsfAllocator::MappingInsert(uint64 units, uint32& fl, uint32& sl) const {
+    if (units < SecondLevelCount) {
+        fl = 0;
+        sl = static_cast<uint32>(units);
+    }
+    else {
+        uint32 msb = FindLastSet(units);
+        sl = static_cast<uint32>(units >> (msb - SecondLevelLog2)) ^ SecondLevelCount;
+        fl = msb - SecondLevelLog2 + 1;
+    }
+}
+
+void TlsfAllocator::MappingSearch(uint64 units, uint32& fl, uint32& sl) const {
+    // Round up to the next list boundary so any block found is large enough.
+    if (units >= SecondLevelCount) {
+        units += (uint64(1) << (FindLastSet(units) - SecondLevelLog2)) - 1;
+    }
+    MappingInsert(units, fl, sl);
+}
+
+uint32 TlsfAllocator::FindSuitableBlock(uint32 fl, uint32 sl) const {
+    uint32 slMap = m_secondLevelBitmap[fl] & (~0u << sl);
+    if (slMap == 0) {
+        uint64 flMap = (fl + 1 < 64) ? (m_firstLevelBitmap & (~uint64(0) << (fl + 1))) : 0;
+        if (flMap == 0) return InvalidNode;
+
+        fl = FindFirstSet(flMap);
+        slMap = m_secondLevelBitmap[fl];
+    }
+
+    sl = FindFirstSet(slMap);
+    return m_freeHeads[fl][sl];
+}
+
+void TlsfAllocator::InsertFreeBlock(uint32 node) {
+    Block& block = m_blocks[node];
+    block.isFree = true;
+
+    uint32 fl, sl;
+    MappingInsert(block.size / m_granularity, fl, sl);
+
+    block.prevFree = InvalidNode;
+    block.nextFree = m_freeHeads[fl][sl];
+    if (block.nextFree != InvalidNode) {
+        m_blocks[block.nextFree].prevFree = node;
+    }
+    m_freeHeads[fl][sl] = node;
+
+    m_firstLevelBitmap |= uint64(1) << fl;
+    m_secondLevelBitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::RemoveFreeBlock(uint32 node) {
+    Block& block = m_blocks[node];
+
+    uint32 fl, sl;
+    MappingInsert(block.size / m_granularity, fl, sl);
+
+    if (block.prevFree != InvalidNode) {
+        m_blocks[block.prevFree].nextFree = block.nextFree;
+    }
+    if (block.nextFree != InvalidNode) {
+        m_blocks[block.nextFree].prevFree = block.prevFree;
+    }
+
+    if (m_freeHeads[fl][sl] == node) {
+        m_freeHeads[fl][sl] = block.nextFree;
+        if (block.nextFree == InvalidNode) {
+            m_secondLevelBitmap[fl] &= ~(1u << sl);
+            if (m_secondLevelBitmap[fl] == 0) {
+                m_firstLevelBitmap &= ~(uint64(1) << fl);
+            }
+        }
+    }
+
+    block.prevFree = InvalidNode;
+    block.nextFree = InvalidNode;
+    block.isFree = false;
+}
+
+// Shrinks the block to size bytes and links the remainder in as a new, not yet listed, physical block.
+void TlsfAllocator::SplitBlock(uint32 node, uint64 size) {
+    uint32 rest = NewNode();
+    // NewNode may reallocate m_blocks, so index instead of holding references across it.
+    m_blocks[rest].offset = m_blocks[node].offset + size;
+    m_blocks[rest].size = m_blocks[node].size - size;
+    m_blocks[rest].prevPhys = node;
+    m_blocks[rest].nextPhys = m_blocks[node].nextPhys;
+    if (m_blocks[node].nextPhys != InvalidNode) {
+        m_blocks[m_blocks[node].nextPhys].prevPhys = rest;
+    }
+    m_blocks[node].nextPhys = rest;
+    m_blocks[node].size = size;
+}
+
+uint32 TlsfAllocator::MarkUsed(uint32 node, uint64 size) {
+    if (m_blocks[node].size > size) {
+        SplitBlock(node, size);
+        InsertFreeBlock(m_blocks[node].nextPhys);
+    }
+
+    m_blocks[node].isFree = false;
+    m_usedBytes += m_blocks[node].size;
+    ++m_allocationCount;
+    return node;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Types.h>
+
+// Two-Level Segregated Fit allocator over an abstract address range.
+// It only manages offsets, so the same code places resources inside an
+// ID3D12Heap and runs against a simulated heap without a device.
+//
+// Every block offset and size is a multiple of the granularity. Pools are
+// expected to use one granularity per alignment class (4KB, 64KB, 4MB), which
+// keeps allocations packed without any per-allocation alignment padding.
+class TlsfAllocator {
+public:
+    static constexpr uint32 InvalidNode = 0xFFFFFFFFu;
+
+    struct Allocation {
+        uint32 node = InvalidNode;
+        uint64 offset = 0;
+        uint64 size = 0;
+
+        bool IsValid() const { return node != InvalidNode; }
+    };
+
+    struct Stats {
+        uint64 capacity = 0;
+        uint64 usedBytes = 0;
+        uint64 freeBytes = 0;
+        uint64 largestFreeBlock = 0;
+        uint32 allocationCount = 0;
+        uint32 freeBlockCount = 0;
+
+        // 0 when all free memory is one contiguous block, approaching 1 as it
+        // splinters into many small blocks.
+        float Fragmentation() const {
+            return freeBytes > 0 ? 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeBytes) : 0.0f;
+        }
+    };
+
+    TlsfAllocator(uint64 capacity, uint64 granularity);
+
+    TlsfAllocator(const TlsfAllocator&) = delete;
+    TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+    // Returns an invalid allocation when no free block is large enough.
+    Allocation Allocate(uint64 size);
+
+    // Reserves the exact range [offset, offset + size) if it is currently free.
+    // Used when a caller needs a specific placement (e.g. defragmentation targets).
+    Allocation AllocateAt(uint64 offset, uint64 size);
+
+    void Free(uint32 node);
+
+    uint64 GetCapacity() const { return m_capacity; }
+    uint64 GetGranularity() const { return m_granularity; }
+    uint64 GetUsedBytes() const { return m_usedBytes; }
+    uint32 GetAllocationCount() const { return m_allocationCount; }
+    bool IsEmpty() const { return m_allocationCount == 0; }
+
+    Stats GetStats() const;
+
+    // Visits live allocations in address order.
+    template<typename Fn>
+    void ForEachAllocation(Fn&& fn) const {
+        for (uint32 node = m_firstPhysical; node != InvalidNode; node = m_blocks[node].nextPhys) {
+            const Block& block = m_blocks[node];
+            if (!block.isFree) {
+                fn(Allocation{ node, block.offset, block.size });
+            }
+        }
+    }
+
+private:
+    static constexpr uint32 SecondLevelLog2 = 4;
+    static constexpr uint32 SecondLevelCount = 1u << SecondLevelLog2;
+    static constexpr uint32 FirstLevelCount = 40;
+
+    struct Block {
+        uint64 offset = 0;
+        uint64 size = 0;
+        uint32 prevPhys = InvalidNode;
+        uint32 nextPhys = InvalidNode;
+        uint32 prevFree = InvalidNode;
+        uint32 nextFree = InvalidNode;
+        bool isFree = false;
+    };
+
+    uint64 m_capacity = 0;
+    uint64 m_granularity = 1;
+    uint64 m_usedBytes = 0;
+    uint32 m_allocationCount = 0;
+    uint32 m_firstPhysical = InvalidNode;
+
+    Vector<Block> m_blocks;
+    Vector<uint32> m_unusedNodes;
+
+    uint64 m_firstLevelBitmap = 0;
+    uint32 m_secondLevelBitmap[FirstLevelCount] = {};
+    uint32 m_freeHeads[FirstLevelCount][SecondLevelCount];
+
+    uint32 NewNode();
+    void ReleaseNode(uint32 node);
+
+    void MappingInsert(uint64 units, uint32& fl, uint32& sl) const;
+    void MappingSearch(uint64 units, uint32& fl, uint32& sl) const;
+    uint32 FindSuitableBlock(uint32 fl, uint32 sl) const;
+
+    void InsertFreeBlock(uint32 node);
+    void RemoveFreeBlock(uint32 node);
+    void SplitBlock(uint32 node, uint64 size);
+    uint32 MarkUsed(uint32 node, uint64 size);
+};
@@ -0,0 +1,295 @@
+#include "TransformBatch.h"
+#include "WorkerPool.h"
+#include "SimdSupport.h"
+
+namespace {
+    // Output row r of a matrix gathers these four elements of the row-major matrix.
+    constexpr uint32 RowMajorRows[4][4] = { { 0, 1, 2, 3 }, { 4, 5, 6, 7 }, { 8, 9, 10, 11 }, { 12, 13, 14, 15 } };
+    constexpr uint32 TransposedRows[4][4] = { { 0, 4, 8, 12 }, { 1, 5, 9, 13 }, { 2, 6, 10, 14 }, { 3, 7, 11, 15 } };
+
+    const uint32 (*GetRows(MatrixLayout layout))[4] {
+        return layout == MatrixLayout::RowMajor ? RowMajorRows : TransposedRows;
+    }
+
+    void ComputeScalar(const TransformStreams& in, uint32 begin, uint32 end, MatrixLayout layout,
+                       float* world, const float* viewProj, float* worldViewProj) {
+        const uint32 (*rows)[4] = GetRows(layout);
+        for (uint32 i = begin; i < end; ++i) {
+            float x = in.rotationX[i], y = in.rotationY[i], z = in.rotationZ[i], w = in.rotationW[i];
+            float xx = x * x, yy = y * y, zz = z * z;
+            float xy = x * y, xz = x * z, yz = y * z;
+            float wx = w * x, wy = w * y, wz = w * z;
+            float sx = in.scaleX[i], sy = in.scaleY[i], sz = in.scaleZ[i];
+
+            float e[16] = {
+                (1.0f - 2.0f * (yy + zz)) * sx, 2.0f * (xy + wz) * sx, 2.0f * (xz - wy) * sx, 0.0f,
+                2.0f * (xy - wz) * sy, (1.0f - 2.0f * (xx + zz)) * sy, 2.0f * (yz + wx) * sy, 0.0f,
+                2.0f * (xz + wy) * sz, 2.0f * (yz - wx) * sz, (1.0f - 2.0f * (xx + yy)) * sz, 0.0f,
+                in.positionX[i], in.positionY[i], in.positionZ[i], 1.0f
+            };
+
+            if (world) {
+                float* dst = world + size_t(i) * 16;
+                for (uint32 k = 0; k < 16; ++k) dst[k] = e[rows[k / 4][k % 4]];
+            }
+
+            if (worldViewProj) {
+                float f[16];
+                for (uint32 r = 0; r < 4; ++r) {
+                    for (uint32 c = 0; c < 4; ++c) {
+                        f[r * 4 + c] = e[r * 4] * viewProj[c] + e[r * 4 + 1] * viewProj[4 + c] +
+                                       e[r * 4 + 2] * viewProj[8 + c] + e[r * 4 + 3] * viewProj[12 + c];
+                    }
+                }
+                float* dst = worldViewProj + size_t(i) * 16;
+                for (uint32 k = 0; k < 16; ++k) dst[k] = f[rows[k / 4][k % 4]];
+            }
+        }
+    }
+
+#ifdef SIMD_X86
+    // Stores 4 objects' matrices: output row r of object j is lane j of e[rows[r][0..3]].
+    void Store4(const __m128* e, const uint32 (*rows)[4], float* dst) {
+        for (uint32 r = 0; r < 4; ++r) {
+            __m128 a = e[rows[r][0]], b = e[rows[r][1]], c = e[rows[r][2]], d = e[rows[r][3]];
+            _MM_TRANSPOSE4_PS(a, b, c, d);
+            _mm_storeu_ps(dst + r * 4, a);
+            _mm_storeu_ps(dst + 16 + r * 4, b);
+            _mm_storeu_ps(dst + 32 + r * 4, c);
+            _mm_storeu_ps(dst + 48 + r * 4, d);
+        }
+    }
+
+    void MultiplySSE(const __m128* e, const float* viewProj, __m128* f) {
+        for (uint32 c = 0; c < 4; ++c) {
+            __m128 v0 = _mm_set1_ps(viewProj[c]), v1 = _mm_set1_ps(viewProj[4 + c]);
+            __m128 v2 = _mm_set1_ps(viewProj[8 + c]), v3 = _mm_set1_ps(viewProj[12 + c]);
+            for (uint32 r = 0; r < 3; ++r) {
+                f[r * 4 + c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[r * 4], v0), _mm_mul_ps(e[r * 4 + 1], v1)),
+                                          _mm_mul_ps(e[r * 4 + 2], v2));
+            }
+            // The last row carries the translation and w = 1.
+            f[12 + c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[12], v0), _mm_mul_ps(e[13], v1)),
+                                   _mm_add_ps(_mm_mul_ps(e[14], v2), v3));
+        }
+    }
+
+    void ComputeSSE(const TransformStreams& in, uint32 begin, uint32 end, MatrixLayout layout,
+                    float* world, const float* viewProj, float* worldViewProj) {
+        const uint32 (*rows)[4] = GetRows(layout);
+        const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+
+        uint32 i = begin;
+        for (; i + 4 <= end; i += 4) {
+            __m128 x = _mm_loadu_ps(in.rotationX + i), y = _mm_loadu_ps(in.rotationY + i);
+            __m128 z = _mm_loadu_ps(in.rotationZ + i), w = _mm_loadu_ps(in.rotationW + i);
+            __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+            __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+            __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+            __m128 sx = _mm_loadu_ps(in.scaleX + i), sy = _mm_loadu_ps(in.scaleY + i), sz = _mm_loadu_ps(in.scaleZ + i);
+
+            __m128 e[16];
+            e[0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+            e[1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+            e[2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+            e[3] = zero;
+            e[4] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+            e[5] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+            e[6] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+            e[7] = zero;
+            e[8] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+            e[9] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+            e[10] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+            e[11] = zero;
+            e[12] = _mm_loadu_ps(in.positionX + i);
+            e[13] = _mm_loadu_ps(in.positionY + i);
+            e[14] = _mm_loadu_ps(in.positionZ + i);
+            e[15] = one;
+
+            if (world) Store4(e, rows, world + size_t(i) * 16);
+
+            if (worldViewProj) {
+                __m128 f[16];
+                MultiplySSE(e, viewProj, f);
+                Store4(f, rows, worldViewProj + size_t(i) * 16);
+            }
+        }
+
+        ComputeScalar(in, i, end, layout, world, viewProj, worldViewProj);
+    }
+
+    // Stores 8 objects' matrices. The shuffles transpose within each 128-bit half, so the
+    // low half holds objects 0-3 and the high half objects 4-7.
+    SIMD_TARGET_AVX2 void Store8(const __m256* e, const uint32 (*rows)[4], float* dst) {
+        for (uint32 r = 0; r < 4; ++r) {
+            __m256 t0 = _mm256_unpacklo_ps(e[rows[r][0]], e[rows[r][1]]);
+            __m256 t1 = _mm256_unpacklo_ps(e[rows[r][2]], e[rows[r][3]]);
+            __m256 t2 = _mm256_unpackhi_ps(e[rows[r][0]], e[rows[r][1]]);
+            __m256 t3 = _mm256_unpackhi_ps(e[rows[r][2]], e[rows[r][3]]);
+            __m256 o0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 o1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 o2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 o3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            _mm_storeu_ps(dst + 0 * 16 + r * 4, _mm256_castps256_ps128(o0));
+            _mm_storeu_ps(dst + 1 * 16 + r * 4, _mm256_castps256_ps128(o1));
+            _mm_storeu_ps(dst + 2 * 16 + r * 4, _mm256_castps256_ps128(o2));
+            _mm_storeu_ps(dst + 3 * 16 + r * 4, _mm256_castps256_ps128(o3));
+            _mm_storeu_ps(dst + 4 * 16 + r * 4, _mm256_extractf128_ps(o0, 1));
+            _mm_storeu_ps(dst + 5 * 16 + r * 4, _mm256_extractf128_ps(o1, 1));
+            _mm_storeu_ps(dst + 6 * 16 + r * 4, _mm256_extractf128_ps(o2, 1));
+            _mm_storeu_ps(dst + 7 * 16 + r * 4, _mm256_extractf128_ps(o3, 1));
+        }
+    }
+
+    SIMD_TARGET_AVX2 void MultiplyAVX2(const __m256* e, const float* viewProj, __m256* f) {
+        for (uint32 c = 0; c < 4; ++c) {
+            __m256 v0 = _mm256_set1_ps(viewProj[c]), v1 = _mm256_set1_ps(viewProj[4 + c]);
+            __m256 v2 = _mm256_set1_ps(viewProj[8 + c]), v3 = _mm256_set1_ps(viewProj[12 + c]);
+            for (uint32 r = 0; r < 3; ++r) {
+                f[r * 4 + c] = _mm256_fmadd_ps(e[r * 4 + 2], v2, _mm256_fmadd_ps(e[r * 4 + 1], v1, _mm256_mul_ps(e[r * 4], v0)));
+            }
+            f[12 + c] = _mm256_fmadd_ps(e[14], v2, _mm256_fmadd_ps(e[13], v1, _mm256_fmadd_ps(e[12], v0, v3)));
+        }
+    }
+
+    SIMD_TARGET_AVX2 void ComputeAVX2(const TransformStreams& in, uint32 begin, uint32 end, MatrixLayout layout,
+                                           float* world, const float* viewProj, float* worldViewProj) {
+        const uint32 (*rows)[4] = GetRows(layout);
+        const __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f), zero = _mm256_setzero_ps();
+
+        uint32 i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256 x = _mm256_loadu_ps(in.rotationX + i), y = _mm256_loadu_ps(in.rotationY + i);
+            __m256 z = _mm256_loadu_ps(in.rotationZ + i), w = _mm256_loadu_ps(in.rotationW + i);
+            __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+            __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+            __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+            __m256 sx = _mm256_loadu_ps(in.scaleX + i), sy = _mm256_loadu_ps(in.scaleY + i);
+            __m256 sz = _mm256_loadu_ps(in.scaleZ + i);
+
+            __m256 e[16];
+            e[0] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), sx);
+            e[1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx);
+            e[2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx);
+            e[3] = zero;
+            e[4] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy);
+            e[5] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), sy);
+            e[6] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy);
+            e[7] = zero;
+            e[8] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz);
+            e[9] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz);
+            e[10] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), sz);
+            e[11] = zero;
+            e[12] = _mm256_loadu_ps(in.positionX + i);
+            e[13] = _mm256_loadu_ps(in.positionY + i);
+            e[14] = _mm256_loadu_ps(in.positionZ + i);
+            e[15] = one;
+
+            if (world) Store8(e, rows, world + size_t(i) * 16);
+
+            if (worldViewProj) {
+                __m256 f[16];
+                MultiplyAVX2(e, viewProj, f);
+                Store8(f, rows, worldViewProj + size_t(i) * 16);
+            }
+        }
+
+        // The tail of fewer than 8 objects takes the 4-wide path.
+        ComputeSSE(in, i, end, layout, world, viewProj, worldViewProj);
+    }
+#endif
+
+    void ComputeRange(const TransformStreams& in, uint32 begin, uint32 end, MatrixLayout layout,
+                      float* world, const float* viewProj, float* worldViewProj, TransformKernel::Path path) {
+        if (!viewProj) worldViewProj = nullptr;
+
+#ifdef SIMD_X86
+        switch (path) {
+        case TransformKernel::Path::AVX2: ComputeAVX2(in, begin, end, layout, world, viewProj, worldViewProj); return;
+        case TransformKernel::Path::SSE: ComputeSSE(in, begin, end, layout, world, viewProj, worldViewProj); return;
+        default: break;
+        }
+#endif
+        ComputeScalar(in, begin, end, layout, world, viewProj, worldViewProj);
+    }
+}
+
+TransformKernel::Path TransformKernel::GetBestPath() {
+#ifdef SIMD_X86
+    static const Path best = Simd::SupportsAVX2() ? Path::AVX2 : Path::SSE;
+    return best;
+#else
+    return Path::Scalar;
+#endif
+}
+
+void TransformKernel::Compute(const TransformStreams& in, uint32 count, MatrixLayout layout, float* world,
+                              const float* viewProj, float* worldViewProj) {
+    ComputeRange(in, 0, count, layout, world, viewProj, worldViewProj, GetBestPath());
+}
+
+void TransformKernel::Compute(const TransformStreams& in, uint32 count, MatrixLayout layout, float* world,
+                              const float* viewProj, float* worldViewProj, Path path) {
+    ComputeRange(in, 0, count, layout, world, viewProj, worldViewProj, path);
+}
+
+void TransformKernel::ComputeParallel(WorkerPool* pool, const TransformStreams& in, uint32 count, MatrixLayout layout,
+                                      float* world, const float* viewProj, float* worldViewProj) {
+    Path path = GetBestPath();
+    if (!pool || count < ParallelThreshold) {
+        ComputeRange(in, 0, count, layout, world, viewProj, worldViewProj, path);
+        return;
+    }
+
+    // Batches of whole AVX2 iterations keep every thread on the vector loop.
+    pool->ParallelFor(count, 8, [&](uint32 begin, uint32 end) {
+        ComputeRange(in, begin, end, layout, world, viewProj, worldViewProj, path);
+    });
+}
+
+void TransformBatch::Clear() {
+    for (auto* stream : { &m_positionX, &m_positionY, &m_positionZ, &m_rotationX, &m_rotationY, &m_rotationZ,
+                          &m_rotationW, &m_scaleX, &m_scaleY, &m_scaleZ }) {
+        stream->clear();
+    }
+}
+
+void TransformBatch::Reserve(uint32 count) {
+    for (auto* stream : { &m_positionX, &m_positionY, &m_positionZ, &m_rotationX, &m_rotationY, &m_rotationZ,
+                          &m_rotationW, &m_scaleX, &m_scaleY, &m_scaleZ }) {
+        stream->reserve(count);
+    }
+    m_world.reserve(size_t(count) * 16);
+}
+
+uint32 TransformBatch::Add(const float position[3], const float rotation[4], const float scale[3]) {
+    m_positionX.push_back(position[0]);
+    m_positionY.push_back(position[1]);
+    m_positionZ.push_back(position[2]);
+    m_rotationX.push_back(rotation[0]);
+    m_rotationY.push_back(rotation[1]);
+    m_rotationZ.push_back(rotation[2]);
+    m_rotationW.push_back(rotation[3]);
+    m_scaleX.push_back(scale[0]);
+    m_scaleY.push_back(scale[1]);
+    m_scaleZ.push_back(scale[2]);
+    return GetCount() - 1;
+}
+
+void TransformBatch::Compute(MatrixLayout layout, WorkerPool* pool) {
+    TransformStreams in;
+    in.positionX = m_positionX.data();
+    in.positionY = m_positionY.data();
+    in.positionZ = m_positionZ.data();
+    in.rotationX = m_rotationX.data();
+    in.rotationY = m_rotationY.data();
+    in.rotationZ = m_rotationZ.data();
+    in.rotationW = m_rotationW.data();
+    in.scaleX = m_scaleX.data();
+    in.scaleY = m_scaleY.data();
+    in.scaleZ = m_scaleZ.data();
+
+    m_world.resize(size_t(GetCount()) * 16);
+    TransformKernel::ComputeParallel(pool, in, GetCount(), layout, m_world.data());
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Types.h>
+
+class WorkerPool;
+
+// Structure-of-arrays transform inputs: one array per component, count elements each.
+// Rotations are unit quaternions.
+struct TransformStreams {
+    const float* positionX = nullptr;
+    const float* positionY = nullptr;
+    const float* positionZ = nullptr;
+    const float* rotationX = nullptr;
+    const float* rotationY = nullptr;
+    const float* rotationZ = nullptr;
+    const float* rotationW = nullptr;
+    const float* scaleX = nullptr;
+    const float* scaleY = nullptr;
+    const float* scaleZ = nullptr;
+};
+
+enum class MatrixLayout : uint8 {
+    RowMajor,       // As stored in XMFLOAT4X4, for the CPU
+    Transposed      // Column-major, as HLSL reads it from buffers
+};
+
+// Builds world = scale * rotation * translation, the XMMatrixAffineTransformation result,
+// and optionally world * viewProj, for many objects at once. The SIMD paths compute 4 or
+// 8 objects per iteration with the matrix elements spread across lanes, then transpose
+// them into whole matrices on store.
+class TransformKernel {
+public:
+    enum class Path : uint8 { Scalar, SSE, AVX2 };
+
+    // Objects per call below which threading costs more than it saves.
+    static constexpr uint32 ParallelThreshold = 4096;
+
+    // Best path the CPU supports, detected once.
+    static Path GetBestPath();
+
+    // Writes 16 floats per object to world and, when viewProj (row-major) is given, to
+    // worldViewProj. Either output may be null.
+    static void Compute(const TransformStreams& in, uint32 count, MatrixLayout layout, float* world,
+                        const float* viewProj = nullptr, float* worldViewProj = nullptr);
+
+    static void Compute(const TransformStreams& in, uint32 count, MatrixLayout layout, float* world,
+                        const float* viewProj, float* worldViewProj, Path path);
+
+    // Same, split across pool for large counts.
+    static void ComputeParallel(WorkerPool* pool, const TransformStreams& in, uint32 count, MatrixLayout layout,
+                                float* world, const float* viewProj = nullptr, float* worldViewProj = nullptr);
+};
+
+// Gathers transforms into SoA streams for TransformKernel, so callers whose objects keep
+// their transforms elsewhere can batch them. Results are read back by the order of Add.
+class TransformBatch {
+public:
+    void Clear();
+    void Reserve(uint32 count);
+
+    // Returns the object's index in the batch.
+    uint32 Add(const float position[3], const float rotation[4], const float scale[3]);
+
+    // Computes the world matrix of every object added, on pool when given.
+    void Compute(MatrixLayout layout, WorkerPool* pool = nullptr);
+
+    // 16 floats in the layout given to Compute.
+    const float* GetWorld(uint32 index) const { return &m_world[size_t(index) * 16]; }
+
+    uint32 GetCount() const { return static_cast<uint32>(m_positionX.size()); }
+
+private:
+    Vector<float> m_positionX, m_positionY, m_positionZ;
+    Vector<float> m_rotationX, m_rotationY, m_rotationZ, m_rotationW;
+    Vector<float> m_scaleX, m_scaleY, m_scaleZ;
+    Vector<float> m_world;
+};
@@ -0,0 +1,243 @@
+#include "TransformHierarchy.h"
+#include "WorkerPool.h"
+
+namespace {
+    // out = a * b for row-major matrices.
+    void Multiply(const WorldMatrix& a, const WorldMatrix& b, WorldMatrix& out) {
+        for (uint32 r = 0; r < 4; ++r) {
+            for (uint32 c = 0; c < 4; ++c) {
+                out.m[r * 4 + c] = a.m[r * 4] * b.m[c] + a.m[r * 4 + 1] * b.m[4 + c] +
+                                   a.m[r * 4 + 2] * b.m[8 + c] + a.m[r * 4 + 3] * b.m[12 + c];
+            }
+        }
+    }
+
+    template<typename T>
+    void Permute(Vector<T>& values, const Vector<uint32>& newIndex) {
+        Vector<T> sorted(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            sorted[newIndex[i]] = values[i];
+        }
+        values.swap(sorted);
+    }
+}
+
+TransformHierarchy::TransformHierarchy() {
+    m_slots.emplace_back();         // Slot 0 stays unused
+    m_levelStarts.push_back(0);
+}
+
+Handle TransformHierarchy::CreateNode(Handle parent, Handle userHandle) {
+    Handle node;
+    if (!m_freeSlots.empty()) {
+        node.index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else {
+        node.index = static_cast<uint32>(m_slots.size());
+        m_slots.emplace_back();
+    }
+    node.generation = m_slots[node.index].generation;
+
+    uint32 dense = GetNodeCount();
+    uint32 parentDense = Contains(parent) ? GetDense(parent) : InvalidIndex;
+    uint32 depth = (parentDense != InvalidIndex) ? m_depths[parentDense] + 1 : 0;
+
+    // Appending keeps the order as long as the new node is at least as deep as the last.
+    if (!m_depths.empty() && depth < m_depths.back()) {
+        m_orderDirty = true;
+    }
+
+    m_slots[node.index].dense = dense;
+    m_parents.push_back(parentDense);
+    m_depths.push_back(depth);
+    m_slotOf.push_back(node.index);
+    m_userHandles.push_back(userHandle);
+    m_local.emplace_back();
+    m_world.emplace_back();
+    m_localDirty.push_back(1);
+    m_worldChanged.push_back(0);
+
+    if (!m_orderDirty) {
+        if (depth + 1 < m_levelStarts.size()) {
+            m_levelStarts.back() = GetNodeCount();
+        }
+        else {
+            m_levelStarts.push_back(GetNodeCount());
+        }
+    }
+    return node;
+}
+
+void TransformHierarchy::DestroyNode(Handle node) {
+    if (!Contains(node)) return;
+
+    // Descendants must come after their ancestors for the single scan below.
+    if (m_orderDirty) SortByDepth();
+
+    uint32 count = GetNodeCount();
+    Vector<uint8> removed(count, 0);
+    removed[GetDense(node)] = 1;
+    for (uint32 i = GetDense(node) + 1; i < count; ++i) {
+        if (m_parents[i] != InvalidIndex && removed[m_parents[i]]) removed[i] = 1;
+    }
+
+    // Compacting keeps the survivors in order, so the arrays stay sorted by depth.
+    Vector<uint32> newIndex(count, InvalidIndex);
+    uint32 kept = 0;
+    for (uint32 i = 0; i < count; ++i) {
+        if (removed[i]) {
+            Slot& slot = m_slots[m_slotOf[i]];
+            slot.dense = InvalidIndex;
+            ++slot.generation;
+            m_freeSlots.push_back(m_slotOf[i]);
+            continue;
+        }
+
+        newIndex[i] = kept;
+        m_parents[kept] = (m_parents[i] != InvalidIndex) ? newIndex[m_parents[i]] : InvalidIndex;
+        m_depths[kept] = m_depths[i];
+        m_slotOf[kept] = m_slotOf[i];
+        m_userHandles[kept] = m_userHandles[i];
+        m_local[kept] = m_local[i];
+        m_world[kept] = m_world[i];
+        m_localDirty[kept] = m_localDirty[i];
+        m_worldChanged[kept] = m_worldChanged[i];
+        m_slots[m_slotOf[kept]].dense = kept;
+        ++kept;
+    }
+
+    m_parents.resize(kept);
+    m_depths.resize(kept);
+    m_slotOf.resize(kept);
+    m_userHandles.resize(kept);
+    m_local.resize(kept);
+    m_world.resize(kept);
+    m_localDirty.resize(kept);
+    m_worldChanged.resize(kept);
+    RebuildLevels();
+}
+
+bool TransformHierarchy::SetParent(Handle node, Handle parent) {
+    if (!Contains(node) || (parent.IsValid() && !Contains(parent))) return false;
+
+    uint32 dense = GetDense(node);
+    uint32 parentDense = parent.IsValid() ? GetDense(parent) : InvalidIndex;
+    for (uint32 ancestor = parentDense; ancestor != InvalidIndex; ancestor = m_parents[ancestor]) {
+        if (ancestor == dense) return false;
+    }
+
+    m_parents[dense] = parentDense;
+    m_localDirty[dense] = 1;
+    m_orderDirty = true;
+    return true;
+}
+
+void TransformHierarchy::SetLocal(Handle node, const WorldMatrix& local) {
+    if (!Contains(node)) return;
+
+    uint32 dense = GetDense(node);
+    m_local[dense] = local;
+    m_localDirty[dense] = 1;
+}
+
+const WorldMatrix* TransformHierarchy::GetWorld(Handle node) const {
+    return Contains(node) ? &m_world[GetDense(node)] : nullptr;
+}
+
+void TransformHierarchy::SortByDepth() {
+    uint32 count = GetNodeCount();
+
+    // Depths from the parent links, walking each chain up to the first known depth.
+    Vector<uint32> chain;
+    std::fill(m_depths.begin(), m_depths.end(), InvalidIndex);
+    for (uint32 i = 0; i < count; ++i) {
+        uint32 node = i;
+        while (node != InvalidIndex && m_depths[node] == InvalidIndex) {
+            chain.push_back(node);
+            node = m_parents[node];
+        }
+
+        uint32 depth = (node == InvalidIndex) ? 0 : m_depths[node] + 1;
+        while (!chain.empty()) {
+            m_depths[chain.back()] = depth++;
+            chain.pop_back();
+        }
+    }
+
+    // Stable counting sort by depth.
+    uint32 maxDepth = count ? *std::max_element(m_depths.begin(), m_depths.end()) : 0;
+    Vector<uint32> starts(maxDepth + 2, 0);
+    for (uint32 depth : m_depths) ++starts[depth + 1];
+    for (uint32 d = 1; d < starts.size(); ++d) starts[d] += starts[d - 1];
+
+    Vector<uint32> newIndex(count);
+    for (uint32 i = 0; i < count; ++i) newIndex[i] = starts[m_depths[i]]++;
+
+    for (uint32& parent : m_parents) {
+        if (parent != InvalidIndex) parent = newIndex[parent];
+    }
+    Permute(m_parents, newIndex);
+    Permute(m_depths, newIndex);
+    Permute(m_slotOf, newIndex);
+    Permute(m_userHandles, newIndex);
+    Permute(m_local, newIndex);
+    Permute(m_world, newIndex);
+    Permute(m_localDirty, newIndex);
+    Permute(m_worldChanged, newIndex);
+    for (uint32 i = 0; i < count; ++i) {
+        m_slots[m_slotOf[i]].dense = i;
+    }
+
+    m_orderDirty = false;
+    RebuildLevels();
+}
+
+void TransformHierarchy::RebuildLevels() {
+    m_levelStarts.clear();
+    for (uint32 i = 0; i < GetNodeCount(); ++i) {
+        while (m_levelStarts.size() <= m_depths[i]) m_levelStarts.push_back(i);
+    }
+    m_levelStarts.push_back(GetNodeCount());
+}
+
+void TransformHierarchy::UpdateRange(uint32 begin, uint32 end) {
+    for (uint32 i = begin; i < end; ++i) {
+        uint32 parent = m_parents[i];
+
+        // Parents sit on earlier levels, so their flags are final by now.
+        bool changed = m_localDirty[i] || (parent != InvalidIndex && m_worldChanged[parent]);
+        m_worldChanged[i] = changed;
+        if (!changed) continue;
+
+        m_localDirty[i] = 0;
+        if (parent == InvalidIndex) {
+            m_world[i] = m_local[i];
+        }
+        else {
+            Multiply(m_local[i], m_world[parent], m_world[i]);
+        }
+    }
+}
+
+uint32 TransformHierarchy::Update(WorkerPool* pool) {
+    if (m_orderDirty) SortByDepth();
+
+    for (uint32 level = 0; level < GetDepthCount(); ++level) {
+        uint32 begin = m_levelStarts[level];
+        uint32 end = m_levelStarts[level + 1];
+
+        if (pool && end - begin >= ParallelLevelSize) {
+            pool->ParallelFor(end - begin, 64, [this, begin](uint32 first, uint32 last) {
+                UpdateRange(begin + first, begin + last);
+            });
+        }
+        else {
+            UpdateRange(begin, end);
+        }
+    }
+
+    uint32 changed = 0;
+    for (uint8 flag : m_worldChanged) changed += flag;
+    return changed;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Types.h>
+#include "SceneComponents.h"
+
+class WorkerPool;
+
+// Parent/child transforms stored flat and sorted by depth: every parent comes before its
+// children, and each depth level is one contiguous range. Update walks the levels in
+// order and computes world = local * parentWorld in a single linear pass, with each
+// level split across threads, so there is no recursion and no pointer chasing.
+//
+// Nodes are addressed by Handle. Adding a node below the deepest level keeps the order;
+// any other structural change re-sorts the arrays on the next Update.
+class TransformHierarchy {
+public:
+    TransformHierarchy();
+
+    // parent may be an invalid Handle for a root. userHandle is returned by ForEachChanged,
+    // e.g. the render object driven by the node.
+    Handle CreateNode(Handle parent = Handle(), Handle userHandle = Handle());
+
+    // Destroys the node and its whole subtree.
+    void DestroyNode(Handle node);
+
+    // Returns false when either handle is stale or parent lies in node's subtree.
+    bool SetParent(Handle node, Handle parent);
+
+    bool Contains(Handle node) const {
+        return node.index != 0 && node.index < m_slots.size() &&
+               m_slots[node.index].generation == node.generation && m_slots[node.index].dense != InvalidIndex;
+    }
+
+    // Row-major, relative to the parent. Marks the node's subtree for recomputation.
+    void SetLocal(Handle node, const WorldMatrix& local);
+
+    // As of the last Update.
+    const WorldMatrix* GetWorld(Handle node) const;
+
+    // Recomputes the world matrices of changed nodes and their subtrees. Returns how many.
+    uint32 Update(WorkerPool* pool = nullptr);
+
+    // Calls fn(userHandle, world) for every node the last Update recomputed.
+    template<typename Fn>
+    void ForEachChanged(Fn&& fn) const {
+        for (uint32 i = 0; i < GetNodeCount(); ++i) {
+            if (m_worldChanged[i]) fn(m_userHandles[i], m_world[i]);
+        }
+    }
+
+    uint32 GetNodeCount() const { return static_cast<uint32>(m_world.size()); }
+    uint32 GetDepthCount() const { return static_cast<uint32>(m_levelStarts.size()) - 1; }
+
+private:
+    static constexpr uint32 InvalidIndex = UINT32_MAX;
+
+    // Levels smaller than this are not worth splitting across threads.
+    static constexpr uint32 ParallelLevelSize = 1024;
+
+    struct Slot {
+        uint32 dense = InvalidIndex;
+        uint32 generation = 1;
+    };
+
+    Vector<Slot> m_slots;               // Indexed by Handle.index, 0 is reserved
+    Vector<uint32> m_freeSlots;
+
+    // Flat node arrays, parents before children.
+    Vector<uint32> m_parents;           // Dense index, InvalidIndex for roots
+    Vector<uint32> m_depths;
+    Vector<uint32> m_slotOf;
+    Vector<Handle> m_userHandles;
+    Vector<WorldMatrix> m_local;
+    Vector<WorldMatrix> m_world;
+    Vector<uint8> m_localDirty;
+    Vector<uint8> m_worldChanged;       // Recomputed by the last Update
+
+    Vector<uint32> m_levelStarts;       // Dense index of each depth level's first node, plus the end
+    bool m_orderDirty = false;
+
+    uint32 GetDense(Handle node) const { return m_slots[node.index].dense; }
+
+    // Re-sorts the arrays by depth after a structural change.
+    void SortByDepth();
+    void RebuildLevels();
+    void UpdateRange(uint32 begin, uint32 end);
+};
@@ -0,0 +1,95 @@
+#include "TransformSystem.h"
+#include "TransformBatch.h"
+
+namespace {
+    // Shorter runs of changed rows are composed one by one: gathering them into streams
+    // costs more than the kernel saves.
+    constexpr uint32 KernelMinRun = 8;
+
+    // Rebuilds count consecutive rows, at most one dirty word, in place with TransformKernel.
+    void ComposeRun(uint32 count, const Position* positions, const Rotation* rotations, const Scale* scales,
+                    WorldMatrix* matrices) {
+        float streams[10][64];
+        for (uint32 i = 0; i < count; ++i) {
+            const float values[10] = { positions[i].x, positions[i].y, positions[i].z, rotations[i].x,
+                rotations[i].y, rotations[i].z, rotations[i].w, scales[i].x, scales[i].y, scales[i].z };
+            for (uint32 s = 0; s < 10; ++s) streams[s][i] = values[s];
+        }
+
+        TransformStreams in;
+        const float** targets[10] = { &in.positionX, &in.positionY, &in.positionZ, &in.rotationX, &in.rotationY,
+                                      &in.rotationZ, &in.rotationW, &in.scaleX, &in.scaleY, &in.scaleZ };
+        for (uint32 s = 0; s < 10; ++s) *targets[s] = streams[s];
+
+        // WorldMatrix is 16 packed floats, so the column takes the kernel's output as is.
+        static_assert(sizeof(WorldMatrix) == 16 * sizeof(float), "WorldMatrix must be a bare 4x4 matrix");
+        TransformKernel::Compute(in, count, MatrixLayout::RowMajor, matrices[0].m);
+    }
+}
+
+uint32 TransformSystem::Update(EntityWorld& world) {
+    uint32 rebuilt = 0;
+    world.ForEachDirtyChunk<Position, Rotation, Scale, WorldMatrix, EntityFlags>(
+        [&rebuilt](uint32 count, const Handle*, uint64* dirtyRows, Position* positions, Rotation* rotations,
+                   Scale* scales, WorldMatrix* matrices, EntityFlags* flags) {
+            for (uint32 w = 0; w < (count + 63) / 64; ++w) {
+                uint64 changed = 0;
+                for (uint64 bits = dirtyRows[w]; bits; bits &= bits - 1) {
+                    uint64 bit = bits & (~bits + 1);
+                    uint32 row = w * 64 + static_cast<uint32>(std::countr_zero(bits));
+                    if (flags[row].bits & EntityFlagTransformDirty) {
+                        changed |= bit;
+                    }
+                    else if (!(flags[row].bits & EntityFlagWorldChanged)) {
+                        dirtyRows[w] &= ~bit;   // Nothing left to report
+                    }
+                }
+
+                // Rows stay marked until ForEachChanged has reported their new matrix.
+                while (changed) {
+                    uint32 first = static_cast<uint32>(std::countr_zero(changed));
+                    uint32 length = static_cast<uint32>(std::countr_one(changed >> first));
+                    changed &= (length + first == 64) ? 0 : ~uint64(0) << (first + length);
+
+                    uint32 row = w * 64 + first;
+                    if (length >= KernelMinRun) {
+                        ComposeRun(length, positions + row, rotations + row, scales + row, matrices + row);
+                    }
+                    for (uint32 i = row; i < row + length; ++i) {
+                        if (length < KernelMinRun) Compose(positions[i], rotations[i], scales[i], matrices[i]);
+                        flags[i].bits = (flags[i].bits & ~EntityFlagTransformDirty) | EntityFlagWorldChanged;
+                    }
+                    rebuilt += length;
+                }
+            }
+        });
+    return rebuilt;
+}
+
+void TransformSystem::Compose(const Position& position, const Rotation& rotation, const Scale& scale, WorldMatrix& world) {
+    float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+    float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+    float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+    // Rows of the rotation matrix for row vectors, each scaled by its axis.
+    float* m = world.m;
+    m[0] = (1.0f - 2.0f * (yy + zz)) * scale.x;
+    m[1] = 2.0f * (xy + wz) * scale.x;
+    m[2] = 2.0f * (xz - wy) * scale.x;
+    m[3] = 0.0f;
+
+    m[4] = 2.0f * (xy - wz) * scale.y;
+    m[5] = (1.0f - 2.0f * (xx + zz)) * scale.y;
+    m[6] = 2.0f * (yz + wx) * scale.y;
+    m[7] = 0.0f;
+
+    m[8] = 2.0f * (xz + wy) * scale.z;
+    m[9] = 2.0f * (yz - wx) * scale.z;
+    m[10] = (1.0f - 2.0f * (xx + yy)) * scale.z;
+    m[11] = 0.0f;
+
+    m[12] = position.x;
+    m[13] = position.y;
+    m[14] = position.z;
+    m[15] = 1.0f;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "EntityWorld.h"
+#include "SceneComponents.h"
+#include <bit>
+
+// Rebuilds world matrices from position, rotation and scale. Both passes only visit the
+// rows EntityWorld has marked dirty, so transforms must be changed through MarkDirty.
+class TransformSystem {
+public:
+    // Flags the entity EntityFlagTransformDirty and marks its row for the next Update.
+    static void MarkDirty(EntityWorld& world, Handle entity) {
+        if (EntityFlags* flags = world.GetDirty<EntityFlags>(entity)) {
+            flags->bits |= EntityFlagTransformDirty;
+        }
+    }
+
+    // Rebuilds the world matrix of every entity flagged EntityFlagTransformDirty and flags
+    // it EntityFlagWorldChanged instead. Runs of neighbouring rows go through TransformKernel.
+    // Returns the number of matrices rebuilt.
+    static uint32 Update(EntityWorld& world);
+
+    // Calls fn(worldMatrix, components&...) for every entity with Ts flagged
+    // EntityFlagWorldChanged, then clears the flag. Returns the number of entities visited.
+    // Rows still waiting for Update stay marked.
+    template<typename... Ts, typename Fn>
+    static uint32 ForEachChanged(EntityWorld& world, Fn&& fn) {
+        uint32 changed = 0;
+        world.ForEachDirtyChunk<WorldMatrix, EntityFlags, Ts...>(
+            [&](uint32 count, const Handle*, uint64* dirtyRows, WorldMatrix* matrices, EntityFlags* flags, Ts*... columns) {
+                ForEachDirtyRow(count, dirtyRows, [&](uint32 i) {
+                    if (flags[i].bits & EntityFlagWorldChanged) {
+                        fn(matrices[i], columns[i]...);
+                        flags[i].bits &= ~EntityFlagWorldChanged;
+                        ++changed;
+                    }
+                    return (flags[i].bits & EntityFlagTransformDirty) != 0;
+                });
+            });
+        return changed;
+    }
+
+    // world = scale * rotation * translation, matching XMMatrixAffineTransformation
+    // without a rotation origin.
+    static void Compose(const Position& position, const Rotation& rotation, const Scale& scale, WorldMatrix& world);
+
+private:
+    // Calls fn(row) for every dirty row of a chunk holding count rows; the row stays
+    // dirty when fn returns true.
+    template<typename Fn>
+    static void ForEachDirtyRow(uint32 count, uint64* dirtyRows, Fn&& fn) {
+        for (uint32 w = 0; w < (count + 63) / 64; ++w) {
+            uint64 bits = dirtyRows[w];
+            uint64 keep = 0;
+            while (bits) {
+                uint32 bit = static_cast<uint32>(std::countr_zero(bits));
+                bits &= bits - 1;
+                if (fn(w * 64 + bit)) keep |= uint64(1) << bit;
+            }
+            dirtyRows[w] = keep;
+        }
+    }
+};
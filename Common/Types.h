@@ -73,9 +73,17 @@ struct Handle {
     ClassName(ClassName&&) = delete; \
     ClassName& operator=(ClassName&&) = delete;
 
-// Debug macros
+// Debug macros. DEBUG_BUILD follows _DEBUG unless the build sets it, e.g. to test
+// debug-only checks in an optimized build.
+#ifndef DEBUG_BUILD
+    #ifdef _DEBUG
+        #define DEBUG_BUILD 1
+    #else
+        #define DEBUG_BUILD 0
+    #endif
+#endif
+
 #ifdef _DEBUG
-    #define DEBUG_BUILD 1
     #define ASSERT(condition, message) \
         do { \
             if (!(condition)) { \
@@ -87,7 +95,6 @@ struct Handle {
             } \
         } while(0)
 #else
-    #define DEBUG_BUILD 0
     #define ASSERT(condition, message) ((void)0)
 #endif
 
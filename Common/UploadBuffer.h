@@ -1,11 +1,16 @@
 #pragma once
 
 #include <WindowsPlatform.h>
+#include "MemoryUtils.h"
+#include "GpuMemoryAllocator.h"
 
 template<typename T>
 class UploadBuffer {
 public:
-    UploadBuffer(ID3D12Device* device, UINT elementCount, bool isConstantBuffer) :
+    // When an allocator is given the buffer is placed in one of its upload heaps
+    // instead of getting a committed resource of its own.
+    UploadBuffer(ID3D12Device* device, UINT elementCount, bool isConstantBuffer,
+                 GpuMemoryAllocator* allocator = nullptr) :
         mIsConstantBuffer(isConstantBuffer) {
         mElementByteSize = sizeof(T);
 
@@ -20,17 +25,37 @@ public:
             mElementByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(T));
         }
 
-        CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
 		CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(mElementByteSize * elementCount);
-        ThrowIfFailed(device->CreateCommittedResource(
-            &heapProps,
-            D3D12_HEAP_FLAG_NONE,
-            &bufferDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr,
-            IID_PPV_ARGS(&mUploadBuffer)));
+        if (allocator) {
+            ThrowIfFailed(allocator->CreateResource(
+                D3D12_HEAP_TYPE_UPLOAD,
+                bufferDesc,
+                D3D12_RESOURCE_STATE_GENERIC_READ,
+                nullptr,
+                mAllocation,
+                mUploadBuffer));
+        }
+        else {
+            CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+            ThrowIfFailed(device->CreateCommittedResource(
+                &heapProps,
+                D3D12_HEAP_FLAG_NONE,
+                &bufferDesc,
+                D3D12_RESOURCE_STATE_GENERIC_READ,
+                nullptr,
+                IID_PPV_ARGS(&mUploadBuffer)));
+        }
         ThrowIfFailed(mUploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
 
+        // The defragmenter copies the contents on the CPU before handing over the new buffer.
+        if (allocator) {
+            mAllocation.EnableRelocation(D3D12_RESOURCE_STATE_GENERIC_READ, [this](ID3D12Resource* resource) {
+                mUploadBuffer->Unmap(0, nullptr);
+                mUploadBuffer = resource;
+                ThrowIfFailed(mUploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
+            });
+        }
+
         // We do not need to unmap until we are done with the resource.  However, we must not write to
         // the resource while it is in use by the GPU (so we must use synchronization techniques).
     }
@@ -52,7 +77,23 @@ public:
         memcpy(&mMappedData[elementIndex*mElementByteSize], &data, sizeof(T));
     }
 
+    // Copies count consecutive elements starting at firstElement. Non-constant buffers
+    // are tightly packed, so the whole range goes out as one streaming copy.
+    void CopyRange(int firstElement, const T* data, UINT count) {
+        if (count == 0) return;
+
+        if (mElementByteSize == sizeof(T)) {
+            StreamingCopy(&mMappedData[firstElement*mElementByteSize], data, sizeof(T) * count);
+        }
+        else {
+            for (UINT i = 0; i < count; ++i) {
+                memcpy(&mMappedData[(firstElement + i)*mElementByteSize], &data[i], sizeof(T));
+            }
+        }
+    }
+
 private:
+    GpuAllocation mAllocation;  // Declared first so the range outlives the resource
     Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
     BYTE* mMappedData = nullptr;
     UINT mElementByteSize = 0;
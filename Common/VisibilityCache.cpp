@@ -0,0 +1,136 @@
+#include "VisibilityCache.h"
+#include "WorkerPool.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    enum ResultBits : uint8 {
+        ResultVisible = 1,
+        ResultMissed = 2,
+    };
+
+    // Min over the planes of dot(n, center) + d + dot(|n|, extents). The box is inside
+    // the frustum exactly when this is >= 0.
+    float GetMargin(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32 i) {
+        float margin = FLT_MAX;
+        for (uint32 p = 0; p < 6; ++p) {
+            float distance = frustum.normalX[p] * bounds.GetCenterX()[i] + frustum.normalY[p] * bounds.GetCenterY()[i] +
+                             frustum.normalZ[p] * bounds.GetCenterZ()[i] + frustum.d[p];
+            float radius = std::fabs(frustum.normalX[p]) * bounds.GetExtentX()[i] +
+                           std::fabs(frustum.normalY[p]) * bounds.GetExtentY()[i] +
+                           std::fabs(frustum.normalZ[p]) * bounds.GetExtentZ()[i];
+            margin = std::min(margin, distance + radius);
+        }
+        return margin;
+    }
+
+    bool SamePlanes(const FrustumPlanes& a, const FrustumPlanes& b) {
+        return std::memcmp(&a, &b, sizeof(FrustumPlanes)) == 0;
+    }
+}
+
+void VisibilityCache::Resize(uint32 count) {
+    m_margins.assign(count, 0.0f);
+    m_radii.assign(count, 0.0f);
+    m_invalid.assign(count, 0);
+    m_invalidIndices.clear();
+    m_rebase = true;
+}
+
+void VisibilityCache::Invalidate(uint32 index) {
+    if (index >= m_invalid.size() || m_invalid[index]) return;
+
+    m_invalid[index] = 1;
+    m_invalidIndices.push_back(index);
+}
+
+void VisibilityCache::Refresh(const CullingBounds& bounds, uint32 i) {
+    m_margins[i] = GetMargin(m_reference, bounds, i);
+
+    // Empty boxes have negative extents, which must not shrink the bound.
+    float dx = bounds.GetCenterX()[i] - m_referenceOrigin[0];
+    float dy = bounds.GetCenterY()[i] - m_referenceOrigin[1];
+    float dz = bounds.GetCenterZ()[i] - m_referenceOrigin[2];
+    float ex = std::max(bounds.GetExtentX()[i], 0.0f);
+    float ey = std::max(bounds.GetExtentY()[i], 0.0f);
+    float ez = std::max(bounds.GetExtentZ()[i], 0.0f);
+    m_radii[i] = std::sqrt(dx * dx + dy * dy + dz * dz) + std::sqrt(ex * ex + ey * ey + ez * ez);
+}
+
+uint32 VisibilityCache::Cull(const FrustumPlanes& frustum, const float cameraPosition[3], const CullingBounds& bounds,
+                             uint32* visible, WorkerPool* pool) {
+    uint32 count = bounds.GetCount();
+    if (count != m_margins.size()) Resize(count);
+
+    m_stats = Stats();
+    if (!m_rebase && m_invalidIndices.empty() && SamePlanes(frustum, m_lastFrustum)) {
+        if (!m_visible.empty()) std::memcpy(visible, m_visible.data(), m_visible.size() * sizeof(uint32));
+        m_stats.hits = count;
+        m_stats.idle = true;
+        return static_cast<uint32>(m_visible.size());
+    }
+
+    if (m_rebase) {
+        m_reference = frustum;
+        for (uint32 i = 0; i < 3; ++i) m_referenceOrigin[i] = cameraPosition[i];
+        for (uint32 index : m_invalidIndices) m_invalid[index] = 0;
+        m_invalidIndices.clear();
+        m_stats.rebased = true;
+    }
+
+    // A point p moves relative to plane k by (n'_k - n_k) . p + (d'_k - d_k), which is at
+    // most |n'_k - n_k| |p - o| + |(n'_k - n_k) . o + d'_k - d_k| for the reference eye o.
+    // The extents add |n'_k - n_k| |e| at most.
+    float scale = 0.0f, offset = 0.0f;
+    for (uint32 p = 0; p < 6; ++p) {
+        float nx = frustum.normalX[p] - m_reference.normalX[p];
+        float ny = frustum.normalY[p] - m_reference.normalY[p];
+        float nz = frustum.normalZ[p] - m_reference.normalZ[p];
+        float d = frustum.d[p] - m_reference.d[p];
+        scale = std::max(scale, std::sqrt(nx * nx + ny * ny + nz * nz));
+        offset = std::max(offset, std::fabs(nx * m_referenceOrigin[0] + ny * m_referenceOrigin[1] +
+                                            nz * m_referenceOrigin[2] + d));
+    }
+
+    bool rebase = m_stats.rebased;
+    m_visibleFlags.resize(count);
+    auto cullRange = [&](uint32 begin, uint32 end) {
+        for (uint32 i = begin; i < end; ++i) {
+            if (rebase || m_invalid[i]) {
+                Refresh(bounds, i);
+                m_invalid[i] = 0;
+                m_visibleFlags[i] = ResultMissed | ((rebase ? m_margins[i] : GetMargin(frustum, bounds, i)) >= 0.0f);
+            }
+            else if (std::fabs(m_margins[i]) > scale * m_radii[i] + offset) {
+                m_visibleFlags[i] = m_margins[i] >= 0.0f;
+            }
+            else {
+                m_visibleFlags[i] = ResultMissed | (GetMargin(frustum, bounds, i) >= 0.0f);
+            }
+        }
+    };
+
+    if (pool && count >= ParallelThreshold) {
+        pool->ParallelFor(count, 256, cullRange);
+    }
+    else {
+        cullRange(0, count);
+    }
+    m_invalidIndices.clear();
+
+    m_visible.clear();
+    for (uint32 i = 0; i < count; ++i) {
+        if (m_visibleFlags[i] & ResultVisible) m_visible.push_back(i);
+        m_stats.misses += (m_visibleFlags[i] & ResultMissed) >> 1;
+    }
+    m_stats.hits = count - m_stats.misses;
+
+    // Once the camera has wandered far enough that many margins are too small, measuring
+    // from the current camera makes the following frames cheap again.
+    m_rebase = !rebase && m_stats.misses > static_cast<uint32>(static_cast<float>(count) * RebaseMissRatio);
+    m_lastFrustum = frustum;
+
+    if (!m_visible.empty()) std::memcpy(visible, m_visible.data(), m_visible.size() * sizeof(uint32));
+    return static_cast<uint32>(m_visible.size());
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Types.h>
+#include "FrustumCuller.h"
+
+// Frustum culling that reuses last frame's answers. Each box keeps how far inside (or
+// outside) a reference frustum it was, and how far it is from the reference camera.
+// Moving the camera shifts every plane by at most A * distance + B for the box, with A
+// and B taken from the plane differences, so a box whose margin is larger than that
+// keeps its state without being tested. Boxes that moved are always retested, and the
+// reference is moved to the current camera once too many boxes miss.
+//
+// A frame where neither the camera nor any box changed only copies the last result.
+class VisibilityCache {
+public:
+    // Share of boxes missing in one frame that makes the next frame retest everything
+    // against the camera of that frame.
+    static constexpr float RebaseMissRatio = 0.25f;
+
+    // Boxes per call below which threading costs more than it saves.
+    static constexpr uint32 ParallelThreshold = 8192;
+
+    struct Stats {
+        uint32 hits = 0;            // Boxes answered from the cache
+        uint32 misses = 0;          // Boxes tested against the frustum
+        bool idle = false;          // Nothing changed and the last result was reused
+        bool rebased = false;       // Everything was retested against a new reference
+    };
+
+    // Marks the box at index as moved, so it is retested on the next Cull.
+    void Invalidate(uint32 index);
+    void InvalidateAll() { m_rebase = true; }
+
+    // Same contract as FrustumCuller::Cull: writes the indices of the boxes that
+    // intersect the frustum to visible in ascending order and returns how many there
+    // are. cameraPosition is the eye the frustum was built from.
+    uint32 Cull(const FrustumPlanes& frustum, const float cameraPosition[3], const CullingBounds& bounds,
+                uint32* visible, WorkerPool* pool = nullptr);
+
+    // Counts of the last Cull.
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    FrustumPlanes m_reference = {};
+    float m_referenceOrigin[3] = {};
+    FrustumPlanes m_lastFrustum = {};
+    bool m_rebase = true;
+
+    // Per box: min over the reference planes of signed distance plus projected extent,
+    // which is >= 0 exactly when the box is visible, and the distance bound's scale.
+    Vector<float> m_margins;
+    Vector<float> m_radii;
+    Vector<uint8> m_invalid;
+    Vector<uint32> m_invalidIndices;
+
+    Vector<uint8> m_visibleFlags;
+    Vector<uint32> m_visible;           // Last result, reused by idle frames
+    Stats m_stats;
+
+    void Resize(uint32 count);
+    void Refresh(const CullingBounds& bounds, uint32 index);
+};
@@ -16,6 +16,7 @@
 #include <DirectXColors.h>
 #include <DirectXCollision.h>
 #include <DDSTextureLoader.h>
+#include <GpuAllocation.h>
 
 // Link necessary d3d12 libraries.
 #pragma comment(lib,"d3dcompiler.lib")
@@ -170,6 +171,13 @@ struct MeshGeometry {
 	// Give it a name so we can look it up by name.
 	std::string Name;
 
+	// Heap ranges of the GPU buffers when they were placed through GpuMemoryAllocator.
+	// Declared before the resources so the ranges are returned after the resources are released.
+	GpuAllocation VertexBufferAllocation;
+	GpuAllocation IndexBufferAllocation;
+	GpuAllocation VertexUploaderAllocation;
+	GpuAllocation IndexUploaderAllocation;
+
 	// System memory copies.  Use Blobs because the vertex/index format can be generic.
 	// It is up to the client to cast appropriately.
 	ComPtr<ID3DBlob> VertexBufferCPU = nullptr;
@@ -214,6 +222,8 @@ struct MeshGeometry {
 	void DisposeUploaders() {
 		VertexBufferUploader = nullptr;
 		IndexBufferUploader = nullptr;
+		VertexUploaderAllocation.Reset();
+		IndexUploaderAllocation.Reset();
 	}
 };
 
@@ -223,8 +233,15 @@ struct Texture {
 
     WString filename;
 
+    // Heap ranges when placed through GpuMemoryAllocator.
+    GpuAllocation allocation;
+    GpuAllocation uploadAllocation;
+
     ComPtr<ID3D12Resource> resource = nullptr;
     ComPtr<ID3D12Resource> uploadHeap = nullptr;
+
+    // Slot in the bindless texture table; 0 is the null fallback until one is assigned.
+    uint32 bindlessIndex = 0;
 };
 
 // Error checking macros
@@ -0,0 +1,126 @@
+#include "WorkerPool.h"
+
+namespace {
+    // Pool whose batches the current thread is running, for detecting nested calls.
+    thread_local const WorkerPool* t_runningPool = nullptr;
+
+    class RunningPoolScope {
+    public:
+        explicit RunningPoolScope(const WorkerPool* pool) : m_previous(t_runningPool) { t_runningPool = pool; }
+        ~RunningPoolScope() { t_runningPool = m_previous; }
+
+    private:
+        const WorkerPool* m_previous;
+    };
+}
+
+uint32 WorkerPool::GetDefaultWorkerCount() {
+    uint32 threads = std::thread::hardware_concurrency();
+    return threads > 1 ? threads - 1 : 0;
+}
+
+WorkerPool::WorkerPool(uint32 workerCount) {
+    m_workers.reserve(workerCount);
+    for (uint32 i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back([this] { WorkerMain(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::RunBatches(Job& job) {
+    for (;;) {
+        uint32 batch = job.nextBatch.fetch_add(1, std::memory_order_relaxed);
+        if (batch >= job.batchCount) return;
+
+        uint32 begin = batch * job.batchSize;
+        uint32 end = std::min(job.count, begin + job.batchSize);
+        try {
+            (*job.fn)(begin, end);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(job.errorMutex);
+            if (!job.error) job.error = std::current_exception();
+            job.nextBatch.store(job.batchCount, std::memory_order_relaxed);
+        }
+    }
+}
+
+void WorkerPool::ParallelFor(uint32 count, uint32 minBatch, const Function<void(uint32, uint32)>& fn) {
+    if (count == 0) return;
+    minBatch = std::max<uint32>(1, minBatch);
+
+    // A few batches per thread balance uneven work without much claiming overhead.
+    uint32 targetBatches = GetThreadCount() * 4;
+    uint32 batchSize = std::max(minBatch, (count + targetBatches - 1) / targetBatches);
+    batchSize = (batchSize + minBatch - 1) / minBatch * minBatch;
+
+    // Waiting for the pool from one of its own batches would deadlock on m_submitMutex.
+    if (m_workers.empty() || batchSize >= count || t_runningPool == this) {
+        fn(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(m_submitMutex);
+
+    Job job;
+    job.fn = &fn;
+    job.count = count;
+    job.batchSize = batchSize;
+    job.batchCount = (count + batchSize - 1) / batchSize;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        ++m_jobSerial;
+    }
+    m_wake.notify_all();
+
+    {
+        RunningPoolScope scope(this);
+        RunBatches(job);
+    }
+
+    // Every batch is claimed by now. Closing the job keeps late workers out; the ones
+    // that joined finish the batches they claimed before the job leaves the stack.
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job = nullptr;
+        m_idle.wait(lock, [this] { return m_activeWorkers == 0; });
+    }
+
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void WorkerPool::WorkerMain() {
+    RunningPoolScope scope(this);
+    uint64 seenSerial = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [&] { return m_stop || (m_job && m_jobSerial != seenSerial); });
+        if (m_stop) return;
+
+        seenSerial = m_jobSerial;
+        Job* job = m_job;
+        ++m_activeWorkers;
+        lock.unlock();
+
+        RunBatches(*job);
+
+        lock.lock();
+        if (--m_activeWorkers == 0) {
+            m_idle.notify_all();
+        }
+    }
+}
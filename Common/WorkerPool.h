@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Types.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+// Fixed set of worker threads for data-parallel loops. The calling thread works on the
+// loop too, so a pool with no workers simply runs it inline.
+class WorkerPool {
+public:
+    // One worker per hardware thread besides the caller's.
+    static uint32 GetDefaultWorkerCount();
+
+    explicit WorkerPool(uint32 workerCount = GetDefaultWorkerCount());
+    ~WorkerPool();
+
+    DECLARE_NON_COPYABLE(WorkerPool)
+    DECLARE_NON_MOVABLE(WorkerPool)
+
+    // Splits [0, count) into batches and calls fn(begin, end) for each, returning once all
+    // are done. Batches hold a multiple of minBatch elements and start at multiples of it,
+    // so SIMD loops can keep whole vectors. Concurrent calls run one after the other.
+    //
+    // Calls made from inside fn, on any thread working for this pool, run inline on that
+    // thread instead of waiting for the pool. When fn throws, the batches nobody has
+    // started yet are skipped and the first exception is rethrown here once every
+    // running batch has finished.
+    void ParallelFor(uint32 count, uint32 minBatch, const Function<void(uint32, uint32)>& fn);
+
+    // Workers plus the calling thread.
+    uint32 GetThreadCount() const { return static_cast<uint32>(m_workers.size()) + 1; }
+
+private:
+    struct Job {
+        const Function<void(uint32, uint32)>* fn = nullptr;
+        uint32 count = 0;
+        uint32 batchSize = 0;
+        uint32 batchCount = 0;
+        std::atomic<uint32> nextBatch{ 0 };
+
+        std::mutex errorMutex;
+        std::exception_ptr error;       // First exception thrown by fn
+    };
+
+    static void RunBatches(Job& job);
+    void WorkerMain();
+
+    Vector<std::thread> m_workers;
+    std::mutex m_submitMutex;           // Serializes ParallelFor calls
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    Job* m_job = nullptr;               // Open for workers to join, guarded by m_mutex
+    uint64 m_jobSerial = 0;
+    uint32 m_activeWorkers = 0;
+    bool m_stop = false;
+};
@@ -2,7 +2,39 @@
 // texture.hlsl - Simple texture mapping shader without lighting
 //***************************************************************************************
 
-Texture2D gDiffuseMap : register(t0);
+struct MaterialData
+{
+	float4 DiffuseAlbedo;
+	float3 FresnelR0;
+	float Roughness;
+	float4x4 MatTransform;
+	uint DiffuseMapIndex;
+	uint MatPad0;
+	uint MatPad1;
+	uint MatPad2;
+};
+
+struct ObjectData
+{
+	float4x4 World;
+	uint MaterialIndex;
+	uint Flags;
+	uint ObjPad0;
+	uint ObjPad1;
+};
+
+// Every material of the scene, indexed by the object's material index.
+StructuredBuffer<MaterialData> gMaterials : register(t0);
+
+// Per-object data of the frame, indexed by draw ID plus instance ID.
+StructuredBuffer<ObjectData> gObjects : register(t1);
+
+// Draw IDs of the frame's instanced draws, indexed by instance offset plus instance ID.
+StructuredBuffer<uint> gInstanceDrawIds : register(t2);
+
+// Every texture lives in one bindless table; materials refer to them by slot.
+Texture2D gTextures[] : register(t0, space1);
+
 SamplerState gsamPointWrap : register(s0);
 SamplerState gsamPointClamp : register(s1);
 SamplerState gsamLinearWrap : register(s2);
@@ -10,9 +42,29 @@ SamplerState gsamLinearClamp : register(s3);
 SamplerState gsamAnisotropicWrap : register(s4);
 SamplerState gsamAnisotropicClamp : register(s5);
 
-cbuffer cbPerObject : register(b0)
+// Root constants, the only arguments that change between draws.
+cbuffer cbDraw : register(b0)
 {
-	float4x4 gWorldViewProj; 
+	uint gDrawId;
+	uint gInstanceOffset;	// 0xFFFFFFFF when the draw covers consecutive draw IDs
+};
+
+cbuffer cbPass : register(b1)
+{
+	float4x4 gView;
+	float4x4 gInvView;
+	float4x4 gProj;
+	float4x4 gInvProj;
+	float4x4 gViewProj;
+	float4x4 gInvViewProj;
+	float3 gEyePosW;
+	float cbPerObjectPad1;
+	float2 gRenderTargetSize;
+	float2 gInvRenderTargetSize;
+	float gNearZ;
+	float gFarZ;
+	float gTotalTime;
+	float gDeltaTime;
 };
 
 struct VertexIn
@@ -22,29 +74,66 @@ struct VertexIn
     float2 TexC : TEXCOORD;
 };
 
+// Per-instance data of InstancedStaticMesh, read from vertex buffer slot 1.
+struct InstanceIn
+{
+	float4 World0 : WORLD0;
+	float4 World1 : WORLD1;
+	float4 World2 : WORLD2;
+	float4 World3 : WORLD3;
+	float4 Color : COLOR;
+};
+
 struct VertexOut
 {
 	float4 PosH  : SV_POSITION;
     float2 TexC : TEXCOORD;
+    float4 Color : COLOR;
+    nointerpolation uint MaterialIndex : MATERIAL;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceID : SV_InstanceID)
 {
 	VertexOut vout;
+
+	uint drawId = (gInstanceOffset != 0xFFFFFFFF) ? gInstanceDrawIds[gInstanceOffset + instanceID] : gDrawId + instanceID;
+	ObjectData object = gObjects[drawId];
 	
 	// Transform to homogeneous clip space.
-	vout.PosH = mul(float4(vin.PosL, 1.0f), gWorldViewProj);
+	float4 posW = mul(float4(vin.PosL, 1.0f), object.World);
+	vout.PosH = mul(posW, gViewProj);
 	
 	// Pass texture coordinates to pixel shader
     vout.TexC = vin.TexC;
+    vout.Color = float4(1.0f, 1.0f, 1.0f, 1.0f);
+    vout.MaterialIndex = object.MaterialIndex;
+    
+    return vout;
+}
+
+// Instances carry their own world matrix and tint; the draw's object only supplies the material.
+VertexOut VSInstanced(VertexIn vin, InstanceIn instance)
+{
+	VertexOut vout;
+
+	float4x4 world = float4x4(instance.World0, instance.World1, instance.World2, instance.World3);
+	float4 posW = mul(float4(vin.PosL, 1.0f), world);
+	vout.PosH = mul(posW, gViewProj);
+
+    vout.TexC = vin.TexC;
+    vout.Color = instance.Color;
+    vout.MaterialIndex = gObjects[gDrawId].MaterialIndex;
     
     return vout;
 }
 
 float4 PS(VertexOut pin) : SV_Target
 {
-    // Sample the texture
-    float4 diffuseAlbedo = gDiffuseMap.Sample(gsamAnisotropicWrap, pin.TexC);
+    MaterialData material = gMaterials[pin.MaterialIndex];
+
+    // Sample the texture. Instances of one draw may use different materials.
+    float4 diffuseAlbedo = material.DiffuseAlbedo *
+        gTextures[NonUniformResourceIndex(material.DiffuseMapIndex)].Sample(gsamAnisotropicWrap, pin.TexC);
     
-    return diffuseAlbedo;
-}
\ No newline at end of file
+    return diffuseAlbedo * pin.Color;
+}
@@ -16,7 +16,7 @@ Application::Application(const ApplicationConfig& config)
     // Setup event callbacks
     SetupEventCallbacks();
 
-	m_graphics = std::make_unique<Graphics>(m_window.get());
+	m_graphics = std::make_unique<Graphics>(m_window.get(), m_config.framesInFlight);
     if (!m_graphics) {
         throw std::runtime_error("Graphics initialization failed");
 	}
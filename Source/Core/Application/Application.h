@@ -11,6 +11,7 @@ struct ApplicationConfig {
     WindowDesc windowDesc;
     bool enableDebugLayer = DEBUG_BUILD;
     bool enableValidation = DEBUG_BUILD;
+    uint32 framesInFlight = FramePacer::DefaultFramesInFlight;     // 1 to 4, fewer trades throughput for input latency
 };
 
 class Application {
@@ -1,7 +1,55 @@
 #include "Graphics.h"
+#include <DrawEmitter.h>
+
+namespace {
+	// Records DrawEmitter's draws into the frame's command list through the DrawBinder.
+	class CommandListDrawSink : public IDrawCommandSink {
+	public:
+		// pipelines holds, by draw ID, the pipeline each object's queue key was built from.
+		CommandListDrawSink(ID3D12GraphicsCommandList* commandList, DrawBinder& binder,
+			const Vector<IRenderObject*>& objectsByDrawId, const Vector<ID3D12PipelineState*>& pipelines)
+			: m_commandList(commandList), m_binder(binder), m_objectsByDrawId(objectsByDrawId), m_pipelines(pipelines) {
+		}
+
+		bool BindDraw(uint32 drawId, uint32 instanceOffset, IndexRange& range) override {
+			IRenderObject* object = m_objectsByDrawId[drawId];
+			const SubmeshDrawRecord* record = object->GetDrawRecord();
+			if (!record) return false;
+
+			m_binder.SetPipelineState(m_pipelines[drawId]);
+			m_binder.SetGeometry(object->GetGeometry());
+			DrawConstants constants;
+			constants.DrawId = drawId;
+			constants.InstanceOffset = instanceOffset;
+			m_binder.SetConstants(RootParamDrawConstants, &constants, DrawConstantCount);
+
+			range.indexCount = record->IndexCount;
+			range.startIndex = record->StartIndexLocation;
+			range.baseVertex = record->BaseVertexLocation;
+			return true;
+		}
+
+		void DrawIndexedInstanced(uint32 indexCountPerInstance, uint32 instanceCount, uint32 startIndexLocation,
+			int32 baseVertexLocation, uint32 startInstanceLocation) override {
+			m_commandList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation,
+				baseVertexLocation, startInstanceLocation);
+		}
 
+		// Objects with their own pipeline, e.g. instanced meshes, draw themselves.
+		void RenderObject(uint32 drawId) override {
+			m_binder.SetPipelineState(m_pipelines[drawId]);
+			m_objectsByDrawId[drawId]->Render(m_binder);
+		}
+
+	private:
+		ID3D12GraphicsCommandList* m_commandList;
+		DrawBinder& m_binder;
+		const Vector<IRenderObject*>& m_objectsByDrawId;
+		const Vector<ID3D12PipelineState*>& m_pipelines;
+	};
+}
 
-Graphics::Graphics(Window* wnd)
+Graphics::Graphics(Window* wnd, uint32 framesInFlight)
 	: m_window(wnd) {
 	Platform::OutputDebugMessage("Initializing Graphics...\n");
 
@@ -20,6 +68,9 @@ Graphics::Graphics(Window* wnd)
 	THROW_IF_FAILED(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE,
 		IID_PPV_ARGS(&m_fence)), __FUNCTION__);
 
+	m_gpuAllocator = UniquePtr<GpuMemoryAllocator>(new GpuMemoryAllocator(m_device.Get()));
+	m_defragmenter = UniquePtr<GpuDefragmenter>(new GpuDefragmenter(m_device.Get(), m_gpuAllocator.get()));
+
 	// Descriptor sizes can vary across GPUs so we need to query
 	// this information. We cache the descriptor sizes so that it
 	// is available when we need it for various descriptor types.
@@ -33,6 +84,10 @@ Graphics::Graphics(Window* wnd)
 	// Creation of command queue, command allocator and command list
 	CreateCommandObjects();
 
+	m_gpuFence = UniquePtr<D3D12GpuFence>(new D3D12GpuFence(m_commandQueue.Get(), m_fence.Get()));
+	m_fenceTimeline = UniquePtr<FenceTimeline>(new FenceTimeline(m_gpuFence.get()));
+	m_framePacer = UniquePtr<FramePacer>(new FramePacer(m_gpuFence.get(), framesInFlight));
+
 	CreateSwapChain(wnd);
 
 	// Create rtv and dsv descriptor heaps
@@ -51,14 +106,14 @@ Graphics::Graphics(Window* wnd)
 	*/
 	// Build frame resources first
 	BuildFrameResources();
-	// Build the descriptor heaps for the scene.
-    D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-    cbvHeapDesc.NumDescriptors = 2; // 1 CBV + 1 SRV for texture
-    cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	cbvHeapDesc.NodeMask = 0;
-    ThrowIfFailed(m_device->CreateDescriptorHeap(&cbvHeapDesc,
-        IID_PPV_ARGS(&m_cbvHeap)));
+	// Build the descriptor heap for the scene: persistent SRVs up front, per-frame CBVs in a ring.
+	// Resource binding tier 1 hardware can only bind a small texture table.
+	uint32 textureTableCapacity = DescriptorHeapManager::GetMaxTextureTableCapacity(m_device.Get());
+	if (textureTableCapacity < DescriptorHeapManager::DefaultTextureTableCapacity) {
+		Platform::OutputDebugMessage("Resource binding tier 1: the bindless texture table is limited to " +
+			std::to_string(textureTableCapacity) + " textures\n");
+	}
+	m_descriptors = UniquePtr<DescriptorHeapManager>(new DescriptorHeapManager(m_device.Get(), textureTableCapacity));
 
 	// Create root signature
 	//
@@ -68,55 +123,39 @@ Graphics::Graphics(Window* wnd)
 	// the input resources as function parameters, then the root signature can be
 	// thought of as defining the function signature.
 
-	// Root parameter can be a table, root descriptor or root constants.
-	CD3DX12_ROOT_PARAMETER slotRootParameter[2];
-
-	// Create a single descriptor table of CBVs.
-	CD3DX12_DESCRIPTOR_RANGE cbvTable;
-	cbvTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
-	slotRootParameter[0].InitAsDescriptorTable(1, &cbvTable);
-
-	// Create SRV table for textures
-	CD3DX12_DESCRIPTOR_RANGE texTable;
-	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
-	slotRootParameter[1].InitAsDescriptorTable(1, &texTable);
-
-	// Create samplers
+	// Per-draw data is a root constant block (draw ID, material index) so consecutive draws
+	// change a single root argument. Object and pass constants are root CBVs, materials
+	// and textures are tables bound once per frame.
 	auto staticSamplers = GetStaticSamplers();
-
-	// A root signature is an array of root parameters.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(2, slotRootParameter,
-		(UINT)staticSamplers.size(), staticSamplers.data(),
-		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
-
-	// create a root signature with a single slot which points to a descriptor range consisting of a single constant buffer
-	ComPtr<ID3DBlob> serializedRootSig = nullptr;
-	ComPtr<ID3DBlob> errorBlob = nullptr;
-	HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
-		serializedRootSig.GetAddressOf(), errorBlob.GetAddressOf());
-
-	if (errorBlob != nullptr) {
-		::OutputDebugStringA((char*)errorBlob->GetBufferPointer());
-	}
-	ThrowIfFailed(hr);
-
-	ThrowIfFailed(m_device->CreateRootSignature(
-		0,
-		serializedRootSig->GetBufferPointer(),
-		serializedRootSig->GetBufferSize(),
-		IID_PPV_ARGS(&m_rootSignature)));
+	m_rootSignature = CreateRootSignature(m_device.Get(),
+		BuildSceneRootSignatureDesc(m_descriptors->GetTextureTable().GetCapacity()),
+		staticSamplers.data(), (UINT)staticSamplers.size(),
+		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS);
 
 	// Initialize ResourceManager
-	m_resourceManager = UniquePtr<ResourceManager>(new ResourceManager(m_device.Get(), m_commandList.Get()));
+	m_resourceManager = UniquePtr<ResourceManager>(new ResourceManager(m_device.Get(), m_commandList.Get(), m_gpuAllocator.get(),
+		m_fenceTimeline.get(), m_descriptors.get()));
 
-	// Build shaders and input layout
-	m_vsByteCode = d3dUtil::CompileShader(L"Shaders\\texture.hlsl", nullptr, "VS", "vs_5_0");
-	m_psByteCode = d3dUtil::CompileShader(L"Shaders\\texture.hlsl", nullptr, "PS", "ps_5_0");
+	// Build shaders and input layout. Unbounded texture arrays need shader model 5.1.
+	m_vsByteCode = d3dUtil::CompileShader(L"Shaders\\texture.hlsl", nullptr, "VS", "vs_5_1");
+	m_psByteCode = d3dUtil::CompileShader(L"Shaders\\texture.hlsl", nullptr, "PS", "ps_5_1");
     m_inputLayout = {
         { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
         { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
         { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
     };
+	m_instancedVsByteCode = d3dUtil::CompileShader(L"Shaders\\texture.hlsl", nullptr, "VSInstanced", "vs_5_1");
+	m_instancedInputLayout = m_inputLayout;
+	m_instancedInputLayout.insert(m_instancedInputLayout.end(), {
+		{ "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 }
+	});
 
 	//Load Textures
 	LoadTextures();
@@ -127,36 +166,81 @@ Graphics::Graphics(Window* wnd)
 	BuildPSOs();
 
 	// Create render object
-	auto meshComponent = m_resourceManager->CreateMeshComponent("box");
-	auto materialComponent = m_resourceManager->CreateMaterial("default");
-
-	m_boxObject = UniquePtr<StaticMesh>(new StaticMesh(meshComponent, materialComponent, "box"));
-	// Don't initialize constant buffer here - we'll use frame resources
-	// Each frame resource has its own constant buffers
-
-	// Create descriptor for the frame resource constant buffer
-	// We'll bind the appropriate one during rendering
-	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-
-	// Create CBV for the first frame resource as initial setup
-	if (m_frameResources.size() > 0 && m_frameResources[0]->ObjectCB) {
-		D3D12_GPU_VIRTUAL_ADDRESS cbAddress = m_frameResources[0]->ObjectCB->Resource()->GetGPUVirtualAddress();
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
-		cbvDesc.BufferLocation = cbAddress;
-		cbvDesc.SizeInBytes = objCBByteSize;
+	auto meshComponent = m_resourceManager->CreateMeshComponent(ID("box"));
+	auto materialComponent = m_resourceManager->CreateMaterial(ID("default"), MaterialConstants(), "woodCrateTex");
+
+	m_boxObject = m_renderObjects.Insert(UniquePtr<StaticMesh>(new StaticMesh(meshComponent, materialComponent, "box")));
+
+	// A smaller box on top of it, placed relative to the box once attached below.
+	Handle topBox = m_renderObjects.Insert(UniquePtr<StaticMesh>(new StaticMesh(meshComponent, materialComponent, "box")));
+	(*m_renderObjects.Get(topBox))->SetPosition(DirectX::XMFLOAT3(0.0f, 1.5f, 0.0f));
+	(*m_renderObjects.Get(topBox))->SetScale(DirectX::XMFLOAT3(0.5f, 0.5f, 0.5f));
+
+	// Two walls beyond the crate grid, large enough to hide what stands behind them, and a
+	// ring of posts. None of them ever moves, so they are merged into static batches.
+	for (float32 z : { -30.0f, 30.0f }) {
+		StaticMesh* wall = m_renderObjects.Get(m_renderObjects.Insert(
+			UniquePtr<StaticMesh>(new StaticMesh(meshComponent, materialComponent, "box"))))->get();
+		wall->SetPosition(DirectX::XMFLOAT3(0.0f, -2.0f, z));
+		wall->SetScale(DirectX::XMFLOAT3(12.0f, 3.0f, 0.5f));
+		wall->SetStatic(true);
+	}
+	for (uint32 i = 0; i < 16; ++i) {
+		float32 angle = DirectX::XM_2PI * i / 16.0f;
+		StaticMesh* post = m_renderObjects.Get(m_renderObjects.Insert(
+			UniquePtr<StaticMesh>(new StaticMesh(meshComponent, materialComponent, "box"))))->get();
+		post->SetPosition(DirectX::XMFLOAT3(20.0f * std::cos(angle), -3.0f, 20.0f * std::sin(angle)));
+		post->SetScale(DirectX::XMFLOAT3(0.3f, 1.5f, 0.3f));
+		post->SetStatic(true);
+	}
 
-		m_device->CreateConstantBufferView(
-			&cbvDesc,
-			m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
+	// Every object keeps its data in a persistent slot that doubles as its draw ID.
+	m_objectBuffer = UniquePtr<PersistentObjectBuffer>(new PersistentObjectBuffer(m_device.Get(), MaxObjectCount, m_gpuAllocator.get()));
+	m_workerPool = UniquePtr<WorkerPool>(new WorkerPool());
+	BuildStaticBatches();
+	m_cullingBounds.Resize(MaxObjectCount);
+	m_objectsByDrawId.resize(MaxObjectCount, nullptr);
+	m_drawPipelines.resize(MaxObjectCount, nullptr);
+	m_isStaticBatch.resize(MaxObjectCount, 0);
+	for (auto& object : m_renderObjects) {
+		uint32 drawId = m_objectBuffer->GetStore().Allocate();
+		object->SetConstantBufferIndex(drawId);
+		object->SetDirtyList(&m_dirtyObjects);
+		m_objectsByDrawId[drawId] = object.get();
 	}
+	// Selection and gameplay queries want the objects themselves, which stay queryable
+	// through their hidden sources, not the merged batches.
+	for (Handle batch : m_staticBatchObjects) {
+		m_isStaticBatch[(*m_renderObjects.Get(batch))->GetConstantBufferIndex()] = 1;
+	}
+	MarkOccluders();
+	// The box's transform comes from its entity.
+	CreateEntity(m_boxObject, Position());
+	AttachObject(topBox, m_boxObject);
+
+	// A grid of crates around the box, drawn as one instanced draw.
+	UniquePtr<InstancedStaticMesh> crates(new InstancedStaticMesh(meshComponent, materialComponent, "box"));
+	for (int32 z = -4; z < 4; ++z) {
+		for (int32 x = -4; x < 4; ++x) {
+			InstancedStaticMesh::InstanceData instance;
+			DirectX::XMStoreFloat4x4(&instance.World, DirectX::XMMatrixTranslation(x * 6.0f + 3.0f, -4.0f, z * 6.0f + 3.0f));
+			instance.Color = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+			crates->AddInstance(instance);
+		}
+	}
+	AddInstancedMesh(std::move(crates));
+	// Don't initialize constant buffer here - we'll use frame resources
+	// Each frame resource has its own constant buffers, whose CBVs are written
+	// into the transient descriptor ring while rendering.
 
     // Execute the initialization commands.
     ThrowIfFailed(m_commandList->Close());
 	ID3D12CommandList* cmdsLists[] = { m_commandList.Get() };
 	m_commandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
 
-    // Wait until initialization is complete.
-    FlushCommandQueue();
+	// The upload buffers are released once the GPU has executed the initialization commands.
+	m_resourceManager->CleanupUploadBuffers();
+	m_fenceTimeline->Signal();
 }
 
 void Graphics::CacheDescSizes() {
@@ -279,59 +363,155 @@ void Graphics::EnableDebugLayer() {
 }
 
 void Graphics::FlushCommandQueue() {
-	// Advance the fence value to mark commands up to this fence point.
-    m_currentFence++;
-
-    // Add an instruction to the command queue to set a new fence point.  Because we
-	// are on the GPU timeline, the new fence point won't be set until the GPU finishes
-	// processing all the commands prior to this Signal().
-    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_currentFence));
-
-	// Wait until the GPU has completed commands up to this fence point.
-    if(m_fence->GetCompletedValue() < m_currentFence) {
-		ScopedHandle eventHandle(CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS));
-
-        // Fire event when GPU hits current fence.
-        ThrowIfFailed(m_fence->SetEventOnCompletion(m_currentFence, eventHandle.get()));
-
-        // Wait until the GPU hits current fence event is fired.
-		WaitForSingleObject(eventHandle.get(), INFINITE);
-        // CloseHandle is automatically called by ScopedHandle destructor
-	}
+	// Signal a new fence point and wait until the GPU has processed all commands before it.
+	// Only needed when the swap chain itself changes; everything else is released through
+	// the fence timeline.
+	m_fenceTimeline->WaitForIdle();
 }
 
 void Graphics::Update(float32 deltaTime) {
 	UpdateCamera(deltaTime);
 
-	// Cycle through the circular frame resource array.
-	m_currFrameResourceIndex = (m_currFrameResourceIndex + 1) % NumFrameResources;
+	// Cycle through the circular frame resource array. The pacer waits until the GPU
+	// has finished processing the commands of the frame that last used this resource.
+	m_currFrameResourceIndex = m_framePacer->BeginFrame();
 	m_currFrameResource = m_frameResources[m_currFrameResourceIndex].get();
 
-	// Has the GPU finished processing the commands of the current frame resource?
-	// If not, wait until the GPU has completed commands up to this fence point.
-	if (m_currFrameResource->Fence != 0 && m_fence->GetCompletedValue() < m_currFrameResource->Fence) {
-		HANDLE eventHandle = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
-		assert(eventHandle && "Failed to create event handle.");
-		ThrowIfFailed(m_fence->SetEventOnCompletion(m_currFrameResource->Fence, eventHandle));
-		WaitForSingleObject(eventHandle, INFINITE);
-		CloseHandle(eventHandle);
-	}
+	m_fenceTimeline->CollectGarbage();
 
 	// Update object constant buffers
 	DirectX::XMMATRIX view = DirectX::XMLoadFloat4x4(&mView);
 	DirectX::XMMATRIX proj = DirectX::XMLoadFloat4x4(&mProj);
+	DirectX::XMFLOAT4X4 viewProj;
+	DirectX::XMStoreFloat4x4(&viewProj, view * proj);
+
+	// Instance buffers follow the frame resource, so the slot written here is one the GPU
+	// has finished reading.
+	for (auto& mesh : m_instancedMeshes) {
+		mesh->SetFrameIndex(m_currFrameResourceIndex, m_framePacer->GetFrameNumber());
+		mesh->Update(deltaTime, view, proj);
+	}
 
-	// Update the constant buffer for this frame
-	if (m_boxObject && m_currFrameResource->ObjectCB) {
-		DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&m_boxObject->GetWorldMatrix());
-		DirectX::XMMATRIX worldViewProj = world * view * proj;
-
-		ObjectConstants objConstants;
-		DirectX::XMStoreFloat4x4(&objConstants.WorldViewProj, DirectX::XMMatrixTranspose(worldViewProj));
-		DirectX::XMStoreFloat4x4(&objConstants.World, DirectX::XMMatrixTranspose(world));
+	// Only objects whose transform or material changed are uploaded; the camera no longer
+	// touches per-object data since the view-projection lives in the pass constants.
+	m_objectBuffer->GetStore().Reclaim(m_fenceTimeline->GetCompletedValue());
+	// Entities whose transform changed rebuild their matrices and hand them to their objects.
+	TransformSystem::Update(m_entities);
+	// Attached objects take it as their local transform instead.
+	TransformSystem::ForEachChanged<RenderObjectRef>(m_entities, [this](const WorldMatrix& world, RenderObjectRef& ref) {
+		if (ref.object->GetTransformNode().IsValid()) {
+			m_transformHierarchy.SetLocal(ref.object->GetTransformNode(), world);
+		}
+		else {
+			ref.object->SetWorldMatrix(DirectX::XMFLOAT4X4(world.m));
+		}
+	});
+	// Transforms set since the last frame are composed here in one batch.
+	m_dirtyObjects.Flush(m_workerPool.get());
+
+	// Attached objects hand their transform to the hierarchy as the local one and take
+	// the composed world matrix back, which queues their children's objects as well.
+	for (IRenderObject* object : m_dirtyObjects.GetTransformedObjects()) {
+		if (!object->GetTransformNode().IsValid()) continue;
+
+		WorldMatrix local;
+		std::memcpy(local.m, &object->GetWorldMatrix().m[0][0], sizeof(local.m));
+		m_transformHierarchy.SetLocal(object->GetTransformNode(), local);
+	}
+	m_transformHierarchy.Update(m_workerPool.get());
+	m_transformHierarchy.ForEachChanged([this](Handle objectHandle, const WorldMatrix& world) {
+		if (auto* object = m_renderObjects.Get(objectHandle)) {
+			(*object)->SetWorldMatrix(DirectX::XMFLOAT4X4(world.m));
+		}
+	});
+
+	for (IRenderObject* object : m_dirtyObjects.GetObjects()) {
+		uint32 flags = object->IsTransparent() ? ObjectFlagTransparent : ObjectFlagNone;
+		m_objectBuffer->GetStore().Update(object->GetConstantBufferIndex(),
+			&object->GetWorldMatrix().m[0][0], object->GetMaterialIndex(), flags);
+		object->ClearDirty();
+
+		DirectX::BoundingBox localBounds, worldBounds;
+		if (object->GetLocalBounds(localBounds)) {
+			localBounds.Transform(worldBounds, DirectX::XMLoadFloat4x4(&object->GetWorldMatrix()));
+			m_cullingBounds.Set(object->GetConstantBufferIndex(), &worldBounds.Center.x, &worldBounds.Extents.x);
+			if (!m_isStaticBatch[object->GetConstantBufferIndex()]) {
+				m_spatialIndex.Insert(object->GetConstantBufferIndex(), &worldBounds.Center.x, &worldBounds.Extents.x);
+			}
+		}
+		else {
+			m_cullingBounds.SetInfinite(object->GetConstantBufferIndex());
+			m_spatialIndex.Remove(object->GetConstantBufferIndex());
+		}
+		m_visibilityCache.Invalidate(object->GetConstantBufferIndex());
+	}
+	m_dirtyObjects.Clear();
+
+	// Only objects whose bounds touch the camera frustum are submitted. Objects that did
+	// not move keep last frame's answer unless the camera moved enough to change it.
+	m_visibleDrawIds.resize(m_cullingBounds.GetCount());
+	uint32 visibleCount = m_visibilityCache.Cull(FrustumCuller::ExtractPlanes(&viewProj.m[0][0]), &m_eyePos.x,
+		m_cullingBounds, m_visibleDrawIds.data(), m_workerPool.get());
+
+	// Occluders in view are rasterized on the CPU, and whatever they fully hide is
+	// dropped before any draw is recorded.
+	m_occlusionCuller.Begin(&viewProj.m[0][0]);
+	for (auto& object : m_renderObjects) {
+		if (!object->IsOccluder()) continue;
+
+		const MeshGeometry* mesh = object->GetGeometry();
+		const SubmeshDrawRecord* record = object->GetDrawRecord();
+		if (!mesh || !record || !mesh->VertexBufferCPU || !mesh->IndexBufferCPU || mesh->IndexFormat != DXGI_FORMAT_R16_UINT) {
+			continue;
+		}
 
-		m_currFrameResource->ObjectCB->CopyData(0, objConstants);
+		const uint16* indices = static_cast<const uint16*>(mesh->IndexBufferCPU->GetBufferPointer());
+		m_occlusionCuller.AddOccluder(&object->GetWorldMatrix().m[0][0], mesh->VertexBufferCPU->GetBufferPointer(),
+			mesh->VertexByteStride, mesh->VertexBufferByteSize / mesh->VertexByteStride,
+			indices + record->StartIndexLocation, record->IndexCount, record->BaseVertexLocation);
+	}
+	if (m_occlusionCuller.HasOccluders()) {
+		m_occlusionCuller.Rasterize(m_workerPool.get());
+		visibleCount = m_occlusionCuller.Filter(m_cullingBounds, m_visibleDrawIds.data(), visibleCount, m_workerPool.get());
 	}
+	m_visibleDrawIds.resize(visibleCount);
+
+	// Opaque draws are grouped by state and go front to back within a group, so mesh and
+	// pipeline changes are rare and early depth rejects most hidden pixels. Transparent
+	// draws follow back to front.
+	m_renderQueue.Clear();
+	m_renderQueue.Reserve(visibleCount);
+	m_pipelineIds.BeginFrame();
+	m_submeshIds.BeginFrame();
+	for (uint32 drawId : m_visibleDrawIds) {
+		const IRenderObject* object = m_objectsByDrawId[drawId];
+		if (!object->IsVisible()) continue;
+
+		float32 viewDepth = m_cullingBounds.GetCenterX()[drawId] * mView._13 + m_cullingBounds.GetCenterY()[drawId] * mView._23 +
+			m_cullingBounds.GetCenterZ()[drawId] * mView._33 + mView._43;
+		RenderQueue::Bucket bucket = object->IsTransparent() ? RenderQueue::Bucket::Transparent : RenderQueue::Bucket::Opaque;
+
+		// Equal keys are merged into one instanced draw, so IDs that don't fit their field
+		// would merge different state and opt the object out instead.
+		// The sink binds exactly the pipeline the key encodes, so a merged run never mixes two.
+		ID3D12PipelineState* pso = ResolvePipelineState(object);
+		m_drawPipelines[drawId] = pso;
+		uint32 pipeline = m_pipelineIds.GetId(pso);
+		const SubmeshDrawRecord* record = object->GetDrawRecord();
+		uint32 mesh = record ? m_submeshIds.GetId(record->Submesh) + 1 : InstanceBatcher::NotInstanced;
+		if (pipeline >= (1u << RenderQueue::PipelineBits) || object->GetMaterialIndex() >= (1u << RenderQueue::MaterialBits) ||
+			mesh >= (1u << RenderQueue::MeshBits)) {
+			mesh = InstanceBatcher::NotInstanced;
+		}
+		m_renderQueue.Push(RenderQueue::MakeKey(0, bucket, pipeline, object->GetMaterialIndex(), mesh, viewDepth / FarPlane), drawId);
+	}
+	m_renderQueue.Sort();
+
+	// Objects drawn with the same mesh, submesh, material and pipeline become one
+	// instanced draw, reading their draw IDs from the frame's instance list.
+	m_instanceBatcher.Build(m_renderQueue);
+	const Vector<uint32>& instanceList = m_instanceBatcher.GetInstanceList();
+	m_currFrameResource->InstanceList->CopyRange(0, instanceList.data(), static_cast<UINT>(instanceList.size()));
 
 	// Update Pass constant buffer
 	if (m_currFrameResource->PassCB) {
@@ -357,6 +537,16 @@ void Graphics::Update(float32 deltaTime) {
 		m_currFrameResource->PassCB->CopyData(0, passConstants);
 	}
 
+	// Refresh the frame's material table
+	if (m_currFrameResource->MaterialBuffer) {
+		for (const auto& material : m_resourceManager->GetMaterials()) {
+			uint32 index = material->GetMaterialIndex();
+			if (index < MaxMaterialCount) {
+				m_currFrameResource->MaterialBuffer->CopyData(index, material->GetMaterialConstants());
+			}
+		}
+	}
+
 	// Legacy system - commented out
 	/*
     DirectX::XMMATRIX world = XMLoadFloat4x4(&mWorld);
@@ -394,6 +584,16 @@ void Graphics::DrawFrame() {
 	ID3D12PipelineState* currentPSO = m_isWireframe ? m_wireframePSO.Get() : m_PSO.Get();
     ThrowIfFailed(m_commandList->Reset(cmdListAlloc.Get(), currentPSO));
 
+	// Recycle the descriptors of frames the GPU has finished.
+	m_descriptors->BeginFrame(m_fenceTimeline->GetCompletedValue());
+
+	// Hand out relocated resources before anything binds them this frame.
+	m_defragmenter->BeginFrame(m_commandList.Get(), m_fenceTimeline->GetCompletedValue(),
+		m_fenceTimeline->GetLastSignaledValue());
+
+	// Copy the objects that changed into the persistent object buffer before any draw reads it.
+	m_objectBuffer->RecordUploads(m_commandList.Get(), *m_currFrameResource->ObjectUpload);
+
     m_commandList->RSSetViewports(1, &m_screenViewport);
     m_commandList->RSSetScissorRects(1, &m_scissorRect);
 
@@ -411,33 +611,32 @@ void Graphics::DrawFrame() {
 	D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = DepthStencilView();
 	m_commandList->OMSetRenderTargets(1, &rtvHandle, true, &dsvHandle);
 
-	ID3D12DescriptorHeap* descriptorHeaps[] = { m_cbvHeap.Get() };
+	ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptors->GetHeap() };
 	m_commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
 
-	m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+	m_drawBinder.Begin(m_commandList.Get(), m_rootSignature.Get(), currentPSO);
 
-	// New render system with frame resources
-	if (m_boxObject && m_currFrameResource->ObjectCB) {
-		// Update the CBV to point to the current frame resource's constant buffer
-		UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-		D3D12_GPU_VIRTUAL_ADDRESS cbAddress = m_currFrameResource->ObjectCB->Resource()->GetGPUVirtualAddress();
+	// Per-frame bindings, shared by every draw
+	m_drawBinder.SetShaderResource(RootParamObjectBuffer, m_objectBuffer->GetGpuAddress());
+	m_drawBinder.SetShaderResource(RootParamInstanceList, m_currFrameResource->InstanceList->Resource()->GetGPUVirtualAddress());
+	m_drawBinder.SetConstantBuffer(RootParamPassCB, m_currFrameResource->PassCB->Resource()->GetGPUVirtualAddress());
 
-		// Create/Update the CBV for this frame
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
-		cbvDesc.BufferLocation = cbAddress;
-		cbvDesc.SizeInBytes = objCBByteSize;
-		m_device->CreateConstantBufferView(&cbvDesc, m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
+	D3D12_SHADER_RESOURCE_VIEW_DESC materialSrvDesc = {};
+	materialSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	materialSrvDesc.Format = DXGI_FORMAT_UNKNOWN;
+	materialSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+	materialSrvDesc.Buffer.NumElements = MaxMaterialCount;
+	materialSrvDesc.Buffer.StructureByteStride = sizeof(MaterialConstants);
 
-		// Bind the descriptor table for constant buffer
-		m_commandList->SetGraphicsRootDescriptorTable(0, m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
+	uint32 materialSrvIndex = m_descriptors->AllocateTransient();
+	m_descriptors->CreateShaderResourceView(m_currFrameResource->MaterialBuffer->Resource(), &materialSrvDesc, materialSrvIndex);
+	m_drawBinder.SetDescriptorTable(RootParamMaterialTable, m_descriptors->GetGpuHandle(materialSrvIndex));
 
-		// Bind the descriptor table for texture SRV
-		CD3DX12_GPU_DESCRIPTOR_HANDLE tex(m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
-		tex.Offset(1, m_cbvSrvUavDescriptorSize);
-		m_commandList->SetGraphicsRootDescriptorTable(1, tex);
+	m_drawBinder.SetDescriptorTable(RootParamTextureTable, m_descriptors->GetTextureTableGpuHandle());
 
-		m_boxObject->Render(m_commandList.Get());
-	}
+	// One DrawIndexedInstanced per run of objects sharing pipeline, material and submesh.
+	CommandListDrawSink drawSink(m_commandList.Get(), m_drawBinder, m_objectsByDrawId, m_drawPipelines);
+	DrawEmitter::Emit(m_instanceBatcher, drawSink);
 
     // Indicate a state transition on the resource usage.
 	CD3DX12_RESOURCE_BARRIER presentBarrier = CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
@@ -447,6 +646,9 @@ void Graphics::DrawFrame() {
     // Done recording commands.
 	ThrowIfFailed(m_commandList->Close());
 
+	// Descriptors written this frame must be in the shader-visible heap before execution.
+	m_descriptors->FlushCopies();
+
     // Add the command list to the queue for execution.
 	ID3D12CommandList* cmdsLists[] = { m_commandList.Get() };
 	m_commandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
@@ -455,13 +657,13 @@ void Graphics::DrawFrame() {
 	ThrowIfFailed(m_swapChain->Present(0, 0));
 	m_currBackBuffer = (m_currBackBuffer + 1) % m_swapChainBufferCount;
 
-	// Advance the fence value to mark commands up to this fence point.
-	m_currFrameResource->Fence = ++m_currentFence;
+	// Mark commands up to this fence point. Because we are on the GPU timeline, the new
+	// fence point won't be set until the GPU finishes processing all the commands prior to it.
+	m_currFrameResource->Fence = m_fenceTimeline->Signal();
+	m_framePacer->EndFrame(m_currFrameResource->Fence);
+	m_descriptors->EndFrame(m_currFrameResource->Fence);
 
-	// Add an instruction to the command queue to set a new fence point.
-	// Because we are on the GPU timeline, the new fence point won't be
-	// set until the GPU finishes processing all the commands prior to this Signal().
-	m_commandQueue->Signal(m_fence.Get(), m_currentFence);
+	m_defragmenter->EndFrame(m_fence.Get(), m_currFrameResource->Fence);
 }
 
 void Graphics::OnResize() {
@@ -567,7 +769,7 @@ void Graphics::OnResize() {
 
 	// Update the aspect ratio and recompute the projection matrix.
 	DirectX::XMMATRIX P = DirectX::XMMatrixPerspectiveFovLH(0.25f*DirectX::XM_PI,
-		static_cast<float>(m_window->GetWidth()) / m_window->GetHeight(), 1.0f, 1000.0f);
+		static_cast<float>(m_window->GetWidth()) / m_window->GetHeight(), NearPlane, FarPlane);
 	XMStoreFloat4x4(&mProj, P);
 }
 
@@ -660,12 +862,19 @@ void Graphics::BuildBoxGeometry() {
 void Graphics::OnMouseDown(MouseButton button, int32 x, int32 y) {
     m_lastMousePos.x = x;
     m_lastMousePos.y = y;
+    m_mouseDownPos = m_lastMousePos;
 
     SetCapture(static_cast<HWND>(m_window->GetNativeHandle()));
 }
 
 void Graphics::OnMouseUp(MouseButton button, int32 x, int32 y) {
     ReleaseCapture();
+
+    // Dragging with the left button orbits the camera; a click selects.
+    if (button == MouseButton::Left && std::abs(x - m_mouseDownPos.x) <= ClickSlop &&
+        std::abs(y - m_mouseDownPos.y) <= ClickSlop) {
+        m_selectedObject = PickObject(x, y);
+    }
 }
 
 void Graphics::OnMouseMove(int32 x, int32 y) {
@@ -701,6 +910,145 @@ void Graphics::OnKeyDown(KeyCode keyCode) {
 	if (keyCode == KeyCode::Num1) {
 		m_isWireframe = !m_isWireframe;
 	}
+	else if (keyCode == KeyCode::Num2) {
+		SetFramesInFlight(GetFramesInFlight() % FramePacer::MaxFramesInFlight + 1);
+	}
+}
+
+void Graphics::SetFramesInFlight(uint32 count) {
+	count = FramePacer::ClampFramesInFlight(count);
+	if (count == m_framePacer->GetFramesInFlight()) {
+		return;
+	}
+
+	// Frames still in flight keep using the old resources until the GPU is done with them.
+	for (auto& frameResource : m_frameResources) {
+		m_fenceTimeline->DeferRelease(std::move(frameResource));
+	}
+	m_currFrameResource = nullptr;
+	m_frameResources.clear();
+	m_framePacer->SetFramesInFlight(count);
+	BuildFrameResources();
+
+	for (auto& mesh : m_instancedMeshes) {
+		mesh->SetFrameCount(count);
+	}
+}
+
+Handle Graphics::CreateEntity(Handle renderObject, const Position& position, const Rotation& rotation, const Scale& scale) {
+	auto* object = m_renderObjects.Get(renderObject);
+	if (!object) return Handle();
+
+	RenderObjectRef ref;
+	ref.object = object->get();
+	return m_entities.CreateEntity(position, rotation, scale, WorldMatrix(), EntityFlags(), ref);
+}
+
+void Graphics::SetEntityTransform(Handle entity, const Position& position, const Rotation& rotation, const Scale& scale) {
+	// Only entities made by CreateEntity carry a render object and every transform component.
+	if (!m_entities.Has<RenderObjectRef>(entity)) return;
+
+	*m_entities.Get<Position>(entity) = position;
+	*m_entities.Get<Rotation>(entity) = rotation;
+	*m_entities.Get<Scale>(entity) = scale;
+	TransformSystem::MarkDirty(m_entities, entity);
+}
+
+void Graphics::MarkOccluders() {
+	for (auto& object : m_renderObjects) {
+		// The occlusion pass reads the CPU copy of the geometry, with 16-bit indices.
+		const MeshGeometry* mesh = object->GetGeometry();
+		DirectX::BoundingBox localBounds, worldBounds;
+		if (!mesh || !mesh->VertexBufferCPU || mesh->IndexFormat != DXGI_FORMAT_R16_UINT || object->IsTransparent() ||
+			!object->GetLocalBounds(localBounds)) {
+			continue;
+		}
+
+		localBounds.Transform(worldBounds, DirectX::XMLoadFloat4x4(&object->GetWorldMatrix()));
+		const DirectX::XMFLOAT3& e = worldBounds.Extents;
+		float32 largestFace = 4.0f * std::max({ e.x * e.y, e.y * e.z, e.z * e.x });
+		if (largestFace >= OccluderMinArea) {
+			object->SetOccluder(true);
+		}
+	}
+}
+
+IRenderObject* Graphics::PickObject(int32 x, int32 y) const {
+	using namespace DirectX;
+
+	// The ray through the pixel in view space, then in world space.
+	float viewX = (2.0f * x / m_window->GetWidth() - 1.0f) / mProj._11;
+	float viewY = (1.0f - 2.0f * y / m_window->GetHeight()) / mProj._22;
+	XMMATRIX invView = XMMatrixInverse(nullptr, XMLoadFloat4x4(&mView));
+	XMVECTOR origin = XMLoadFloat3(&m_eyePos);
+	XMVECTOR direction = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(viewX, viewY, 1.0f, 0.0f), invView));
+
+	// Only objects whose bounds overlap the ray's footprint on the ground are tested. The
+	// footprint ends where the ray meets the ground, or at the pick distance.
+	float length = PickDistance;
+	float directionY = XMVectorGetY(direction);
+	if (directionY < 0.0f && m_eyePos.y > 0.0f) {
+		length = std::min(length, -m_eyePos.y / directionY);
+	}
+	XMFLOAT3 end;
+	XMStoreFloat3(&end, XMVectorMultiplyAdd(direction, XMVectorReplicate(length), origin));
+
+	Vector<uint32> candidates;
+	m_spatialIndex.QueryRect(std::min(m_eyePos.x, end.x), std::min(m_eyePos.z, end.z),
+		std::max(m_eyePos.x, end.x), std::max(m_eyePos.z, end.z), candidates);
+
+	IRenderObject* nearest = nullptr;
+	float nearestDistance = PickDistance;
+	for (uint32 drawId : candidates) {
+		BoundingBox bounds(
+			XMFLOAT3(m_cullingBounds.GetCenterX()[drawId], m_cullingBounds.GetCenterY()[drawId], m_cullingBounds.GetCenterZ()[drawId]),
+			XMFLOAT3(m_cullingBounds.GetExtentX()[drawId], m_cullingBounds.GetExtentY()[drawId], m_cullingBounds.GetExtentZ()[drawId]));
+		float distance = 0.0f;
+		if (bounds.Intersects(origin, direction, distance) && distance < nearestDistance) {
+			nearest = m_objectsByDrawId[drawId];
+			nearestDistance = distance;
+		}
+	}
+	return nearest;
+}
+
+bool Graphics::AttachObject(Handle object, Handle parent) {
+	if (object == parent || !m_renderObjects.Get(object) || !m_renderObjects.Get(parent)) return false;
+
+	Handle parentNode = GetOrCreateTransformNode(parent);
+	return m_transformHierarchy.SetParent(GetOrCreateTransformNode(object), parentNode);
+}
+
+void Graphics::DetachObject(Handle object) {
+	auto* renderObject = m_renderObjects.Get(object);
+	if (!renderObject || !(*renderObject)->GetTransformNode().IsValid()) return;
+
+	m_transformHierarchy.SetParent((*renderObject)->GetTransformNode(), Handle());
+}
+
+Handle Graphics::GetOrCreateTransformNode(Handle object) {
+	IRenderObject* renderObject = m_renderObjects.Get(object)->get();
+	if (!renderObject->GetTransformNode().IsValid()) {
+		// Until now the object was placed in world space, so its world matrix is the new
+		// node's local one. Later changes reach the node through Update.
+		WorldMatrix local;
+		std::memcpy(local.m, &renderObject->GetWorldMatrix().m[0][0], sizeof(local.m));
+		Handle node = m_transformHierarchy.CreateNode(Handle(), object);
+		m_transformHierarchy.SetLocal(node, local);
+		renderObject->SetTransformNode(node);
+	}
+	return renderObject->GetTransformNode();
+}
+
+Handle Graphics::AddInstancedMesh(UniquePtr<InstancedStaticMesh> mesh) {
+	mesh->InitializeInstanceBuffer(m_device.Get(), m_framePacer->GetFramesInFlight(), m_fenceTimeline.get());
+	mesh->SetPipelineState(m_instancedPSO);
+
+	uint32 drawId = m_objectBuffer->GetStore().Allocate();
+	mesh->SetConstantBufferIndex(drawId);
+	mesh->SetDirtyList(&m_dirtyObjects);
+	m_objectsByDrawId[drawId] = mesh.get();
+	return m_instancedMeshes.Insert(std::move(mesh));
 }
 
 void Graphics::BuildDefaultPSO() {
@@ -768,44 +1116,203 @@ void Graphics::BuildWireframePSO() {
 	m_resourceManager->AddPSO("wireframe", m_wireframePSO);
 }
 
+void Graphics::BuildInstancedPSO() {
+	// The default pipeline with the instanced vertex shader and its per-instance attributes.
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC instancedPsoDesc;
+    ZeroMemory(&instancedPsoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
+    instancedPsoDesc.InputLayout = { m_instancedInputLayout.data(), (UINT)m_instancedInputLayout.size() };
+    instancedPsoDesc.pRootSignature = m_rootSignature.Get();
+    instancedPsoDesc.VS =
+	{
+		reinterpret_cast<BYTE*>(m_instancedVsByteCode->GetBufferPointer()),
+		m_instancedVsByteCode->GetBufferSize()
+	};
+    instancedPsoDesc.PS =
+	{
+		reinterpret_cast<BYTE*>(m_psByteCode->GetBufferPointer()),
+		m_psByteCode->GetBufferSize()
+	};
+    instancedPsoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    instancedPsoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    instancedPsoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+    instancedPsoDesc.SampleMask = UINT_MAX;
+    instancedPsoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    instancedPsoDesc.NumRenderTargets = 1;
+    instancedPsoDesc.RTVFormats[0] = m_backBufferFormat;
+    instancedPsoDesc.SampleDesc.Count = m_4xMsaaState ? 4 : 1;
+    instancedPsoDesc.SampleDesc.Quality = m_4xMsaaState ? (m_4xMsaaQuality - 1) : 0;
+    instancedPsoDesc.DSVFormat = m_depthStencilFormat;
+    ThrowIfFailed(m_device->CreateGraphicsPipelineState(&instancedPsoDesc, IID_PPV_ARGS(&m_instancedPSO)));
+
+	// Instanced meshes need their own input layout in wireframe mode too.
+    instancedPsoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
+    ThrowIfFailed(m_device->CreateGraphicsPipelineState(&instancedPsoDesc, IID_PPV_ARGS(&m_instancedWireframePSO)));
+
+	m_resourceManager->AddPSO("instanced", m_instancedPSO);
+	m_resourceManager->AddPSO("instanced_wireframe", m_instancedWireframePSO);
+}
+
+void Graphics::BuildTransparentPSO() {
+	// The default pipeline blending by source alpha. Transparent objects are drawn back to
+	// front after the opaque ones and test depth without writing it, so they don't hide
+	// each other.
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC transparentPsoDesc;
+    ZeroMemory(&transparentPsoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
+    transparentPsoDesc.InputLayout = { m_inputLayout.data(), (UINT)m_inputLayout.size() };
+    transparentPsoDesc.pRootSignature = m_rootSignature.Get();
+    transparentPsoDesc.VS =
+	{
+		reinterpret_cast<BYTE*>(m_vsByteCode->GetBufferPointer()),
+		m_vsByteCode->GetBufferSize()
+	};
+    transparentPsoDesc.PS =
+	{
+		reinterpret_cast<BYTE*>(m_psByteCode->GetBufferPointer()),
+		m_psByteCode->GetBufferSize()
+	};
+    transparentPsoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    transparentPsoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    transparentPsoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+    transparentPsoDesc.SampleMask = UINT_MAX;
+    transparentPsoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    transparentPsoDesc.NumRenderTargets = 1;
+    transparentPsoDesc.RTVFormats[0] = m_backBufferFormat;
+    transparentPsoDesc.SampleDesc.Count = m_4xMsaaState ? 4 : 1;
+    transparentPsoDesc.SampleDesc.Quality = m_4xMsaaState ? (m_4xMsaaQuality - 1) : 0;
+    transparentPsoDesc.DSVFormat = m_depthStencilFormat;
+
+	D3D12_RENDER_TARGET_BLEND_DESC& blend = transparentPsoDesc.BlendState.RenderTarget[0];
+	blend.BlendEnable = TRUE;
+	blend.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+	blend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	blend.BlendOp = D3D12_BLEND_OP_ADD;
+	blend.SrcBlendAlpha = D3D12_BLEND_ONE;
+	blend.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+	blend.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	transparentPsoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+
+    ThrowIfFailed(m_device->CreateGraphicsPipelineState(&transparentPsoDesc, IID_PPV_ARGS(&m_transparentPSO)));
+
+	m_resourceManager->AddPSO("transparent", m_transparentPSO);
+}
+
 void Graphics::BuildPSOs() {
 	BuildDefaultPSO();
 	BuildWireframePSO();
+	BuildInstancedPSO();
+	BuildTransparentPSO();
+}
+
+ID3D12PipelineState* Graphics::ResolvePipelineState(const IRenderObject* object) const {
+	ID3D12PipelineState* pso = object->GetPipelineState();
+	if (!object->GetDrawRecord()) {
+		if (m_isWireframe && pso == m_instancedPSO.Get()) {
+			return m_instancedWireframePSO.Get();
+		}
+		return pso ? pso : m_PSO.Get();
+	}
+	if (m_isWireframe) {
+		return m_wireframePSO.Get();
+	}
+	if (!pso || pso == m_PSO.Get()) {
+		return object->IsTransparent() ? m_transparentPSO.Get() : m_PSO.Get();
+	}
+	return pso;
+}
+
+void Graphics::BuildStaticBatches() {
+	Vector<StaticBatchSource> sources;
+	Vector<StaticMesh*> batchedObjects;
+	HashMap<uint32, SharedPtr<IMaterialComponent>> materials;
+	for (auto& object : m_renderObjects) {
+		// Transparent objects must stay sorted one by one.
+		const MeshGeometry* mesh = object->GetGeometry();
+		const SubmeshDrawRecord* record = object->GetDrawRecord();
+		if (!object->IsStatic() || object->IsTransparent() || !record || !mesh->VertexBufferCPU || !mesh->IndexBufferCPU ||
+			mesh->VertexByteStride != sizeof(StaticBatchVertex)) {
+			continue;
+		}
+
+		StaticBatchSource source;
+		source.vertices = static_cast<const StaticBatchVertex*>(mesh->VertexBufferCPU->GetBufferPointer());
+		source.vertexCount = mesh->VertexBufferByteSize / mesh->VertexByteStride;
+		source.indices = mesh->IndexBufferCPU->GetBufferPointer();
+		source.indexSize = (mesh->IndexFormat == DXGI_FORMAT_R32_UINT) ? 4 : 2;
+		source.startIndex = record->StartIndexLocation;
+		source.indexCount = record->IndexCount;
+		source.baseVertex = record->BaseVertexLocation;
+		std::memcpy(source.world, &object->GetWorldMatrix().m[0][0], sizeof(source.world));
+		source.material = object->GetMaterialIndex();
+		sources.push_back(source);
+
+		batchedObjects.push_back(object.get());
+		materials.emplace(source.material, object->GetMaterial());
+	}
+	if (sources.empty()) return;
+
+	uint64 sourceHash = m_staticBatcher.HashSources(sources);
+	bool cached = m_staticBatcher.LoadCache(StaticBatchCachePath, sourceHash);
+	if (!cached) {
+		m_staticBatcher.Build(sources, m_workerPool.get());
+		m_staticBatcher.SaveCache(StaticBatchCachePath, sourceHash);
+	}
+
+	const StaticBatcher::Stats& stats = m_staticBatcher.GetStats();
+	Platform::OutputDebugMessage("Static batches" + String(cached ? " (cached)" : "") + ": " +
+		std::to_string(stats.sourceCount) + " draws merged into " + std::to_string(stats.batchCount) + ", " +
+		std::to_string(stats.sourceBytes / 1024) + " KB of source geometry in " + std::to_string(stats.batchBytes / 1024) +
+		" KB\n");
+
+	const Vector<StaticBatchVertex>& vertices = m_staticBatcher.GetVertices();
+	const Vector<uint32>& indices = m_staticBatcher.GetIndices();
+	auto mesh = m_resourceManager->CreateMesh("staticBatches", vertices.data(), sizeof(StaticBatchVertex),
+		static_cast<uint32>(vertices.size()), indices.data(), DXGI_FORMAT_R32_UINT, static_cast<uint32>(indices.size()));
+
+	// Vertices are in world space already, so the batch objects keep the identity transform.
+	auto meshComponent = m_resourceManager->CreateMeshComponent(ID("staticBatches"));
+	const Vector<StaticBatch>& batches = m_staticBatcher.GetBatches();
+	for (uint32 i = 0; i < batches.size(); ++i) {
+		const StaticBatch& batch = batches[i];
+		SubmeshGeometry submesh;
+		submesh.IndexCount = batch.indexCount;
+		submesh.StartIndexLocation = batch.startIndex;
+		submesh.BaseVertexLocation = static_cast<INT>(batch.baseVertex);
+		submesh.Bounds = DirectX::BoundingBox(DirectX::XMFLOAT3(batch.center), DirectX::XMFLOAT3(batch.extents));
+
+		String submeshName = "batch" + std::to_string(i);
+		mesh->DrawArgs[submeshName] = submesh;
+		m_staticBatchObjects.push_back(
+			m_renderObjects.Insert(UniquePtr<StaticMesh>(new StaticMesh(meshComponent, materials[batch.material], submeshName))));
+	}
+
+	for (StaticMesh* object : batchedObjects) {
+		object->SetVisible(false);
+	}
 }
 
 void Graphics::BuildFrameResources() {
-	for (int i = 0; i < NumFrameResources; ++i) {
+	for (uint32 i = 0; i < m_framePacer->GetFramesInFlight(); ++i) {
 		m_frameResources.push_back(UniquePtr<FrameResource>(
 			new FrameResource(m_device.Get(),
 				1,  // 1 pass CB
-				1,  // 1 object CB (for now, increase if you have more objects)
-				1)  // 1 material CB
+				MaxObjectCount,
+				MaxMaterialCount,
+				m_gpuAllocator.get())
 		));
 	}
 }
 
 void Graphics::LoadTextures() {
-	auto woodCrateTex = std::make_unique<Texture>();
+	auto woodCrateTex = std::make_shared<Texture>();
 	woodCrateTex->name = "woodCrateTex";
 	woodCrateTex->filename = L"Textures/WoodCrate01.dds";
 	ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(m_device.Get(),
 		m_commandList.Get(), woodCrateTex->filename.c_str(),
-		woodCrateTex->resource, woodCrateTex->uploadHeap));
-
-	m_textures[woodCrateTex->name] = std::move(woodCrateTex);
-
-	// Create SRV for the texture
-	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
-	hDescriptor.Offset(1, m_cbvSrvUavDescriptorSize); // Offset by 1 to skip CBV
-
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.Format = m_textures["woodCrateTex"]->resource->GetDesc().Format;
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MostDetailedMip = 0;
-	srvDesc.Texture2D.MipLevels = m_textures["woodCrateTex"]->resource->GetDesc().MipLevels;
+		woodCrateTex->resource, woodCrateTex->uploadHeap, 0, nullptr,
+		m_gpuAllocator.get(), &woodCrateTex->allocation, &woodCrateTex->uploadAllocation));
 
-	m_device->CreateShaderResourceView(m_textures["woodCrateTex"]->resource.Get(), &srvDesc, hDescriptor);
+	// Registers the texture in the bindless table and writes its SRV.
+	m_resourceManager->AddTexture(woodCrateTex->name, woodCrateTex);
 }
 
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> Graphics::GetStaticSamplers() {
@@ -8,6 +8,25 @@
 #include <StaticMesh.h>
 #include <RenderObject.h>
 #include <FrameResource.h>
+#include <GpuDefragmenter.h>
+#include <D3D12GpuFence.h>
+#include <FenceTimeline.h>
+#include <FramePacer.h>
+#include <DescriptorHeapManager.h>
+#include <RootSignature.h>
+#include <DrawBinder.h>
+#include <PersistentObjectBuffer.h>
+#include <SlotMap.h>
+#include <WorkerPool.h>
+#include <TransformHierarchy.h>
+#include <TransformSystem.h>
+#include <FrustumCuller.h>
+#include <LooseQuadtree.h>
+#include <OcclusionCuller.h>
+#include <VisibilityCache.h>
+#include <RenderQueue.h>
+#include <InstanceBatcher.h>
+#include <StaticBatcher.h>
 
 static DirectX::XMFLOAT4X4 Identity4x4() {
 	static DirectX::XMFLOAT4X4 I(
@@ -27,7 +46,7 @@ struct LegacyVertex {
 
 class Graphics {
 public:
-    Graphics(Window* wnd);
+    Graphics(Window* wnd, uint32 framesInFlight = FramePacer::DefaultFramesInFlight);
     void CacheDescSizes();
     void CreateRTVandDSVdescHeaps();
     void CreateSwapChain(Window* wnd);
@@ -48,6 +67,52 @@ public:
 	void OnKeyDown(KeyCode keyCode);
 
 	void OnResize();
+
+	// Rebuilds the frame resources for the new count (clamped to 1..4). The old ones are
+	// released through the fence timeline, so the GPU is not drained.
+	void SetFramesInFlight(uint32 count);
+	uint32 GetFramesInFlight() const { return m_framePacer->GetFramesInFlight(); }
+	const FrameLatencyStats& GetFrameStats() const { return m_framePacer->GetStats(); }
+
+	// Objects by world position, keyed by draw ID, for selection and gameplay queries.
+	// Kept current with the uploaded transforms.
+	const LooseQuadtree& GetSpatialIndex() const { return m_spatialIndex; }
+	// Nearest object whose world bounds the ray through the pixel hits, searched through
+	// the spatial index; null when there is none. A left click selects it.
+	IRenderObject* PickObject(int32 x, int32 y) const;
+	IRenderObject* GetSelectedObject() const { return m_selectedObject; }
+	const VisibilityCache::Stats& GetVisibilityStats() const { return m_visibilityCache.GetStats(); }
+	const OcclusionCuller::Stats& GetOcclusionStats() const { return m_occlusionCuller.GetStats(); }
+	const InstanceBatcher& GetInstanceBatcher() const { return m_instanceBatcher; }
+	const StaticBatcher::Stats& GetStaticBatchStats() const { return m_staticBatcher.GetStats(); }
+	// Per pool usage; memory.largestFreeBlock against memory.freeBytes shows how fragmented
+	// the heaps are, and when the defragmenter has work to do.
+	Vector<GpuMemoryAllocator::PoolStats> GetGpuMemoryStats() const { return m_gpuAllocator->GetStats(); }
+	// An entity drives the render object's world matrix from position, rotation and scale.
+	// Matrices of changed entities are rebuilt chunk by chunk at the start of Update.
+	Handle CreateEntity(Handle renderObject, const Position& position, const Rotation& rotation = Rotation(),
+		const Scale& scale = Scale());
+	void SetEntityTransform(Handle entity, const Position& position, const Rotation& rotation, const Scale& scale);
+	EntityWorld& GetEntityWorld() { return m_entities; }
+
+	// Attaches the render object below parent's; the object's transform, or its entity's,
+	// becomes relative to the parent from the next Update on. Returns false when either
+	// handle is stale or parent is the object or one of its descendants.
+	bool AttachObject(Handle object, Handle parent);
+	// Makes the object a root again, placed in world space by its own transform.
+	void DetachObject(Handle object);
+	const TransformHierarchy& GetTransformHierarchy() const { return m_transformHierarchy; }
+
+	// Instanced meshes get one instance buffer per frame in flight, kept in step with the
+	// frame pacer, and are drawn with the instanced pipeline.
+	Handle AddInstancedMesh(UniquePtr<InstancedStaticMesh> mesh);
+	InstancedStaticMesh* GetInstancedMesh(Handle handle) const {
+		auto* mesh = m_instancedMeshes.Get(handle);
+		return mesh ? mesh->get() : nullptr;
+	}
+	IRenderObject* GetObjectByDrawId(uint32 drawId) const {
+		return drawId < m_objectsByDrawId.size() ? m_objectsByDrawId[drawId] : nullptr;
+	}
 private:
     void CreateDevice();
     void CheckMSAAqual();
@@ -63,8 +128,28 @@ private:
     void BuildPSOs();
 	void BuildDefaultPSO();
 	void BuildWireframePSO();
+	void BuildInstancedPSO();
+	void BuildTransparentPSO();
 	void BuildFrameResources();
 
+	// Merges the static objects into one draw per cell and material, reusing the cache
+	// file when it was made from the same objects. Sources are hidden but keep their
+	// draw IDs, so they still occlude and can be queried.
+	void BuildStaticBatches();
+
+	// Opaque objects whose bounds have a face of at least OccluderMinArea become occluders.
+	// Run at load, once the objects are placed.
+	void MarkOccluders();
+
+	// The object's hierarchy node, created as a root on first use.
+	Handle GetOrCreateTransformNode(Handle object);
+
+	// Pipeline the object is drawn with this frame: its own, the blending variant of the
+	// default one for transparent objects, or the wireframe one while it is toggled on.
+	// Objects that record their own draws keep theirs, which matches their vertex layout;
+	// only instanced meshes have a wireframe variant of it.
+	ID3D12PipelineState* ResolvePipelineState(const IRenderObject* object) const;
+
     // Textures
     void LoadTextures();
     std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
@@ -72,15 +157,47 @@ private:
 private:
 	Window* m_window = nullptr;
 
-	// Frame Resources for CPU-GPU parallelism
-	static const int NumFrameResources = 3;
+	// Places buffers and textures in shared heaps instead of committed resources.
+	// Declared before everything that owns placed resources so it is destroyed last.
+	UniquePtr<GpuMemoryAllocator> m_gpuAllocator;
+	UniquePtr<GpuDefragmenter> m_defragmenter;
+
+	// Frame Resources for CPU-GPU parallelism, one per frame in flight
 	Vector<UniquePtr<FrameResource>> m_frameResources;
 	FrameResource* m_currFrameResource = nullptr;
 	int m_currFrameResourceIndex = 0;
 
 	// New render system
 	UniquePtr<ResourceManager> m_resourceManager;
-	UniquePtr<StaticMesh> m_boxObject;
+	UniquePtr<WorkerPool> m_workerPool;
+	DirtyObjectList m_dirtyObjects;
+	EntityWorld m_entities;
+	TransformHierarchy m_transformHierarchy;
+	SlotMap<UniquePtr<StaticMesh>> m_renderObjects;
+	SlotMap<UniquePtr<InstancedStaticMesh>> m_instancedMeshes;
+
+	// World bounds and objects by draw ID. Update culls them into m_visibleDrawIds,
+	// which DrawFrame submits.
+	CullingBounds m_cullingBounds;
+	Vector<IRenderObject*> m_objectsByDrawId;
+	Vector<ID3D12PipelineState*> m_drawPipelines;  // By draw ID, the pipeline its queue key encodes
+	Vector<uint8> m_isStaticBatch;          // By draw ID
+	Vector<uint32> m_visibleDrawIds;
+	VisibilityCache m_visibilityCache;
+	OcclusionCuller m_occlusionCuller;
+
+	// Visible draws in submission order, keyed by the state IDs below, and merged into
+	// instanced draws.
+	RenderQueue m_renderQueue;
+	SortKeyIdTable m_pipelineIds{ 1u << RenderQueue::PipelineBits };
+	SortKeyIdTable m_submeshIds{ (1u << RenderQueue::MeshBits) - 1 };     // Mesh field holds ID + 1
+	InstanceBatcher m_instanceBatcher;
+	LooseQuadtree m_spatialIndex{ -WorldHalfSize, -WorldHalfSize, 2.0f * WorldHalfSize };
+	StaticBatcher m_staticBatcher{ StaticBatchCellSize };
+	Vector<Handle> m_staticBatchObjects;
+	IRenderObject* m_selectedObject = nullptr;
+	Handle m_boxObject;
+	UniquePtr<PersistentObjectBuffer> m_objectBuffer;
 
 	// Legacy - will be removed after full migration
 	UniquePtr<UploadBuffer<ObjectConstants>> m_objectCB;
@@ -93,9 +210,11 @@ private:
 
 	ComPtr<ID3D12PipelineState> m_PSO = nullptr; // For now it's a default opaque PSO
 	ComPtr<ID3D12PipelineState> m_wireframePSO = nullptr;
+	ComPtr<ID3D12PipelineState> m_instancedPSO = nullptr;
+	ComPtr<ID3D12PipelineState> m_instancedWireframePSO = nullptr;
+	ComPtr<ID3D12PipelineState> m_transparentPSO = nullptr;   // Default PSO with alpha blending
 	bool m_isWireframe = false;
 
-    HashMap<String, UniquePtr<Texture>> m_textures;
 
     // Core D3D12 objects
     ComPtr<ID3D12Device> m_device;
@@ -110,7 +229,33 @@ private:
     ComPtr<ID3D12DescriptorHeap> m_dsvHeap;
 
     ComPtr<ID3D12RootSignature> m_rootSignature = nullptr;
-    ComPtr<ID3D12DescriptorHeap> m_cbvHeap = nullptr;
+    UniquePtr<DescriptorHeapManager> m_descriptors;
+	DrawBinder m_drawBinder;
+
+	// Capacity of each frame's material table and of the object buffer
+	static constexpr uint32 MaxMaterialCount = 256;
+	static constexpr uint32 MaxObjectCount = 4096;
+
+	static constexpr float32 NearPlane = 1.0f;
+	static constexpr float32 FarPlane = 1000.0f;
+
+	// Area covered by the spatial index around the origin; objects outside it still work
+	// but are searched by every query.
+	static constexpr float32 WorldHalfSize = 2048.0f;
+
+	// Smallest bounds face, in square units, that makes an object an occluder. Smaller
+	// objects hide too little to pay for their triangles.
+	static constexpr float32 OccluderMinArea = 64.0f;
+
+	// Picking ignores objects further from the camera than this.
+	static constexpr float32 PickDistance = 500.0f;
+	// A left button release within this many pixels of the press is a click, not a drag.
+	static constexpr int32 ClickSlop = 3;
+
+	// Static batches cover this many units along X and Z. Larger cells save draws but
+	// cull coarser.
+	static constexpr float32 StaticBatchCellSize = 64.0f;
+	static constexpr const char* StaticBatchCachePath = "StaticBatches.cache";
 
 	// Set true to use 4X MSAA (�4.1.8).  The default is false.
     bool m_4xMsaaState = false;    // 4X MSAA enabled
@@ -123,12 +268,18 @@ private:
     ComPtr<ID3DBlob> m_vsByteCode = nullptr;
     ComPtr<ID3DBlob> m_psByteCode = nullptr;
     std::vector<D3D12_INPUT_ELEMENT_DESC> m_inputLayout;
+    ComPtr<ID3DBlob> m_instancedVsByteCode = nullptr;
+    std::vector<D3D12_INPUT_ELEMENT_DESC> m_instancedInputLayout;   // m_inputLayout plus InstanceData in slot 1
 
     D3D12_VIEWPORT m_screenViewport;
     D3D12_RECT m_scissorRect;
 
     ComPtr<ID3D12Fence> m_fence;
-    UINT64 m_currentFence = 0;
+	UniquePtr<D3D12GpuFence> m_gpuFence;
+	// Hands out fence values and destroys released resources once the GPU is done with them.
+	// Declared after everything it may hold, so it waits for the GPU before they are destroyed.
+	UniquePtr<FenceTimeline> m_fenceTimeline;
+	UniquePtr<FramePacer> m_framePacer;     // Picks the frame resource and records frame timings
 
     DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
     DXGI_FORMAT m_depthStencilFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
@@ -144,5 +295,6 @@ private:
     float mRadius = 5.0f;
 
     POINT m_lastMousePos;
+    POINT m_mouseDownPos;
 
 };
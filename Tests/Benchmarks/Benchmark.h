@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Types.h>
+#include <chrono>
+#include <cstdio>
+
+// Median wall time of fn over several runs, in milliseconds. The median keeps one
+// descheduled run from skewing the result on busy machines.
+template<typename Fn>
+double MeasureMs(uint32 runs, Fn&& fn) {
+    Vector<double> times;
+    times.reserve(runs);
+    for (uint32 i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
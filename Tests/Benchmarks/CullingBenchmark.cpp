@@ -0,0 +1,45 @@
+#include "Benchmark.h"
+#include <FrustumCuller.h>
+#include <WorkerPool.h>
+#include <random>
+
+// Frustum culling of boxes scattered around the camera, about a quarter of them in
+// view, on each path and across a WorkerPool.
+namespace {
+    constexpr uint32 Runs = 100;
+    const float ViewProj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1, 0, 0, -1000.0f / 999.0f, 0 };
+}
+
+int main() {
+    FrustumPlanes frustum = FrustumCuller::ExtractPlanes(ViewProj);
+    WorkerPool pool;
+
+    std::printf("%8s %9s %10s %10s %10s %10s\n", "boxes", "visible", "scalar", "SSE", "AVX2", "parallel");
+    for (uint32 count : { 1000u, 10000u, 100000u }) {
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> position(-800.0f, 800.0f);
+        std::uniform_real_distribution<float> size(0.5f, 10.0f);
+        CullingBounds bounds;
+        bounds.Resize(count);
+        for (uint32 i = 0; i < count; ++i) {
+            const float center[3] = { position(rng), position(rng) * 0.1f, position(rng) };
+            const float extents[3] = { size(rng), size(rng), size(rng) };
+            bounds.Set(i, center, extents);
+        }
+
+        Vector<uint32> visible(count);
+        uint32 visibleCount = 0;
+        double pathMs[3] = {};
+        const FrustumCuller::Path paths[3] = { FrustumCuller::Path::Scalar, FrustumCuller::Path::SSE,
+                                               FrustumCuller::Path::AVX2 };
+        for (uint32 p = 0; p < 3; ++p) {
+            if (paths[p] > FrustumCuller::GetBestPath()) continue;
+            pathMs[p] = MeasureMs(Runs, [&] { visibleCount = FrustumCuller::Cull(frustum, bounds, visible.data(), paths[p]); });
+        }
+        double parallelMs = MeasureMs(Runs, [&] { FrustumCuller::Cull(frustum, bounds, visible.data(), &pool); });
+
+        std::printf("%8u %9u %10.4f %10.4f %10.4f %10.4f\n", count, visibleCount, pathMs[0], pathMs[1], pathMs[2],
+                    parallelMs);
+    }
+    return 0;
+}
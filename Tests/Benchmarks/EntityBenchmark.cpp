@@ -0,0 +1,102 @@
+#include "Benchmark.h"
+#include <TransformSystem.h>
+#include <random>
+
+// Rebuilding 10k world matrices: the object graph the renderer uses today, one heap
+// object per renderable with a virtual update and shared components, against
+// TransformSystem walking the dirty rows of EntityWorld chunks. Changed entities are
+// either spread evenly, so every chunk has some, or clustered at the start, so whole
+// chunks stay clean.
+namespace {
+    constexpr uint32 EntityCount = 10000;
+    constexpr uint32 Runs = 200;
+
+    struct MeshComponent { uint32 mesh = 0; };
+    struct MaterialComponent { uint32 material = 0; };
+    struct TextureComponent { uint32 texture = 0; };
+
+    // Stand-in for RenderObject: virtual interface, three shared components and the
+    // transform inline.
+    class Object {
+    public:
+        virtual ~Object() = default;
+        virtual void Update() = 0;
+    };
+
+    class MeshObject : public Object {
+    public:
+        MeshObject(const Position& position)
+            : m_mesh(new MeshComponent()), m_material(new MaterialComponent()), m_texture(new TextureComponent()),
+              m_position(position) {}
+
+        void Update() override {
+            if (!m_dirty) return;
+            TransformSystem::Compose(m_position, m_rotation, m_scale, m_world);
+            m_dirty = false;
+        }
+
+        void MarkDirty() { m_dirty = true; }
+        const WorldMatrix& GetWorld() const { return m_world; }
+
+    private:
+        SharedPtr<MeshComponent> m_mesh;
+        SharedPtr<MaterialComponent> m_material;
+        SharedPtr<TextureComponent> m_texture;
+        Position m_position;
+        Rotation m_rotation;
+        Scale m_scale;
+        WorldMatrix m_world;
+        bool m_dirty = true;
+        uint8 m_padding[64] = {};       // Bookkeeping the real objects carry around
+    };
+}
+
+int main() {
+    std::mt19937 rng(3);
+    Vector<Position> positions(EntityCount);
+    for (auto& position : positions) position = { float(rng() % 1000), 0.0f, float(rng() % 1000) };
+
+    // Objects are created over the scene's lifetime, so neighbours in the list are not
+    // neighbours in memory.
+    Vector<UniquePtr<Object>> objects;
+    Vector<UniquePtr<uint8[]>> interleaved;
+    for (uint32 i = 0; i < EntityCount; ++i) {
+        objects.push_back(UniquePtr<Object>(new MeshObject(positions[i])));
+        interleaved.push_back(UniquePtr<uint8[]>(new uint8[rng() % 512 + 16]));
+    }
+    std::shuffle(objects.begin(), objects.end(), rng);
+
+    EntityWorld world;
+    Vector<Handle> entities;
+    for (const auto& position : positions) {
+        entities.push_back(world.CreateEntity(position, Rotation(), Scale(), WorldMatrix(), EntityFlags(), MeshRef(), MaterialRef()));
+    }
+
+    std::printf("%10s %10s %12s %12s\n", "dirty", "pattern", "objects ms", "chunks ms");
+    for (uint32 dirtyPercent : { 10u, 50u, 100u }) {
+        for (bool clustered : { false, true }) {
+            if (clustered && dirtyPercent == 100) continue;
+
+            // Indices of the entities changed each frame.
+            Vector<uint32> dirty;
+            for (uint32 i = 0; i < EntityCount * dirtyPercent / 100; ++i) {
+                dirty.push_back(clustered ? i : i * (100 / dirtyPercent));
+            }
+
+            double objectMs = MeasureMs(Runs, [&] {
+                for (uint32 i : dirty) static_cast<MeshObject*>(objects[i].get())->MarkDirty();
+                for (auto& object : objects) object->Update();
+            });
+
+            double chunkMs = MeasureMs(Runs, [&] {
+                for (uint32 i : dirty) TransformSystem::MarkDirty(world, entities[i]);
+                TransformSystem::Update(world);
+                TransformSystem::ForEachChanged(world, [](const WorldMatrix&) {});
+            });
+
+            std::printf("%9u%% %10s %12.4f %12.4f\n", dirtyPercent, clustered ? "clustered" : "spread", objectMs,
+                        chunkMs);
+        }
+    }
+    return 0;
+}
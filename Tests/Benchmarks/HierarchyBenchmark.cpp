@@ -0,0 +1,116 @@
+#include "Benchmark.h"
+#include <TransformHierarchy.h>
+#include <WorkerPool.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+
+// 50k nodes seven levels deep (depth 0 to 6), the shape of units carrying attachments
+// carrying effects. A pointer tree updated recursively from its roots, one heap node per
+// transform, against TransformHierarchy's flat level-by-level pass.
+namespace {
+    constexpr uint32 LevelSizes[] = { 50, 200, 800, 2400, 6400, 14000, 26150 };
+    constexpr uint32 Runs = 30;
+
+    struct TreeNode {
+        WorldMatrix local;
+        WorldMatrix world;
+        Vector<TreeNode*> children;
+        bool dirty = true;
+    };
+
+    void Multiply(const WorldMatrix& a, const WorldMatrix& b, WorldMatrix& out) {
+        for (uint32 r = 0; r < 4; ++r) {
+            for (uint32 c = 0; c < 4; ++c) {
+                out.m[r * 4 + c] = a.m[r * 4] * b.m[c] + a.m[r * 4 + 1] * b.m[4 + c] +
+                                   a.m[r * 4 + 2] * b.m[8 + c] + a.m[r * 4 + 3] * b.m[12 + c];
+            }
+        }
+    }
+
+    void UpdateTree(TreeNode* node, const WorldMatrix* parentWorld, bool parentChanged) {
+        bool changed = node->dirty || parentChanged;
+        if (changed) {
+            if (parentWorld) Multiply(node->local, *parentWorld, node->world);
+            else node->world = node->local;
+            node->dirty = false;
+        }
+        for (TreeNode* child : node->children) UpdateTree(child, &node->world, changed);
+    }
+}
+
+int main() {
+    std::mt19937 rng(6);
+
+    // Parents picked at random from the level above, nodes allocated in shuffled order
+    // as a scene built over time would leave them.
+    Vector<uint32> parents;
+    Vector<uint32> levelStart;
+    for (uint32 level = 0; level < std::size(LevelSizes); ++level) {
+        levelStart.push_back(static_cast<uint32>(parents.size()));
+        for (uint32 i = 0; i < LevelSizes[level]; ++i) {
+            parents.push_back(level == 0 ? UINT32_MAX : levelStart[level - 1] + rng() % LevelSizes[level - 1]);
+        }
+    }
+    uint32 count = static_cast<uint32>(parents.size());
+    uint32 rootCount = LevelSizes[0];
+
+    Vector<uint32> allocationOrder(count);
+    for (uint32 i = 0; i < count; ++i) allocationOrder[i] = i;
+    std::shuffle(allocationOrder.begin(), allocationOrder.end(), rng);
+    Vector<UniquePtr<TreeNode>> treeNodes(count);
+    for (uint32 i : allocationOrder) treeNodes[i] = UniquePtr<TreeNode>(new TreeNode());
+    for (uint32 i = rootCount; i < count; ++i) treeNodes[parents[i]]->children.push_back(treeNodes[i].get());
+
+    // Children are created before their parents' later siblings, so the hierarchy starts
+    // out unsorted like a scene that was edited.
+    TransformHierarchy hierarchy;
+    Vector<Handle> nodes(count);
+    for (uint32 i : allocationOrder) nodes[i] = hierarchy.CreateNode();
+    for (uint32 i = rootCount; i < count; ++i) hierarchy.SetParent(nodes[i], nodes[parents[i]]);
+
+    for (uint32 i = 0; i < count; ++i) {
+        WorldMatrix local;
+        local.m[12] = float(rng() % 100);
+        local.m[14] = float(rng() % 100);
+        treeNodes[i]->local = local;
+        hierarchy.SetLocal(nodes[i], local);
+    }
+    hierarchy.Update();
+    std::printf("%u nodes, %u levels\n", hierarchy.GetNodeCount(), hierarchy.GetDepthCount());
+
+    WorkerPool pool;
+    auto markAll = [&] {
+        for (uint32 i = 0; i < count; ++i) {
+            treeNodes[i]->dirty = true;
+            hierarchy.SetLocal(nodes[i], treeNodes[i]->local);
+        }
+    };
+    auto markRoots = [&](uint32 moved) {
+        for (uint32 i = 0; i < moved; ++i) {
+            treeNodes[i]->dirty = true;
+            hierarchy.SetLocal(nodes[i], treeNodes[i]->local);
+        }
+    };
+    auto updateTree = [&] {
+        for (uint32 i = 0; i < rootCount; ++i) UpdateTree(treeNodes[i].get(), nullptr, false);
+    };
+
+    std::printf("%-22s %12s %12s %12s\n", "", "pointer tree", "flat", "flat + pool");
+    struct Case {
+        const char* name;
+        std::function<void()> mark;
+    };
+    const Case cases[] = {
+        { "every local changed", markAll },
+        { "10% of roots moved", [&] { markRoots(rootCount / 10); } },
+        { "nothing changed", [] {} },
+    };
+    for (const Case& c : cases) {
+        double treeMs = MeasureMs(Runs, [&] { c.mark(); updateTree(); });
+        double flatMs = MeasureMs(Runs, [&] { c.mark(); hierarchy.Update(); });
+        double poolMs = MeasureMs(Runs, [&] { c.mark(); hierarchy.Update(&pool); });
+        std::printf("%-22s %9.3f ms %9.3f ms %9.3f ms\n", c.name, treeMs, flatMs, poolMs);
+    }
+    return 0;
+}
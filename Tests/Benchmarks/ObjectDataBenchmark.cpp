@@ -0,0 +1,109 @@
+#include "Benchmark.h"
+#include <ObjectDataStore.h>
+#include <MemoryUtils.h>
+#include <random>
+
+// One frame of object data for 100k objects, streamed into a buffer standing in for the
+// mapped upload heap:
+//   legacy   - ObjectConstants per object (WorldViewProj and World, transposed), each
+//              in its own 256 byte constant buffer slot
+//   packed   - ObjectDataPacker, 80 bytes per object and no camera data
+//   store    - ObjectDataStore::Update on every object after moving the given share of
+//              them (picked at random, so some twice), then FlushChanges of the merged
+//              changed ranges
+// The byte column is what each frame uploads; like DirtyRangeBenchmark, the times are
+// for cached memory and understate copies over a real write-combined heap.
+namespace {
+    constexpr uint32 ObjectCount = 100000;
+    constexpr uint32 ConstantBufferAlignment = 256;
+    constexpr uint32 Runs = 21;
+
+    struct ObjectConstants {
+        float WorldViewProj[16];
+        float World[16];
+    };
+
+    void MultiplyTransposed(const float* a, const float* b, float* transposedResult) {
+        for (uint32 row = 0; row < 4; ++row) {
+            for (uint32 column = 0; column < 4; ++column) {
+                float sum = 0.0f;
+                for (uint32 k = 0; k < 4; ++k) sum += a[row * 4 + k] * b[k * 4 + column];
+                transposedResult[column * 4 + row] = sum;
+            }
+        }
+    }
+
+    void Transpose(const float* m, float* result) {
+        for (uint32 row = 0; row < 4; ++row) {
+            for (uint32 column = 0; column < 4; ++column) result[column * 4 + row] = m[row * 4 + column];
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+    Vector<float> worlds(ObjectCount * 16, 0.0f);
+    for (uint32 i = 0; i < ObjectCount; ++i) {
+        float* world = &worlds[i * 16];
+        world[0] = world[5] = world[10] = world[15] = 1.0f;
+        world[12] = position(rng);
+        world[13] = position(rng) * 0.05f;
+        world[14] = position(rng);
+    }
+    const float viewProj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1, 0, 0, -1000.0f / 999.0f, 0 };
+
+    std::printf("%-16s %12s %14s %12s\n", "path", "ms", "bytes", "vs legacy");
+    const uint64 legacyBytes = uint64(ObjectCount) * ConstantBufferAlignment;
+
+    Vector<uint8> legacyMapped(legacyBytes);
+    Vector<ObjectConstants> legacyStaging(1);
+    double legacyMs = MeasureMs(Runs, [&] {
+        for (uint32 i = 0; i < ObjectCount; ++i) {
+            ObjectConstants& constants = legacyStaging[0];
+            const float* world = &worlds[i * 16];
+            MultiplyTransposed(world, viewProj, constants.WorldViewProj);
+            Transpose(world, constants.World);
+            std::memcpy(&legacyMapped[uint64(i) * ConstantBufferAlignment], &constants, sizeof(ObjectConstants));
+        }
+    });
+    std::printf("%-16s %12.3f %14llu %11.1f%%\n", "legacy", legacyMs, static_cast<unsigned long long>(legacyBytes), 100.0);
+
+    Vector<ObjectData> mapped(ObjectCount);
+    ObjectDataPacker packer;
+    packer.Reserve(ObjectCount);
+    double packedMs = MeasureMs(Runs, [&] {
+        packer.Clear();
+        for (uint32 i = 0; i < ObjectCount; ++i) packer.Add(&worlds[i * 16], i % 64);
+        StreamingCopy(mapped.data(), packer.GetData(), packer.GetByteSize());
+    });
+    std::printf("%-16s %12.3f %14llu %11.1f%%\n", "packed", packedMs,
+                static_cast<unsigned long long>(packer.GetByteSize()), 100.0 * packer.GetByteSize() / legacyBytes);
+
+    for (uint32 movedPercent : { 100u, 10u, 1u, 0u }) {
+        ObjectDataStore store(ObjectCount);
+        for (uint32 i = 0; i < ObjectCount; ++i) store.Update(store.Allocate(), &worlds[i * 16], i % 64);
+        store.FlushChanges([](uint32, const ObjectData*, uint32) {});
+
+        // The same objects move every frame, a little further each time.
+        uint32 movedCount = ObjectCount / 100 * movedPercent;
+        Vector<uint32> moved(movedCount);
+        for (uint32& index : moved) index = rng() % ObjectCount;
+
+        uint64 bytes = 0;
+        double storeMs = MeasureMs(Runs, [&] {
+            for (uint32 index : moved) worlds[index * 16 + 12] += 0.5f;
+            for (uint32 i = 0; i < ObjectCount; ++i) store.Update(i, &worlds[i * 16], i % 64);
+            uint32 uploaded = store.FlushChanges([&](uint32 first, const ObjectData* objects, uint32 count) {
+                StreamingCopy(mapped.data() + first, objects, uint64(count) * sizeof(ObjectData));
+            });
+            bytes = uint64(uploaded) * sizeof(ObjectData);
+        });
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "store %u%% moved", movedPercent);
+        std::printf("%-16s %12.3f %14llu %11.1f%%\n", name, storeMs, static_cast<unsigned long long>(bytes),
+                    100.0 * bytes / legacyBytes);
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+#include <OcclusionCuller.h>
+#include <FrustumCuller.h>
+#include <WorkerPool.h>
+#include <array>
+#include <random>
+
+// A street of wall-sized boxes in front of the camera hiding a field of small objects
+// behind them: the cost of rasterizing the occluders and of testing the objects, and
+// how many of them the walls hide.
+namespace {
+    constexpr uint32 Runs = 50;
+    constexpr uint32 WallCount = 12;
+    constexpr uint32 ObjectCount = 20000;
+    const float ViewProj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1, 0, 0, -1000.0f / 999.0f, 0 };
+
+    struct Vertex {
+        float position[3];
+    };
+
+    // Unit box corners and its 12 triangles.
+    const Vertex BoxVertices[8] = { { { -1, -1, -1 } }, { { 1, -1, -1 } }, { { 1, 1, -1 } }, { { -1, 1, -1 } },
+                                    { { -1, -1, 1 } },  { { 1, -1, 1 } },  { { 1, 1, 1 } },  { { -1, 1, 1 } } };
+    const uint16 BoxIndices[36] = { 0, 1, 2, 0, 2, 3, 4, 6, 5, 4, 7, 6, 0, 4, 5, 0, 5, 1,
+                                    3, 2, 6, 3, 6, 7, 0, 3, 7, 0, 7, 4, 1, 5, 6, 1, 6, 2 };
+}
+
+int main() {
+    std::mt19937 rng(44);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    Vector<std::array<float, 16>> walls(WallCount);
+    for (uint32 i = 0; i < WallCount; ++i) {
+        float x = unit(rng) * 40.0f, z = 20.0f + (unit(rng) + 1.0f) * 20.0f;
+        walls[i] = { 8, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0.5f, 0, x, 0, z, 1 };
+    }
+
+    CullingBounds bounds;
+    bounds.Resize(ObjectCount);
+    Vector<uint32> drawIds(ObjectCount);
+    for (uint32 i = 0; i < ObjectCount; ++i) {
+        float z = 70.0f + (unit(rng) + 1.0f) * 200.0f;
+        const float center[3] = { unit(rng) * z, unit(rng) * z * 0.2f, z };
+        const float extents[3] = { 1.0f, 1.0f, 1.0f };
+        bounds.Set(i, center, extents);
+    }
+
+    OcclusionCuller culler;
+    WorkerPool pool;
+    auto addWalls = [&] {
+        culler.Begin(ViewProj);
+        for (const auto& world : walls) culler.AddOccluder(world.data(), BoxVertices, sizeof(Vertex), 8, BoxIndices, 36);
+    };
+
+    uint32 visible = 0;
+    auto filter = [&](WorkerPool* filterPool) {
+        for (uint32 i = 0; i < ObjectCount; ++i) drawIds[i] = i;
+        visible = culler.Filter(bounds, drawIds.data(), ObjectCount, filterPool);
+    };
+
+    double rasterMs = MeasureMs(Runs, [&] { addWalls(); culler.Rasterize(); });
+    double rasterPoolMs = MeasureMs(Runs, [&] { addWalls(); culler.Rasterize(&pool); });
+    double filterMs = MeasureMs(Runs, [&] { filter(nullptr); });
+    double filterPoolMs = MeasureMs(Runs, [&] { filter(&pool); });
+
+    std::printf("%u walls, %u triangles rasterized, %ux%u depth buffer\n", WallCount,
+                culler.GetStats().rasterizedTriangles, culler.GetWidth(), culler.GetHeight());
+    std::printf("%-10s %10s %10s\n", "", "serial", "pool");
+    std::printf("%-10s %7.4f ms %7.4f ms\n", "rasterize", rasterMs, rasterPoolMs);
+    std::printf("%-10s %7.4f ms %7.4f ms\n", "filter", filterMs, filterPoolMs);
+    std::printf("%u of %u objects hidden\n", ObjectCount - visible, ObjectCount);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "Benchmark.h"
+#include <LooseQuadtree.h>
+#include <cmath>
+#include <random>
+
+// Units wandering over a 4096 x 4096 map, indexed by a LooseQuadtree. Queries are the
+// ones the renderer and game code issue: a drag-select rectangle, an attack radius and
+// the camera frustum, each against a loop over every unit, in ms per query. The update
+// row is one frame of moving every unit up to a unit length and reinserting it.
+namespace {
+    constexpr float MapSize = 4096.0f;
+    constexpr uint32 QueriesPerRun = 100;
+    constexpr uint32 Runs = 21;
+
+    struct Unit {
+        float center[3];
+        float extents[3];
+        float velocity[2];
+    };
+
+    bool OverlapsRect(const Unit& unit, float minX, float minZ, float maxX, float maxZ) {
+        return unit.center[0] - unit.extents[0] <= maxX && unit.center[0] + unit.extents[0] >= minX &&
+               unit.center[2] - unit.extents[2] <= maxZ && unit.center[2] + unit.extents[2] >= minZ;
+    }
+
+    bool OverlapsCircle(const Unit& unit, float x, float z, float radius) {
+        float dx = std::max(std::fabs(x - unit.center[0]) - unit.extents[0], 0.0f);
+        float dz = std::max(std::fabs(z - unit.center[2]) - unit.extents[2], 0.0f);
+        return dx * dx + dz * dz <= radius * radius;
+    }
+
+    bool InFrustum(const Unit& unit, const FrustumPlanes& frustum) {
+        for (uint32 p = 0; p < 6; ++p) {
+            float distance = frustum.normalX[p] * unit.center[0] + frustum.normalY[p] * unit.center[1] +
+                             frustum.normalZ[p] * unit.center[2] + frustum.d[p];
+            float radius = std::fabs(frustum.normalX[p]) * unit.extents[0] +
+                           std::fabs(frustum.normalY[p]) * unit.extents[1] +
+                           std::fabs(frustum.normalZ[p]) * unit.extents[2];
+            if (distance + radius < 0.0f) return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    // RTS camera at (2048, 300, 1500) looking down +z, 90 degree field of view, depth 1 to 1000.
+    const float viewProj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1,
+                                 -2048.0f, -300.0f, -1500.0f * 1000.0f / 999.0f - 1000.0f / 999.0f, -1500.0f };
+    FrustumPlanes frustum = FrustumCuller::ExtractPlanes(viewProj);
+
+    std::printf("%8s %-8s %10s %10s %10s %10s\n", "units", "query", "results", "tree ms", "brute ms", "update ms");
+    for (uint32 count : { 10000u, 50000u, 200000u }) {
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> position(0.0f, MapSize);
+        std::uniform_real_distribution<float> size(0.5f, 3.0f);
+        std::uniform_real_distribution<float> speed(-1.0f, 1.0f);
+        Vector<Unit> units(count);
+        LooseQuadtree tree(0.0f, 0.0f, MapSize);
+        for (uint32 i = 0; i < count; ++i) {
+            Unit& unit = units[i];
+            unit = { { position(rng), 0.0f, position(rng) }, { size(rng), size(rng), size(rng) },
+                     { speed(rng), speed(rng) } };
+            tree.Insert(i, unit.center, unit.extents);
+        }
+
+        // Query spots fixed up front so both sides answer the same questions.
+        Vector<float> spots(QueriesPerRun * 2);
+        for (float& spot : spots) spot = position(rng);
+
+        auto measure = [&](const char* name, auto&& treeQuery, auto&& bruteQuery) {
+            Vector<uint32> results;
+            size_t found = 0;
+            double treeMs = MeasureMs(Runs, [&] {
+                found = 0;
+                for (uint32 q = 0; q < QueriesPerRun; ++q) {
+                    results.clear();
+                    treeQuery(spots[q * 2], spots[q * 2 + 1], results);
+                    found += results.size();
+                }
+            });
+            double bruteMs = MeasureMs(Runs, [&] {
+                for (uint32 q = 0; q < QueriesPerRun; ++q) {
+                    results.clear();
+                    for (uint32 i = 0; i < count; ++i) {
+                        if (bruteQuery(units[i], spots[q * 2], spots[q * 2 + 1])) results.push_back(i);
+                    }
+                }
+            });
+            std::printf("%8u %-8s %10zu %10.4f %10.4f\n", count, name, found / QueriesPerRun, treeMs / QueriesPerRun,
+                        bruteMs / QueriesPerRun);
+        };
+
+        measure("rect", [&](float x, float z, Vector<uint32>& results) {
+            tree.QueryRect(x, z, x + 200.0f, z + 120.0f, results);
+        }, [](const Unit& unit, float x, float z) { return OverlapsRect(unit, x, z, x + 200.0f, z + 120.0f); });
+        measure("radius", [&](float x, float z, Vector<uint32>& results) {
+            tree.QueryRadius(x, z, 40.0f, results);
+        }, [](const Unit& unit, float x, float z) { return OverlapsCircle(unit, x, z, 40.0f); });
+        measure("frustum", [&](float, float, Vector<uint32>& results) {
+            tree.QueryFrustum(frustum, results);
+        }, [&](const Unit& unit, float, float) { return InFrustum(unit, frustum); });
+
+        // Units bounce off the map edges so the density stays the same.
+        double updateMs = MeasureMs(Runs, [&] {
+            for (uint32 i = 0; i < count; ++i) {
+                Unit& unit = units[i];
+                for (uint32 axis = 0; axis < 2; ++axis) {
+                    float& coordinate = unit.center[axis * 2];
+                    coordinate += unit.velocity[axis];
+                    if (coordinate < 0.0f || coordinate >= MapSize) {
+                        unit.velocity[axis] = -unit.velocity[axis];
+                        coordinate += 2.0f * unit.velocity[axis];
+                    }
+                }
+                tree.Insert(i, unit.center, unit.extents);
+            }
+        });
+        std::printf("%8u %-8s %10s %10s %10s %10.4f\n", count, "update", "", "", "", updateMs);
+    }
+    return 0;
+}
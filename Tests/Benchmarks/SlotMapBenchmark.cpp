@@ -0,0 +1,107 @@
+#include "Benchmark.h"
+#include <SlotMap.h>
+#include <random>
+
+// SlotMap against the containers ResourceManager used before it: a HashMap<String,
+// SharedPtr<T>> resolved by name, as meshes and textures were, and a Vector<SharedPtr<T>>
+// indexed by material index. Both old lookups handed out a SharedPtr copy; the slot map
+// resolves a handle to a raw pointer. Measures lookups in random order, iterating every
+// value, and churn that erases and reinserts values. Erasing from the vector shifts every
+// later value, which is what renumbered the materials.
+namespace {
+    constexpr uint32 ValueCount = 100000;
+    constexpr uint32 ChurnCount = ValueCount / 100;
+    constexpr uint32 Runs = 50;
+    constexpr uint32 ChurnRuns = 10;
+
+    struct Value {
+        float data[8];
+    };
+
+    SharedPtr<Value> MakeValue(uint32 i) {
+        SharedPtr<Value> value = std::make_shared<Value>();
+        value->data[0] = static_cast<float>(i);
+        return value;
+    }
+}
+
+int main() {
+    std::mt19937 rng(5);
+
+    Vector<String> names;
+    for (uint32 i = 0; i < ValueCount; ++i) {
+        names.push_back("resource_" + std::to_string(i));
+    }
+
+    SlotMap<SharedPtr<Value>> map;
+    HashMap<String, SharedPtr<Value>> hashMap;
+    Vector<SharedPtr<Value>> vector;
+    Vector<Handle> handles;
+    for (uint32 i = 0; i < ValueCount; ++i) {
+        SharedPtr<Value> value = MakeValue(i);
+        handles.push_back(map.Insert(value));
+        hashMap[names[i]] = value;
+        vector.push_back(value);
+    }
+
+    Vector<uint32> order(ValueCount);
+    for (uint32 i = 0; i < ValueCount; ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+
+    float sink = 0.0f;
+    double slotLookupMs = MeasureMs(Runs, [&] {
+        for (uint32 i : order) sink += (*map.Get(handles[i]))->data[0];
+    });
+    double hashLookupMs = MeasureMs(Runs, [&] {
+        for (uint32 i : order) {
+            SharedPtr<Value> value = hashMap.find(names[i])->second;
+            sink += value->data[0];
+        }
+    });
+    double vectorLookupMs = MeasureMs(Runs, [&] {
+        for (uint32 i : order) {
+            SharedPtr<Value> value = vector[i];
+            sink += value->data[0];
+        }
+    });
+
+    double slotIterateMs = MeasureMs(Runs, [&] {
+        for (const auto& value : map) sink += value->data[0];
+    });
+    double hashIterateMs = MeasureMs(Runs, [&] {
+        for (const auto& [name, value] : hashMap) sink += value->data[0];
+    });
+    double vectorIterateMs = MeasureMs(Runs, [&] {
+        for (const auto& value : vector) sink += value->data[0];
+    });
+
+    // Each round erases ChurnCount values at random positions and inserts as many new ones.
+    double slotChurnMs = MeasureMs(ChurnRuns, [&] {
+        for (uint32 i = 0; i < ChurnCount; ++i) {
+            uint32 index = order[i];
+            map.Erase(handles[index]);
+            handles[index] = map.Insert(MakeValue(index));
+        }
+    });
+    double hashChurnMs = MeasureMs(ChurnRuns, [&] {
+        for (uint32 i = 0; i < ChurnCount; ++i) {
+            uint32 index = order[i];
+            hashMap.erase(names[index]);
+            hashMap.emplace(names[index], MakeValue(index));
+        }
+    });
+    double vectorChurnMs = MeasureMs(ChurnRuns, [&] {
+        for (uint32 i = 0; i < ChurnCount; ++i) {
+            uint32 index = order[i];
+            vector.erase(vector.begin() + index);
+            vector.push_back(MakeValue(index));
+        }
+    });
+
+    std::printf("%u values, churn erases and reinserts %u\n", ValueCount, ChurnCount);
+    std::printf("%-16s %12s %18s %17s\n", "", "slot map", "HashMap<String>", "Vector<SharedPtr>");
+    std::printf("%-16s %9.3f ms %15.3f ms %14.3f ms\n", "random lookups", slotLookupMs, hashLookupMs, vectorLookupMs);
+    std::printf("%-16s %9.3f ms %15.3f ms %14.3f ms\n", "iteration", slotIterateMs, hashIterateMs, vectorIterateMs);
+    std::printf("%-16s %9.3f ms %15.3f ms %14.3f ms\n", "churn", slotChurnMs, hashChurnMs, vectorChurnMs);
+    return sink == 0.0f ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+#include "Benchmark.h"
+#include <TlsfAllocator.h>
+#include <random>
+
+// Heap churn as the resource allocator sees it: a 64 MB block with 64 KB granularity,
+// filled with buffers of 64 KB to 4 MB, then half of them replaced at random. Reports
+// the cost per allocate/free pair and how fragmented the free space ends up.
+namespace {
+    constexpr uint64 KB = 1024;
+    constexpr uint64 Capacity = 64 * KB * KB;
+    constexpr uint64 Granularity = 64 * KB;
+    constexpr uint32 Operations = 100000;
+    constexpr uint32 Runs = 20;
+}
+
+int main() {
+    std::mt19937 rng(1);
+    Vector<uint64> sizes(Operations);
+    for (uint64& size : sizes) size = (rng() % 64 + 1) * Granularity;
+
+    TlsfAllocator::Stats stats;
+    uint32 failed = 0;
+    double ms = MeasureMs(Runs, [&] {
+        TlsfAllocator allocator(Capacity, Granularity);
+        Vector<TlsfAllocator::Allocation> live;
+        std::mt19937 pick(2);
+        failed = 0;
+
+        for (uint64 size : sizes) {
+            // Keep the heap around three quarters full.
+            while (allocator.GetUsedBytes() + size > Capacity * 3 / 4 && !live.empty()) {
+                size_t index = pick() % live.size();
+                allocator.Free(live[index].node);
+                live[index] = live.back();
+                live.pop_back();
+            }
+            auto allocation = allocator.Allocate(size);
+            if (allocation.IsValid()) live.push_back(allocation);
+            else ++failed;
+        }
+        stats = allocator.GetStats();
+    });
+
+    std::printf("%u allocations with frees: %.3f ms, %.1f ns per pair\n", Operations, ms, ms * 1e6 / Operations);
+    std::printf("failed %u, live %u, free %llu KB in %u blocks, largest %llu KB, fragmentation %.2f\n",
+                failed, stats.allocationCount, static_cast<unsigned long long>(stats.freeBytes / KB),
+                stats.freeBlockCount, static_cast<unsigned long long>(stats.largestFreeBlock / KB),
+                stats.Fragmentation());
+    return 0;
+}
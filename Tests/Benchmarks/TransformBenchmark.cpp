@@ -0,0 +1,104 @@
+#include "Benchmark.h"
+#include <TransformBatch.h>
+#include <TransformSystem.h>
+#include <WorkerPool.h>
+#include <random>
+
+// World and world-view-projection matrices for many objects. The per-object path
+// stands in for IRenderObject::UpdateWorldMatrix plus the per-object world * viewProj
+// and transpose: one AoS compose and one 4x4 product per object. The kernel runs the
+// same work on SoA streams with each of its paths, and across a WorkerPool.
+namespace {
+    constexpr uint32 Runs = 50;
+
+    struct ObjectTransform {
+        Position position;
+        Rotation rotation;
+        Scale scale;
+    };
+
+    void Multiply(const float* a, const float* b, float* out) {
+        for (uint32 row = 0; row < 4; ++row) {
+            for (uint32 column = 0; column < 4; ++column) {
+                float sum = 0.0f;
+                for (uint32 k = 0; k < 4; ++k) sum += a[row * 4 + k] * b[k * 4 + column];
+                out[row * 4 + column] = sum;
+            }
+        }
+    }
+
+    void Transpose(float* m) {
+        for (uint32 row = 0; row < 4; ++row) {
+            for (uint32 column = row + 1; column < 4; ++column) std::swap(m[row * 4 + column], m[column * 4 + row]);
+        }
+    }
+}
+
+int main() {
+    const float viewProj[16] = { 1.2f, 0, 0, 0, 0, 1.6f, 0, 0, 0, 0, 1.001f, 1, 0, 0, -1.001f, 0 };
+    WorkerPool pool;
+
+    std::printf("%u threads\n", pool.GetThreadCount());
+    std::printf("%8s %12s %10s %10s %10s %12s\n", "objects", "per-object", "scalar", "SSE", "AVX2", "parallel");
+    for (uint32 count : { 1000u, 10000u, 100000u }) {
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        Vector<ObjectTransform> objects(count);
+        Vector<float> streams[10];
+        for (auto& stream : streams) stream.resize(count);
+        for (uint32 i = 0; i < count; ++i) {
+            ObjectTransform& object = objects[i];
+            object.position = { unit(rng) * 100, unit(rng) * 100, unit(rng) * 100 };
+            float q[4] = { unit(rng), unit(rng), unit(rng), unit(rng) };
+            float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+            object.rotation = { q[0] / length, q[1] / length, q[2] / length, q[3] / length };
+            object.scale = { 1.0f, 1.0f, 1.0f };
+
+            const float values[10] = { object.position.x, object.position.y, object.position.z,
+                object.rotation.x, object.rotation.y, object.rotation.z, object.rotation.w,
+                object.scale.x, object.scale.y, object.scale.z };
+            for (uint32 s = 0; s < 10; ++s) streams[s][i] = values[s];
+        }
+
+        TransformStreams in;
+        const float** targets[10] = { &in.positionX, &in.positionY, &in.positionZ, &in.rotationX, &in.rotationY,
+                                      &in.rotationZ, &in.rotationW, &in.scaleX, &in.scaleY, &in.scaleZ };
+        for (uint32 s = 0; s < 10; ++s) *targets[s] = streams[s].data();
+
+        Vector<float> world(size_t(count) * 16);
+        Vector<float> worldViewProj(size_t(count) * 16);
+
+        double objectMs = MeasureMs(Runs, [&] {
+            for (uint32 i = 0; i < count; ++i) {
+                WorldMatrix matrix;
+                TransformSystem::Compose(objects[i].position, objects[i].rotation, objects[i].scale, matrix);
+                float* wvp = &worldViewProj[size_t(i) * 16];
+                Multiply(matrix.m, viewProj, wvp);
+                Transpose(matrix.m);
+                Transpose(wvp);
+                std::memcpy(&world[size_t(i) * 16], matrix.m, sizeof(matrix.m));
+            }
+        });
+
+        double pathMs[3] = {};
+        const TransformKernel::Path paths[3] = { TransformKernel::Path::Scalar, TransformKernel::Path::SSE,
+                                                 TransformKernel::Path::AVX2 };
+        for (uint32 p = 0; p < 3; ++p) {
+            if (paths[p] > TransformKernel::GetBestPath()) continue;
+            pathMs[p] = MeasureMs(Runs, [&] {
+                TransformKernel::Compute(in, count, MatrixLayout::Transposed, world.data(), viewProj,
+                                         worldViewProj.data(), paths[p]);
+            });
+        }
+
+        double parallelMs = MeasureMs(Runs, [&] {
+            TransformKernel::ComputeParallel(&pool, in, count, MatrixLayout::Transposed, world.data(), viewProj,
+                                             worldViewProj.data());
+        });
+
+        std::printf("%8u %12.4f %10.4f %10.4f %10.4f %12.4f\n", count, objectMs, pathMs[0], pathMs[1], pathMs[2],
+                    parallelMs);
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "Benchmark.h"
+#include <VisibilityCache.h>
+#include <WorkerPool.h>
+#include <cmath>
+#include <random>
+
+// 50k boxes around a camera that stands still, walks, or walks while 1% of the boxes
+// move, culled from scratch by FrustumCuller and through the VisibilityCache. The hit
+// and miss columns are the cache's counts of the last frame.
+namespace {
+    constexpr uint32 Count = 50000;
+    constexpr uint32 Runs = 200;
+
+    // Same camera as the renderer: 90 degree field of view, depth 1 to 1000, turned yaw
+    // radians from +z around y.
+    FrustumPlanes MakeFrustum(const float eye[3], float yaw) {
+        const float right[3] = { std::cos(yaw), 0.0f, -std::sin(yaw) };
+        const float up[3] = { 0.0f, 1.0f, 0.0f };
+        const float forward[3] = { std::sin(yaw), 0.0f, std::cos(yaw) };
+        const float* axes[3] = { right, up, forward };
+
+        float view[16] = {};
+        for (uint32 axis = 0; axis < 3; ++axis) {
+            for (uint32 row = 0; row < 3; ++row) view[row * 4 + axis] = axes[axis][row];
+            view[12 + axis] = -(eye[0] * axes[axis][0] + eye[1] * axes[axis][1] + eye[2] * axes[axis][2]);
+        }
+        view[15] = 1.0f;
+
+        const float proj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1, 0, 0, -1000.0f / 999.0f, 0 };
+        float viewProj[16] = {};
+        for (uint32 row = 0; row < 4; ++row) {
+            for (uint32 col = 0; col < 4; ++col) {
+                for (uint32 k = 0; k < 4; ++k) viewProj[row * 4 + col] += view[row * 4 + k] * proj[k * 4 + col];
+            }
+        }
+        return FrustumCuller::ExtractPlanes(viewProj);
+    }
+
+    enum class Scene : uint8 { Idle, Walking, WalkingWithMovers };
+}
+
+int main() {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-800.0f, 800.0f);
+    std::uniform_real_distribution<float> size(0.5f, 10.0f);
+    CullingBounds bounds;
+    bounds.Resize(Count);
+    auto placeBox = [&](uint32 i) {
+        const float center[3] = { position(rng), position(rng) * 0.1f, position(rng) };
+        const float extents[3] = { size(rng), size(rng), size(rng) };
+        bounds.Set(i, center, extents);
+    };
+    for (uint32 i = 0; i < Count; ++i) placeBox(i);
+
+    WorkerPool pool;
+    Vector<uint32> visible(Count);
+    std::uniform_int_distribution<uint32> box(0, Count - 1);
+
+    std::printf("%-20s %10s %10s %10s %10s %8s %8s %8s\n", "camera", "full", "full MT", "cache", "cache MT", "hits",
+                "misses", "rebases");
+    const char* names[3] = { "idle", "walking", "walking, 1% moved" };
+    for (Scene scene : { Scene::Idle, Scene::Walking, Scene::WalkingWithMovers }) {
+        float eye[3] = { 0.0f, 0.0f, 0.0f };
+        float yaw = 0.0f;
+        FrustumPlanes frustum = MakeFrustum(eye, yaw);
+        VisibilityCache cache;
+
+        // One frame of camera and box movement; about one unit and half a degree.
+        auto advance = [&]() {
+            if (scene == Scene::Idle) return;
+            eye[2] += 1.0f;
+            yaw += 0.01f;
+            frustum = MakeFrustum(eye, yaw);
+            if (scene == Scene::WalkingWithMovers) {
+                for (uint32 moved = 0; moved < Count / 100; ++moved) {
+                    uint32 i = box(rng);
+                    placeBox(i);
+                    cache.Invalidate(i);
+                }
+            }
+        };
+
+        double fullMs = MeasureMs(Runs, [&] {
+            advance();
+            FrustumCuller::Cull(frustum, bounds, visible.data());
+        });
+        double fullParallelMs = MeasureMs(Runs, [&] {
+            advance();
+            FrustumCuller::Cull(frustum, bounds, visible.data(), &pool);
+        });
+
+        cache.Cull(frustum, eye, bounds, visible.data());
+        uint32 rebases = 0;
+        double cacheMs = MeasureMs(Runs, [&] {
+            advance();
+            cache.Cull(frustum, eye, bounds, visible.data());
+            rebases += cache.GetStats().rebased;
+        });
+        double cacheParallelMs = MeasureMs(Runs, [&] {
+            advance();
+            cache.Cull(frustum, eye, bounds, visible.data(), &pool);
+        });
+
+        const VisibilityCache::Stats& stats = cache.GetStats();
+        std::printf("%-20s %10.4f %10.4f %10.4f %10.4f %8u %8u %8u\n", names[static_cast<uint32>(scene)], fullMs,
+                    fullParallelMs, cacheMs, cacheParallelMs, stats.hits, stats.misses, rebases);
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "TestMain.h"
+#include <BindlessTextureTable.h>
+
+namespace {
+    template<typename Fn>
+    bool Throws(Fn&& fn) {
+        try {
+            fn();
+        }
+        catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    }
+}
+
+TEST_CASE(RegisterSkipsTheFallbackSlot) {
+    BindlessTextureTable table(100, 8);
+    bool added = false;
+    uint32 slot = table.Register("crate", &added);
+    CHECK(added);
+    CHECK(slot != BindlessTextureTable::FallbackIndex);
+    CHECK(table.Register("crate", &added) == slot && !added);
+    CHECK(table.GetDescriptorIndex(slot) == 100 + slot);
+    CHECK(table.Find("missing") == BindlessTextureTable::FallbackIndex);
+}
+
+TEST_CASE(ReassignFreesTheOldSlotOnlyAfterTheFence) {
+    BindlessTextureTable table(0, 4);      // Fallback plus three texture slots
+    uint32 crate = table.Register("crate");
+    uint32 moved = table.Reassign("crate", 10);
+    CHECK(moved != crate);
+    CHECK(table.Find("crate") == moved);
+    CHECK(table.GetTextureCount() == 1);
+
+    // Frames up to fence 10 may still read the old slot, so it is not handed out yet.
+    uint32 grass = table.Register("grass");
+    CHECK(grass != crate && grass != moved);
+    table.Reclaim(9);
+    CHECK(Throws([&] { table.Register("stone"); }));
+
+    table.Reclaim(10);
+    CHECK(table.Register("stone") == crate);
+}
+
+TEST_CASE(ReassignOfUnknownNamesReturnsTheFallback) {
+    BindlessTextureTable table(0, 4);
+    CHECK(table.Reassign("missing", 1) == BindlessTextureTable::FallbackIndex);
+}
+
+TEST_CASE(ReassignThrowsWhenTheTableIsFull) {
+    BindlessTextureTable table(0, 2);      // Fallback plus one texture slot
+    uint32 crate = table.Register("crate");
+    CHECK(Throws([&] { table.Reassign("crate", 1); }));
+    CHECK(table.Find("crate") == crate);
+}
+
+TEST_CASE(UnregisteredNamesFallBackAndTheirSlotWaitsForTheFence) {
+    BindlessTextureTable table(0, 3);      // Fallback plus two texture slots
+    uint32 crate = table.Register("crate");
+    uint32 grass = table.Register("grass");
+
+    table.Unregister("crate", 5);
+    CHECK(!table.Contains("crate"));
+    CHECK(table.Find("crate") == BindlessTextureTable::FallbackIndex);
+    CHECK(table.Find("grass") == grass);
+    CHECK(table.GetTextureCount() == 1);
+
+    // Frames up to fence 5 may still sample the removed texture through the old slot.
+    table.Reclaim(4);
+    CHECK(Throws([&] { table.Register("stone"); }));
+    table.Reclaim(5);
+    CHECK(table.Register("stone") == crate);
+
+    // Unregistering an unknown name leaves the table alone.
+    table.Unregister("missing", 6);
+    CHECK(table.GetTextureCount() == 2);
+}
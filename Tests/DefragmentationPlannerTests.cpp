@@ -0,0 +1,242 @@
+#include "TestMain.h"
+#include <DefragmentationPlanner.h>
+#include <cstring>
+
+// Runs plans against simulated heaps: every block has backing bytes and every allocation
+// an owner with a relocation callback, the way GpuDefragmenter copies resources and hands
+// their owners the new placement.
+namespace {
+    constexpr uint64 KB = 1024;
+    constexpr uint64 BlockSize = 1024 * KB;
+    constexpr uint64 Granularity = 64 * KB;
+
+    struct Location {
+        uint32 block = 0;
+        uint64 offset = 0;
+    };
+
+    struct Owner {
+        uint32 block = 0;
+        uint32 node = TlsfAllocator::InvalidNode;
+        uint64 size = 0;
+        uint8 pattern = 0;
+        bool pinned = false;
+        Function<void(Location)> onRelocate;
+    };
+
+    class SimulatedHeap {
+    public:
+        explicit SimulatedHeap(uint32 blockCount) {
+            for (uint32 i = 0; i < blockCount; ++i) {
+                m_allocators.push_back(UniquePtr<TlsfAllocator>(new TlsfAllocator(BlockSize, Granularity)));
+                m_memory.emplace_back(BlockSize, 0);
+                m_blocks.push_back(m_allocators.back().get());
+            }
+        }
+
+        // Places the allocation in the given block and fills it with pattern.
+        Owner* Allocate(uint32 block, uint64 size, uint8 pattern) {
+            auto allocation = m_allocators[block]->Allocate(size);
+            if (!allocation.IsValid()) return nullptr;
+
+            std::memset(&m_memory[block][allocation.offset], pattern, allocation.size);
+            m_owners.push_back(UniquePtr<Owner>(new Owner{ block, allocation.node, allocation.size, pattern }));
+            return m_owners.back().get();
+        }
+
+        void Free(Owner* owner) {
+            m_allocators[owner->block]->Free(owner->node);
+            owner->node = TlsfAllocator::InvalidNode;
+        }
+
+        DefragmentationPlanner::Plan Plan(const DefragmentationPlanner::Settings& settings = {}) {
+            return DefragmentationPlanner::CreatePlan(m_blocks, [this](uint32 block, uint32 node) {
+                Owner* owner = Find(block, node);
+                return owner && !owner->pinned;
+            }, settings);
+        }
+
+        // Copies the bytes, tells the owners, then frees the sources.
+        void Execute(const DefragmentationPlanner::Plan& plan) {
+            for (const auto& move : plan.moves) {
+                std::memcpy(&m_memory[move.dstBlock][move.dstOffset], &m_memory[move.srcBlock][move.srcOffset], move.size);
+                std::memset(&m_memory[move.srcBlock][move.srcOffset], 0xDD, move.size);
+
+                Owner* owner = Find(move.srcBlock, move.srcNode);
+                owner->block = move.dstBlock;
+                owner->node = move.dstNode;
+                if (owner->onRelocate) owner->onRelocate({ move.dstBlock, move.dstOffset });
+            }
+            DefragmentationPlanner::Complete(m_blocks, plan);
+        }
+
+        // Every live owner still finds its own bytes.
+        bool ContentsIntact() const {
+            for (const auto& owner : m_owners) {
+                if (owner->node == TlsfAllocator::InvalidNode) continue;
+
+                uint64 offset = OffsetOf(*owner);
+                for (uint64 i = 0; i < owner->size; ++i) {
+                    if (m_memory[owner->block][offset + i] != owner->pattern) return false;
+                }
+            }
+            return true;
+        }
+
+        uint64 OffsetOf(const Owner& owner) const {
+            uint64 offset = ~0ull;
+            m_allocators[owner.block]->ForEachAllocation([&](const TlsfAllocator::Allocation& allocation) {
+                if (allocation.node == owner.node) offset = allocation.offset;
+            });
+            return offset;
+        }
+
+        TlsfAllocator& Block(uint32 index) { return *m_allocators[index]; }
+        const Vector<TlsfAllocator*>& Blocks() const { return m_blocks; }
+
+    private:
+        Vector<UniquePtr<TlsfAllocator>> m_allocators;
+        Vector<Vector<uint8>> m_memory;
+        Vector<TlsfAllocator*> m_blocks;
+        Vector<UniquePtr<Owner>> m_owners;
+
+        Owner* Find(uint32 block, uint32 node) const {
+            for (const auto& owner : m_owners) {
+                if (owner->block == block && owner->node == node) return owner.get();
+            }
+            return nullptr;
+        }
+    };
+
+    // Four blocks filled with 128 KB allocations, then holes punched into blocks 0 and 1
+    // and blocks 2 and 3 thinned out to one and two allocations, which fit into those holes.
+    Vector<Owner*> Fragment(SimulatedHeap& heap) {
+        Vector<Owner*> owners;
+        uint8 pattern = 1;
+        for (uint32 block = 0; block < 4; ++block) {
+            for (uint32 i = 0; i < 8; ++i) owners.push_back(heap.Allocate(block, 128 * KB, pattern++));
+        }
+        heap.Free(owners[3]);
+        heap.Free(owners[12]);
+        heap.Free(owners[13]);
+        heap.Free(owners[14]);
+        for (uint32 i = 17; i < 32; ++i) {
+            if (i != 24 && i != 28) heap.Free(owners[i]);
+        }
+        return owners;
+    }
+}
+
+TEST_CASE(PlanEvacuatesSparseBlocksIntoDenseOnes) {
+    SimulatedHeap heap(4);
+    Fragment(heap);
+    auto before = DefragmentationPlanner::Measure(heap.Blocks());
+    CHECK(before.emptyBlockCount == 0);
+
+    auto plan = heap.Plan();
+    CHECK(plan.evacuatedBlocks.size() == 2);
+    CHECK(plan.moves.size() == 3);
+    CHECK(plan.bytesMoved == 3 * 128 * KB);
+    for (const auto& move : plan.moves) {
+        CHECK(move.srcBlock >= 2);
+        CHECK(move.dstBlock < 2);
+        CHECK(move.dstOffset % Granularity == 0);
+    }
+
+    heap.Execute(plan);
+    CHECK(heap.ContentsIntact());
+    CHECK(heap.Block(2).IsEmpty() && heap.Block(3).IsEmpty());
+
+    auto after = DefragmentationPlanner::Measure(heap.Blocks());
+    CHECK(after.emptyBlockCount == 2);
+    CHECK(after.usedBytes == before.usedBytes);
+    CHECK(heap.Block(0).GetUsedBytes() == BlockSize);
+    CHECK(heap.Block(0).GetUsedBytes() + heap.Block(1).GetUsedBytes() == after.usedBytes);
+}
+
+TEST_CASE(RelocationCallbacksReceiveTheNewPlacement) {
+    SimulatedHeap heap(4);
+    Vector<Owner*> owners = Fragment(heap);
+
+    Vector<Location> relocated(owners.size(), Location{ ~0u, ~0ull });
+    for (size_t i = 0; i < owners.size(); ++i) {
+        owners[i]->onRelocate = [&relocated, i](Location location) { relocated[i] = location; };
+    }
+
+    auto plan = heap.Plan();
+    heap.Execute(plan);
+
+    uint32 calls = 0;
+    for (size_t i = 0; i < owners.size(); ++i) {
+        if (relocated[i].block == ~0u) continue;
+
+        ++calls;
+        CHECK(relocated[i].block == owners[i]->block);
+        CHECK(relocated[i].offset == heap.OffsetOf(*owners[i]));
+    }
+    CHECK(calls == plan.moves.size());
+
+    // Owners in the dense blocks were left where they were.
+    CHECK(relocated[0].block == ~0u);
+    CHECK(owners[0]->block == 0);
+}
+
+TEST_CASE(PinnedAllocationsKeepTheirBlock) {
+    SimulatedHeap heap(4);
+    Vector<Owner*> owners = Fragment(heap);
+    owners[16]->pinned = true;
+
+    auto plan = heap.Plan();
+    CHECK(plan.evacuatedBlocks.size() == 1);
+    CHECK(plan.evacuatedBlocks[0] == 3);
+    for (const auto& move : plan.moves) CHECK(move.srcBlock == 3);
+
+    heap.Execute(plan);
+    CHECK(heap.ContentsIntact());
+    CHECK(owners[16]->block == 2);
+    CHECK(heap.Block(3).IsEmpty());
+}
+
+TEST_CASE(BlocksThatDontFitElsewhereAreLeftAlone) {
+    SimulatedHeap heap(2);
+    Vector<Owner*> owners;
+    for (uint32 i = 0; i < 8; ++i) owners.push_back(heap.Allocate(0, 128 * KB, static_cast<uint8>(i + 1)));
+    owners.push_back(heap.Allocate(1, 256 * KB, 9));
+    heap.Free(owners[2]);   // 128 KB free in block 0, too little for the 256 KB allocation
+
+    auto plan = heap.Plan();
+    CHECK(plan.IsEmpty());
+    CHECK(plan.evacuatedBlocks.empty());
+    CHECK(heap.Block(0).GetUsedBytes() == 7 * 128 * KB);    // No reservation left behind
+}
+
+TEST_CASE(CancelReleasesTheReservations) {
+    SimulatedHeap heap(4);
+    Fragment(heap);
+    uint64 used0 = heap.Block(0).GetUsedBytes();
+    uint64 used1 = heap.Block(1).GetUsedBytes();
+
+    auto plan = heap.Plan();
+    CHECK(!plan.IsEmpty());
+    CHECK(heap.Block(0).GetUsedBytes() + heap.Block(1).GetUsedBytes() == used0 + used1 + plan.bytesMoved);
+
+    DefragmentationPlanner::Cancel(heap.Blocks(), plan);
+    CHECK(heap.Block(0).GetUsedBytes() == used0);
+    CHECK(heap.Block(1).GetUsedBytes() == used1);
+    CHECK(heap.ContentsIntact());
+}
+
+TEST_CASE(PassBudgetLimitsTheMoves) {
+    SimulatedHeap heap(4);
+    Fragment(heap);
+
+    DefragmentationPlanner::Settings settings;
+    settings.maxMovesPerPass = 2;
+    auto plan = heap.Plan(settings);
+    CHECK(plan.moves.size() <= 2);
+    CHECK(plan.evacuatedBlocks.size() == 1);
+
+    heap.Execute(plan);
+    CHECK(heap.ContentsIntact());
+    CHECK(DefragmentationPlanner::Measure(heap.Blocks()).emptyBlockCount == 1);
+}
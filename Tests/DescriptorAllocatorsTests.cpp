@@ -0,0 +1,127 @@
+#include "TestMain.h"
+#include <DescriptorAllocators.h>
+#include <algorithm>
+
+TEST_CASE(FreeListHandsOutEverySlotOnce) {
+    DescriptorFreeList list(100, 4);
+    Vector<uint32> indices;
+    for (uint32 i = 0; i < 4; ++i) indices.push_back(list.Allocate());
+    std::sort(indices.begin(), indices.end());
+    CHECK(indices == Vector<uint32>({ 100, 101, 102, 103 }));
+    CHECK(list.Allocate() == DescriptorFreeList::InvalidIndex);
+    CHECK(list.GetAllocatedCount() == 4);
+    CHECK(list.GetHighWaterMark() == 4);
+}
+
+TEST_CASE(FreeListReusesOnlyAfterTheFence) {
+    DescriptorFreeList list(0, 3);
+    uint32 a = list.Allocate();
+    uint32 b = list.Allocate();
+    list.Free(a, 5);
+    CHECK(list.GetAllocatedCount() == 1);
+
+    // The third slot was never used, so it comes first; then nothing is left.
+    uint32 c = list.Allocate();
+    CHECK(c != a && c != b);
+    CHECK(list.Allocate() == DescriptorFreeList::InvalidIndex);
+
+    list.Reclaim(4);
+    CHECK(list.Allocate() == DescriptorFreeList::InvalidIndex);
+    list.Reclaim(5);
+    CHECK(list.Allocate() == a);
+    CHECK(list.GetHighWaterMark() == 3);
+}
+
+TEST_CASE(FreeListReclaimsInFenceOrder) {
+    DescriptorFreeList list(0, 3);
+    uint32 a = list.Allocate();
+    uint32 b = list.Allocate();
+    uint32 c = list.Allocate();
+    list.Free(b, 1);
+    list.Free(a, 2);
+    list.Free(c, 3);
+
+    list.Reclaim(2);
+    Vector<uint32> reused = { list.Allocate(), list.Allocate() };
+    std::sort(reused.begin(), reused.end());
+    CHECK(reused == Vector<uint32>({ a, b }));
+    CHECK(list.Allocate() == DescriptorFreeList::InvalidIndex);
+
+    list.Reclaim(3);
+    CHECK(list.Allocate() == c);
+}
+
+TEST_CASE(RingAllocatesContiguously) {
+    DescriptorRing ring(1000, 16);
+    CHECK(ring.Allocate(3) == 1000);
+    CHECK(ring.Allocate(5) == 1003);
+    CHECK(ring.Allocate(1) == 1008);
+    CHECK(ring.GetUsedCount() == 9);
+    CHECK(ring.Allocate(0) == DescriptorRing::InvalidIndex);
+    CHECK(ring.Allocate(17) == DescriptorRing::InvalidIndex);
+}
+
+TEST_CASE(RingRefusesWhenFramesInFlightHoldIt) {
+    DescriptorRing ring(0, 8);
+    CHECK(ring.Allocate(6) == 0);
+    ring.EndFrame(1);
+    CHECK(ring.Allocate(2) == 6);
+    CHECK(ring.Allocate(1) == DescriptorRing::InvalidIndex);
+    ring.EndFrame(2);
+
+    // Frame 1's descriptors come back once its fence completes, frame 2's stay.
+    ring.Reclaim(0);
+    CHECK(ring.Allocate(1) == DescriptorRing::InvalidIndex);
+    ring.Reclaim(1);
+    CHECK(ring.GetUsedCount() == 2);
+    CHECK(ring.Allocate(6) == 0);
+    CHECK(ring.Allocate(1) == DescriptorRing::InvalidIndex);
+}
+
+TEST_CASE(RingSkipsTheTailOnWrap) {
+    DescriptorRing ring(0, 10);
+    CHECK(ring.Allocate(4) == 0);
+    ring.EndFrame(1);
+    CHECK(ring.Allocate(4) == 4);
+    ring.EndFrame(2);
+    ring.Reclaim(1);                // Descriptors 0-3 are free again, 8 and 9 too
+
+    // Three don't fit before the end, so 8 and 9 are skipped and the run starts at 0.
+    CHECK(ring.Allocate(3) == 0);
+    CHECK(ring.GetUsedCount() == 4 + 2 + 3);
+    ring.EndFrame(3);
+
+    // The skipped descriptors belong to frame 3 and come back with it.
+    ring.Reclaim(2);
+    CHECK(ring.GetUsedCount() == 5);
+    ring.Reclaim(3);
+    CHECK(ring.GetUsedCount() == 0);
+    CHECK(ring.Allocate(10) == 0);
+}
+
+TEST_CASE(RingRefusesAWrapThatWouldOverrunTheOldestFrame) {
+    DescriptorRing ring(0, 10);
+    CHECK(ring.Allocate(2) == 0);
+    ring.EndFrame(1);
+    CHECK(ring.Allocate(5) == 2);
+    ring.EndFrame(2);
+    ring.Reclaim(1);                // Free: 0-1 and 7-9
+
+    // Four fit neither before the end nor in front of frame 2, even though five are free.
+    CHECK(ring.Allocate(4) == DescriptorRing::InvalidIndex);
+    CHECK(ring.GetUsedCount() == 5);
+    CHECK(ring.Allocate(3) == 7);
+    CHECK(ring.Allocate(2) == 0);
+    CHECK(ring.Allocate(1) == DescriptorRing::InvalidIndex);
+}
+
+TEST_CASE(EmptyRingRestartsAtTheFront) {
+    DescriptorRing ring(0, 8);
+    CHECK(ring.Allocate(5) == 0);
+    ring.EndFrame(1);
+    ring.Reclaim(1);
+
+    // Without the restart, six would have to skip the three at the end.
+    CHECK(ring.Allocate(6) == 0);
+    CHECK(ring.GetUsedCount() == 6);
+}
@@ -0,0 +1,65 @@
+#include "TestMain.h"
+#include <DirtyRangeTracker.h>
+
+namespace {
+    Vector<DirtyRangeTracker::Range> FlushRanges(DirtyRangeTracker& tracker, uint32 elementCount) {
+        Vector<DirtyRangeTracker::Range> ranges;
+        tracker.Flush(elementCount, [&](uint32 first, uint32 count) { ranges.push_back({ first, first + count }); });
+        return ranges;
+    }
+}
+
+TEST_CASE(SequentialMarksExtendOneRange) {
+    DirtyRangeTracker tracker;
+    for (uint32 i = 10; i < 20; ++i) tracker.MarkDirty(i);
+
+    auto ranges = FlushRanges(tracker, 100);
+    CHECK(ranges.size() == 1);
+    CHECK(ranges[0].begin == 10 && ranges[0].end == 20);
+    CHECK(!tracker.IsDirty());
+}
+
+TEST_CASE(NearbyRangesMergeAcrossSmallGaps) {
+    DirtyRangeTracker tracker(4);
+    tracker.MarkDirty(0);
+    tracker.MarkDirty(5);      // Gap of 4 clean elements, merged
+    tracker.MarkDirty(20);     // Too far, separate copy
+
+    auto ranges = FlushRanges(tracker, 100);
+    CHECK(ranges.size() == 2);
+    CHECK(ranges[0].begin == 0 && ranges[0].end == 6);
+    CHECK(ranges[1].begin == 20 && ranges[1].end == 21);
+}
+
+TEST_CASE(UnorderedMarksAreSortedAndCoalesced) {
+    DirtyRangeTracker tracker(0);
+    tracker.MarkDirty(50);
+    tracker.MarkDirty(10);
+    tracker.MarkDirty(30, 40);
+    tracker.MarkDirty(11);
+    tracker.MarkDirty(35, 52);
+
+    auto ranges = FlushRanges(tracker, 100);
+    CHECK(ranges.size() == 2);
+    CHECK(ranges[0].begin == 10 && ranges[0].end == 12);
+    CHECK(ranges[1].begin == 30 && ranges[1].end == 52);
+}
+
+TEST_CASE(FlushClampsToElementCount) {
+    DirtyRangeTracker tracker;
+    tracker.MarkDirty(5, 15);
+    tracker.MarkDirty(40);
+
+    uint32 flushed = tracker.Flush(10, [](uint32, uint32) {});
+    CHECK(flushed == 5);
+}
+
+TEST_CASE(MarkAllDirtyReplacesPendingRanges) {
+    DirtyRangeTracker tracker;
+    tracker.MarkDirty(3);
+    tracker.MarkAllDirty(64);
+
+    auto ranges = FlushRanges(tracker, 64);
+    CHECK(ranges.size() == 1);
+    CHECK(ranges[0].begin == 0 && ranges[0].end == 64);
+}
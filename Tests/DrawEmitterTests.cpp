@@ -0,0 +1,167 @@
+#include "TestMain.h"
+#include <DrawEmitter.h>
+#include <algorithm>
+#include <random>
+
+namespace {
+    using Bucket = RenderQueue::Bucket;
+
+    // What the renderer knows about each draw ID: its state and where its submesh lives
+    // in the shared index buffer. Mesh NotInstanced stands for objects drawing themselves.
+    struct SceneObject {
+        uint32 pipeline;
+        uint32 material;
+        uint32 mesh;
+        Bucket bucket;
+    };
+
+    IDrawCommandSink::IndexRange GetSubmesh(uint32 mesh) {
+        IDrawCommandSink::IndexRange range;
+        range.indexCount = 36 + 6 * mesh;
+        range.startIndex = 1000 * mesh;
+        range.baseVertex = static_cast<int32>(100 * mesh);
+        return range;
+    }
+
+    // Captures the calls like a command list would record them.
+    class RecordingSink : public IDrawCommandSink {
+    public:
+        struct Draw {
+            uint32 drawId;
+            uint32 instanceOffset;
+            uint32 indexCount;
+            uint32 instanceCount;
+            uint32 startIndex;
+            int32 baseVertex;
+            uint32 startInstance;
+        };
+
+        explicit RecordingSink(const Vector<SceneObject>& objects) : m_objects(objects) {}
+
+        bool BindDraw(uint32 drawId, uint32 instanceOffset, IndexRange& range) override {
+            if (m_objects[drawId].mesh == InstanceBatcher::NotInstanced) return false;
+
+            m_boundDrawId = drawId;
+            m_boundOffset = instanceOffset;
+            range = GetSubmesh(m_objects[drawId].mesh);
+            return true;
+        }
+
+        void DrawIndexedInstanced(uint32 indexCountPerInstance, uint32 instanceCount, uint32 startIndexLocation,
+                                  int32 baseVertexLocation, uint32 startInstanceLocation) override {
+            draws.push_back({ m_boundDrawId, m_boundOffset, indexCountPerInstance, instanceCount, startIndexLocation,
+                              baseVertexLocation, startInstanceLocation });
+        }
+
+        void RenderObject(uint32 drawId) override { renderedObjects.push_back(drawId); }
+
+        Vector<Draw> draws;
+        Vector<uint32> renderedObjects;
+
+    private:
+        const Vector<SceneObject>& m_objects;
+        uint32 m_boundDrawId = UINT32_MAX;
+        uint32 m_boundOffset = UINT32_MAX;
+    };
+
+    void Queue(RenderQueue& queue, const Vector<SceneObject>& objects, const Vector<float>& depths) {
+        queue.Clear();
+        for (uint32 id = 0; id < objects.size(); ++id) {
+            const SceneObject& object = objects[id];
+            queue.Push(RenderQueue::MakeKey(0, object.bucket, object.pipeline, object.material, object.mesh, depths[id]), id);
+        }
+        queue.Sort();
+    }
+
+    bool SameState(const SceneObject& a, const SceneObject& b) {
+        return a.pipeline == b.pipeline && a.material == b.material && a.mesh == b.mesh && a.bucket == b.bucket;
+    }
+}
+
+TEST_CASE(EachRunBecomesOneIndexedDraw) {
+    // Three boxes and two spheres with one material, a sphere with another one, and an
+    // object that records itself.
+    Vector<SceneObject> objects = {
+        { 1, 0, 1, Bucket::Opaque }, { 1, 0, 2, Bucket::Opaque }, { 1, 0, 1, Bucket::Opaque },
+        { 1, 0, 2, Bucket::Opaque }, { 1, 5, 2, Bucket::Opaque }, { 1, 0, 1, Bucket::Opaque },
+        { 2, 0, InstanceBatcher::NotInstanced, Bucket::Opaque },
+    };
+    Vector<float> depths = { 0.3f, 0.2f, 0.1f, 0.6f, 0.4f, 0.5f, 0.1f };
+    RenderQueue queue;
+    Queue(queue, objects, depths);
+
+    InstanceBatcher batcher;
+    batcher.Build(queue);
+    RecordingSink sink(objects);
+    DrawEmitter::Stats stats = DrawEmitter::Emit(batcher, sink);
+
+    CHECK(stats.instancedDraws == 3 && stats.objectDraws == 1 && stats.instances == 6);
+    CHECK(sink.draws.size() == 3);
+    CHECK(sink.renderedObjects == Vector<uint32>({ 6 }));
+
+    // Boxes front to back, then the two spheres sharing material 0, then the other one.
+    const Vector<uint32>& list = batcher.GetInstanceList();
+    const RecordingSink::Draw& boxes = sink.draws[0];
+    CHECK(boxes.drawId == 2 && boxes.instanceCount == 3 && boxes.instanceOffset == 0);
+    CHECK(list[0] == 2 && list[1] == 0 && list[2] == 5);
+    CHECK(boxes.indexCount == 42 && boxes.startIndex == 1000 && boxes.baseVertex == 100);
+
+    const RecordingSink::Draw& spheres = sink.draws[1];
+    CHECK(spheres.drawId == 1 && spheres.instanceCount == 2 && spheres.instanceOffset == 3);
+    CHECK(list[3] == 1 && list[4] == 3);
+    CHECK(spheres.indexCount == 48 && spheres.startIndex == 2000 && spheres.baseVertex == 200);
+
+    CHECK(sink.draws[2].drawId == 4 && sink.draws[2].instanceCount == 1 && sink.draws[2].instanceOffset == 5);
+
+    // The instance ID starts at 0; the offset goes through the draw constants.
+    for (const RecordingSink::Draw& draw : sink.draws) CHECK(draw.startInstance == 0);
+}
+
+TEST_CASE(RandomScenesDrawEveryObjectOnceWithItsState) {
+    std::mt19937 rng(7);
+    for (uint32 scene = 0; scene < 20; ++scene) {
+        std::uniform_int_distribution<uint32> pipeline(1, 3), material(0, 5), mesh(0, 12), bucket(0, 4);
+        std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+        Vector<SceneObject> objects(500 + scene * 37);
+        Vector<float> depths(objects.size());
+        for (uint32 id = 0; id < objects.size(); ++id) {
+            objects[id] = { pipeline(rng), material(rng), mesh(rng), bucket(rng) == 0 ? Bucket::Transparent : Bucket::Opaque };
+            depths[id] = depth(rng);
+        }
+        RenderQueue queue;
+        Queue(queue, objects, depths);
+        InstanceBatcher batcher;
+        batcher.Build(queue);
+        RecordingSink sink(objects);
+        DrawEmitter::Stats stats = DrawEmitter::Emit(batcher, sink);
+        CHECK(stats.instancedDraws + stats.objectDraws == batcher.GetDrawCount());
+
+        Vector<uint32> drawn = sink.renderedObjects;
+        const Vector<uint32>& list = batcher.GetInstanceList();
+        for (const RecordingSink::Draw& draw : sink.draws) {
+            IDrawCommandSink::IndexRange range = GetSubmesh(objects[draw.drawId].mesh);
+            CHECK(draw.indexCount == range.indexCount && draw.startIndex == range.startIndex);
+            CHECK(draw.instanceOffset + draw.instanceCount <= list.size());
+            CHECK(list[draw.instanceOffset] == draw.drawId);
+            for (uint32 i = 0; i < draw.instanceCount; ++i) {
+                uint32 id = list[draw.instanceOffset + i];
+                CHECK(SameState(objects[id], objects[draw.drawId]));
+                drawn.push_back(id);
+            }
+        }
+        std::sort(drawn.begin(), drawn.end());
+        CHECK(drawn.size() == objects.size());
+        for (uint32 id = 0; id < drawn.size(); ++id) CHECK(drawn[id] == id);
+    }
+}
+
+TEST_CASE(EmptyBatcherEmitsNothing) {
+    Vector<SceneObject> objects;
+    RenderQueue queue;
+    InstanceBatcher batcher;
+    batcher.Build(queue);
+    RecordingSink sink(objects);
+    DrawEmitter::Stats stats = DrawEmitter::Emit(batcher, sink);
+    CHECK(stats.instancedDraws == 0 && stats.objectDraws == 0 && stats.instances == 0);
+    CHECK(sink.draws.empty() && sink.renderedObjects.empty());
+}
@@ -0,0 +1,186 @@
+#include "TestMain.h"
+#include <TransformSystem.h>
+#include <cmath>
+#include <thread>
+
+namespace {
+    struct Velocity {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+    };
+
+    struct alignas(16) Bounds {
+        float center[4];
+        float extents[4];
+    };
+
+    struct Byte {
+        uint8 value = 0;
+    };
+}
+
+TEST_CASE(CreateGetAndDestroy) {
+    EntityWorld world;
+    Handle a = world.CreateEntity(Position{ 1, 2, 3 });
+    Handle b = world.CreateEntity(Position{ 4, 5, 6 }, Velocity{ 1, 0, 0 });
+    CHECK(world.IsAlive(a) && world.IsAlive(b));
+    CHECK(world.GetEntityCount() == 2);
+    CHECK(world.GetArchetypeCount() == 2);
+    CHECK(world.Get<Position>(b)->y == 5);
+    CHECK(world.Get<Velocity>(a) == nullptr);
+
+    world.DestroyEntity(a);
+    CHECK(!world.IsAlive(a));
+    CHECK(world.Get<Position>(a) == nullptr);
+
+    // The ID is reused with a new generation, so the old handle stays dead.
+    Handle c = world.CreateEntity(Position{ 7, 8, 9 });
+    CHECK(c.index == a.index && c.generation != a.generation);
+    CHECK(!world.IsAlive(a));
+    CHECK(world.Get<Position>(c)->x == 7);
+}
+
+TEST_CASE(DestroyMovesTheLastRowIntoTheHole) {
+    EntityWorld world;
+    Vector<Handle> entities;
+    for (uint32 i = 0; i < 1000; ++i) {
+        entities.push_back(world.CreateEntity(Position{ static_cast<float>(i), 0, 0 }));
+    }
+    for (uint32 i = 0; i < 1000; i += 3) world.DestroyEntity(entities[i]);
+
+    for (uint32 i = 0; i < 1000; ++i) {
+        if (i % 3 == 0) CHECK(!world.IsAlive(entities[i]));
+        else CHECK(world.Get<Position>(entities[i])->x == static_cast<float>(i));
+    }
+    CHECK(world.Count<Position>() == 666);
+}
+
+TEST_CASE(AddAndRemoveChangeTheArchetype) {
+    EntityWorld world;
+    Handle entity = world.CreateEntity(Position{ 1, 2, 3 });
+    world.Add(entity, Velocity{ 4, 5, 6 });
+    CHECK(world.Has<Velocity>(entity));
+    CHECK(world.Get<Position>(entity)->z == 3);
+    CHECK(world.Get<Velocity>(entity)->x == 4);
+
+    world.Remove<Position>(entity);
+    CHECK(!world.Has<Position>(entity));
+    CHECK(world.Get<Velocity>(entity)->z == 6);
+    CHECK(world.Count<Velocity>() == 1);
+    CHECK(world.Count<Position>() == 0);
+}
+
+TEST_CASE(QueriesVisitEveryMatchingArchetype) {
+    EntityWorld world;
+    for (uint32 i = 0; i < 10; ++i) world.CreateEntity(Position{}, Velocity{ 1, 0, 0 });
+    for (uint32 i = 0; i < 5; ++i) world.CreateEntity(Position{}, Velocity{ 1, 0, 0 }, Scale{});
+    for (uint32 i = 0; i < 7; ++i) world.CreateEntity(Position{});
+
+    world.ForEach<Position, Velocity>([](Handle, Position& position, Velocity& velocity) { position.x += velocity.x; });
+
+    float sum = 0.0f;
+    world.ForEach<Position>([&sum](Handle, Position& position) { sum += position.x; });
+    CHECK(sum == 15.0f);
+}
+
+TEST_CASE(ChunksStayWithinTheirSize) {
+    EntityWorld world;
+    // Mixed sizes and alignments, so every column needs padding.
+    for (uint32 i = 0; i < 5000; ++i) world.CreateEntity(Byte{}, Bounds{}, Position{}, WorldMatrix{});
+
+    uint32 checked = 0;
+    world.ForEachChunk<Byte, Bounds, Position, WorldMatrix>(
+        [&checked](uint32 count, const Handle* entities, Byte* bytes, Bounds* bounds, Position* positions, WorldMatrix* matrices) {
+            const uint8* end = reinterpret_cast<const uint8*>(entities) + Archetype::ChunkBytes;
+            CHECK(reinterpret_cast<const uint8*>(bytes + count) <= end);
+            CHECK(reinterpret_cast<const uint8*>(bounds + count) <= end);
+            CHECK(reinterpret_cast<const uint8*>(positions + count) <= end);
+            CHECK(reinterpret_cast<const uint8*>(matrices + count) <= end);
+            CHECK(reinterpret_cast<uintptr_t>(bounds) % alignof(Bounds) == 0);
+            ++checked;
+        });
+    CHECK(checked > 1);
+}
+
+TEST_CASE(TransformSystemRebuildsOnlyDirtyMatrices) {
+    EntityWorld world;
+    Handle moved = world.CreateEntity(Position{ 1, 2, 3 }, Rotation{}, Scale{ 2, 2, 2 }, WorldMatrix{}, EntityFlags{});
+    world.CreateEntity(Position{}, Rotation{}, Scale{}, WorldMatrix{}, EntityFlags{});
+    CHECK(TransformSystem::Update(world) == 2);
+    CHECK(TransformSystem::Update(world) == 0);
+
+    const WorldMatrix& matrix = *world.Get<WorldMatrix>(moved);
+    CHECK(matrix.m[0] == 2 && matrix.m[5] == 2 && matrix.m[10] == 2);
+    CHECK(matrix.m[12] == 1 && matrix.m[13] == 2 && matrix.m[14] == 3);
+
+    // Both entities report their new matrix once.
+    CHECK(TransformSystem::ForEachChanged<Position>(world, [](const WorldMatrix&, Position&) {}) == 2);
+    CHECK(TransformSystem::ForEachChanged<Position>(world, [](const WorldMatrix&, Position&) {}) == 0);
+
+    world.Get<Position>(moved)->x = 10;
+    TransformSystem::MarkDirty(world, moved);
+    CHECK(TransformSystem::Update(world) == 1);
+
+    float x = 0.0f;
+    CHECK(TransformSystem::ForEachChanged<Position>(world, [&x](const WorldMatrix& world, Position&) { x = world.m[12]; }) == 1);
+    CHECK(x == 10);
+}
+
+TEST_CASE(OnlyChunksWithDirtyRowsAreVisited) {
+    EntityWorld world;
+    Vector<Handle> entities;
+    for (uint32 i = 0; i < 1000; ++i) {
+        entities.push_back(world.CreateEntity(Position{ float(i), 0, 0 }, Rotation{}, Scale{}, WorldMatrix{}, EntityFlags{}));
+    }
+    CHECK(TransformSystem::Update(world) == 1000);
+    CHECK(TransformSystem::ForEachChanged(world, [](const WorldMatrix&) {}) == 1000);
+
+    uint32 visited = 0;
+    world.ForEachDirtyChunk<EntityFlags>([&visited](uint32, const Handle*, uint64*, EntityFlags*) { ++visited; });
+    CHECK(visited == 0);
+
+    TransformSystem::MarkDirty(world, entities[500]);
+    world.ForEachDirtyChunk<EntityFlags>([&visited](uint32, const Handle*, uint64*, EntityFlags*) { ++visited; });
+    CHECK(visited == 1);
+
+    // The last entity moves into the destroyed one's row and keeps its pending change.
+    world.Get<Position>(entities[999])->x = -1;
+    TransformSystem::MarkDirty(world, entities[999]);
+    world.DestroyEntity(entities[0]);
+    CHECK(TransformSystem::Update(world) == 2);
+    CHECK(world.Get<WorldMatrix>(entities[999])->m[12] == -1);
+    CHECK(world.Get<WorldMatrix>(entities[500])->m[12] == 500);
+    CHECK(TransformSystem::ForEachChanged(world, [](const WorldMatrix&) {}) == 2);
+}
+
+TEST_CASE(ComposeMatchesAQuarterTurn) {
+    // 90 degrees around Y: +X maps to -Z for row vectors, as with XMMatrixRotationY.
+    const float half = 0.70710678f;
+    WorldMatrix matrix;
+    TransformSystem::Compose(Position{}, Rotation{ 0, half, 0, half }, Scale{}, matrix);
+    CHECK(std::abs(matrix.m[0]) < 1e-6f);
+    CHECK(std::abs(matrix.m[2] + 1.0f) < 1e-6f);
+    CHECK(std::abs(matrix.m[8] - 1.0f) < 1e-6f);
+}
+
+TEST_CASE(ComponentIdsAreUniqueAcrossThreads) {
+    struct A { int v; };
+    struct B { int v; };
+    struct C { int v; };
+    struct D { int v; };
+
+    ComponentId ids[4] = {};
+    std::thread threads[4] = {
+        std::thread([&ids] { ids[0] = ComponentRegistry::Id<A>(); }),
+        std::thread([&ids] { ids[1] = ComponentRegistry::Id<B>(); }),
+        std::thread([&ids] { ids[2] = ComponentRegistry::Id<C>(); }),
+        std::thread([&ids] { ids[3] = ComponentRegistry::Id<D>(); }),
+    };
+    for (auto& thread : threads) thread.join();
+
+    for (uint32 i = 0; i < 4; ++i) {
+        for (uint32 j = i + 1; j < 4; ++j) CHECK(ids[i] != ids[j]);
+    }
+    CHECK(ComponentRegistry::GetInfo(ids[2]).size == sizeof(int));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <GpuFence.h>
+#include <algorithm>
+
+// IGpuFence without a device. Signalled values queue up as if the GPU were still working
+// on them; the test completes them with Complete, or a wait completes them itself.
+//
+// Like D3D12GpuFence it owns one wait event: a wait on a value that already passed
+// returns straight away, every other wait arms the same event once and blocks on it.
+// onBlock runs while "blocked", so a test can advance its clock by the time spent there.
+class FakeGpuFence : public IGpuFence {
+public:
+    explicit FakeGpuFence(uint64 completedValue = 0)
+        : m_signaled(completedValue), m_completed(completedValue) {
+    }
+
+    void Signal(uint64 value) override {
+        m_signaled = std::max(m_signaled, value);
+        ++m_signalCount;
+    }
+
+    uint64 GetCompletedValue() const override {
+        ++m_queryCount;
+        return m_completed;
+    }
+
+    void WaitForValue(uint64 value) override {
+        ++m_waitCount;
+        if (m_completed >= value) return;
+
+        ++m_eventArmCount;
+        if (onBlock) onBlock(value);
+        Complete(value);
+    }
+
+    // Lets the simulated GPU finish everything up to value that was signalled.
+    void Complete(uint64 value) { m_completed = std::max(m_completed, std::min(value, m_signaled)); }
+    void CompleteAll() { m_completed = m_signaled; }
+
+    uint64 GetSignaledValue() const { return m_signaled; }
+    uint32 GetSignalCount() const { return m_signalCount; }
+    uint32 GetQueryCount() const { return m_queryCount; }
+    uint32 GetWaitCount() const { return m_waitCount; }
+    uint32 GetEventArmCount() const { return m_eventArmCount; }
+
+    Function<void(uint64)> onBlock;
+
+private:
+    uint64 m_signaled = 0;
+    uint64 m_completed = 0;
+    uint32 m_signalCount = 0;
+    mutable uint32 m_queryCount = 0;
+    uint32 m_waitCount = 0;
+    uint32 m_eventArmCount = 0;
+};
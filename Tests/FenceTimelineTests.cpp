@@ -0,0 +1,146 @@
+#include "TestMain.h"
+#include "FakeGpuFence.h"
+#include <FenceTimeline.h>
+
+namespace {
+    // Appends its id to log when destroyed, unless it was moved from.
+    struct Tracked {
+        Tracked(Vector<int>* log, int id) : log(log), id(id) {}
+        Tracked(Tracked&& other) noexcept : log(other.log), id(other.id) { other.log = nullptr; }
+        ~Tracked() {
+            if (log) log->push_back(id);
+        }
+
+        Vector<int>* log;
+        int id;
+    };
+}
+
+TEST_CASE(QueueReleasesInFenceOrder) {
+    Vector<int> released;
+    DeferredReleaseQueue queue;
+    queue.Push(Tracked(&released, 1), 5);
+    queue.Push(Tracked(&released, 2), 3);      // Out of order, goes in front
+    queue.Push(Tracked(&released, 3), 5);
+    queue.Push(Tracked(&released, 4), 8);
+    CHECK(released.empty());
+    CHECK(queue.GetPendingCount() == 4);
+
+    CHECK(queue.Collect(2) == 0);
+    CHECK(queue.Collect(3) == 1);
+    CHECK(released == Vector<int>({ 2 }));
+
+    // Objects released at the same value go in the order they were pushed.
+    CHECK(queue.Collect(7) == 2);
+    CHECK(released == Vector<int>({ 2, 1, 3 }));
+
+    queue.Clear();
+    CHECK(released == Vector<int>({ 2, 1, 3, 4 }));
+    CHECK(queue.IsEmpty());
+}
+
+TEST_CASE(SignalContinuesFromTheCompletedValue) {
+    FakeGpuFence fence(41);
+    FenceTimeline timeline(&fence);
+    CHECK(timeline.GetLastSignaledValue() == 41);
+    CHECK(timeline.Signal() == 42);
+    CHECK(timeline.Signal() == 43);
+    CHECK(fence.GetSignaledValue() == 43);
+    CHECK(fence.GetSignalCount() == 2);
+    fence.CompleteAll();
+}
+
+TEST_CASE(DeferredObjectsReleaseAtTheirCompletedValue) {
+    Vector<int> released;
+    FakeGpuFence fence;
+    FenceTimeline timeline(&fence);
+
+    // Released while frame 1 is recorded, so frame 1 may still use it.
+    timeline.DeferRelease(Tracked(&released, 1));
+    uint64 frame1 = timeline.Signal();
+    timeline.DeferRelease(Tracked(&released, 2));
+    timeline.DeferRelease(Tracked(&released, 3), frame1);
+    uint64 frame2 = timeline.Signal();
+    CHECK(timeline.GetPendingReleaseCount() == 3);
+
+    CHECK(timeline.CollectGarbage() == 0);
+    fence.Complete(frame1);
+    CHECK(timeline.CollectGarbage() == 2);
+    CHECK(released == Vector<int>({ 1, 3 }));
+
+    fence.Complete(frame2);
+    CHECK(timeline.CollectGarbage() == 1);
+    CHECK(released == Vector<int>({ 1, 3, 2 }));
+    CHECK(timeline.GetPendingReleaseCount() == 0);
+}
+
+TEST_CASE(CompletedValuesAnswerFromTheCache) {
+    FakeGpuFence fence;
+    FenceTimeline timeline(&fence);
+    uint64 first = timeline.Signal();
+    uint64 second = timeline.Signal();
+    fence.Complete(second);
+
+    CHECK(timeline.GetCompletedValue() == second);
+    uint32 queries = fence.GetQueryCount();
+    CHECK(timeline.IsComplete(first));
+    CHECK(timeline.IsComplete(second));
+    CHECK(fence.GetQueryCount() == queries);
+
+    uint64 third = timeline.Signal();
+    CHECK(!timeline.IsComplete(third));
+    CHECK(fence.GetQueryCount() == queries + 1);
+    fence.CompleteAll();
+}
+
+TEST_CASE(WaitsReuseTheFenceEvent) {
+    FakeGpuFence fence;
+    FenceTimeline timeline(&fence);
+    Vector<uint64> blockedOn;
+    fence.onBlock = [&blockedOn](uint64 value) { blockedOn.push_back(value); };
+
+    uint64 first = timeline.Signal();
+    uint64 second = timeline.Signal();
+    uint64 third = timeline.Signal();
+
+    // Values that already passed never reach the fence's event.
+    fence.Complete(first);
+    timeline.WaitFor(first);
+    CHECK(fence.GetWaitCount() == 0);
+
+    timeline.WaitFor(second);
+    timeline.WaitFor(second);
+    timeline.WaitFor(third);
+    CHECK(fence.GetWaitCount() == 2);
+    CHECK(fence.GetEventArmCount() == 2);
+    CHECK(blockedOn == Vector<uint64>({ second, third }));
+    CHECK(timeline.IsComplete(third));
+}
+
+TEST_CASE(WaitForIdleDrainsTheQueue) {
+    Vector<int> released;
+    FakeGpuFence fence;
+    FenceTimeline timeline(&fence);
+    timeline.Signal();
+    timeline.DeferRelease(Tracked(&released, 1));
+
+    timeline.WaitForIdle();
+    CHECK(timeline.GetLastSignaledValue() == 2);
+    CHECK(timeline.GetCompletedValue() == 2);
+    CHECK(released == Vector<int>({ 1 }));
+}
+
+TEST_CASE(DestructionWaitsForTheLastSignal) {
+    Vector<int> released;
+    FakeGpuFence fence;
+    {
+        FenceTimeline timeline(&fence);
+        timeline.DeferRelease(Tracked(&released, 1));
+        timeline.Signal();
+        timeline.Signal();
+        CHECK(released.empty());
+    }
+    CHECK(fence.GetEventArmCount() == 1);
+    CHECK(fence.GetCompletedValue() == 2);
+    CHECK(released == Vector<int>({ 1 }));
+}
@@ -0,0 +1,151 @@
+#include "TestMain.h"
+#include "FakeGpuFence.h"
+#include <FramePacer.h>
+#include <cmath>
+
+namespace {
+    bool Near(float64 a, float64 b) {
+        return std::abs(a - b) < 1e-9;
+    }
+
+    // Records one frame the way the renderer does: pick the slot, do cpuMs of work,
+    // signal after the frame's commands and hand the value to the pacer.
+    uint32 RunFrame(FramePacer& pacer, FakeGpuFence& fence, uint64& lastSignaled, float64& now, float64 cpuMs) {
+        uint32 slot = pacer.BeginFrame();
+        now += cpuMs;
+        fence.Signal(++lastSignaled);
+        pacer.EndFrame(lastSignaled);
+        return slot;
+    }
+}
+
+TEST_CASE(StatsRingKeepsTheNewestFrames) {
+    FrameLatencyStats stats(4);
+    for (uint64 frame = 1; frame <= 6; ++frame) {
+        stats.BeginFrame(frame, 2, 10.0 * frame);
+        stats.RecordSubmit(frame, 10.0 * frame + 1.0);
+    }
+    CHECK(stats.GetCapacity() == 4);
+    CHECK(stats.GetCount() == 4);
+    for (uint32 age = 0; age < 4; ++age) {
+        CHECK(stats.GetFrame(age).frameNumber == 6 - age);
+    }
+    CHECK(stats.GetFrame(0).cpuFrameMs < 0.0);
+    CHECK(Near(stats.GetFrame(1).cpuFrameMs, 10.0));
+
+    // Resolving across the wrap reaches every frame still in the ring.
+    stats.RecordFenceCompleted(6, 70.0);
+    CHECK(Near(stats.GetFrame(0).gpuLatencyMs, 9.0));
+    CHECK(Near(stats.GetFrame(3).gpuLatencyMs, 39.0));
+
+    // The walk stops at the newest resolved frame, so later polls leave older ones alone.
+    stats.BeginFrame(7, 2, 80.0);
+    stats.RecordSubmit(7, 81.0);
+    stats.RecordFenceCompleted(7, 90.0);
+    CHECK(Near(stats.GetFrame(0).gpuLatencyMs, 9.0));
+    CHECK(Near(stats.GetFrame(1).gpuLatencyMs, 9.0));
+    CHECK(Near(stats.GetFrame(1).cpuFrameMs, 20.0));
+
+    FrameLatencyStats::Summary summary = stats.Summarize(100);
+    CHECK(summary.sampleCount == 4);
+    CHECK(Near(summary.avgCpuFrameMs, 40.0 / 3.0));    // Frame 7 is still running
+    CHECK(Near(summary.maxCpuFrameMs, 20.0));
+    CHECK(Near(summary.maxGpuLatencyMs, 29.0));
+
+    stats.Clear();
+    CHECK(stats.GetCount() == 0);
+    CHECK(stats.Summarize(4).sampleCount == 0);
+}
+
+TEST_CASE(StatsNeedAtLeastOneSlot) {
+    FrameLatencyStats stats(0);
+    CHECK(stats.GetCapacity() == 1);
+    stats.BeginFrame(1, 1, 0.0);
+    stats.BeginFrame(2, 1, 5.0);
+    CHECK(stats.GetCount() == 1);
+    CHECK(stats.GetFrame(0).frameNumber == 2);
+}
+
+TEST_CASE(PacerMeasuresWaitsAndLatencies) {
+    FakeGpuFence fence;
+    float64 now = 0.0;
+    uint64 lastSignaled = 0;
+    FramePacer pacer(&fence, 2, [&now]() { return now; });
+
+    // The simulated GPU needs 5 ms past the point the CPU starts waiting.
+    fence.onBlock = [&now](uint64) { now += 5.0; };
+
+    CHECK(RunFrame(pacer, fence, lastSignaled, now, 10.0) == 0);     // 0 to 10
+    CHECK(RunFrame(pacer, fence, lastSignaled, now, 10.0) == 1);     // 10 to 20
+    CHECK(fence.GetWaitCount() == 0);
+
+    // Slot 0 still belongs to frame 1, so frame 3 waits for it first.
+    CHECK(RunFrame(pacer, fence, lastSignaled, now, 10.0) == 0);     // 20, waits until 25, submits at 35
+    CHECK(fence.GetEventArmCount() == 1);
+    CHECK(pacer.GetFrameNumber() == 3);
+
+    const FrameLatencyStats& stats = pacer.GetStats();
+    const FrameTiming& frame3 = stats.GetFrame(0);
+    const FrameTiming& frame2 = stats.GetFrame(1);
+    const FrameTiming& frame1 = stats.GetFrame(2);
+    CHECK(frame3.fenceValue == 3 && frame3.framesInFlight == 2);
+    CHECK(Near(frame3.fenceWaitMs, 5.0));
+    CHECK(Near(frame3.submitMs, 35.0));
+    CHECK(Near(frame1.fenceWaitMs, 0.0));
+    CHECK(Near(frame1.cpuFrameMs, 10.0));
+    CHECK(Near(frame2.cpuFrameMs, 10.0));
+
+    // Frame 1 was seen complete right after the wait, 15 ms after its submit.
+    CHECK(Near(frame1.gpuLatencyMs, 15.0));
+    CHECK(frame2.gpuLatencyMs < 0.0);
+
+    now = 40.0;
+    fence.Complete(3);
+    pacer.PollCompletion();
+    CHECK(Near(frame2.gpuLatencyMs, 20.0));
+    CHECK(Near(frame3.gpuLatencyMs, 5.0));
+
+    // Slot 1 was released without a wait.
+    CHECK(RunFrame(pacer, fence, lastSignaled, now, 10.0) == 1);
+    CHECK(Near(stats.GetFrame(0).fenceWaitMs, 0.0));
+    CHECK(fence.GetEventArmCount() == 1);
+
+    FrameLatencyStats::Summary summary = stats.Summarize(4);
+    CHECK(summary.sampleCount == 4);
+    CHECK(Near(summary.maxFenceWaitMs, 5.0));
+    CHECK(Near(summary.avgFenceWaitMs, 1.25));
+    CHECK(Near(summary.avgGpuLatencyMs, 40.0 / 3.0));
+}
+
+TEST_CASE(ChangingFramesInFlightRestartsAtSlotZero) {
+    FakeGpuFence fence;
+    float64 now = 0.0;
+    uint64 lastSignaled = 0;
+    FramePacer pacer(&fence, 3, [&now]() { return now; });
+
+    RunFrame(pacer, fence, lastSignaled, now, 1.0);
+    RunFrame(pacer, fence, lastSignaled, now, 1.0);
+    CHECK(pacer.GetFrameIndex() == 1);
+
+    // Nothing is drained: the new slots start free even though frames 1 and 2 are running.
+    pacer.SetFramesInFlight(9);
+    CHECK(pacer.GetFramesInFlight() == FramePacer::MaxFramesInFlight);
+    CHECK(RunFrame(pacer, fence, lastSignaled, now, 1.0) == 0);
+    CHECK(fence.GetWaitCount() == 0);
+    CHECK(pacer.GetFrameNumber() == 3);
+
+    pacer.SetFramesInFlight(0);
+    CHECK(pacer.GetFramesInFlight() == FramePacer::MinFramesInFlight);
+    CHECK(RunFrame(pacer, fence, lastSignaled, now, 1.0) == 0);
+
+    // One frame in flight: the next frame waits for the one before.
+    CHECK(RunFrame(pacer, fence, lastSignaled, now, 1.0) == 0);
+    CHECK(fence.GetEventArmCount() == 1);
+
+    // Frames from before the change still get their latency.
+    fence.CompleteAll();
+    pacer.PollCompletion();
+    for (uint32 age = 0; age < pacer.GetStats().GetCount(); ++age) {
+        CHECK(pacer.GetStats().GetFrame(age).gpuLatencyMs >= 0.0);
+    }
+}
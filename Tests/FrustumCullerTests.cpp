@@ -0,0 +1,124 @@
+#include "TestMain.h"
+#include <FrustumCuller.h>
+#include <WorkerPool.h>
+#include <cmath>
+#include <random>
+
+namespace {
+    // Camera at the origin looking down +z, 90 degree field of view, depth 1 to 1000.
+    const float ViewProj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1, 0, 0, -1000.0f / 999.0f, 0 };
+
+    // Smallest signed margin of the box over the planes; boxes within rounding of zero
+    // may legitimately go either way depending on the path.
+    float Margin(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32 i) {
+        float margin = 1e30f;
+        for (uint32 p = 0; p < 6; ++p) {
+            float distance = frustum.normalX[p] * bounds.GetCenterX()[i] + frustum.normalY[p] * bounds.GetCenterY()[i] +
+                             frustum.normalZ[p] * bounds.GetCenterZ()[i] + frustum.d[p];
+            float radius = std::fabs(frustum.normalX[p]) * bounds.GetExtentX()[i] +
+                           std::fabs(frustum.normalY[p]) * bounds.GetExtentY()[i] +
+                           std::fabs(frustum.normalZ[p]) * bounds.GetExtentZ()[i];
+            margin = std::min(margin, distance + radius);
+        }
+        return margin;
+    }
+
+    CullingBounds RandomBounds(uint32 count, uint32 seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(-600.0f, 600.0f);
+        std::uniform_real_distribution<float> size(0.1f, 20.0f);
+        CullingBounds bounds;
+        bounds.Resize(count);
+        for (uint32 i = 0; i < count; ++i) {
+            const float center[3] = { position(rng), position(rng), position(rng) + 400.0f };
+            const float extents[3] = { size(rng), size(rng), size(rng) };
+            bounds.Set(i, center, extents);
+        }
+        return bounds;
+    }
+
+    // Both lists ascending; any box only one of them holds must sit on a plane.
+    bool Agree(const FrustumPlanes& frustum, const CullingBounds& bounds, const Vector<uint32>& a,
+               const Vector<uint32>& b) {
+        size_t i = 0, j = 0;
+        while (i < a.size() || j < b.size()) {
+            if (i < a.size() && j < b.size() && a[i] == b[j]) {
+                ++i;
+                ++j;
+                continue;
+            }
+            uint32 box = (j == b.size() || (i < a.size() && a[i] < b[j])) ? a[i++] : b[j++];
+            if (std::fabs(Margin(frustum, bounds, box)) > 1e-3f) return false;
+        }
+        return true;
+    }
+
+    Vector<uint32> Cull(const FrustumPlanes& frustum, const CullingBounds& bounds, FrustumCuller::Path path) {
+        Vector<uint32> visible(bounds.GetCount());
+        visible.resize(FrustumCuller::Cull(frustum, bounds, visible.data(), path));
+        return visible;
+    }
+}
+
+TEST_CASE(PlanesMatchTheFrustum) {
+    FrustumPlanes frustum = FrustumCuller::ExtractPlanes(ViewProj);
+    CullingBounds bounds;
+    bounds.Resize(5);
+    const float extents[3] = { 0.5f, 0.5f, 0.5f };
+    const float inFront[3] = { 0, 0, 10 };
+    const float behind[3] = { 0, 0, -10 };
+    const float beyondFar[3] = { 0, 0, 1100 };
+    const float leftOfView[3] = { -20, 0, 10 };
+    bounds.Set(0, inFront, extents);
+    bounds.Set(1, behind, extents);
+    bounds.Set(2, beyondFar, extents);
+    bounds.Set(3, leftOfView, extents);
+    bounds.SetInfinite(4);
+
+    Vector<uint32> visible = Cull(frustum, bounds, FrustumCuller::Path::Scalar);
+    CHECK(visible.size() == 2 && visible[0] == 0 && visible[1] == 4);
+}
+
+TEST_CASE(SimdPathsAgreeWithScalar) {
+    FrustumPlanes frustum = FrustumCuller::ExtractPlanes(ViewProj);
+
+    // Odd counts leave tails for the narrower paths to finish.
+    for (uint32 count : { 1u, 7u, 9u, 1003u, 20000u }) {
+        CullingBounds bounds = RandomBounds(count, count);
+        if (count > 8) {
+            bounds.SetEmpty(3);
+            bounds.SetInfinite(5);
+        }
+
+        Vector<uint32> scalar = Cull(frustum, bounds, FrustumCuller::Path::Scalar);
+        CHECK(Agree(frustum, bounds, scalar, Cull(frustum, bounds, FrustumCuller::Path::SSE)));
+        if (FrustumCuller::GetBestPath() == FrustumCuller::Path::AVX2) {
+            CHECK(Agree(frustum, bounds, scalar, Cull(frustum, bounds, FrustumCuller::Path::AVX2)));
+        }
+    }
+}
+
+TEST_CASE(EmptyAndInfiniteBoxes) {
+    FrustumPlanes frustum = FrustumCuller::ExtractPlanes(ViewProj);
+    CullingBounds bounds;
+    bounds.Resize(16);          // New entries are empty
+    bounds.SetInfinite(2);
+    bounds.SetInfinite(11);
+
+    for (auto path : { FrustumCuller::Path::Scalar, FrustumCuller::Path::SSE, FrustumCuller::GetBestPath() }) {
+        Vector<uint32> visible = Cull(frustum, bounds, path);
+        CHECK(visible.size() == 2 && visible[0] == 2 && visible[1] == 11);
+    }
+}
+
+TEST_CASE(ParallelCullKeepsOrder) {
+    WorkerPool pool(3);
+    FrustumPlanes frustum = FrustumCuller::ExtractPlanes(ViewProj);
+    CullingBounds bounds = RandomBounds(50000, 5);
+
+    Vector<uint32> serial = Cull(frustum, bounds, FrustumCuller::GetBestPath());
+    Vector<uint32> parallel(bounds.GetCount());
+    parallel.resize(FrustumCuller::Cull(frustum, bounds, parallel.data(), &pool));
+    CHECK(parallel == serial);
+    CHECK(!serial.empty() && serial.size() < bounds.GetCount());
+}
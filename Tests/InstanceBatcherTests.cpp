@@ -0,0 +1,84 @@
+#include "TestMain.h"
+#include <InstanceBatcher.h>
+
+namespace {
+    using Bucket = RenderQueue::Bucket;
+
+    // Draws cover the instance list back to back, each starting with its own draw ID.
+    bool CoversInstanceList(const InstanceBatcher& batcher) {
+        uint32 next = 0;
+        for (const InstancedDraw& draw : batcher.GetDraws()) {
+            if (draw.firstInstance != next || draw.instanceCount == 0) return false;
+            if (batcher.GetInstanceList()[draw.firstInstance] != draw.drawId) return false;
+            next += draw.instanceCount;
+        }
+        return next == batcher.GetInstanceCount();
+    }
+}
+
+TEST_CASE(SameStateBecomesOneDraw) {
+    RenderQueue queue;
+    for (uint32 i = 0; i < 5; ++i) queue.Push(RenderQueue::MakeKey(0, Bucket::Opaque, 1, 2, 3, 0.5f - 0.1f * i), 10 + i);
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Opaque, 1, 2, 4, 0.5f), 20);
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Opaque, 1, 7, 3, 0.5f), 21);
+    queue.Sort();
+
+    InstanceBatcher batcher;
+    batcher.Build(queue);
+    CHECK(batcher.GetDrawCount() == 3);
+    CHECK(batcher.GetInstanceCount() == 7);
+    CHECK(CoversInstanceList(batcher));
+
+    // The merged run is front to back: the nearest object is drawn as instance 0.
+    const InstancedDraw& run = batcher.GetDraws()[0];
+    CHECK(run.instanceCount == 5 && run.drawId == 14);
+    const Vector<uint32>& list = batcher.GetInstanceList();
+    CHECK(list[0] == 14 && list[1] == 13 && list[4] == 10);
+}
+
+TEST_CASE(NotInstancedDrawsStayAlone) {
+    RenderQueue queue;
+    for (uint32 i = 0; i < 3; ++i) {
+        queue.Push(RenderQueue::MakeKey(0, Bucket::Opaque, 1, 2, InstanceBatcher::NotInstanced, 0.5f), i);
+    }
+    queue.Sort();
+
+    InstanceBatcher batcher;
+    batcher.Build(queue);
+    CHECK(batcher.GetDrawCount() == 3);
+    CHECK(CoversInstanceList(batcher));
+    for (const InstancedDraw& draw : batcher.GetDraws()) CHECK(draw.instanceCount == 1);
+}
+
+TEST_CASE(TransparentRunsKeepBackToFront) {
+    RenderQueue queue;
+    // Two states alternating by depth can't merge without breaking the blend order.
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Transparent, 1, 2, 3, 0.9f), 0);
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Transparent, 1, 2, 4, 0.8f), 1);
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Transparent, 1, 2, 3, 0.7f), 2);
+    // Neighbours by depth with the same state do merge, whatever their depths.
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Transparent, 1, 2, 3, 0.3f), 3);
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Transparent, 1, 2, 3, 0.1f), 4);
+    queue.Sort();
+
+    InstanceBatcher batcher;
+    batcher.Build(queue);
+    CHECK(CoversInstanceList(batcher));
+    CHECK(batcher.GetDrawCount() == 3);
+    const Vector<uint32>& list = batcher.GetInstanceList();
+    CHECK(list[0] == 0 && list[1] == 1 && list[2] == 2 && list[3] == 3 && list[4] == 4);
+    CHECK(batcher.GetDraws()[2].drawId == 2 && batcher.GetDraws()[2].instanceCount == 3);
+}
+
+TEST_CASE(RebuildReplacesThePreviousFrame) {
+    RenderQueue queue;
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Opaque, 1, 2, 3, 0.5f), 1);
+    queue.Push(RenderQueue::MakeKey(0, Bucket::Opaque, 1, 2, 3, 0.6f), 2);
+    queue.Sort();
+
+    InstanceBatcher batcher;
+    batcher.Build(queue);
+    queue.Clear();
+    batcher.Build(queue);
+    CHECK(batcher.GetDrawCount() == 0 && batcher.GetInstanceCount() == 0);
+}
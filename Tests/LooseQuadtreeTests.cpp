@@ -0,0 +1,214 @@
+#include "TestMain.h"
+#include <LooseQuadtree.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+    // Box i of the reference copy the tests keep next to the tree; empty ones were removed.
+    struct Box {
+        float center[3];
+        float extents[3];
+        bool present;
+    };
+
+    // Camera at (500, 20, -100) looking down +z over the covered area, 90 degree field of
+    // view, depth 1 to 1000.
+    FrustumPlanes MakeFrustum() {
+        const float viewProj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1,
+                                     -500.0f, -20.0f, 100.0f * 1000.0f / 999.0f - 1000.0f / 999.0f, 100.0f };
+        return FrustumCuller::ExtractPlanes(viewProj);
+    }
+
+    bool OverlapsRect(const Box& box, float minX, float minZ, float maxX, float maxZ) {
+        return box.center[0] - box.extents[0] <= maxX && box.center[0] + box.extents[0] >= minX &&
+               box.center[2] - box.extents[2] <= maxZ && box.center[2] + box.extents[2] >= minZ;
+    }
+
+    bool OverlapsCircle(const Box& box, float x, float z, float radius) {
+        float dx = std::max(std::fabs(x - box.center[0]) - box.extents[0], 0.0f);
+        float dz = std::max(std::fabs(z - box.center[2]) - box.extents[2], 0.0f);
+        return dx * dx + dz * dz <= radius * radius;
+    }
+
+    bool InFrustum(const Box& box, const FrustumPlanes& frustum) {
+        for (uint32 p = 0; p < 6; ++p) {
+            float distance = frustum.normalX[p] * box.center[0] + frustum.normalY[p] * box.center[1] +
+                             frustum.normalZ[p] * box.center[2] + frustum.d[p];
+            float radius = std::fabs(frustum.normalX[p]) * box.extents[0] +
+                           std::fabs(frustum.normalY[p]) * box.extents[1] +
+                           std::fabs(frustum.normalZ[p]) * box.extents[2];
+            if (distance + radius < 0.0f) return false;
+        }
+        return true;
+    }
+
+    template<typename Predicate>
+    Vector<uint32> BruteForce(const Vector<Box>& boxes, Predicate&& predicate) {
+        Vector<uint32> ids;
+        for (uint32 i = 0; i < boxes.size(); ++i) {
+            if (boxes[i].present && predicate(boxes[i])) ids.push_back(i);
+        }
+        return ids;
+    }
+
+    Vector<uint32> Sorted(Vector<uint32> ids) {
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    // The covered area is 0..1000 on X and Z; a few boxes lie beyond it.
+    Box RandomBox(std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(-100.0f, 1100.0f);
+        std::uniform_real_distribution<float> height(-20.0f, 60.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_real_distribution<float> size(0.2f, 4.0f);
+
+        Box box = { { position(rng), height(rng), position(rng) }, {}, true };
+        // Mostly small units, some buildings and the odd object spanning a large part.
+        float scale = unit(rng) < 0.05f ? 60.0f : (unit(rng) < 0.2f ? 8.0f : 1.0f);
+        for (float& extent : box.extents) extent = size(rng) * scale;
+        return box;
+    }
+
+    bool QueriesMatchBruteForce(const LooseQuadtree& tree, const Vector<Box>& boxes, std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(-150.0f, 1150.0f);
+        std::uniform_real_distribution<float> span(0.0f, 300.0f);
+        bool match = true;
+        for (uint32 query = 0; query < 50; ++query) {
+            float x = position(rng), z = position(rng), width = span(rng), depth = span(rng);
+            Vector<uint32> rect;
+            tree.QueryRect(x, z, x + width, z + depth, rect);
+            match = match && Sorted(rect) == BruteForce(boxes, [&](const Box& box) {
+                return OverlapsRect(box, x, z, x + width, z + depth);
+            });
+
+            Vector<uint32> circle;
+            tree.QueryRadius(x, z, width, circle);
+            match = match && Sorted(circle) == BruteForce(boxes, [&](const Box& box) {
+                return OverlapsCircle(box, x, z, width);
+            });
+        }
+
+        FrustumPlanes frustum = MakeFrustum();
+        Vector<uint32> visible;
+        tree.QueryFrustum(frustum, visible);
+        return match && Sorted(visible) == BruteForce(boxes, [&](const Box& box) { return InFrustum(box, frustum); });
+    }
+}
+
+TEST_CASE(QueriesMatchBruteForceAsObjectsMove) {
+    std::mt19937 rng(1);
+    LooseQuadtree tree(0.0f, 0.0f, 1000.0f, 6);
+    Vector<Box> boxes;
+    for (uint32 i = 0; i < 3000; ++i) {
+        boxes.push_back(RandomBox(rng));
+        tree.Insert(i, boxes[i].center, boxes[i].extents);
+    }
+    CHECK(tree.GetObjectCount() == 3000);
+    CHECK(QueriesMatchBruteForce(tree, boxes, rng));
+
+    std::uniform_int_distribution<uint32> pick(0, 2999);
+    std::uniform_real_distribution<float> nudge(-0.5f, 0.5f);
+    for (uint32 round = 0; round < 5; ++round) {
+        // Small steps mostly stay within a cell, some boxes jump anywhere, some go away.
+        for (Box& box : boxes) {
+            box.center[0] += nudge(rng);
+            box.center[2] += nudge(rng);
+        }
+        for (uint32 i = 0; i < 200; ++i) boxes[pick(rng)] = RandomBox(rng);
+        for (uint32 i = 0; i < 50; ++i) boxes[pick(rng)].present = false;
+
+        uint32 present = 0;
+        for (uint32 i = 0; i < boxes.size(); ++i) {
+            if (boxes[i].present) {
+                tree.Insert(i, boxes[i].center, boxes[i].extents);
+                ++present;
+            }
+            else {
+                tree.Remove(i);
+            }
+            CHECK(tree.Contains(i) == boxes[i].present);
+        }
+        CHECK(tree.GetObjectCount() == present);
+        CHECK(QueriesMatchBruteForce(tree, boxes, rng));
+    }
+}
+
+TEST_CASE(ObjectsOutsideTheAreaAreStillFound) {
+    LooseQuadtree tree(0.0f, 0.0f, 100.0f, 4);
+    const float outside[3] = { -500.0f, 0.0f, 250.0f };
+    const float inside[3] = { 50.0f, 0.0f, 50.0f };
+    const float small[3] = { 1.0f, 1.0f, 1.0f };
+    tree.Insert(3, outside, small);
+    tree.Insert(8, inside, small);
+
+    Vector<uint32> results;
+    tree.QueryRect(-510.0f, 240.0f, -490.0f, 260.0f, results);
+    CHECK(results == Vector<uint32>({ 3 }));
+
+    results.clear();
+    tree.QueryRadius(-500.0f, 252.0f, 1.5f, results);
+    CHECK(results == Vector<uint32>({ 3 }));
+
+    // Moving into the area and back out again.
+    tree.Insert(3, inside, small);
+    results.clear();
+    tree.QueryRect(49.0f, 49.0f, 51.0f, 51.0f, results);
+    CHECK(Sorted(results) == Vector<uint32>({ 3, 8 }));
+
+    tree.Insert(3, outside, small);
+    results.clear();
+    tree.QueryRect(49.0f, 49.0f, 51.0f, 51.0f, results);
+    CHECK(results == Vector<uint32>({ 8 }));
+    CHECK(tree.GetObjectCount() == 2);
+}
+
+TEST_CASE(MovesWithinACellUpdateTheBounds) {
+    LooseQuadtree tree(0.0f, 0.0f, 128.0f, 4);        // Deepest cells are 8 units wide
+    const float extents[3] = { 0.5f, 0.5f, 0.5f };
+    const float start[3] = { 2.0f, 0.0f, 2.0f };
+    tree.Insert(0, start, extents);
+
+    // Still centered in the same deepest cell, so the object is not relinked, but the
+    // queries must see where it is now.
+    const float moved[3] = { 6.0f, 0.0f, 6.0f };
+    tree.Insert(0, moved, extents);
+    CHECK(tree.GetObjectCount() == 1);
+
+    Vector<uint32> results;
+    tree.QueryRect(1.0f, 1.0f, 3.0f, 3.0f, results);
+    CHECK(results.empty());
+    tree.QueryRect(5.0f, 5.0f, 7.0f, 7.0f, results);
+    CHECK(results == Vector<uint32>({ 0 }));
+
+    results.clear();
+    tree.QueryRadius(8.0f, 6.0f, 1.6f, results);
+    CHECK(results == Vector<uint32>({ 0 }));
+
+    // Queries far away skip the occupied subtree entirely.
+    results.clear();
+    tree.QueryRect(100.0f, 100.0f, 110.0f, 110.0f, results);
+    CHECK(results.empty());
+    CHECK(tree.GetLastQueryStats().objectsTested == 0);
+}
+
+TEST_CASE(RemovedObjectsLeaveTheQueries) {
+    LooseQuadtree tree(0.0f, 0.0f, 100.0f);
+    const float center[3] = { 10.0f, 0.0f, 10.0f };
+    const float extents[3] = { 1.0f, 1.0f, 1.0f };
+    tree.Insert(5, center, extents);
+    tree.Remove(5);
+    tree.Remove(5);
+    tree.Remove(42);
+    CHECK(!tree.Contains(5) && !tree.Contains(42));
+    CHECK(tree.GetObjectCount() == 0);
+
+    Vector<uint32> results;
+    tree.QueryRadius(10.0f, 10.0f, 50.0f, results);
+    CHECK(results.empty());
+
+    tree.Insert(5, center, extents);
+    tree.QueryRadius(10.0f, 10.0f, 50.0f, results);
+    CHECK(results == Vector<uint32>({ 5 }));
+}
@@ -0,0 +1,101 @@
+#include "TestMain.h"
+#include <ObjectDataStore.h>
+#include <cstddef>
+
+// ObjectData is read by texture.hlsl as a StructuredBuffer element:
+//   float4x4 World; uint MaterialIndex; uint Flags; uint ObjPad0; uint ObjPad1;
+// Structured buffers are tightly packed, so every member offset must match exactly.
+static_assert(offsetof(ObjectData, World) == 0, "World must come first");
+static_assert(offsetof(ObjectData, MaterialIndex) == 64, "MaterialIndex follows the matrix");
+static_assert(offsetof(ObjectData, Flags) == 68, "Flags follows MaterialIndex");
+static_assert(offsetof(ObjectData, Pad0) == 72 && offsetof(ObjectData, Pad1) == 76, "Padding ends the element");
+static_assert(sizeof(ObjectData) % 16 == 0, "Stride keeps every matrix 16-byte aligned");
+
+namespace {
+    // Row-major world matrix with a translation, as XMFLOAT4X4 stores it.
+    void Translation(float x, float y, float z, float* m) {
+        const float values[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1 };
+        for (uint32 i = 0; i < 16; ++i) m[i] = values[i];
+    }
+}
+
+TEST_CASE(PackTransposesTheWorldMatrix) {
+    float world[16];
+    for (uint32 i = 0; i < 16; ++i) world[i] = static_cast<float>(i);
+
+    ObjectData data;
+    ObjectDataPacker::Pack(world, 7, ObjectFlagTransparent, data);
+    for (uint32 row = 0; row < 4; ++row) {
+        for (uint32 column = 0; column < 4; ++column) {
+            CHECK(data.World[column * 4 + row] == world[row * 4 + column]);
+        }
+    }
+
+    // The translation ends up in the last column, where HLSL's column-major read expects it.
+    Translation(3, 4, 5, world);
+    ObjectDataPacker::Pack(world, 7, ObjectFlagTransparent, data);
+    CHECK(data.World[3] == 3 && data.World[7] == 4 && data.World[11] == 5);
+    CHECK(data.MaterialIndex == 7);
+    CHECK(data.Flags == ObjectFlagTransparent);
+    CHECK(data.Pad0 == 0 && data.Pad1 == 0);
+}
+
+TEST_CASE(PackerHandsOutConsecutiveDrawIds) {
+    ObjectDataPacker packer;
+    float world[16];
+    Translation(0, 0, 0, world);
+
+    CHECK(packer.Add(world, 1) == 0);
+    CHECK(packer.Add(world, 2) == 1);
+    CHECK(packer.GetCount() == 2);
+    CHECK(packer.GetByteSize() == 2 * sizeof(ObjectData));
+    CHECK(packer.GetData()[1].MaterialIndex == 2);
+}
+
+TEST_CASE(StoreUploadsOnlyChangedSlots) {
+    ObjectDataStore store(16);
+    float world[16];
+    Translation(1, 2, 3, world);
+
+    Vector<uint32> slots;
+    for (uint32 i = 0; i < 8; ++i) {
+        slots.push_back(store.Allocate());
+        CHECK(store.Update(slots.back(), world, 0));
+    }
+    CHECK(store.FlushChanges([](uint32, const ObjectData*, uint32) {}) == 8);
+
+    // Writing the same data again is not a change.
+    CHECK(!store.Update(slots[3], world, 0));
+    CHECK(!store.HasChanges());
+
+    Translation(9, 9, 9, world);
+    CHECK(store.Update(slots[5], world, 0));
+
+    Vector<uint32> uploaded;
+    store.FlushChanges([&](uint32 first, const ObjectData* objects, uint32 count) {
+        for (uint32 i = 0; i < count; ++i) {
+            uploaded.push_back(first + i);
+            CHECK(objects[i].World[3] == store.Get(first + i).World[3]);
+        }
+    });
+    CHECK(uploaded.size() == 1 && uploaded[0] == slots[5]);
+    CHECK(store.Get(slots[5]).World[3] == 9);
+    CHECK(store.GetStats().updates == 2);
+    CHECK(store.GetStats().changedObjects == 1);
+}
+
+TEST_CASE(StoreReusesFreedSlotsAfterTheFence) {
+    ObjectDataStore store(2);
+    uint32 a = store.Allocate();
+    uint32 b = store.Allocate();
+    CHECK(store.Allocate() == ObjectDataStore::InvalidSlot);
+
+    store.Free(a, 5);
+    store.Reclaim(4);
+    CHECK(store.Allocate() == ObjectDataStore::InvalidSlot);
+    store.Reclaim(5);
+    CHECK(store.Allocate() == a);
+    CHECK(store.GetLiveCount() == 2);
+    CHECK(store.GetHighWaterMark() == 2);
+    (void)b;
+}
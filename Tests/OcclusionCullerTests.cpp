@@ -0,0 +1,111 @@
+#include "TestMain.h"
+#include <OcclusionCuller.h>
+#include <FrustumCuller.h>
+#include <WorkerPool.h>
+
+namespace {
+    // Camera at the origin looking down +z, 90 degree field of view, depth 1 to 1000.
+    const float ViewProj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1, 0, 0, -1000.0f / 999.0f, 0 };
+    const float Identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+    struct Vertex {
+        float position[3];
+        float padding;
+    };
+
+    const uint16 QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    // A quad facing the camera at depth z.
+    void AddQuad(OcclusionCuller& culler, float minX, float maxX, float minY, float maxY, float z) {
+        const Vertex vertices[4] = { { { minX, minY, z } }, { { maxX, minY, z } }, { { maxX, maxY, z } },
+                                     { { minX, maxY, z } } };
+        culler.AddOccluder(Identity, vertices, sizeof(Vertex), 4, QuadIndices, 6);
+    }
+
+    bool IsVisible(const OcclusionCuller& culler, float x, float y, float z, float extent) {
+        const float center[3] = { x, y, z };
+        const float extents[3] = { extent, extent, extent };
+        return culler.IsVisible(center, extents);
+    }
+}
+
+TEST_CASE(NothingIsHiddenWithoutOccluders) {
+    OcclusionCuller culler;
+    culler.Begin(ViewProj);
+    CHECK(!culler.HasOccluders());
+    culler.Rasterize();
+    CHECK(culler.GetDepth(10, 10) == 1.0f);
+    CHECK(IsVisible(culler, 0, 0, 500, 1));
+}
+
+TEST_CASE(BoxesBehindAWallAreHidden) {
+    OcclusionCuller culler;
+    culler.Begin(ViewProj);
+    AddQuad(culler, -20, 20, -20, 20, 10);
+    culler.Rasterize();
+    CHECK(culler.GetStats().rasterizedTriangles == 2);
+
+    // Depth of the wall is (z - 1) / z scaled to the 1..1000 range.
+    float wallDepth = (1000.0f / 999.0f) * 0.9f;
+    float depth = culler.GetDepth(culler.GetWidth() / 2, culler.GetHeight() / 2);
+    CHECK(depth > wallDepth - 1e-4f && depth < wallDepth + 1e-4f);
+
+    CHECK(!IsVisible(culler, 0, 0, 50, 1));
+    CHECK(!IsVisible(culler, 30, 0, 100, 5));
+    CHECK(IsVisible(culler, 0, 0, 5, 1));          // In front of the wall
+    CHECK(IsVisible(culler, 0, 0, 10, 1));         // Pokes through it
+    CHECK(IsVisible(culler, 0, 0, 1.5f, 1));       // Crosses the near plane
+}
+
+TEST_CASE(PartialWallsOnlyHideWhatTheyCover) {
+    OcclusionCuller culler;
+    culler.Begin(ViewProj);
+    AddQuad(culler, -20, 0, -20, 20, 10);          // Left half of the screen
+    culler.Rasterize();
+
+    CHECK(!IsVisible(culler, -20, 0, 50, 1));
+    CHECK(IsVisible(culler, 20, 0, 50, 1));
+    CHECK(IsVisible(culler, 0, 0, 50, 5));         // Straddles the edge
+}
+
+TEST_CASE(FilterKeepsTheVisibleInOrder) {
+    OcclusionCuller culler;
+    culler.Begin(ViewProj);
+    AddQuad(culler, -20, 0, -20, 20, 10);
+    culler.Rasterize();
+
+    CullingBounds bounds;
+    bounds.Resize(6);
+    const float extents[3] = { 1, 1, 1 };
+    for (uint32 i = 0; i < 6; ++i) {
+        // Even IDs sit behind the wall, odd ones to its right.
+        const float center[3] = { (i % 2) ? 20.0f : -20.0f, 0.0f, 50.0f + i };
+        bounds.Set(i, center, extents);
+    }
+
+    uint32 drawIds[6] = { 0, 1, 2, 3, 4, 5 };
+    uint32 visible = culler.Filter(bounds, drawIds, 6);
+    CHECK(visible == 3 && drawIds[0] == 1 && drawIds[1] == 3 && drawIds[2] == 5);
+    CHECK(culler.GetStats().testedObjects == 6 && culler.GetStats().occludedObjects == 3);
+}
+
+TEST_CASE(ParallelRasterizeMatchesSerial) {
+    WorkerPool pool(3);
+    OcclusionCuller serial;
+    OcclusionCuller parallel;
+    for (OcclusionCuller* culler : { &serial, &parallel }) {
+        culler->Begin(ViewProj);
+        for (uint32 i = 0; i < 8; ++i) {
+            float x = -16.0f + 4.0f * i;
+            AddQuad(*culler, x, x + 3.0f, -8.0f + i, 4.0f + i, 10.0f + 3.0f * i);
+        }
+    }
+    serial.Rasterize();
+    parallel.Rasterize(&pool);
+
+    bool same = true;
+    for (uint32 y = 0; y < serial.GetHeight(); ++y) {
+        for (uint32 x = 0; x < serial.GetWidth(); ++x) same &= serial.GetDepth(x, y) == parallel.GetDepth(x, y);
+    }
+    CHECK(same);
+}
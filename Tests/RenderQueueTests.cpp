@@ -0,0 +1,70 @@
+#include "TestMain.h"
+#include <RenderQueue.h>
+#include <algorithm>
+#include <random>
+
+TEST_CASE(KeysOrderBucketsAndDepth) {
+    using Bucket = RenderQueue::Bucket;
+    uint64 nearOpaque = RenderQueue::MakeKey(0, Bucket::Opaque, 1, 2, 3, 0.1f);
+    uint64 farOpaque = RenderQueue::MakeKey(0, Bucket::Opaque, 1, 2, 3, 0.9f);
+    uint64 otherState = RenderQueue::MakeKey(0, Bucket::Opaque, 1, 2, 4, 0.0f);
+    uint64 nearTransparent = RenderQueue::MakeKey(0, Bucket::Transparent, 1, 2, 3, 0.1f);
+    uint64 farTransparent = RenderQueue::MakeKey(0, Bucket::Transparent, 1, 2, 3, 0.9f);
+
+    // Opaque front to back within a state group, transparent back to front after them.
+    CHECK(nearOpaque < farOpaque && farOpaque < otherState);
+    CHECK(otherState < farTransparent && farTransparent < nearTransparent);
+    CHECK(RenderQueue::GetStateBits(nearOpaque) == RenderQueue::GetStateBits(farOpaque));
+    CHECK(RenderQueue::GetMesh(otherState) == 4 && RenderQueue::GetMesh(nearTransparent) == 3);
+    CHECK(RenderQueue::GetBucket(nearTransparent) == Bucket::Transparent);
+}
+
+TEST_CASE(RadixSortMatchesStableSort) {
+    std::mt19937 rng(46);
+    for (uint32 count : { 0u, 1u, 2u, 100u, 5000u }) {
+        RenderQueue queue;
+        Vector<std::pair<uint64, uint32>> expected;
+        for (uint32 i = 0; i < count; ++i) {
+            auto bucket = (rng() % 4 == 0) ? RenderQueue::Bucket::Transparent : RenderQueue::Bucket::Opaque;
+            // Few depths, so many keys are equal and stability shows.
+            uint64 key = RenderQueue::MakeKey(rng() % 2, bucket, rng() % 4, rng() % 50, rng() % 70, (rng() % 16) / 16.0f);
+            queue.Push(key, i);
+            expected.push_back({ key, i });
+        }
+        queue.Sort();
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        bool same = queue.GetCount() == count;
+        for (uint32 i = 0; i < count && same; ++i) {
+            same = queue.GetKey(i) == expected[i].first && queue.GetPayload(i) == expected[i].second;
+        }
+        CHECK(same);
+    }
+}
+
+TEST_CASE(EqualKeysKeepTheirOrder) {
+    RenderQueue queue;
+    uint64 key = RenderQueue::MakeKey(0, RenderQueue::Bucket::Opaque, 1, 1, 1, 0.5f);
+    for (uint32 i = 0; i < 10; ++i) queue.Push(key, 9 - i);
+    queue.Sort();
+    CHECK(queue.GetPayload(0) == 9 && queue.GetPayload(9) == 0);
+}
+
+TEST_CASE(IdTableStartsOverOnlyBetweenFrames) {
+    SortKeyIdTable table(4);
+    int objects[6];
+    table.BeginFrame();
+    for (uint32 i = 0; i < 6; ++i) table.GetId(&objects[i]);
+
+    // Within the frame IDs keep growing past the capacity; callers opt those out.
+    CHECK(table.GetId(&objects[5]) == 5);
+    CHECK(table.GetId(&objects[0]) == 0);
+
+    // The next frame starts over, and the table stays bounded.
+    table.BeginFrame();
+    CHECK(table.GetCount() == 0);
+    CHECK(table.GetId(&objects[3]) == 0);
+    table.BeginFrame();
+    CHECK(table.GetId(&objects[3]) == 0 && table.GetCount() == 1);
+}
@@ -0,0 +1,66 @@
+#include "TestMain.h"
+#include <ResourceId.h>
+
+// ID() must hash at compile time and agree with the runtime hash.
+static_assert(ID("").GetHash() == 0xcbf29ce484222325ull, "FNV-1a offset basis");
+static_assert(ID("a").GetHash() == 0xaf63dc4c8601ec8cull, "FNV-1a reference value");
+static_assert(ID("box") == ResourceId("box"));
+static_assert(ID("box") != ID("Box"));
+static_assert(!ResourceId().IsValid() && ID("").IsValid());
+
+namespace {
+    // Two names with the same 64-bit FNV-1a hash, found with a rho search.
+    const char* CollidingA = "NTSE04pvvYj";
+    const char* CollidingB = "7dixCZiBfbc";
+}
+
+TEST_CASE(RuntimeHashMatchesCompileTimeHash) {
+    // Built at runtime so the hash can't be folded.
+    String name = "crate";
+    name += "_diffuse";
+    constexpr ResourceId compiled = ID("crate_diffuse");
+    CHECK(ResourceId(name) == compiled);
+    CHECK(ResourceId::Hash(name) == compiled.GetHash());
+    CHECK(std::hash<ResourceId>()(compiled) == static_cast<size_t>(compiled.GetHash()));
+}
+
+TEST_CASE(CollidingNamesHashAlike) {
+    CHECK(String(CollidingA) != CollidingB);
+    CHECK(ResourceId(CollidingA) == ResourceId(CollidingB));
+}
+
+TEST_CASE(RegisterIsIdempotent) {
+    ResourceId first = ResourceNameTable::Register("sky");
+    bool threw = false;
+    try {
+        CHECK(ResourceNameTable::Register("sky") == first);
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(!threw);
+    CHECK(first == ID("sky"));
+
+#if DEBUG_BUILD
+    CHECK(ResourceNameTable::GetName(first) == "sky");
+#else
+    CHECK(ResourceNameTable::GetName(ID("sky")) == "#82428e195ce838b6");
+#endif
+}
+
+TEST_CASE(RegisterRejectsCollisionsInDebugBuilds) {
+    ResourceId id = ResourceNameTable::Register(CollidingA);
+    bool threw = false;
+    try {
+        CHECK(ResourceNameTable::Register(CollidingB) == id);
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+
+    // Release builds keep no names, so the collision goes unnoticed there.
+    CHECK(threw == bool(DEBUG_BUILD));
+#if DEBUG_BUILD
+    CHECK(ResourceNameTable::GetName(id) == CollidingA);
+#endif
+}
@@ -0,0 +1,170 @@
+#include "TestMain.h"
+#include <RootSignatureDesc.h>
+#include <RootArgumentCache.h>
+
+namespace {
+    DescriptorRangeDesc MakeRange(DescriptorRangeKind kind, uint32 baseRegister, uint32 count, uint32 space = 0) {
+        DescriptorRangeDesc range;
+        range.kind = kind;
+        range.baseRegister = baseRegister;
+        range.count = count;
+        range.space = space;
+        return range;
+    }
+}
+
+TEST_CASE(CostCountsDwordsPerParameterKind) {
+    RootSignatureDesc desc;
+    desc.AddConstants(3, 0);
+    desc.AddConstantBuffer(1);
+    desc.AddShaderResource(0);
+    desc.AddDescriptorTable({ MakeRange(DescriptorRangeKind::ShaderResource, 1, 8) });
+
+    CHECK(desc.GetParameter(0).GetCost() == 3);
+    CHECK(desc.GetParameter(1).GetCost() == 2);
+    CHECK(desc.GetParameter(2).GetCost() == 2);
+    CHECK(desc.GetParameter(3).GetCost() == 1);
+    CHECK(desc.GetCost() == 8);
+    CHECK(desc.Validate().empty());
+}
+
+TEST_CASE(ValidateEnforcesTheBudget) {
+    RootSignatureDesc desc;
+    desc.AddConstants(RootSignatureDesc::MaxCost, 0);
+    CHECK(desc.Validate().empty());
+
+    desc.AddDescriptorTable({ MakeRange(DescriptorRangeKind::ShaderResource, 0, 1) });
+    CHECK(desc.GetCost() == RootSignatureDesc::MaxCost + 1);
+    CHECK(!desc.Validate().empty());
+}
+
+TEST_CASE(ValidateRejectsEmptyParameters) {
+    RootSignatureDesc noConstants;
+    noConstants.AddConstants(0, 0);
+    CHECK(!noConstants.Validate().empty());
+
+    RootSignatureDesc noRanges;
+    noRanges.AddDescriptorTable({});
+    CHECK(!noRanges.Validate().empty());
+
+    RootSignatureDesc emptyRange;
+    emptyRange.AddDescriptorTable({ MakeRange(DescriptorRangeKind::ShaderResource, 0, 0) });
+    CHECK(!emptyRange.Validate().empty());
+
+    RootSignatureDesc mixed;
+    mixed.AddDescriptorTable({ MakeRange(DescriptorRangeKind::ShaderResource, 0, 1),
+                               MakeRange(DescriptorRangeKind::Sampler, 0, 1) });
+    CHECK(!mixed.Validate().empty());
+}
+
+TEST_CASE(ValidateFindsRegisterOverlapPerVisibility) {
+    // Same register, class and space visible to every stage.
+    RootSignatureDesc clash;
+    clash.AddShaderResource(2);
+    clash.AddDescriptorTable({ MakeRange(DescriptorRangeKind::ShaderResource, 0, 4) });
+    CHECK(!clash.Validate().empty());
+
+    // All overlaps every single stage.
+    RootSignatureDesc allAndPixel;
+    allAndPixel.AddConstantBuffer(0);
+    allAndPixel.AddConstants(1, 0, 0, RootVisibility::Pixel);
+    CHECK(!allAndPixel.Validate().empty());
+
+    // Different stages may reuse a register.
+    RootSignatureDesc perStage;
+    perStage.AddShaderResource(0, 0, RootVisibility::Vertex);
+    perStage.AddShaderResource(0, 0, RootVisibility::Pixel);
+    CHECK(perStage.Validate().empty());
+
+    // Different register classes and spaces never collide.
+    RootSignatureDesc classes;
+    classes.AddConstantBuffer(0);
+    classes.AddShaderResource(0);
+    classes.AddDescriptorTable({ MakeRange(DescriptorRangeKind::ShaderResource, 0, 4, 1) });
+    CHECK(classes.Validate().empty());
+
+    // Adjacent ranges touch without overlapping.
+    RootSignatureDesc adjacent;
+    adjacent.AddDescriptorTable({ MakeRange(DescriptorRangeKind::ShaderResource, 0, 4),
+                                  MakeRange(DescriptorRangeKind::ShaderResource, 4, 4) });
+    CHECK(adjacent.Validate().empty());
+
+    // An unbounded range claims every register above its base.
+    RootSignatureDesc unbounded;
+    unbounded.AddDescriptorTable({ MakeRange(DescriptorRangeKind::ShaderResource, 10, DescriptorRangeDesc::Unbounded) });
+    unbounded.AddShaderResource(1000000);
+    CHECK(!unbounded.Validate().empty());
+}
+
+TEST_CASE(SceneRootSignatureMatchesRootParameter) {
+    RootSignatureDesc desc = BuildSceneRootSignatureDesc(4096);
+    CHECK(desc.GetParameterCount() == RootParamCount);
+    CHECK(desc.Validate().empty());
+    CHECK(desc.GetCost() == DrawConstantCount + 2 + 2 + 2 + 1 + 1);
+
+    const auto& constants = desc.GetParameter(RootParamDrawConstants);
+    CHECK(constants.kind == RootParameterKind::Constants);
+    CHECK(constants.num32BitValues == DrawConstantCount);
+    CHECK(constants.shaderRegister == 0);
+
+    CHECK(desc.GetParameter(RootParamObjectBuffer).kind == RootParameterKind::ShaderResource);
+    CHECK(desc.GetParameter(RootParamObjectBuffer).shaderRegister == 1);
+    CHECK(desc.GetParameter(RootParamInstanceList).kind == RootParameterKind::ShaderResource);
+    CHECK(desc.GetParameter(RootParamInstanceList).visibility == RootVisibility::Vertex);
+    CHECK(desc.GetParameter(RootParamPassCB).kind == RootParameterKind::ConstantBuffer);
+    CHECK(desc.GetParameter(RootParamPassCB).shaderRegister == 1);
+    CHECK(desc.GetParameter(RootParamMaterialTable).kind == RootParameterKind::DescriptorTable);
+
+    const auto& textures = desc.GetParameter(RootParamTextureTable);
+    CHECK(textures.kind == RootParameterKind::DescriptorTable);
+    CHECK(textures.visibility == RootVisibility::Pixel);
+    CHECK(textures.ranges.size() == 1);
+    CHECK(textures.ranges[0].count == 4096);
+    CHECK(textures.ranges[0].space == 1);
+    CHECK(textures.ranges[0].volatileDescriptors);
+}
+
+TEST_CASE(ArgumentCacheSkipsRedundantValues) {
+    RootArgumentCache cache;
+    CHECK(cache.SetValue(RootParamObjectBuffer, 0x1000));
+    CHECK(!cache.SetValue(RootParamObjectBuffer, 0x1000));
+    CHECK(cache.SetValue(RootParamObjectBuffer, 0x2000));
+
+    // Parameters are tracked independently.
+    CHECK(cache.SetValue(RootParamPassCB, 0x2000));
+    CHECK(!cache.SetValue(RootParamObjectBuffer, 0x2000));
+
+    cache.Invalidate(RootParamObjectBuffer);
+    CHECK(cache.SetValue(RootParamObjectBuffer, 0x2000));
+    CHECK(!cache.SetValue(RootParamPassCB, 0x2000));
+
+    cache.Reset();
+    CHECK(cache.SetValue(RootParamObjectBuffer, 0x2000));
+    CHECK(cache.SetValue(RootParamPassCB, 0x2000));
+}
+
+TEST_CASE(ArgumentCacheSkipsRedundantConstants) {
+    RootArgumentCache cache;
+    uint32 draw[2] = { 7, NoInstanceList };
+    CHECK(cache.SetConstants(RootParamDrawConstants, draw, 2));
+    CHECK(!cache.SetConstants(RootParamDrawConstants, draw, 2));
+
+    // A changed subrange, then a subrange that is already cached.
+    uint32 id = 8;
+    CHECK(cache.SetConstants(RootParamDrawConstants, &id, 1));
+    CHECK(!cache.SetConstants(RootParamDrawConstants, &id, 1));
+    CHECK(!cache.SetConstants(RootParamDrawConstants, &draw[1], 1, 1));
+
+    // Never-written offsets count as changed even when the value is zero.
+    uint32 zero = 0;
+    CHECK(cache.SetConstants(RootParamDrawConstants, &zero, 1, 5));
+    CHECK(!cache.SetConstants(RootParamDrawConstants, &zero, 1, 5));
+
+    // Constants past the cached window are always set and drop what was cached.
+    uint32 far = 1;
+    CHECK(cache.SetConstants(RootParamDrawConstants, &far, 1, RootArgumentCache::MaxCachedConstants));
+    CHECK(cache.SetConstants(RootParamDrawConstants, &id, 1));
+
+    cache.Reset();
+    CHECK(cache.SetConstants(RootParamDrawConstants, &id, 1));
+}
@@ -0,0 +1,95 @@
+#include "TestMain.h"
+#include <SlotMap.h>
+#include <random>
+
+TEST_CASE(InsertAndGet) {
+    SlotMap<int> map;
+    Handle a = map.Insert(10);
+    Handle b = map.Insert(20);
+    CHECK(a.IsValid() && b.IsValid());
+    CHECK(a.index != b.index);
+    CHECK(*map.Get(a) == 10 && *map.Get(b) == 20);
+    CHECK(map.Size() == 2);
+    CHECK(map.Get(Handle()) == nullptr);
+}
+
+TEST_CASE(ErasedSlotsAreReusedWithANewGeneration) {
+    SlotMap<int> map;
+    Handle a = map.Insert(1);
+    CHECK(map.Erase(a));
+
+    Handle b = map.Insert(2);
+    CHECK(b.index == a.index);
+    CHECK(b.generation != a.generation);
+    CHECK(map.GetSlotCount() == 2);     // Slot 0 plus the reused one
+}
+
+TEST_CASE(StaleHandlesAreRejected) {
+    SlotMap<int> map;
+    Handle a = map.Insert(1);
+    map.Erase(a);
+    Handle b = map.Insert(2);
+
+    CHECK(!map.Contains(a));
+    CHECK(map.Get(a) == nullptr);
+    CHECK(!map.Erase(a));
+    CHECK(*map.Get(b) == 2);
+    CHECK(map.Size() == 1);
+
+    // Clear invalidates every handle as well.
+    map.Clear();
+    CHECK(!map.Contains(b));
+    CHECK(map.Empty());
+    Handle c = map.Insert(3);
+    CHECK(c.index == b.index && !(c == b));
+}
+
+TEST_CASE(IterationAfterEraseVisitsEveryLiveValueOnce) {
+    SlotMap<int> map;
+    Vector<Handle> handles;
+    for (int i = 0; i < 100; ++i) handles.push_back(map.Insert(i));
+    for (int i = 0; i < 100; i += 3) map.Erase(handles[i]);
+
+    Vector<int> seen(100, 0);
+    for (int value : map) ++seen[value];
+    for (int i = 0; i < 100; ++i) CHECK(seen[i] == (i % 3 == 0 ? 0 : 1));
+
+    // Dense positions and handles stay paired after the moves.
+    for (uint32 i = 0; i < map.Size(); ++i) {
+        Handle handle = map.GetHandle(i);
+        CHECK(map.Get(handle) == map.Data() + i);
+        CHECK(handles[map.Data()[i]] == handle);
+    }
+}
+
+TEST_CASE(RandomOperationsMatchAReferenceModel) {
+    SlotMap<uint32> map;
+    Vector<std::pair<Handle, uint32>> live;
+    Vector<Handle> dead;
+    std::mt19937 rng(11);
+
+    for (uint32 step = 0; step < 20000; ++step) {
+        if (live.empty() || rng() % 2 == 0) {
+            live.push_back({ map.Insert(step), step });
+        }
+        else {
+            size_t index = rng() % live.size();
+            CHECK(map.Erase(live[index].first));
+            dead.push_back(live[index].first);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    CHECK(map.Size() == live.size());
+    for (const auto& [handle, value] : live) CHECK(map.Get(handle) && *map.Get(handle) == value);
+    for (const Handle& handle : dead) CHECK(!map.Contains(handle));
+}
+
+TEST_CASE(MoveOnlyValues) {
+    SlotMap<UniquePtr<int>> map;
+    Handle a = map.Insert(UniquePtr<int>(new int(1)));
+    Handle b = map.Emplace(new int(2));
+    map.Erase(a);
+    CHECK(**map.Get(b) == 2);
+}
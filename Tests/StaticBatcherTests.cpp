@@ -0,0 +1,95 @@
+#include "TestMain.h"
+#include <StaticBatcher.h>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    // A quad in the XY plane, two triangles.
+    const StaticBatchVertex QuadVertices[4] = {
+        { { 0, 0, 0 }, { 0, 0, 1 }, { 0, 0 } },
+        { { 1, 0, 0 }, { 0, 0, 1 }, { 1, 0 } },
+        { { 1, 1, 0 }, { 0, 0, 1 }, { 1, 1 } },
+        { { 0, 1, 0 }, { 0, 0, 1 }, { 0, 1 } },
+    };
+    const uint16 QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    StaticBatchSource Quad(float x, float z, uint32 material) {
+        StaticBatchSource source;
+        source.vertices = QuadVertices;
+        source.vertexCount = 4;
+        source.indices = QuadIndices;
+        source.indexCount = 6;
+        source.world[12] = x;
+        source.world[14] = z;
+        source.material = material;
+        return source;
+    }
+
+    const char* CachePath = "StaticBatcherTests.cache";
+}
+
+TEST_CASE(SourcesMergePerCellAndMaterial) {
+    Vector<StaticBatchSource> sources = { Quad(1, 1, 0), Quad(5, 5, 0), Quad(2, 2, 1), Quad(100, 1, 0) };
+    StaticBatcher batcher(64.0f);
+    batcher.Build(sources);
+
+    // Two quads share cell (0, 0) and material 0; the others each get a batch.
+    CHECK(batcher.GetBatches().size() == 3);
+    CHECK(batcher.GetStats().sourceCount == 4 && batcher.GetStats().batchCount == 3);
+    CHECK(batcher.GetVertices().size() == 16 && batcher.GetIndices().size() == 24);
+
+    bool merged = false;
+    for (const StaticBatch& batch : batcher.GetBatches()) {
+        CHECK(batch.baseVertex + batch.vertexCount <= batcher.GetVertices().size());
+        for (uint32 i = 0; i < batch.indexCount; ++i) CHECK(batcher.GetIndices()[batch.startIndex + i] < batch.vertexCount);
+
+        if (batch.sourceCount == 2) {
+            merged = batch.material == 0 && batch.cellX == 0 && batch.cellZ == 0 && batch.indexCount == 12;
+            // Vertices are in world space: the second quad starts at (5, 0, 5).
+            const StaticBatchVertex& corner = batcher.GetVertices()[batch.baseVertex + 4];
+            CHECK(corner.position[0] == 5 && corner.position[2] == 5);
+        }
+    }
+    CHECK(merged);
+}
+
+TEST_CASE(CacheRoundTrip) {
+    Vector<StaticBatchSource> sources = { Quad(1, 1, 0), Quad(5, 5, 0), Quad(70, 1, 2) };
+    StaticBatcher built;
+    built.Build(sources);
+    uint64 hash = built.HashSources(sources);
+    CHECK(built.SaveCache(CachePath, hash));
+
+    StaticBatcher loaded;
+    CHECK(loaded.LoadCache(CachePath, hash));
+    CHECK(loaded.GetBatches().size() == built.GetBatches().size());
+    CHECK(loaded.GetIndices() == built.GetIndices());
+    CHECK(loaded.GetStats().batchCount == built.GetStats().batchCount);
+
+    // Other sources hash differently, and their cache is refused.
+    sources[1] = Quad(6, 5, 0);
+    CHECK(built.HashSources(sources) != hash);
+    CHECK(!loaded.LoadCache(CachePath, built.HashSources(sources)));
+    CHECK(loaded.GetBatches().empty());
+    std::remove(CachePath);
+}
+
+TEST_CASE(CacheWithIndicesOutsideTheBatchIsRefused) {
+    Vector<StaticBatchSource> sources = { Quad(1, 1, 0), Quad(70, 1, 0) };
+    StaticBatcher batcher;
+    batcher.Build(sources);
+    uint64 hash = batcher.HashSources(sources);
+    CHECK(batcher.SaveCache(CachePath, hash));
+
+    // Indices are stored last. The final one still points inside the vertex buffer, but
+    // past its own batch's vertices.
+    {
+        std::fstream file(CachePath, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-static_cast<std::streamoff>(sizeof(uint32)), std::ios::end);
+        uint32 index = 5;
+        file.write(reinterpret_cast<const char*>(&index), sizeof(index));
+    }
+    CHECK(!batcher.LoadCache(CachePath, hash));
+    CHECK(batcher.GetBatches().empty() && batcher.GetIndices().empty());
+    std::remove(CachePath);
+}
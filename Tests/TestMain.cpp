@@ -0,0 +1,24 @@
+#include "TestMain.h"
+
+namespace {
+    uint32 s_failures = 0;
+}
+
+Vector<Test::Case>& Test::GetCases() {
+    static Vector<Case> cases;
+    return cases;
+}
+
+void Test::Fail(const char* file, int line, const char* expression) {
+    std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+    ++s_failures;
+}
+
+int main() {
+    for (const Test::Case& testCase : Test::GetCases()) {
+        uint32 failuresBefore = s_failures;
+        testCase.fn();
+        std::printf("%s %s\n", (s_failures == failuresBefore) ? "[pass]" : "[FAIL]", testCase.name);
+    }
+    return (s_failures == 0) ? 0 : 1;
+}
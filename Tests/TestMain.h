@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Types.h>
+#include <cstdio>
+
+// Minimal test harness: TEST_CASE registers a function, CHECK records a failure and
+// keeps going, so one run reports every broken expectation.
+namespace Test {
+    struct Case {
+        const char* name;
+        void (*fn)();
+    };
+
+    Vector<Case>& GetCases();
+    void Fail(const char* file, int line, const char* expression);
+
+    struct Registrar {
+        Registrar(const char* name, void (*fn)()) { GetCases().push_back({ name, fn }); }
+    };
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static Test::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) Test::Fail(__FILE__, __LINE__, #condition); \
+    } while (0)
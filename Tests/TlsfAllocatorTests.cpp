@@ -0,0 +1,155 @@
+#include "TestMain.h"
+#include <TlsfAllocator.h>
+#include <random>
+
+namespace {
+    constexpr uint64 KB = 1024;
+
+    // Live allocations must lie inside the range and never overlap.
+    bool AllocationsAreDisjoint(const TlsfAllocator& allocator) {
+        uint64 end = 0;
+        bool disjoint = true;
+        allocator.ForEachAllocation([&](const TlsfAllocator::Allocation& allocation) {
+            if (allocation.offset < end || allocation.offset + allocation.size > allocator.GetCapacity()) disjoint = false;
+            end = allocation.offset + allocation.size;
+        });
+        return disjoint;
+    }
+}
+
+TEST_CASE(AllocationsAreRoundedToTheGranularity) {
+    TlsfAllocator allocator(1024 * KB, 4 * KB);
+
+    auto a = allocator.Allocate(1);
+    auto b = allocator.Allocate(5 * KB);
+    CHECK(a.IsValid() && b.IsValid());
+    CHECK(a.size == 4 * KB);
+    CHECK(b.size == 8 * KB);
+    CHECK(a.offset % (4 * KB) == 0 && b.offset % (4 * KB) == 0);
+    CHECK(allocator.GetUsedBytes() == 12 * KB);
+    CHECK(allocator.GetAllocationCount() == 2);
+    CHECK(AllocationsAreDisjoint(allocator));
+}
+
+TEST_CASE(AllocateFailsWhenNothingFits) {
+    TlsfAllocator allocator(64 * KB, 4 * KB);
+
+    CHECK(!allocator.Allocate(128 * KB).IsValid());
+
+    Vector<TlsfAllocator::Allocation> allocations;
+    for (;;) {
+        auto allocation = allocator.Allocate(4 * KB);
+        if (!allocation.IsValid()) break;
+        allocations.push_back(allocation);
+    }
+    CHECK(allocations.size() == 16);
+    CHECK(allocator.GetUsedBytes() == allocator.GetCapacity());
+    CHECK(allocator.GetStats().freeBytes == 0);
+}
+
+TEST_CASE(FreeCoalescesWithBothNeighbours) {
+    TlsfAllocator allocator(64 * KB, 4 * KB);
+    auto a = allocator.Allocate(16 * KB);
+    auto b = allocator.Allocate(16 * KB);
+    auto c = allocator.Allocate(16 * KB);
+    auto d = allocator.Allocate(16 * KB);
+    CHECK(d.IsValid());
+
+    // Freeing a and c leaves two separate holes.
+    allocator.Free(a.node);
+    allocator.Free(c.node);
+    auto stats = allocator.GetStats();
+    CHECK(stats.freeBlockCount == 2);
+    CHECK(stats.largestFreeBlock == 16 * KB);
+
+    // b joins both holes into one block.
+    allocator.Free(b.node);
+    stats = allocator.GetStats();
+    CHECK(stats.freeBlockCount == 1);
+    CHECK(stats.largestFreeBlock == 48 * KB);
+    CHECK(allocator.Allocate(48 * KB).IsValid());
+
+    allocator.Free(d.node);
+    CHECK(allocator.GetAllocationCount() == 1);
+}
+
+TEST_CASE(FreeingEverythingLeavesOneBlock) {
+    TlsfAllocator allocator(1024 * KB, 4 * KB);
+    Vector<TlsfAllocator::Allocation> allocations;
+    for (uint64 size = 4 * KB; size <= 64 * KB; size += 4 * KB) {
+        allocations.push_back(allocator.Allocate(size));
+    }
+    for (size_t i = 0; i < allocations.size(); i += 2) allocator.Free(allocations[i].node);
+    for (size_t i = 1; i < allocations.size(); i += 2) allocator.Free(allocations[i].node);
+
+    auto stats = allocator.GetStats();
+    CHECK(allocator.IsEmpty());
+    CHECK(stats.freeBlockCount == 1);
+    CHECK(stats.largestFreeBlock == allocator.GetCapacity());
+    CHECK(stats.Fragmentation() == 0.0f);
+}
+
+TEST_CASE(AllocateAtReservesExactlyTheFreeRange) {
+    TlsfAllocator allocator(64 * KB, 4 * KB);
+
+    auto placed = allocator.AllocateAt(16 * KB, 8 * KB);
+    CHECK(placed.IsValid());
+    CHECK(placed.offset == 16 * KB && placed.size == 8 * KB);
+
+    // Taken, overlapping or misaligned ranges are refused.
+    CHECK(!allocator.AllocateAt(16 * KB, 4 * KB).IsValid());
+    CHECK(!allocator.AllocateAt(12 * KB, 8 * KB).IsValid());
+    CHECK(!allocator.AllocateAt(2 * KB, 4 * KB).IsValid());
+
+    // The space in front and behind stays usable.
+    CHECK(allocator.AllocateAt(0, 16 * KB).IsValid());
+    CHECK(allocator.AllocateAt(24 * KB, 40 * KB).IsValid());
+    CHECK(allocator.GetUsedBytes() == allocator.GetCapacity());
+    CHECK(AllocationsAreDisjoint(allocator));
+}
+
+TEST_CASE(FragmentationComparesLargestFreeBlockWithTotalFree) {
+    TlsfAllocator allocator(64 * KB, 4 * KB);
+    Vector<TlsfAllocator::Allocation> allocations;
+    for (uint32 i = 0; i < 16; ++i) allocations.push_back(allocator.Allocate(4 * KB));
+    CHECK(allocator.GetStats().Fragmentation() == 0.0f);
+
+    // Every other block free: 32 KB free, but no hole larger than 4 KB.
+    for (uint32 i = 0; i < 16; i += 2) allocator.Free(allocations[i].node);
+    auto stats = allocator.GetStats();
+    CHECK(stats.freeBytes == 32 * KB);
+    CHECK(stats.largestFreeBlock == 4 * KB);
+    CHECK(stats.freeBlockCount == 8);
+    CHECK(stats.Fragmentation() > 0.85f);
+    CHECK(!allocator.Allocate(8 * KB).IsValid());
+}
+
+TEST_CASE(RandomAllocationsMatchAReferenceModel) {
+    TlsfAllocator allocator(4096 * KB, 4 * KB);
+    std::mt19937 rng(7);
+    Vector<TlsfAllocator::Allocation> live;
+    uint64 usedBytes = 0;
+
+    for (uint32 step = 0; step < 20000; ++step) {
+        if (live.empty() || rng() % 3 != 0) {
+            auto allocation = allocator.Allocate((rng() % 64 + 1) * KB);
+            if (allocation.IsValid()) {
+                live.push_back(allocation);
+                usedBytes += allocation.size;
+            }
+        }
+        else {
+            size_t index = rng() % live.size();
+            allocator.Free(live[index].node);
+            usedBytes -= live[index].size;
+            live[index] = live.back();
+            live.pop_back();
+        }
+        if (step % 1000 == 0) CHECK(AllocationsAreDisjoint(allocator));
+    }
+    CHECK(allocator.GetUsedBytes() == usedBytes);
+    CHECK(allocator.GetAllocationCount() == live.size());
+
+    for (const auto& allocation : live) allocator.Free(allocation.node);
+    CHECK(allocator.GetStats().freeBlockCount == 1);
+}
@@ -0,0 +1,153 @@
+#include "TestMain.h"
+#include <TransformBatch.h>
+#include <TransformSystem.h>
+#include <WorkerPool.h>
+#include <cmath>
+#include <random>
+
+namespace {
+    constexpr float Tolerance = 1e-4f;
+    constexpr float Sentinel = -12345.0f;
+
+    const float ViewProj[16] = { 1.2f, 0.1f, 0, 0, -0.2f, 1.6f, 0, 0, 0, 0.3f, 1.001f, 1, 2.0f, -1.0f, -1.001f, 0 };
+
+    // Random transforms as SoA streams plus the expected matrices, built with Compose and
+    // a double precision product.
+    struct Fixture {
+        Vector<float> streams[10];
+        TransformStreams in;
+        Vector<float> world;            // Row-major, 16 per object
+        Vector<float> worldViewProj;
+
+        explicit Fixture(uint32 count) {
+            std::mt19937 rng(count);
+            std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+            std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+            for (auto& stream : streams) stream.resize(count);
+
+            for (uint32 i = 0; i < count; ++i) {
+                Position position{ unit(rng) * 100, unit(rng) * 100, unit(rng) * 100 };
+                float q[4] = { unit(rng), unit(rng), unit(rng), unit(rng) };
+                float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+                Rotation rotation{ q[0] / length, q[1] / length, q[2] / length, q[3] / length };
+                Scale s{ scale(rng), scale(rng), scale(rng) };
+
+                const float values[10] = { position.x, position.y, position.z, rotation.x, rotation.y,
+                                           rotation.z, rotation.w, s.x, s.y, s.z };
+                for (uint32 k = 0; k < 10; ++k) streams[k][i] = values[k];
+
+                WorldMatrix matrix;
+                TransformSystem::Compose(position, rotation, s, matrix);
+                world.insert(world.end(), matrix.m, matrix.m + 16);
+                for (uint32 r = 0; r < 4; ++r) {
+                    for (uint32 c = 0; c < 4; ++c) {
+                        double sum = 0.0;
+                        for (uint32 k = 0; k < 4; ++k) sum += double(matrix.m[r * 4 + k]) * ViewProj[k * 4 + c];
+                        worldViewProj.push_back(static_cast<float>(sum));
+                    }
+                }
+            }
+
+            const float** targets[10] = { &in.positionX, &in.positionY, &in.positionZ, &in.rotationX, &in.rotationY,
+                                          &in.rotationZ, &in.rotationW, &in.scaleX, &in.scaleY, &in.scaleZ };
+            for (uint32 k = 0; k < 10; ++k) *targets[k] = streams[k].data();
+        }
+    };
+
+    // Output buffer with a guard after the last matrix, to catch tails written past count.
+    Vector<float> MakeOutput(uint32 count) {
+        return Vector<float>(size_t(count) * 16 + 16, Sentinel);
+    }
+
+    // Compares count matrices of actual, stored in layout, against row-major expected.
+    bool Matches(const Vector<float>& actual, const Vector<float>& expected, uint32 count, MatrixLayout layout) {
+        for (uint32 i = 0; i < count; ++i) {
+            for (uint32 r = 0; r < 4; ++r) {
+                for (uint32 c = 0; c < 4; ++c) {
+                    float want = expected[size_t(i) * 16 + r * 4 + c];
+                    uint32 at = layout == MatrixLayout::RowMajor ? r * 4 + c : c * 4 + r;
+                    float got = actual[size_t(i) * 16 + at];
+                    if (std::abs(got - want) > Tolerance * std::max(1.0f, std::abs(want))) return false;
+                }
+            }
+        }
+        for (size_t i = size_t(count) * 16; i < actual.size(); ++i) {
+            if (actual[i] != Sentinel) return false;
+        }
+        return true;
+    }
+
+    Vector<uint32> GetCounts() {
+        Vector<uint32> counts;
+        for (uint32 count = 1; count <= 17; ++count) counts.push_back(count);
+        counts.push_back(10001);
+        return counts;
+    }
+}
+
+TEST_CASE(EveryPathMatchesCompose) {
+    const TransformKernel::Path paths[3] = { TransformKernel::Path::Scalar, TransformKernel::Path::SSE,
+                                             TransformKernel::Path::AVX2 };
+    for (uint32 count : GetCounts()) {
+        Fixture fixture(count);
+        for (MatrixLayout layout : { MatrixLayout::RowMajor, MatrixLayout::Transposed }) {
+            for (TransformKernel::Path path : paths) {
+                if (path > TransformKernel::GetBestPath()) continue;
+
+                Vector<float> world = MakeOutput(count);
+                Vector<float> worldViewProj = MakeOutput(count);
+                TransformKernel::Compute(fixture.in, count, layout, world.data(), ViewProj, worldViewProj.data(), path);
+                CHECK(Matches(world, fixture.world, count, layout));
+                CHECK(Matches(worldViewProj, fixture.worldViewProj, count, layout));
+            }
+        }
+    }
+}
+
+TEST_CASE(EitherOutputMayBeSkipped) {
+    const uint32 count = 13;
+    Fixture fixture(count);
+
+    Vector<float> world = MakeOutput(count);
+    TransformKernel::Compute(fixture.in, count, MatrixLayout::RowMajor, world.data());
+    CHECK(Matches(world, fixture.world, count, MatrixLayout::RowMajor));
+
+    Vector<float> worldViewProj = MakeOutput(count);
+    TransformKernel::Compute(fixture.in, count, MatrixLayout::Transposed, nullptr, ViewProj, worldViewProj.data());
+    CHECK(Matches(worldViewProj, fixture.worldViewProj, count, MatrixLayout::Transposed));
+}
+
+TEST_CASE(ParallelMatchesCompose) {
+    WorkerPool pool(3);
+    for (uint32 count : GetCounts()) {
+        Fixture fixture(count);
+        for (MatrixLayout layout : { MatrixLayout::RowMajor, MatrixLayout::Transposed }) {
+            Vector<float> world = MakeOutput(count);
+            Vector<float> worldViewProj = MakeOutput(count);
+            TransformKernel::ComputeParallel(&pool, fixture.in, count, layout, world.data(), ViewProj,
+                                             worldViewProj.data());
+            CHECK(Matches(world, fixture.world, count, layout));
+            CHECK(Matches(worldViewProj, fixture.worldViewProj, count, layout));
+        }
+    }
+}
+
+TEST_CASE(BatchReturnsMatricesInAddOrder) {
+    const uint32 count = 10;
+    Fixture fixture(count);
+
+    TransformBatch batch;
+    for (uint32 i = 0; i < count; ++i) {
+        const float position[3] = { fixture.streams[0][i], fixture.streams[1][i], fixture.streams[2][i] };
+        const float rotation[4] = { fixture.streams[3][i], fixture.streams[4][i], fixture.streams[5][i],
+                                    fixture.streams[6][i] };
+        const float scale[3] = { fixture.streams[7][i], fixture.streams[8][i], fixture.streams[9][i] };
+        CHECK(batch.Add(position, rotation, scale) == i);
+    }
+    batch.Compute(MatrixLayout::RowMajor);
+    CHECK(batch.GetCount() == count);
+
+    Vector<float> world;
+    for (uint32 i = 0; i < count; ++i) world.insert(world.end(), batch.GetWorld(i), batch.GetWorld(i) + 16);
+    CHECK(Matches(world, fixture.world, count, MatrixLayout::RowMajor));
+}
@@ -0,0 +1,102 @@
+#include "TestMain.h"
+#include <TransformHierarchy.h>
+#include <WorkerPool.h>
+#include <cstring>
+
+namespace {
+    WorldMatrix Translation(float x, float y, float z) {
+        WorldMatrix m;
+        m.m[12] = x;
+        m.m[13] = y;
+        m.m[14] = z;
+        return m;
+    }
+
+    bool HasTranslation(const WorldMatrix* m, float x, float y, float z) {
+        return m && m->m[12] == x && m->m[13] == y && m->m[14] == z;
+    }
+}
+
+TEST_CASE(ChildrenComposeWithTheirParents) {
+    TransformHierarchy hierarchy;
+    Handle root = hierarchy.CreateNode();
+    Handle child = hierarchy.CreateNode(root);
+    Handle grandchild = hierarchy.CreateNode(child);
+    hierarchy.SetLocal(root, Translation(1, 0, 0));
+    hierarchy.SetLocal(child, Translation(0, 2, 0));
+    hierarchy.SetLocal(grandchild, Translation(0, 0, 3));
+
+    CHECK(hierarchy.Update() == 3);
+    CHECK(hierarchy.GetDepthCount() == 3);
+    CHECK(HasTranslation(hierarchy.GetWorld(grandchild), 1, 2, 3));
+
+    // Moving the root recomputes its subtree only.
+    Handle other = hierarchy.CreateNode();
+    hierarchy.Update();
+    hierarchy.SetLocal(root, Translation(5, 0, 0));
+    CHECK(hierarchy.Update() == 3);
+    CHECK(HasTranslation(hierarchy.GetWorld(grandchild), 5, 2, 3));
+    CHECK(hierarchy.Update() == 0);
+    CHECK(hierarchy.Contains(other));
+}
+
+TEST_CASE(ReparentingKeepsParentsFirst) {
+    TransformHierarchy hierarchy;
+    Handle a = hierarchy.CreateNode();
+    Handle b = hierarchy.CreateNode(a);
+    Handle c = hierarchy.CreateNode();
+    hierarchy.SetLocal(a, Translation(1, 0, 0));
+    hierarchy.SetLocal(c, Translation(0, 10, 0));
+
+    // c becomes b's child, two levels down, although it was created before b's level.
+    CHECK(hierarchy.SetParent(c, b));
+    hierarchy.Update();
+    CHECK(HasTranslation(hierarchy.GetWorld(c), 1, 10, 0));
+
+    // Cycles are refused; detaching makes the node a root again.
+    CHECK(!hierarchy.SetParent(a, c));
+    CHECK(hierarchy.SetParent(c, Handle()));
+    hierarchy.Update();
+    CHECK(HasTranslation(hierarchy.GetWorld(c), 0, 10, 0));
+}
+
+TEST_CASE(DestroyRemovesTheSubtree) {
+    TransformHierarchy hierarchy;
+    Handle root = hierarchy.CreateNode();
+    Handle child = hierarchy.CreateNode(root);
+    Handle grandchild = hierarchy.CreateNode(child);
+    Handle other = hierarchy.CreateNode();
+
+    hierarchy.DestroyNode(child);
+    CHECK(hierarchy.Contains(root) && hierarchy.Contains(other));
+    CHECK(!hierarchy.Contains(child) && !hierarchy.Contains(grandchild));
+    CHECK(hierarchy.GetNodeCount() == 2);
+
+    // A reused slot gets a new generation.
+    Handle reused = hierarchy.CreateNode(root);
+    CHECK(!hierarchy.Contains(child) || reused.index != child.index);
+    CHECK(hierarchy.GetWorld(grandchild) == nullptr);
+}
+
+TEST_CASE(ParallelUpdateMatchesSerial) {
+    WorkerPool pool(3);
+    TransformHierarchy serial;
+    TransformHierarchy parallel;
+    Vector<Handle> serialNodes;
+    Vector<Handle> parallelNodes;
+    for (uint32 i = 0; i < 5000; ++i) {
+        Handle serialParent = (i < 4) ? Handle() : serialNodes[(i - 4) / 3];
+        Handle parallelParent = (i < 4) ? Handle() : parallelNodes[(i - 4) / 3];
+        serialNodes.push_back(serial.CreateNode(serialParent, Handle()));
+        parallelNodes.push_back(parallel.CreateNode(parallelParent, Handle()));
+        serial.SetLocal(serialNodes.back(), Translation(float(i % 7), 1, 0));
+        parallel.SetLocal(parallelNodes.back(), Translation(float(i % 7), 1, 0));
+    }
+
+    CHECK(serial.Update() == parallel.Update(&pool));
+    bool same = true;
+    for (uint32 i = 0; i < serialNodes.size(); ++i) {
+        same &= std::memcmp(serial.GetWorld(serialNodes[i]), parallel.GetWorld(parallelNodes[i]), sizeof(WorldMatrix)) == 0;
+    }
+    CHECK(same);
+}
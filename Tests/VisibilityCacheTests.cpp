@@ -0,0 +1,207 @@
+#include "TestMain.h"
+#include <VisibilityCache.h>
+#include <WorkerPool.h>
+#include <cmath>
+#include <random>
+
+namespace {
+    // Row-major view-projection for row vectors of a camera at eye turned yaw radians
+    // from +z around y, 90 degree field of view, depth 1 to 1000.
+    FrustumPlanes MakeFrustum(const float eye[3], float yaw) {
+        const float right[3] = { std::cos(yaw), 0.0f, -std::sin(yaw) };
+        const float up[3] = { 0.0f, 1.0f, 0.0f };
+        const float forward[3] = { std::sin(yaw), 0.0f, std::cos(yaw) };
+        const float* axes[3] = { right, up, forward };
+
+        float view[16] = {};
+        for (uint32 axis = 0; axis < 3; ++axis) {
+            for (uint32 row = 0; row < 3; ++row) view[row * 4 + axis] = axes[axis][row];
+            view[12 + axis] = -(eye[0] * axes[axis][0] + eye[1] * axes[axis][1] + eye[2] * axes[axis][2]);
+        }
+        view[15] = 1.0f;
+
+        const float proj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1000.0f / 999.0f, 1, 0, 0, -1000.0f / 999.0f, 0 };
+        float viewProj[16] = {};
+        for (uint32 row = 0; row < 4; ++row) {
+            for (uint32 col = 0; col < 4; ++col) {
+                for (uint32 k = 0; k < 4; ++k) viewProj[row * 4 + col] += view[row * 4 + k] * proj[k * 4 + col];
+            }
+        }
+        return FrustumCuller::ExtractPlanes(viewProj);
+    }
+
+    float Margin(const FrustumPlanes& frustum, const CullingBounds& bounds, uint32 i) {
+        float margin = 1e30f;
+        for (uint32 p = 0; p < 6; ++p) {
+            float distance = frustum.normalX[p] * bounds.GetCenterX()[i] + frustum.normalY[p] * bounds.GetCenterY()[i] +
+                             frustum.normalZ[p] * bounds.GetCenterZ()[i] + frustum.d[p];
+            float radius = std::fabs(frustum.normalX[p]) * bounds.GetExtentX()[i] +
+                           std::fabs(frustum.normalY[p]) * bounds.GetExtentY()[i] +
+                           std::fabs(frustum.normalZ[p]) * bounds.GetExtentZ()[i];
+            margin = std::min(margin, distance + radius);
+        }
+        return margin;
+    }
+
+    // Both lists ascending; any box only one of them holds must sit on a plane.
+    bool Agree(const FrustumPlanes& frustum, const CullingBounds& bounds, const Vector<uint32>& a,
+               const Vector<uint32>& b) {
+        size_t i = 0, j = 0;
+        while (i < a.size() || j < b.size()) {
+            if (i < a.size() && j < b.size() && a[i] == b[j]) {
+                ++i;
+                ++j;
+                continue;
+            }
+            uint32 box = (j == b.size() || (i < a.size() && a[i] < b[j])) ? a[i++] : b[j++];
+            if (std::fabs(Margin(frustum, bounds, box)) > 1e-3f) return false;
+        }
+        return true;
+    }
+
+    void SetRandomBox(CullingBounds& bounds, uint32 i, std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> size(0.1f, 15.0f);
+        const float center[3] = { position(rng), position(rng) * 0.2f, position(rng) };
+        const float extents[3] = { size(rng), size(rng), size(rng) };
+        bounds.Set(i, center, extents);
+    }
+
+    CullingBounds RandomBounds(uint32 count, std::mt19937& rng) {
+        CullingBounds bounds;
+        bounds.Resize(count);
+        for (uint32 i = 0; i < count; ++i) SetRandomBox(bounds, i, rng);
+        return bounds;
+    }
+
+    Vector<uint32> Reference(const FrustumPlanes& frustum, const CullingBounds& bounds) {
+        Vector<uint32> visible(bounds.GetCount());
+        visible.resize(FrustumCuller::Cull(frustum, bounds, visible.data(), FrustumCuller::Path::Scalar));
+        return visible;
+    }
+
+    Vector<uint32> Cull(VisibilityCache& cache, const FrustumPlanes& frustum, const float eye[3],
+                        const CullingBounds& bounds, WorkerPool* pool = nullptr) {
+        Vector<uint32> visible(bounds.GetCount());
+        visible.resize(cache.Cull(frustum, eye, bounds, visible.data(), pool));
+        return visible;
+    }
+
+    // Walks the camera in small steps with the odd jump, moves a few boxes every frame
+    // and checks each frame against culling from scratch.
+    bool MatchesFullCullOverWalk(uint32 count, uint32 frames, uint32 seed, WorkerPool* pool) {
+        std::mt19937 rng(seed);
+        CullingBounds bounds = RandomBounds(count, rng);
+        std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+        std::uniform_real_distribution<float> turn(-0.02f, 0.02f);
+        std::uniform_int_distribution<uint32> box(0, count - 1);
+
+        VisibilityCache cache;
+        float eye[3] = { 0.0f, 0.0f, 0.0f };
+        float yaw = 0.0f;
+        bool agree = true;
+        for (uint32 frame = 0; frame < frames; ++frame) {
+            if (frame % 25 == 24) {
+                yaw += 1.5f;
+                eye[0] += 150.0f;
+            }
+            else if (frame % 5 != 4) {      // Every fifth frame keeps the camera still
+                eye[0] += step(rng);
+                eye[1] += step(rng) * 0.1f;
+                eye[2] += step(rng);
+                yaw += turn(rng);
+            }
+
+            for (uint32 moved = 0; moved < count / 100; ++moved) {
+                uint32 i = box(rng);
+                SetRandomBox(bounds, i, rng);
+                cache.Invalidate(i);
+            }
+
+            FrustumPlanes frustum = MakeFrustum(eye, yaw);
+            agree = agree && Agree(frustum, bounds, Cull(cache, frustum, eye, bounds, pool), Reference(frustum, bounds));
+        }
+        return agree;
+    }
+}
+
+TEST_CASE(MatchesFullCullWhileTheCameraMoves) {
+    CHECK(MatchesFullCullOverWalk(3000, 200, 1, nullptr));
+    CHECK(MatchesFullCullOverWalk(700, 400, 2, nullptr));
+}
+
+TEST_CASE(MatchesFullCullAcrossWorkers) {
+    WorkerPool pool(3);
+    CHECK(MatchesFullCullOverWalk(VisibilityCache::ParallelThreshold + 100, 40, 3, &pool));
+}
+
+TEST_CASE(MovedBoxesAreAlwaysRetested) {
+    std::mt19937 rng(4);
+    CullingBounds bounds = RandomBounds(1000, rng);
+    const float eye[3] = { 0.0f, 0.0f, 0.0f };
+    FrustumPlanes frustum = MakeFrustum(eye, 0.0f);
+
+    VisibilityCache cache;
+    Cull(cache, frustum, eye, bounds);
+
+    // Deep inside the frustum, then far behind the camera, without the camera moving.
+    const float inside[3] = { 0.0f, 0.0f, 300.0f };
+    const float behind[3] = { 0.0f, 0.0f, -300.0f };
+    const float extents[3] = { 1.0f, 1.0f, 1.0f };
+    for (const float* center : { inside, behind, inside }) {
+        bounds.Set(7, center, extents);
+        cache.Invalidate(7);
+        cache.Invalidate(7);        // Twice in a frame is still one retest
+
+        Vector<uint32> visible = Cull(cache, frustum, eye, bounds);
+        bool hasBox = std::find(visible.begin(), visible.end(), 7u) != visible.end();
+        CHECK(hasBox == (center == inside));
+        CHECK(visible == Reference(frustum, bounds));
+        CHECK(cache.GetStats().misses == 1);
+        CHECK(cache.GetStats().hits == 999);
+        CHECK(!cache.GetStats().idle && !cache.GetStats().rebased);
+    }
+}
+
+TEST_CASE(StatsTellHitsMissesIdleAndRebase) {
+    std::mt19937 rng(5);
+    CullingBounds bounds = RandomBounds(2000, rng);
+    float eye[3] = { 0.0f, 0.0f, 0.0f };
+
+    VisibilityCache cache;
+    FrustumPlanes frustum = MakeFrustum(eye, 0.0f);
+    Vector<uint32> first = Cull(cache, frustum, eye, bounds);
+    CHECK(cache.GetStats().rebased);
+    CHECK(cache.GetStats().misses == 2000 && cache.GetStats().hits == 0);
+
+    // Nothing changed: the last result is copied.
+    CHECK(Cull(cache, frustum, eye, bounds) == first);
+    CHECK(cache.GetStats().idle && !cache.GetStats().rebased);
+    CHECK(cache.GetStats().hits == 2000 && cache.GetStats().misses == 0);
+
+    // A small step only retests the boxes close to a plane.
+    eye[2] += 5.0f;
+    frustum = MakeFrustum(eye, 0.0f);
+    CHECK(Cull(cache, frustum, eye, bounds) == Reference(frustum, bounds));
+    const VisibilityCache::Stats& stats = cache.GetStats();
+    CHECK(!stats.idle && !stats.rebased);
+    CHECK(stats.hits + stats.misses == 2000);
+    CHECK(stats.misses > 0 && stats.misses < 2000 / 4);
+
+    // Turning around leaves few margins that still hold, so the next frame rebases.
+    frustum = MakeFrustum(eye, 3.0f);
+    CHECK(Cull(cache, frustum, eye, bounds) == Reference(frustum, bounds));
+    CHECK(cache.GetStats().misses > 2000 / 4 && !cache.GetStats().rebased);
+    eye[0] += 0.5f;
+    frustum = MakeFrustum(eye, 3.0f);
+    CHECK(Cull(cache, frustum, eye, bounds) == Reference(frustum, bounds));
+    CHECK(cache.GetStats().rebased && cache.GetStats().misses == 2000);
+
+    // InvalidateAll and a changed box count both rebase too.
+    cache.InvalidateAll();
+    Cull(cache, frustum, eye, bounds);
+    CHECK(cache.GetStats().rebased);
+    bounds.Resize(2100);
+    Cull(cache, frustum, eye, bounds);
+    CHECK(cache.GetStats().rebased && cache.GetStats().misses == 2100);
+}
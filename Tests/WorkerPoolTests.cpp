@@ -0,0 +1,78 @@
+#include "TestMain.h"
+#include <WorkerPool.h>
+#include <stdexcept>
+
+TEST_CASE(EveryElementRunsOnce) {
+    WorkerPool pool(3);
+    Vector<std::atomic<uint32>> hits(10000);
+    pool.ParallelFor(10000, 8, [&hits](uint32 begin, uint32 end) {
+        CHECK(begin % 8 == 0);
+        for (uint32 i = begin; i < end; ++i) hits[i].fetch_add(1);
+    });
+    for (auto& hit : hits) CHECK(hit.load() == 1);
+}
+
+TEST_CASE(PoolWithoutWorkersRunsInline) {
+    WorkerPool pool(0);
+    uint32 calls = 0;
+    pool.ParallelFor(1000, 1, [&calls](uint32 begin, uint32 end) {
+        CHECK(begin == 0 && end == 1000);
+        ++calls;
+    });
+    CHECK(calls == 1);
+}
+
+TEST_CASE(NestedCallsRunInline) {
+    WorkerPool pool(3);
+    std::atomic<uint32> inner{ 0 };
+    pool.ParallelFor(64, 1, [&](uint32 begin, uint32 end) {
+        for (uint32 i = begin; i < end; ++i) {
+            // Workers and the calling thread both get here; neither may block on the pool.
+            pool.ParallelFor(100, 1, [&inner](uint32 innerBegin, uint32 innerEnd) {
+                inner.fetch_add(innerEnd - innerBegin);
+            });
+        }
+    });
+    CHECK(inner.load() == 64 * 100);
+
+    // The pool still splits work once the outer call returned.
+    std::atomic<uint32> batches{ 0 };
+    pool.ParallelFor(10000, 1, [&batches](uint32, uint32) { batches.fetch_add(1); });
+    CHECK(batches.load() > 1);
+}
+
+TEST_CASE(ExceptionsReachTheCaller) {
+    WorkerPool pool(3);
+    std::atomic<uint32> started{ 0 };
+    bool caught = false;
+    try {
+        pool.ParallelFor(10000, 1, [&started](uint32 begin, uint32) {
+            started.fetch_add(1);
+            if (begin == 0) throw std::runtime_error("batch failed");
+        });
+    }
+    catch (const std::runtime_error& error) {
+        caught = String(error.what()) == "batch failed";
+    }
+    CHECK(caught);
+
+    // The pool survives and runs the next loop completely.
+    std::atomic<uint32> sum{ 0 };
+    pool.ParallelFor(10000, 1, [&sum](uint32 begin, uint32 end) { sum.fetch_add(end - begin); });
+    CHECK(sum.load() == 10000);
+}
+
+TEST_CASE(ConcurrentCallersAreSerialized) {
+    WorkerPool pool(2);
+    std::atomic<uint32> sum{ 0 };
+    auto work = [&] {
+        for (uint32 i = 0; i < 50; ++i) {
+            pool.ParallelFor(1000, 1, [&sum](uint32 begin, uint32 end) { sum.fetch_add(end - begin); });
+        }
+    };
+    std::thread a(work);
+    std::thread b(work);
+    a.join();
+    b.join();
+    CHECK(sum.load() == 2 * 50 * 1000);
+}